@@ -0,0 +1,155 @@
+#include "corpus.h"
+#include <QFile>
+
+namespace {
+    const char* const Words[] = {
+        "editor", "document", "markdown", "preview", "render", "layout", "buffer", "cursor",
+        "latency", "memory", "thread", "index", "search", "highlight", "block", "paragraph",
+        "the", "a", "of", "and", "to", "in", "is", "for", "with", "on", "that", "by",
+        "文档", "编辑器", "预览", "性能", "内存", "线程"
+    };
+    const int WordCount = int(sizeof(Words) / sizeof(Words[0]));
+
+    const qint64 WriteChunkSize = 4 * 1024 * 1024;
+
+    // 截断到 length 字节；末尾不完整的 UTF-8 字符改为换行补齐，保证语料总是合法 UTF-8
+    void truncateTo(QByteArray& text, qint64 length)
+    {
+        text.truncate(length);
+        qint64 keep = text.size();
+        while (keep > 0 && (uchar(text[keep - 1]) & 0x80))
+            --keep;
+        for (qint64 i = keep; i < text.size(); ++i)
+            text[i] = '\n';
+    }
+}
+
+CorpusGenerator::CorpusGenerator(quint32 seed)
+    : m_random(seed)
+    , m_section(0)
+{
+}
+
+QByteArray CorpusGenerator::word()
+{
+    return Words[m_random.bounded(WordCount)];
+}
+
+QByteArray CorpusGenerator::sentence()
+{
+    QByteArray text;
+    const int words = 6 + m_random.bounded(14);
+    for (int i = 0; i < words; ++i)
+    {
+        if (i > 0)
+            text += ' ';
+        switch (m_random.bounded(24))
+        {
+        case 0:
+            text += "**" + word() + "**";
+            break;
+        case 1:
+            text += '*' + word() + '*';
+            break;
+        case 2:
+            text += '`' + word() + "()`";
+            break;
+        case 3:
+            text += '[' + word() + "](https://example.com/" + word() + ')';
+            break;
+        default:
+            text += word();
+            break;
+        }
+    }
+    if (text[0] >= 'a' && text[0] <= 'z')
+        text[0] = char(text[0] - ('a' - 'A'));
+    return text + '.';
+}
+
+QByteArray CorpusGenerator::paragraph()
+{
+    QByteArray text;
+    const int sentences = 2 + m_random.bounded(5);
+    for (int i = 0; i < sentences; ++i)
+    {
+        text += sentence();
+        // 大约每 80 个字符换行，接近真实文档的行长
+        text += (i % 2 == 1) ? '\n' : ' ';
+    }
+    if (!text.endsWith('\n'))
+        text += '\n';
+    return text + '\n';
+}
+
+QByteArray CorpusGenerator::nextSection()
+{
+    QByteArray text;
+    const int section = m_section++;
+
+    text += QByteArray(1 + section % 3, '#') + ' ' + sentence() + "\n\n";
+    text += paragraph();
+
+    switch (section % 5)
+    {
+    case 0:
+        for (int i = 0; i < 4 + m_random.bounded(6); ++i)
+            text += (i % 3 == 2 ? "  - " : "- ") + sentence() + '\n';
+        text += '\n';
+        break;
+    case 1:
+        text += "```cpp\n";
+        for (int i = 0; i < 6 + m_random.bounded(10); ++i)
+            text += "    auto " + word() + " = " + word() + "->" + word() + "(" + QByteArray::number(i) + ");\n";
+        text += "```\n\n";
+        break;
+    case 2:
+        text += "> " + sentence() + "\n> " + sentence() + "\n\n";
+        break;
+    case 3:
+        text += "| Name | Value | Notes |\n| :--- | ---: | --- |\n";
+        for (int i = 0; i < 3 + m_random.bounded(8); ++i)
+            text += "| " + word() + " | " + QByteArray::number(m_random.bounded(10000)) + " | " + word() + ' ' + word() + " |\n";
+        text += '\n';
+        break;
+    default:
+        text += "1. " + sentence() + "\n2. " + sentence() + "\n\n---\n\n";
+        break;
+    }
+
+    text += paragraph();
+    return text;
+}
+
+QByteArray CorpusGenerator::generate(qint64 size)
+{
+    QByteArray text;
+    text.reserve(size);
+    while (text.size() < size)
+        text += nextSection();
+    truncateTo(text, size);
+    return text;
+}
+
+bool CorpusGenerator::writeFile(const QString& path, qint64 size)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray chunk;
+    qint64 written = 0;
+    while (written < size)
+    {
+        while (chunk.size() < WriteChunkSize && written + chunk.size() < size)
+            chunk += nextSection();
+        const qint64 length = qMin<qint64>(chunk.size(), size - written);
+        if (length < chunk.size())
+            truncateTo(chunk, length);
+        if (file.write(chunk.constData(), length) != length)
+            return false;
+        written += length;
+        chunk.clear();
+    }
+    return true;
+}
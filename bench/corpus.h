@@ -0,0 +1,31 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QString>
+
+// 确定性的合成 Markdown 语料：标题、段落（含强调、行内代码与链接）、列表、
+// 引用、代码块与表格按固定比例交替出现，同一种子总是生成相同的内容
+class CorpusGenerator
+{
+public:
+    explicit CorpusGenerator(quint32 seed = 1);
+
+    // 生成下一节内容（几百字节到几 KB）
+    QByteArray nextSection();
+
+    // 生成恰好 size 字节的语料；写文件时按块流式写出，1 GB 也不需要整块内存
+    QByteArray generate(qint64 size);
+    bool writeFile(const QString& path, qint64 size);
+
+private:
+    QByteArray word();
+    QByteArray sentence();
+    QByteArray paragraph();
+
+    QRandomGenerator m_random;
+    int m_section;
+};
+
+#endif // BENCH_CORPUS_H
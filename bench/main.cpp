@@ -0,0 +1,578 @@
+// 无界面性能基准：在 offscreen 平台插件下运行，生成 1 KB - 1 GB 的合成 Markdown 语料，
+// 测量打开、保存、setPlainText、连续输入、滚动绘制、Tab 切换与高亮，结果以 JSON 输出，
+// 可与基准线文件比较（中位数超过容差即视为回退，退出码为 2）
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QKeyEvent>
+#include <QPointer>
+#include <QScrollBar>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextBlock>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include "corpus.h"
+#include "ui/codeeditor.h"
+#include "ui/largefileview.h"
+#include "ui/markdownhighlighter.h"
+#include "ui/undomanager.h"
+#include "ui/notepad.h"
+#include "core/fileloader.h"
+#include "core/filesaver.h"
+
+namespace {
+    // 与 Notepad 一致：超过该大小的文件使用 LargeFileView
+    const qint64 LargeFileThreshold = 256LL * 1024 * 1024;
+
+    struct BenchConfig
+    {
+        QList<qint64> sizes;
+        QStringList only;
+        int iterations = 5;
+        qint64 editorLimit = 64LL * 1024 * 1024;   // 超过该大小不再测试需要 CodeEditor 持有全文的项目
+        int keystrokes = 200;
+        int scrollFrames = 200;
+        int tabCount = 1000;
+    };
+
+    qint64 parseSize(const QString& text, bool* ok)
+    {
+        QString value = text.trimmed().toUpper();
+        qint64 unit = 1;
+        if (value.endsWith('K'))
+            unit = 1024;
+        else if (value.endsWith('M'))
+            unit = 1024 * 1024;
+        else if (value.endsWith('G'))
+            unit = 1024LL * 1024 * 1024;
+        if (unit > 1)
+            value.chop(1);
+        qint64 number = value.toLongLong(ok);
+        return number * unit;
+    }
+
+    QString sizeLabel(qint64 size)
+    {
+        if (size >= 1024LL * 1024 * 1024 && size % (1024LL * 1024 * 1024) == 0)
+            return QString("%1G").arg(size / (1024LL * 1024 * 1024));
+        if (size >= 1024 * 1024 && size % (1024 * 1024) == 0)
+            return QString("%1M").arg(size / (1024 * 1024));
+        if (size >= 1024 && size % 1024 == 0)
+            return QString("%1K").arg(size / 1024);
+        return QString::number(size);
+    }
+
+    // 处理事件直到条件满足或超时
+    bool waitFor(const std::function<bool()>& done, int timeoutMs = 600000)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (!done())
+        {
+            if (timer.hasExpired(timeoutMs))
+                return false;
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+        }
+        return true;
+    }
+
+    class BenchRunner
+    {
+    public:
+        BenchRunner(const BenchConfig& config, const QString& workDir)
+            : m_config(config)
+            , m_workDir(workDir)
+        {
+        }
+
+        QJsonArray results() const { return m_results; }
+
+        void run()
+        {
+            for (qint64 size : m_config.sizes)
+            {
+                const QString path = QDir(m_workDir).filePath(QString("corpus-%1.md").arg(sizeLabel(size)));
+                QElapsedTimer timer;
+                timer.start();
+                CorpusGenerator generator(quint32(size));
+                if (!generator.writeFile(path, size))
+                {
+                    std::fprintf(stderr, "Cannot write corpus %s\n", qPrintable(path));
+                    continue;
+                }
+                std::fprintf(stderr, "corpus %s generated in %lld ms\n", qPrintable(sizeLabel(size)), timer.elapsed());
+
+                if (size >= LargeFileThreshold)
+                {
+                    benchLargeFile(path, size);
+                    continue;
+                }
+
+                if (enabled("open"))
+                    benchOpen(path, size);
+                QFile::remove(path);
+                if (size > m_config.editorLimit)
+                    continue;
+
+                const QString text = QString::fromUtf8(CorpusGenerator(quint32(size)).generate(size));
+                if (enabled("save"))
+                    benchSave(text, size);
+                if (enabled("setPlainText"))
+                    benchSetPlainText(text, size);
+                if (enabled("highlight"))
+                    benchHighlight(text, size);
+                if (enabled("typing"))
+                    benchTyping(text, size);
+                if (enabled("scroll"))
+                    benchScroll(text, size);
+            }
+
+            if (enabled("tabSwitch"))
+                benchTabs();
+        }
+
+    private:
+        bool enabled(const QString& name) const
+        {
+            return m_config.only.isEmpty() || m_config.only.contains(name);
+        }
+
+        int iterationsFor(qint64 size) const
+        {
+            // 大语料单次耗时已足够稳定，减少重复次数
+            if (size >= 16 * 1024 * 1024)
+                return 1;
+            if (size >= 1024 * 1024)
+                return qMin(3, m_config.iterations);
+            return m_config.iterations;
+        }
+
+        void record(const QString& name, qint64 size, QVector<qint64> samplesNs, qint64 bytesPerSample = 0)
+        {
+            if (samplesNs.isEmpty())
+                return;
+            std::sort(samplesNs.begin(), samplesNs.end());
+
+            qint64 total = 0;
+            for (qint64 sample : std::as_const(samplesNs))
+                total += sample;
+            auto percentile = [&samplesNs](double p) {
+                int index = qBound(0, int(p * (samplesNs.size() - 1) + 0.5), int(samplesNs.size()) - 1);
+                return samplesNs[index] / 1e6;
+            };
+
+            QJsonObject result;
+            result.insert("name", name);
+            result.insert("size", double(size));
+            result.insert("sizeLabel", sizeLabel(size));
+            result.insert("samples", samplesNs.size());
+            result.insert("meanMs", total / 1e6 / samplesNs.size());
+            result.insert("p50Ms", percentile(0.5));
+            result.insert("p95Ms", percentile(0.95));
+            result.insert("maxMs", samplesNs.last() / 1e6);
+            if (bytesPerSample > 0 && total > 0)
+                result.insert("mbPerSec", bytesPerSample * double(samplesNs.size()) / (1024.0 * 1024.0) / (total / 1e9));
+            m_results.append(result);
+
+            std::fprintf(stderr, "  %-14s %6s  p50 %10.3f ms  p95 %10.3f ms\n", qPrintable(name),
+                         qPrintable(sizeLabel(size)), percentile(0.5), percentile(0.95));
+        }
+
+        void benchOpen(const QString& path, qint64 size)
+        {
+            QVector<qint64> samples;
+            for (int i = 0; i < iterationsFor(size); ++i)
+            {
+                // 与 Notepad::startLoading 相同：后台解码，GUI 线程逐块插入文档
+                CodeEditor editor;
+                editor.setReadOnly(true);
+                editor.undoManager()->setEnabled(false);
+
+                QElapsedTimer timer;
+                timer.start();
+                FileLoader loader(path);
+                bool finished = false;
+                QObject::connect(&loader, &FileLoader::chunkReady, &editor, [&editor, &loader](const QString& text) {
+                    QTextCursor cursor(editor.document());
+                    cursor.movePosition(QTextCursor::End);
+                    cursor.insertText(text);
+                    loader.chunkConsumed();
+                });
+                QObject::connect(&loader, &FileLoader::finished, [&finished]() { finished = true; });
+                QObject::connect(&loader, &FileLoader::failed, [&finished]() { finished = true; });
+                loader.start();
+                waitFor([&finished]() { return finished; });
+                samples.append(timer.nsecsElapsed());
+            }
+            record("open", size, samples, size);
+        }
+
+        void benchSave(const QString& text, qint64 size)
+        {
+            QVector<qint64> samples;
+            const QString target = QDir(m_workDir).filePath("saved.md");
+            for (int i = 0; i < iterationsFor(size); ++i)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                FileSaver saver(target, text, TextFormat());
+                bool finished = false;
+                QObject::connect(&saver, &FileSaver::finished, [&finished]() { finished = true; });
+                QObject::connect(&saver, &FileSaver::failed, [&finished]() { finished = true; });
+                saver.start();
+                waitFor([&finished]() { return finished; });
+                samples.append(timer.nsecsElapsed());
+            }
+            QFile::remove(target);
+            record("save", size, samples, size);
+        }
+
+        void benchSetPlainText(const QString& text, qint64 size)
+        {
+            QVector<qint64> samples;
+            for (int i = 0; i < iterationsFor(size); ++i)
+            {
+                CodeEditor editor;
+                QElapsedTimer timer;
+                timer.start();
+                editor.setPlainText(text);
+                samples.append(timer.nsecsElapsed());
+            }
+            record("setPlainText", size, samples, size);
+        }
+
+        void benchHighlight(const QString& text, qint64 size)
+        {
+            CodeEditor editor;
+            editor.setPlainText(text);
+            QVector<qint64> samples;
+            for (int i = 0; i < iterationsFor(size); ++i)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                editor.highlighter()->rehighlightAll();
+                samples.append(timer.nsecsElapsed());
+            }
+            record("highlight", size, samples, size);
+        }
+
+        void benchTyping(const QString& text, qint64 size)
+        {
+            CodeEditor editor;
+            editor.resize(1200, 800);
+            editor.setPlainText(text);
+            editor.show();
+            waitFor([&editor]() { return !editor.highlighter()->isPending(); });
+
+            // 在文档中部输入，包括换行，每次按键后处理完事件（含重绘）才计时结束
+            QTextCursor cursor(editor.document()->findBlockByNumber(editor.blockCount() / 2));
+            editor.setTextCursor(cursor);
+            editor.centerCursor();
+
+            const QString keys = "typing burst ";
+            QVector<qint64> samples;
+            for (int i = 0; i < m_config.keystrokes; ++i)
+            {
+                const bool newline = (i % 40) == 39;
+                const QChar c = keys[i % keys.size()];
+                const int key = newline ? Qt::Key_Return : (c == ' ' ? Qt::Key_Space : Qt::Key_A + (c.unicode() - 'a'));
+                QKeyEvent press(QEvent::KeyPress, key, Qt::NoModifier, newline ? QString("\r") : QString(c));
+                QKeyEvent release(QEvent::KeyRelease, key, Qt::NoModifier, newline ? QString("\r") : QString(c));
+
+                QElapsedTimer timer;
+                timer.start();
+                QApplication::sendEvent(&editor, &press);
+                QApplication::sendEvent(&editor, &release);
+                editor.repaint();
+                QCoreApplication::processEvents();
+                samples.append(timer.nsecsElapsed());
+            }
+            record("typing", size, samples);
+        }
+
+        void benchScroll(const QString& text, qint64 size)
+        {
+            CodeEditor editor;
+            editor.resize(1200, 800);
+            editor.setPlainText(text);
+            editor.show();
+            QCoreApplication::processEvents();
+
+            // 每帧跳到新的位置并同步重绘，包含行号区的 lineNumberAreaPaintEvent
+            QScrollBar* bar = editor.verticalScrollBar();
+            const int frames = m_config.scrollFrames;
+            QVector<qint64> samples;
+            for (int i = 0; i < frames; ++i)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                bar->setValue(int(qint64(bar->maximum()) * i / qMax(1, frames - 1)));
+                editor.repaint();
+                QCoreApplication::processEvents();
+                samples.append(timer.nsecsElapsed());
+            }
+            record("scroll", size, samples);
+        }
+
+        void benchLargeFile(const QString& path, qint64 size)
+        {
+            // 滚动与保存都需要先打开文件，但各自只受自己的名字控制
+            if (enabled("open") || enabled("scroll") || enabled("save"))
+            {
+                LargeFileView view;
+                view.resize(1200, 800);
+                bool indexed = false;
+                QObject::connect(&view, &LargeFileView::lineIndexReady, [&indexed]() { indexed = true; });
+
+                QElapsedTimer timer;
+                timer.start();
+                QString error;
+                if (!view.openFile(path, &error))
+                {
+                    std::fprintf(stderr, "Cannot open %s: %s\n", qPrintable(path), qPrintable(error));
+                    QFile::remove(path);
+                    return;
+                }
+                const qint64 openNs = timer.nsecsElapsed();
+                waitFor([&indexed]() { return indexed; });
+                if (enabled("open"))
+                {
+                    record("open", size, { openNs }, size);
+                    record("lineIndex", size, { timer.nsecsElapsed() }, size);
+                }
+
+                if (enabled("scroll"))
+                {
+                    view.show();
+                    QScrollBar* bar = view.verticalScrollBar();
+                    QVector<qint64> samples;
+                    for (int i = 0; i < m_config.scrollFrames; ++i)
+                    {
+                        QElapsedTimer frame;
+                        frame.start();
+                        bar->setValue(int(qint64(bar->maximum()) * i / qMax(1, m_config.scrollFrames - 1)));
+                        view.repaint();
+                        QCoreApplication::processEvents();
+                        samples.append(frame.nsecsElapsed());
+                    }
+                    record("scroll", size, samples);
+                }
+
+                if (enabled("save"))
+                {
+                    const QString target = QDir(m_workDir).filePath("saved-large.md");
+                    QElapsedTimer saveTimer;
+                    saveTimer.start();
+                    FileSaver saver(target, view.buffer().snapshot());
+                    bool finished = false;
+                    QObject::connect(&saver, &FileSaver::finished, [&finished]() { finished = true; });
+                    QObject::connect(&saver, &FileSaver::failed, [&finished]() { finished = true; });
+                    saver.start();
+                    waitFor([&finished]() { return finished; });
+                    record("save", size, { saveTimer.nsecsElapsed() }, size);
+                    QFile::remove(target);
+                }
+            }
+            QFile::remove(path);
+        }
+
+        void benchTabs()
+        {
+            CustomTabBar tabBar;
+            tabBar.resize(1600, 36);
+            tabBar.show();
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < m_config.tabCount; ++i)
+                tabBar.addTab(QString("document-%1.md").arg(i));
+            QCoreApplication::processEvents();
+            record("tabCreate", m_config.tabCount, { timer.nsecsElapsed() });
+
+            // 伪随机的切换顺序，每次切换后同步重绘标签栏
+            QVector<qint64> samples;
+            quint32 state = 12345;
+            for (int i = 0; i < 500; ++i)
+            {
+                state = state * 1103515245u + 12345u;
+                QElapsedTimer frame;
+                frame.start();
+                tabBar.setCurrentIndex(int((state >> 8) % quint32(m_config.tabCount)));
+                tabBar.repaint();
+                QCoreApplication::processEvents();
+                samples.append(frame.nsecsElapsed());
+            }
+            record("tabSwitch", m_config.tabCount, samples);
+        }
+
+        BenchConfig m_config;
+        QString m_workDir;
+        QJsonArray m_results;
+    };
+
+    // 与基准线比较中位数，返回回退的项目数；基准线无法读取或格式不对时返回 -1
+    int compareWithBaseline(const QJsonArray& results, const QString& baselinePath, double tolerance, QJsonArray* comparison)
+    {
+        QFile file(baselinePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            std::fprintf(stderr, "Cannot read baseline %s: %s\n", qPrintable(baselinePath), qPrintable(file.errorString()));
+            return -1;
+        }
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.object().value("results").isArray())
+        {
+            std::fprintf(stderr, "Invalid baseline %s: %s\n", qPrintable(baselinePath),
+                         parseError.error != QJsonParseError::NoError ? qPrintable(parseError.errorString()) : "no results array");
+            return -1;
+        }
+
+        QHash<QString, double> baseline;
+        const QJsonArray baselineResults = document.object().value("results").toArray();
+        for (const QJsonValue& value : baselineResults)
+        {
+            QJsonObject object = value.toObject();
+            baseline.insert(object.value("name").toString() + '@' + object.value("sizeLabel").toString(),
+                            object.value("p50Ms").toDouble());
+        }
+
+        int regressions = 0;
+        for (const QJsonValue& value : results)
+        {
+            QJsonObject object = value.toObject();
+            const QString key = object.value("name").toString() + '@' + object.value("sizeLabel").toString();
+            if (!baseline.contains(key))
+                continue;
+
+            const double before = baseline.value(key);
+            const double after = object.value("p50Ms").toDouble();
+            const double change = before > 0 ? (after - before) / before * 100.0 : 0.0;
+            const bool regressed = change > tolerance;
+            regressions += regressed ? 1 : 0;
+
+            QJsonObject entry;
+            entry.insert("key", key);
+            entry.insert("baselineP50Ms", before);
+            entry.insert("p50Ms", after);
+            entry.insert("changePercent", change);
+            entry.insert("regressed", regressed);
+            comparison->append(entry);
+
+            std::fprintf(stderr, "%s %-24s %10.3f -> %10.3f ms (%+.1f%%)\n", regressed ? "REGRESSED" : "ok       ",
+                         qPrintable(key), before, after, change);
+        }
+        return regressions;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认使用 offscreen 平台插件，无需显示服务器
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("markdowneditor_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless performance benchmarks for MarkdownEditor");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma separated corpus sizes (default 1K,64K,1M,16M).", "list", "1K,64K,1M,16M");
+    QCommandLineOption fullOption("full", "Also run the 256M and 1G corpora.");
+    QCommandLineOption onlyOption("only", "Comma separated benchmarks: open, save, setPlainText, highlight, typing, scroll, tabSwitch.", "list");
+    QCommandLineOption iterationsOption("iterations", "Repetitions for small corpora (default 5).", "n", "5");
+    QCommandLineOption editorLimitOption("editor-limit", "Largest corpus loaded into a CodeEditor for setPlainText, highlight, typing and scroll (default 64M).", "size", "64M");
+    QCommandLineOption outputOption("output", "Write JSON results to this file instead of stdout.", "file");
+    QCommandLineOption baselineOption("baseline", "Compare medians with a previous JSON result.", "file");
+    QCommandLineOption toleranceOption("tolerance", "Allowed slowdown in percent before a result counts as a regression (default 10).", "percent", "10");
+    parser.addOptions({ sizesOption, fullOption, onlyOption, iterationsOption, editorLimitOption, outputOption, baselineOption, toleranceOption });
+    parser.process(app);
+
+    BenchConfig config;
+    QStringList sizeList = parser.value(sizesOption).split(',', Qt::SkipEmptyParts);
+    if (parser.isSet(fullOption))
+        sizeList << "256M" << "1G";
+    for (const QString& text : std::as_const(sizeList))
+    {
+        bool ok = false;
+        qint64 size = parseSize(text, &ok);
+        if (!ok || size <= 0)
+        {
+            std::fprintf(stderr, "Invalid size: %s\n", qPrintable(text));
+            return 1;
+        }
+        config.sizes.append(size);
+    }
+    if (parser.isSet(onlyOption))
+        config.only = parser.value(onlyOption).split(',', Qt::SkipEmptyParts);
+    config.iterations = qMax(1, parser.value(iterationsOption).toInt());
+    bool limitOk = false;
+    config.editorLimit = parseSize(parser.value(editorLimitOption), &limitOk);
+    if (!limitOk)
+    {
+        std::fprintf(stderr, "Invalid editor limit: %s\n", qPrintable(parser.value(editorLimitOption)));
+        return 1;
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+    {
+        std::fprintf(stderr, "Cannot create a temporary directory\n");
+        return 1;
+    }
+
+    BenchRunner runner(config, workDir.path());
+    runner.run();
+
+    QJsonObject root;
+    root.insert("schema", 1);
+    root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("qtVersion", QString(qVersion()));
+    root.insert("platform", QGuiApplication::platformName());
+    root.insert("os", QSysInfo::prettyProductName());
+    root.insert("cpuArchitecture", QSysInfo::currentCpuArchitecture());
+    root.insert("cpuCount", QThread::idealThreadCount());
+    root.insert("results", runner.results());
+
+    int regressions = 0;
+    if (parser.isSet(baselineOption))
+    {
+        QJsonArray comparison;
+        regressions = compareWithBaseline(runner.results(), parser.value(baselineOption),
+                                          parser.value(toleranceOption).toDouble(), &comparison);
+        // 无法比较时不能当作没有回退
+        if (regressions < 0)
+            return 2;
+        root.insert("comparison", comparison);
+        root.insert("regressions", regressions);
+    }
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption))
+    {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+        {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(outputOption)));
+            return 1;
+        }
+    }
+    else
+    {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+
+    return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,568 @@
+#include "batchprocessor.h"
+#include "filereloader.h"
+#include "markdownparser.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const QStringList MarkdownFilters = { "*.md", "*.markdown", "*.mdown", "*.mkd" };
+
+    QString formatMegabytes(qint64 bytes)
+    {
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+    }
+
+    int trailingWhitespace(QStringView line)
+    {
+        int count = 0;
+        while (count < line.size())
+        {
+            const QChar c = line.at(line.size() - 1 - count);
+            if (c != QLatin1Char(' ') && c != QLatin1Char('\t'))
+                break;
+            ++count;
+        }
+        return count;
+    }
+
+    // 行尾恰好是两个以上空格时是 Markdown 的硬换行，块的最后一行除外
+    bool isHardBreak(QStringView line, int trailing, bool lastInBlock)
+    {
+        if (lastInBlock || trailing < 2 || trailing == line.size())
+            return false;
+        for (int i = line.size() - trailing; i < line.size(); ++i)
+        {
+            if (line.at(i) != QLatin1Char(' '))
+                return false;
+        }
+        return true;
+    }
+
+    bool keepsWhitespace(MarkdownParser::BlockKind kind)
+    {
+        return kind == MarkdownParser::FencedCode || kind == MarkdownParser::IndentedCode
+            || kind == MarkdownParser::Html;
+    }
+
+    int headingLevel(QStringView source, MarkdownParser::BlockKind kind)
+    {
+        if (kind == MarkdownParser::SetextHeading)
+        {
+            const QStringView underline = source.mid(source.lastIndexOf(QLatin1Char('\n')) + 1).trimmed();
+            return underline.startsWith(QLatin1Char('=')) ? 1 : 2;
+        }
+        const QStringView line = source.trimmed();
+        int level = 0;
+        while (level < line.size() && line.at(level) == QLatin1Char('#'))
+            ++level;
+        return level;
+    }
+
+    // 形如 "#Title" 的行不是标题：# 之后缺少空格
+    bool isMalformedHeading(QStringView source)
+    {
+        const qsizetype end = source.indexOf(QLatin1Char('\n'));
+        const QStringView line = end < 0 ? source : source.left(end);
+        int pos = 0;
+        while (pos < line.size() && pos < 3 && line.at(pos) == QLatin1Char(' '))
+            ++pos;
+        int hashes = 0;
+        while (pos + hashes < line.size() && line.at(pos + hashes) == QLatin1Char('#'))
+            ++hashes;
+        return hashes >= 1 && hashes <= 6 && pos + hashes < line.size() && !line.at(pos + hashes).isSpace();
+    }
+
+    // 代码块直到文档末尾都没有闭合围栏
+    bool isUnclosedFence(QStringView source)
+    {
+        const QStringView opener = source.trimmed();
+        const QChar fence = opener.at(0);
+        int length = 0;
+        while (length < opener.size() && opener.at(length) == fence)
+            ++length;
+
+        const int lastBreak = source.lastIndexOf(QLatin1Char('\n'));
+        if (lastBreak < 0)
+            return true;
+        const QStringView closer = source.mid(lastBreak + 1).trimmed();
+        if (closer.size() < length)
+            return true;
+        for (QChar c : closer)
+        {
+            if (c != fence)
+                return true;
+        }
+        return false;
+    }
+
+    // 跳过引用符号与列表标记后的围栏（``` 或 ~~~）长度，不是围栏时为 0；
+    // bare 表示围栏之后只有空白（可以作为闭合围栏）
+    int fenceLength(QStringView line, QChar* fence, bool* bare)
+    {
+        const auto isBlank = [](QChar c) { return c == QLatin1Char(' ') || c == QLatin1Char('\t'); };
+        qsizetype pos = 0;
+        for (;;)
+        {
+            while (pos < line.size() && isBlank(line.at(pos)))
+                ++pos;
+            if (pos < line.size() && line.at(pos) == QLatin1Char('>'))
+            {
+                ++pos;
+                continue;
+            }
+            qsizetype marker = pos;
+            if (marker < line.size() && (line.at(marker) == QLatin1Char('-') || line.at(marker) == QLatin1Char('*')
+                                         || line.at(marker) == QLatin1Char('+')))
+            {
+                ++marker;
+            }
+            else
+            {
+                while (marker < line.size() && marker - pos < 9 && line.at(marker).isDigit())
+                    ++marker;
+                if (marker > pos && marker < line.size()
+                    && (line.at(marker) == QLatin1Char('.') || line.at(marker) == QLatin1Char(')')))
+                    ++marker;
+                else
+                    marker = pos;
+            }
+            if (marker > pos && marker < line.size() && isBlank(line.at(marker)))
+            {
+                pos = marker;
+                continue;
+            }
+            break;
+        }
+
+        if (pos >= line.size() || (line.at(pos) != QLatin1Char('`') && line.at(pos) != QLatin1Char('~')))
+            return 0;
+        const QChar c = line.at(pos);
+        int length = 0;
+        while (pos + length < line.size() && line.at(pos + length) == c)
+            ++length;
+        if (length < 3)
+            return 0;
+        *fence = c;
+        *bare = line.mid(pos + length).trimmed().isEmpty();
+        return length;
+    }
+
+    // 列表与引用中嵌套的围栏代码：逐行跟踪围栏的开闭，围栏行及其中的内容保持原样
+    class NestedFence
+    {
+    public:
+        // 该行是否属于围栏代码（含开闭围栏所在的行）
+        bool feed(QStringView line)
+        {
+            QChar fence;
+            bool bare = false;
+            const int length = fenceLength(line, &fence, &bare);
+            if (m_length == 0)
+            {
+                if (length == 0)
+                    return false;
+                m_fence = fence;
+                m_length = length;
+                return true;
+            }
+            if (length >= m_length && fence == m_fence && bare)
+                m_length = 0;
+            return true;
+        }
+
+    private:
+        QChar m_fence;
+        int m_length = 0;   // 打开的围栏长度，0 表示不在围栏中
+    };
+}
+
+// ============ BatchProcessor 实现 ============
+bool BatchProcessor::isRequested(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--batch") == 0 || qstrncmp(argv[i], "--batch=", 8) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool BatchProcessor::parseArguments(const QStringList& arguments, Options* options, QString* error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Process Markdown files without opening a window.");
+    parser.addHelpOption();
+    QCommandLineOption batchOption("batch", "Batch mode: lint, html or normalize.", "mode");
+    QCommandLineOption jobsOption({ "j", "jobs" }, "Number of worker threads (default: CPU cores).", "n");
+    QCommandLineOption outputOption({ "o", "output" }, "Output directory for html mode.", "directory");
+    QCommandLineOption maxSizeOption("max-file-size", "Skip files larger than this (default: 64).", "MB");
+    QCommandLineOption quietOption({ "q", "quiet" }, "Print only the summary.");
+    parser.addOptions({ batchOption, jobsOption, outputOption, maxSizeOption, quietOption });
+    parser.addPositionalArgument("paths", "Directories or files to process.", "<path>...");
+
+    auto fail = [&](const QString& message) {
+        *error = message + "\n\n" + parser.helpText();
+        return false;
+    };
+
+    if (!parser.parse(arguments))
+        return fail(parser.errorText());
+    if (parser.isSet("help"))
+        return fail(QString());
+
+    const QString mode = parser.value(batchOption);
+    if (mode == "lint")
+        options->mode = Lint;
+    else if (mode == "html")
+        options->mode = Html;
+    else if (mode == "normalize")
+        options->mode = Normalize;
+    else
+        return fail(QString("Unknown batch mode: %1").arg(mode));
+
+    options->paths = parser.positionalArguments();
+    if (options->paths.isEmpty())
+        return fail("No input paths given");
+
+    bool ok = true;
+    if (parser.isSet(jobsOption))
+    {
+        options->jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || options->jobs < 1)
+            return fail("Invalid number of jobs: " + parser.value(jobsOption));
+    }
+    if (parser.isSet(maxSizeOption))
+    {
+        const qint64 megabytes = parser.value(maxSizeOption).toLongLong(&ok);
+        if (!ok || megabytes < 1)
+            return fail("Invalid maximum file size: " + parser.value(maxSizeOption));
+        options->maxFileBytes = megabytes * 1024 * 1024;
+    }
+    options->outputDirectory = parser.value(outputOption);
+    options->quiet = parser.isSet(quietOption);
+    return true;
+}
+
+BatchProcessor::BatchProcessor(const Options& options)
+    : m_options(options)
+    , m_next(0)
+    , m_files(0)
+    , m_bytes(0)
+    , m_issues(0)
+    , m_filesWithIssues(0)
+    , m_changed(0)
+    , m_skipped(0)
+    , m_failed(0)
+{
+    m_output.open(stdout, QIODevice::WriteOnly);
+}
+
+int BatchProcessor::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    collectFiles();
+
+    // 线程数不超过文件数；大文件先处理，避免最后只剩一个线程在处理大文件
+    const int jobs = qBound(1, m_options.jobs > 0 ? m_options.jobs : QThread::idealThreadCount(),
+                            qMax(1, int(m_entries.size())));
+    QVector<QThread*> threads;
+    for (int i = 0; i < jobs; ++i)
+    {
+        QThread* thread = QThread::create([this]() { runWorker(); });
+        thread->start();
+        threads.append(thread);
+    }
+    for (QThread* thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+
+    const qint64 elapsed = timer.elapsed();
+    const double rate = elapsed > 0 ? m_bytes * 1000.0 / elapsed : 0.0;
+    const QString modeName = m_options.mode == Lint ? "lint" : m_options.mode == Html ? "html" : "normalize";
+    QStringList summary;
+    summary << QString("%1: %2 files, %3 in %4 ms (%5 threads, %6/s)")
+               .arg(modeName).arg(qint64(m_files)).arg(formatMegabytes(m_bytes))
+               .arg(elapsed).arg(jobs).arg(formatMegabytes(qint64(rate)));
+    if (m_options.mode == Lint)
+        summary << QString("  %1 issues in %2 files").arg(qint64(m_issues)).arg(qint64(m_filesWithIssues));
+    else if (m_options.mode == Html)
+        summary << QString("  %1 files written").arg(qint64(m_changed));
+    else
+        summary << QString("  %1 files changed").arg(qint64(m_changed));
+    summary << QString("  %1 skipped (larger than %2), %3 failed")
+               .arg(qint64(m_skipped)).arg(formatMegabytes(m_options.maxFileBytes)).arg(qint64(m_failed));
+    report(summary);
+
+    return (m_failed > 0 || m_issues > 0) ? 1 : 0;
+}
+
+void BatchProcessor::collectFiles()
+{
+    for (const QString& path : m_options.paths)
+    {
+        const QFileInfo info(path);
+        if (info.isFile())
+        {
+            m_entries.append({ info.filePath(), info.fileName(), info.size() });
+            continue;
+        }
+        if (!info.isDir())
+        {
+            report({ path + ": no such file or directory" });
+            ++m_failed;
+            continue;
+        }
+
+        // 隐藏目录（.git 等）不在 QDir::Files 的默认范围内
+        const QDir root(path);
+        QDirIterator it(path, MarkdownFilters, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            it.next();
+            const QFileInfo file = it.fileInfo();
+            m_entries.append({ file.filePath(), root.relativeFilePath(file.filePath()), file.size() });
+        }
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+        return a.size > b.size;
+    });
+}
+
+void BatchProcessor::runWorker()
+{
+    for (;;)
+    {
+        const int index = m_next++;
+        if (index >= m_entries.size())
+            return;
+
+        const Entry& entry = m_entries.at(index);
+        if (entry.size > m_options.maxFileBytes)
+        {
+            ++m_skipped;
+            if (!m_options.quiet)
+                report({ entry.path + ": skipped, file is larger than " + formatMegabytes(m_options.maxFileBytes) });
+            continue;
+        }
+
+        const Result result = processFile(entry);
+        ++m_files;
+        m_issues += result.issues;
+        if (result.issues > 0)
+            ++m_filesWithIssues;
+        if (result.changed)
+            ++m_changed;
+        if (result.failed)
+            ++m_failed;
+        if (!m_options.quiet || result.failed)
+            report(result.messages);
+    }
+}
+
+BatchProcessor::Result BatchProcessor::processFile(const Entry& entry)
+{
+    Result result;
+    QFile file(entry.path);
+    QByteArray bytes;
+    if (file.open(QIODevice::ReadOnly))
+        bytes = file.readAll();
+    if (file.error() != QFileDevice::NoError)
+    {
+        result.failed = true;
+        result.messages << entry.path + ": " + file.errorString();
+        return result;
+    }
+    m_bytes += bytes.size();
+
+    switch (m_options.mode)
+    {
+    case Lint:
+        lint(entry, bytes, &result);
+        break;
+    case Html:
+        writeHtml(entry, bytes, &result);
+        break;
+    case Normalize:
+        normalize(entry, bytes, &result);
+        break;
+    }
+    return result;
+}
+
+void BatchProcessor::lint(const Entry& entry, const QByteArray& bytes, Result* result)
+{
+    QByteArray buffer = bytes;
+    QString text;
+    TextFormat format;
+    FileReloader::decodeText(buffer, &text, &format);
+    buffer.clear();
+
+    auto issue = [&](int line, const QString& message) {
+        result->messages << QString("%1:%2: %3").arg(entry.path).arg(line + 1).arg(message);
+        ++result->issues;
+    };
+
+    if (format.encoding != TextFormat::Utf8)
+        issue(0, QString("encoding is %1, expected UTF-8").arg(format.encodingName()));
+    if (format.hasBom)
+        issue(0, "byte order mark");
+    if (format.lineEnding != TextFormat::LF)
+        issue(0, QString("%1 line endings").arg(format.lineEndingName()));
+
+    int previousEnd = -1;     // 上一个块的最后一行
+    int previousLevel = 0;
+    NestedFence nestedFence;
+    for (const MarkdownSourceBlock& block : MarkdownParser::splitBlocks(text))
+    {
+        if (previousEnd >= 0 && block.startLine - previousEnd > 2)
+            issue(previousEnd + 2, "multiple consecutive blank lines");
+        previousEnd = block.startLine + block.lineCount - 1;
+
+        const MarkdownParser::BlockKind kind = MarkdownParser::classify(block.source);
+        if (kind == MarkdownParser::Heading || kind == MarkdownParser::SetextHeading)
+        {
+            const int level = headingLevel(block.source, kind);
+            if (previousLevel > 0 && level > previousLevel + 1)
+                issue(block.startLine, QString("heading level jumps from h%1 to h%2").arg(previousLevel).arg(level));
+            previousLevel = level;
+        }
+        else if (kind == MarkdownParser::Paragraph && isMalformedHeading(block.source))
+        {
+            issue(block.startLine, "missing space after '#' in heading");
+        }
+        else if (kind == MarkdownParser::FencedCode && isUnclosedFence(block.source))
+        {
+            issue(block.startLine, "unclosed code fence");
+        }
+
+        if (keepsWhitespace(kind))
+            continue;
+        const QList<QStringView> lines = QStringView(block.source).split(QLatin1Char('\n'));
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            if (nestedFence.feed(lines.at(i)))
+                continue;
+            const int trailing = trailingWhitespace(lines.at(i));
+            if (trailing > 0 && !isHardBreak(lines.at(i), trailing, i + 1 == lines.size()))
+                issue(block.startLine + i, "trailing whitespace");
+        }
+    }
+
+    if (!text.isEmpty() && !text.endsWith(QLatin1Char('\n')))
+        issue(int(text.count(QLatin1Char('\n'))), "missing final newline");
+}
+
+void BatchProcessor::writeHtml(const Entry& entry, const QByteArray& bytes, Result* result)
+{
+    QByteArray buffer = bytes;
+    QString text;
+    FileReloader::decodeText(buffer, &text, nullptr);
+    buffer.clear();
+
+    const QFileInfo source(entry.path);
+    QString target;
+    if (m_options.outputDirectory.isEmpty())
+    {
+        target = source.dir().filePath(source.completeBaseName() + ".html");
+    }
+    else
+    {
+        const QFileInfo relative(entry.relativePath);
+        target = QDir(m_options.outputDirectory).filePath(relative.path() + "/" + relative.completeBaseName() + ".html");
+        QDir().mkpath(QFileInfo(target).absolutePath());
+    }
+
+    const QByteArray html = MarkdownParser::toHtml(text, source.completeBaseName()).toUtf8();
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly) || file.write(html) != html.size() || !file.commit())
+    {
+        result->failed = true;
+        result->messages << target + ": " + file.errorString();
+        return;
+    }
+    result->changed = true;
+    result->messages << entry.path + " -> " + target;
+}
+
+void BatchProcessor::normalize(const Entry& entry, const QByteArray& bytes, Result* result)
+{
+    QByteArray buffer = bytes;
+    QString text;
+    FileReloader::decodeText(buffer, &text, nullptr);
+    buffer.clear();
+
+    // UTF-8 无 BOM、LF 换行；代码块（包括列表与引用中的围栏代码）与 HTML 块以外去掉行尾空白（保留硬换行），
+    // 块间的连续空行合并为一行，文件以单个换行结尾
+    QString normalized;
+    normalized.reserve(text.size());
+    int previousEnd = -1;
+    NestedFence nestedFence;
+    for (const MarkdownSourceBlock& block : MarkdownParser::splitBlocks(text))
+    {
+        if (previousEnd >= 0)
+            normalized += block.startLine - previousEnd > 1 ? QStringLiteral("\n\n") : QStringLiteral("\n");
+        previousEnd = block.startLine + block.lineCount - 1;
+
+        if (keepsWhitespace(MarkdownParser::classify(block.source)))
+        {
+            normalized += block.source;
+            continue;
+        }
+        const QList<QStringView> lines = QStringView(block.source).split(QLatin1Char('\n'));
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            const QStringView line = lines.at(i);
+            if (i > 0)
+                normalized += QLatin1Char('\n');
+            if (nestedFence.feed(line))
+            {
+                normalized += line;
+                continue;
+            }
+            const int trailing = trailingWhitespace(line);
+            normalized += line.left(line.size() - trailing);
+            if (isHardBreak(line, trailing, i + 1 == lines.size()))
+                normalized += QLatin1String("  ");
+        }
+    }
+    if (!normalized.isEmpty())
+        normalized += QLatin1Char('\n');
+
+    const QByteArray output = normalized.toUtf8();
+    if (output == bytes)
+        return;
+
+    QSaveFile file(entry.path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(output) != output.size() || !file.commit())
+    {
+        result->failed = true;
+        result->messages << entry.path + ": " + file.errorString();
+        return;
+    }
+    result->changed = true;
+    result->messages << entry.path + ": normalized";
+}
+
+void BatchProcessor::report(const QStringList& lines)
+{
+    if (lines.isEmpty())
+        return;
+
+    // 一个文件的报告整体写出，不与其他线程交错
+    QByteArray bytes = lines.join(QLatin1Char('\n')).toUtf8();
+    bytes += '\n';
+    QMutexLocker locker(&m_outputMutex);
+    m_output.write(bytes);
+    m_output.flush();
+}
@@ -0,0 +1,80 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+// 无界面的批处理模式（MarkdownEditor --batch lint|html|normalize <目录或文件>...），不创建任何窗口部件。
+// 文件列表先在调用线程中收集并按大小降序排列，工作线程（默认与 CPU 核数相同）用原子下标逐个领取，
+// 彼此不共享数据，只在输出报告时加锁；超过大小上限的文件被跳过，每个线程同一时刻只持有一个文件，
+// 内存占用有界。解析、渲染与换行/编码处理与编辑器使用同一套代码
+class BatchProcessor
+{
+public:
+    enum Mode { Lint, Html, Normalize };
+
+    struct Options
+    {
+        Mode mode = Lint;
+        QStringList paths;
+        QString outputDirectory;    // html 模式的输出目录，为空时写在源文件旁边
+        int jobs = 0;               // 0 表示按 CPU 核数
+        qint64 maxFileBytes = 64 * 1024 * 1024;
+        bool quiet = false;         // 只输出汇总
+    };
+
+    // 命令行中是否带有 --batch，用于在创建 QApplication 之前决定启动方式
+    static bool isRequested(int argc, char* argv[]);
+    // 解析失败时 error 为错误信息与用法说明
+    static bool parseArguments(const QStringList& arguments, Options* options, QString* error);
+
+    explicit BatchProcessor(const Options& options);
+
+    // 处理全部文件，逐文件的报告与最后的汇总写到标准输出，返回进程退出码：
+    // 0 成功；1 有文件失败或 lint 发现问题
+    int run();
+
+private:
+    struct Entry
+    {
+        QString path;
+        QString relativePath;     // 相对于命令行给出的目录，html 输出目录按此镜像
+        qint64 size = 0;
+    };
+
+    struct Result
+    {
+        QStringList messages;
+        int issues = 0;
+        bool changed = false;     // normalize 改写了文件 / html 写出了文件
+        bool failed = false;
+    };
+
+    void collectFiles();
+    void runWorker();
+    Result processFile(const Entry& entry);
+    void lint(const Entry& entry, const QByteArray& bytes, Result* result);
+    void writeHtml(const Entry& entry, const QByteArray& bytes, Result* result);
+    void normalize(const Entry& entry, const QByteArray& bytes, Result* result);
+    void report(const QStringList& lines);
+
+    Options m_options;
+    QVector<Entry> m_entries;
+    std::atomic<int> m_next;
+    std::atomic<qint64> m_files;
+    std::atomic<qint64> m_bytes;
+    std::atomic<qint64> m_issues;
+    std::atomic<qint64> m_filesWithIssues;
+    std::atomic<qint64> m_changed;
+    std::atomic<qint64> m_skipped;
+    std::atomic<qint64> m_failed;
+
+    QMutex m_outputMutex;
+    QFile m_output;
+};
+
+#endif // BATCHPROCESSOR_H
@@ -0,0 +1,278 @@
+#include "documentexporter.h"
+#include "markdownparser.h"
+#include <QAbstractTextDocumentLayout>
+#include <QFontDatabase>
+#include <QPageLayout>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSaveFile>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+    // 每个 HTML 片段累积的字符数；PDF 按片段排版，片段越大排版越完整，占用内存也越多
+    const qsizetype ChunkChars = 256 * 1024;
+    // 渲染领先写出的片段上限，写盘慢时渲染线程在此等待
+    const int MaxQueuedChunks = 4;
+
+    // 与预览的样式保持一致，但使用白底黑字（打印用）
+    const QString ExportStyleSheet = QStringLiteral(
+        "h1, h2, h3, h4, h5, h6 { color: #c7254e; }"
+        "a { color: #1a6fb0; }"
+        "code { color: #3a7a00; font-family: Menlo, Consolas, monospace; }"
+        "pre { background-color: #f5f5f5; }"
+        "blockquote { color: #75715e; margin-left: 12px; }"
+        "table { border-collapse: collapse; }"
+        "th, td { border: 1px solid #bbbbbb; padding: 4px; }");
+}
+
+// ============ DocumentExporter 实现 ============
+DocumentExporter::DocumentExporter(const QString& filePath, const QString& text, Format format,
+                                   const QString& title, const QString& baseDirectory, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_text(text)
+    , m_format(format)
+    , m_title(title)
+    , m_baseDirectory(baseDirectory)
+    , m_renderThread(nullptr)
+    , m_writeThread(nullptr)
+    , m_cancelled(false)
+    , m_totalBlocks(0)
+{
+}
+
+DocumentExporter::~DocumentExporter()
+{
+    cancel();
+    for (QThread* thread : { m_renderThread, m_writeThread })
+    {
+        if (thread)
+        {
+            thread->wait();
+            delete thread;
+        }
+    }
+}
+
+void DocumentExporter::start()
+{
+    if (m_renderThread)
+        return;
+
+    m_timer.start();
+    m_renderThread = QThread::create([this]() { render(); });
+    m_writeThread = QThread::create([this]() { write(); });
+    m_renderThread->start();
+    m_writeThread->start();
+}
+
+void DocumentExporter::cancel()
+{
+    // 唤醒在队列上等待的两端，让它们看到取消标记
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = true;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+void DocumentExporter::render()
+{
+    QVector<MarkdownSourceBlock> blocks = MarkdownParser::splitBlocks(m_text);
+    m_totalBlocks = blocks.size();
+
+    Chunk chunk;
+    for (qsizetype i = 0; i <= blocks.size(); ++i)
+    {
+        if (m_cancelled)
+            return;
+
+        if (i < blocks.size())
+        {
+            chunk.html += MarkdownParser::renderBlock(blocks[i].source);
+            // 已渲染的源码不再需要
+            blocks[i].source = QString();
+            chunk.blocks = i + 1;
+        }
+        chunk.last = i == blocks.size();
+        if (chunk.html.size() < ChunkChars && !chunk.last)
+            continue;
+
+        QMutexLocker locker(&m_mutex);
+        while (m_chunks.size() >= MaxQueuedChunks && !m_cancelled)
+            m_notFull.wait(&m_mutex);
+        if (m_cancelled)
+            return;
+        m_chunks.append(std::move(chunk));
+        m_notEmpty.wakeOne();
+        chunk = Chunk();
+    }
+}
+
+bool DocumentExporter::takeChunk(Chunk* chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.isEmpty() && !m_cancelled)
+        m_notEmpty.wait(&m_mutex);
+    if (m_cancelled)
+        return false;
+    *chunk = m_chunks.dequeue();
+    m_notFull.wakeOne();
+    return true;
+}
+
+void DocumentExporter::write()
+{
+    // QSaveFile 在 commit() 前不触碰目标文件，取消或失败时已写出的部分被丢弃
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        cancel();
+        emit failed(file.errorString());
+        return;
+    }
+
+    QString error;
+    const bool ok = m_format == Html ? writeHtml(file) : writePdf(file, &error);
+    if (m_cancelled && ok)
+        return;
+    if (!ok || !file.flush())
+    {
+        // 出错时让渲染线程也停下；用户取消时不报告错误
+        const bool cancelled = m_cancelled;
+        cancel();
+        if (!cancelled || !error.isEmpty())
+            emit failed(error.isEmpty() ? file.errorString() : error);
+        return;
+    }
+
+    const qint64 bytesWritten = file.size();
+    if (!file.commit())
+    {
+        emit failed(file.errorString());
+        return;
+    }
+    emit finished(bytesWritten, m_timer.elapsed());
+}
+
+bool DocumentExporter::writeHtml(QSaveFile& file)
+{
+    QByteArray bytes = MarkdownParser::htmlHeader(m_title).toUtf8();
+    if (file.write(bytes) != bytes.size())
+        return false;
+
+    Chunk chunk;
+    do
+    {
+        if (!takeChunk(&chunk))
+            return true;
+        bytes = chunk.html.toUtf8();
+        if (file.write(bytes) != bytes.size())
+            return false;
+        emit progress(chunk.blocks, m_totalBlocks);
+    } while (!chunk.last);
+
+    bytes = MarkdownParser::htmlFooter().toUtf8();
+    return file.write(bytes) == bytes.size();
+}
+
+bool DocumentExporter::writePdf(QSaveFile& file, QString* error)
+{
+    // 排版在写出线程中进行，需要平台支持在非 GUI 线程中使用字体
+    if (!QFontDatabase::supportsThreadedFontRendering())
+    {
+        *error = QStringLiteral("PDF export is not supported on this platform");
+        return false;
+    }
+
+    QPdfWriter writer(&file);
+    writer.setTitle(m_title);
+    writer.setCreator(QStringLiteral("MarkdownEditor"));
+    writer.setPageLayout(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait,
+                                     QMarginsF(15, 15, 15, 15), QPageLayout::Millimeter));
+
+    QPainter painter;
+    if (!painter.begin(&writer))
+    {
+        *error = QStringLiteral("Cannot start the PDF writer");
+        return false;
+    }
+
+    // 各片段依次排在同一串页面上，y 是当前页已用的高度
+    qreal y = 0;
+    Chunk chunk;
+    do
+    {
+        if (!takeChunk(&chunk))
+            break;
+        paginate(painter, writer, chunk.html, &y);
+        emit progress(chunk.blocks, m_totalBlocks);
+    } while (!chunk.last);
+
+    return painter.end() || m_cancelled;
+}
+
+void DocumentExporter::paginate(QPainter& painter, QPdfWriter& writer, const QString& html, qreal* y)
+{
+    // 每个片段单独排版，排版完即释放；分页只落在块的底边，块比一页还高时才从中间切开
+    QTextDocument document;
+    document.setUndoRedoEnabled(false);
+    document.documentLayout()->setPaintDevice(&writer);
+    document.setDocumentMargin(0);
+    document.setDefaultStyleSheet(ExportStyleSheet);
+    document.setBaseUrl(QUrl::fromLocalFile(m_baseDirectory + QLatin1Char('/')));
+    document.setHtml(html);
+
+    const qreal pageWidth = writer.width();
+    const qreal pageHeight = writer.height();
+    document.setTextWidth(pageWidth);
+
+    QVector<qreal> breaks;
+    for (QTextBlock block = document.begin(); block.isValid(); block = block.next())
+        breaks.append(document.documentLayout()->blockBoundingRect(block).bottom());
+    std::sort(breaks.begin(), breaks.end());
+
+    const qreal height = document.size().height();
+    qreal offset = 0;
+    while (offset < height && !m_cancelled)
+    {
+        if (*y >= pageHeight)
+        {
+            writer.newPage();
+            *y = 0;
+        }
+
+        qreal end = offset + pageHeight - *y;
+        if (end < height)
+        {
+            // 放得下的最后一个块底边；一个块也放不下时先换页，已在页首则只能切开
+            auto it = std::upper_bound(breaks.cbegin(), breaks.cend(), end);
+            const qreal cut = it != breaks.cbegin() ? *(it - 1) : offset;
+            if (cut > offset)
+            {
+                end = cut;
+            }
+            else if (*y > 0)
+            {
+                *y = pageHeight;
+                continue;
+            }
+        }
+        else
+        {
+            end = height;
+        }
+
+        painter.save();
+        painter.translate(0, *y - offset);
+        document.drawContents(&painter, QRectF(0, offset, pageWidth, end - offset));
+        painter.restore();
+
+        *y += end - offset;
+        offset = end;
+    }
+}
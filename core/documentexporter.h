@@ -0,0 +1,79 @@
+#ifndef DOCUMENTEXPORTER_H
+#define DOCUMENTEXPORTER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+
+class QPainter;
+class QPdfWriter;
+class QSaveFile;
+class QThread;
+
+// 后台导出 HTML / PDF：解析 → 渲染 → 写出三段流水线。
+// 渲染线程把文档切分为顶层块并逐块渲染，拼成大小有限的 HTML 片段放入有界队列；
+// 写出线程取片段：HTML 直接编码写入，PDF 排版后逐页写入 QPdfWriter。
+// 输出通过 QSaveFile 分块写盘，不在内存中拼出整个结果；每个导出各自拥有线程，可同时进行多个
+class DocumentExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format { Html, Pdf };
+
+    // text 是文档的快照（QString 隐式共享，不会复制）；baseDirectory 用于解析图片等相对路径
+    DocumentExporter(const QString& filePath, const QString& text, Format format,
+                     const QString& title, const QString& baseDirectory, QObject* parent = nullptr);
+    // 析构时取消并等待工作线程退出，未完成的输出被丢弃
+    ~DocumentExporter();
+
+    void start();
+    void cancel();
+
+    QString filePath() const { return m_filePath; }
+    Format format() const { return m_format; }
+
+signals:
+    // 以已写出的顶层块计
+    void progress(qint64 done, qint64 total);
+    void finished(qint64 bytesWritten, qint64 elapsedMs);
+    void failed(const QString& error);
+
+private:
+    struct Chunk
+    {
+        QString html;
+        qint64 blocks = 0;      // 截至该片段已渲染的块数
+        bool last = false;
+    };
+
+    void render();
+    void write();
+    bool takeChunk(Chunk* chunk);
+    bool writeHtml(QSaveFile& file);
+    bool writePdf(QSaveFile& file, QString* error);
+    void paginate(QPainter& painter, QPdfWriter& writer, const QString& html, qreal* y);
+
+    QString m_filePath;
+    QString m_text;
+    Format m_format;
+    QString m_title;
+    QString m_baseDirectory;
+    QThread* m_renderThread;
+    QThread* m_writeThread;
+    std::atomic<bool> m_cancelled;
+    std::atomic<qint64> m_totalBlocks;
+    QElapsedTimer m_timer;
+
+    // 渲染与写出之间的有界队列
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<Chunk> m_chunks;
+};
+
+#endif // DOCUMENTEXPORTER_H
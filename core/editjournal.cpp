@@ -0,0 +1,434 @@
+#include "editjournal.h"
+#include "filereloader.h"
+#include "gapbuffer.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QUuid>
+#include <QtEndian>
+
+namespace {
+    const char JournalSuffix[] = ".journal";
+    const quint32 Magic = 0x4d444a31;          // "MDJ1"
+    // 第一条记录到达后等待的提交间隔，期间的记录合并为一次写入
+    const int CommitIntervalMs = 100;
+    const qint64 MaxBatchBytes = 1024 * 1024;
+    // 记录少于此值时不压缩，小文档不必频繁写快照
+    const qint64 MinCompactBytes = 4 * 1024 * 1024;
+    const int FrameHeaderSize = 6;
+
+    enum RecordType : quint8 { HeaderRecord = 1, SnapshotRecord = 2, EditRecord = 3 };
+    enum BaseKind : quint8 { FileBase = 0, TextBase = 1 };
+
+    QDataStream& prepare(QDataStream& stream)
+    {
+        stream.setVersion(QDataStream::Qt_6_0);
+        return stream;
+    }
+
+    // 记录格式：负载长度（quint32）、负载的 CRC-16（quint16）、负载，均为大端。
+    // 崩溃时只写了一半的末尾记录校验失败，重放到它之前为止
+    QByteArray frame(const QByteArray& payload)
+    {
+        QByteArray record(FrameHeaderSize, Qt::Uninitialized);
+        qToBigEndian<quint32>(quint32(payload.size()), record.data());
+        qToBigEndian<quint16>(qChecksum(payload), record.data() + 4);
+        record.append(payload);
+        return record;
+    }
+
+    bool readFrame(const QByteArray& data, qsizetype* offset, QByteArray* payload)
+    {
+        if (data.size() - *offset < FrameHeaderSize)
+            return false;
+        const quint32 length = qFromBigEndian<quint32>(data.constData() + *offset);
+        const quint16 checksum = qFromBigEndian<quint16>(data.constData() + *offset + 4);
+        if (qint64(length) > data.size() - *offset - FrameHeaderSize)
+            return false;
+        *payload = data.mid(*offset + FrameHeaderSize, length);
+        if (qChecksum(*payload) != checksum)
+            return false;
+        *offset += FrameHeaderSize + length;
+        return true;
+    }
+
+    QString journalPath(const QString& directory, const QString& id)
+    {
+        return QDir(directory).filePath(id + JournalSuffix);
+    }
+
+    // 在基准上重放一个日志；没有可恢复的修改时返回 false
+    bool replay(const QByteArray& data, EditJournal::Recovered* document)
+    {
+        qsizetype offset = 0;
+        QByteArray payload;
+        if (!readFrame(data, &offset, &payload))
+            return false;
+
+        quint8 type = 0;
+        quint32 magic = 0;
+        quint8 base = TextBase;
+        qint64 baseSize = 0;
+        qint64 baseModified = 0;
+        QDataStream header(payload);
+        prepare(header) >> type >> magic >> document->title >> document->filePath >> base >> baseSize >> baseModified;
+        if (header.status() != QDataStream::Ok || type != HeaderRecord || magic != Magic)
+            return false;
+
+        // 只有文件头：自上次更换基准以来没有修改
+        if (offset >= data.size())
+            return false;
+
+        QString text;
+        if (base == FileBase)
+        {
+            // 基准文件在最后一次保存之后又被修改，记录中的位置已经失效
+            QFileInfo info(document->filePath);
+            if (!info.isFile() || info.size() != baseSize
+                || info.lastModified().toMSecsSinceEpoch() != baseModified)
+            {
+                document->error = "changed on disk since the last save";
+                return true;
+            }
+            if (!FileReloader::readText(document->filePath, &text, &document->format, &document->error))
+                return true;
+        }
+
+        GapBuffer buffer;
+        buffer.reset(text);
+        text.clear();
+
+        int applied = 0;
+        while (readFrame(data, &offset, &payload))
+        {
+            QDataStream stream(payload);
+            prepare(stream) >> type;
+            if (type == SnapshotRecord)
+            {
+                QByteArray compressed;
+                stream >> compressed;
+                const QByteArray raw = qUncompress(compressed);
+                if (stream.status() != QDataStream::Ok || (!compressed.isEmpty() && raw.isEmpty()))
+                    break;
+                buffer.reset(QStringView(reinterpret_cast<const char16_t*>(raw.constData()), raw.size() / 2));
+            }
+            else if (type == EditRecord)
+            {
+                qint32 position = 0;
+                qint32 removedLength = 0;
+                QString inserted;
+                stream >> position >> removedLength >> inserted;
+                if (stream.status() != QDataStream::Ok)
+                    break;
+                buffer.replace(position, removedLength, inserted);
+            }
+            else
+            {
+                break;
+            }
+            applied++;
+        }
+        if (applied == 0)
+            return false;
+
+        // 记录中的段落分隔符来自 QTextDocument 的原始文本
+        document->text = buffer.mid(0, buffer.size());
+        document->text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+        return true;
+    }
+}
+
+// ============ EditJournal 实现 ============
+EditJournal::EditJournal(const QString& directory, QObject* parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_queuedBytes(0)
+    , m_enqueued(0)
+    , m_committed(0)
+    , m_flushRequested(false)
+    , m_stopping(false)
+{
+    QDir().mkpath(m_directory);
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+EditJournal::~EditJournal()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    qDeleteAll(m_files);
+}
+
+QString EditJournal::begin(const QString& title, const QString& filePath)
+{
+    return beginOperation(QString(), title, filePath, nullptr);
+}
+
+QString EditJournal::begin(const QString& title, const QString& filePath, const QString& text)
+{
+    return beginOperation(QString(), title, filePath, &text);
+}
+
+void EditJournal::rebase(const QString& id, const QString& title, const QString& filePath)
+{
+    if (!id.isEmpty())
+        beginOperation(id, title, filePath, nullptr);
+}
+
+void EditJournal::rebase(const QString& id, const QString& title, const QString& filePath, const QString& text)
+{
+    if (!id.isEmpty())
+        beginOperation(id, title, filePath, &text);
+}
+
+QString EditJournal::beginOperation(QString id, const QString& title, const QString& filePath, const QString* text)
+{
+    if (id.isEmpty())
+        id = QUuid::createUuid().toString(QUuid::Id128);
+
+    // 以磁盘文件为基准时记下大小与修改时间，恢复时据此确认文件未被改动
+    quint8 base = TextBase;
+    qint64 baseSize = 0;
+    qint64 baseModified = 0;
+    if (!text && !filePath.isEmpty())
+    {
+        QFileInfo info(filePath);
+        base = FileBase;
+        baseSize = info.size();
+        baseModified = info.lastModified().toMSecsSinceEpoch();
+    }
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    prepare(stream) << quint8(HeaderRecord) << Magic << title << filePath << base << baseSize << baseModified;
+
+    Operation operation;
+    operation.kind = Operation::Begin;
+    operation.id = id;
+    operation.record = frame(payload);
+    if (text)
+    {
+        operation.text = *text;
+        operation.hasText = true;
+    }
+    m_journalBytes.insert(id, 0);
+    enqueue(std::move(operation));
+    return id;
+}
+
+void EditJournal::append(const QString& id, int position, int removedLength, const QString& inserted)
+{
+    auto bytes = m_journalBytes.find(id);
+    if (bytes == m_journalBytes.end())
+        return;
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    prepare(stream) << quint8(EditRecord) << qint32(position) << qint32(removedLength) << inserted;
+
+    Operation operation;
+    operation.kind = Operation::Append;
+    operation.id = id;
+    operation.record = frame(payload);
+    bytes.value() += operation.record.size();
+    enqueue(std::move(operation));
+}
+
+void EditJournal::end(const QString& id)
+{
+    if (!m_journalBytes.remove(id))
+        return;
+
+    Operation operation;
+    operation.kind = Operation::End;
+    operation.id = id;
+    enqueue(std::move(operation));
+}
+
+bool EditJournal::shouldCompact(const QString& id, qint64 documentLength) const
+{
+    // 压缩写出的快照不超过此前记录的大小，总写入量保持为编辑量的常数倍
+    return m_journalBytes.value(id) >= qMax(MinCompactBytes, documentLength * qint64(sizeof(QChar)));
+}
+
+void EditJournal::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 target = m_enqueued;
+    if (m_committed >= target)
+        return;
+
+    m_flushRequested = true;
+    m_wake.wakeAll();
+    while (m_committed < target)
+        m_idle.wait(&m_mutex);
+}
+
+void EditJournal::discardAll()
+{
+    m_journalBytes.clear();
+    Operation operation;
+    operation.kind = Operation::DiscardAll;
+    enqueue(std::move(operation));
+    flush();
+}
+
+void EditJournal::enqueue(Operation&& operation)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queuedBytes += operation.record.size() + operation.text.size() * qsizetype(sizeof(QChar));
+    m_queue.append(std::move(operation));
+    m_enqueued++;
+    m_wake.wakeAll();
+}
+
+void EditJournal::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;)
+    {
+        while (m_queue.isEmpty() && !m_stopping)
+            m_wake.wait(&m_mutex);
+        if (m_queue.isEmpty())
+            break;
+
+        // 组提交：等满一个提交间隔（或攒够一批、有人等待写完）再统一写入
+        QDeadlineTimer deadline(CommitIntervalMs);
+        while (!m_stopping && !m_flushRequested && m_queuedBytes < MaxBatchBytes)
+        {
+            if (!m_wake.wait(&m_mutex, deadline))
+                break;
+        }
+
+        QVector<Operation> batch;
+        batch.swap(m_queue);
+        m_queuedBytes = 0;
+        m_flushRequested = false;
+        const quint64 target = m_enqueued;
+
+        locker.unlock();
+        process(batch);
+        locker.relock();
+
+        m_committed = target;
+        m_idle.wakeAll();
+    }
+}
+
+void EditJournal::process(QVector<Operation>& batch)
+{
+    // 同一批中每个日志的编辑记录拼接后一次写入；
+    // 更换基准时新的基准已包含此前的全部修改，之前尚未写出的记录直接丢弃
+    QHash<QString, QByteArray> pending;
+    for (Operation& operation : batch)
+    {
+        switch (operation.kind)
+        {
+        case Operation::Append:
+            pending[operation.id].append(operation.record);
+            break;
+        case Operation::Begin:
+            pending.remove(operation.id);
+            writeBegin(operation);
+            break;
+        case Operation::End:
+            pending.remove(operation.id);
+            delete m_files.take(operation.id);
+            QFile::remove(journalPath(m_directory, operation.id));
+            break;
+        case Operation::DiscardAll:
+        {
+            pending.clear();
+            qDeleteAll(m_files);
+            m_files.clear();
+            QDir dir(m_directory);
+            const QStringList names = dir.entryList(QStringList() << QString("*") + JournalSuffix, QDir::Files);
+            for (const QString& name : names)
+                dir.remove(name);
+            break;
+        }
+        }
+        // 快照可能很大，写出后立即释放
+        operation.text.clear();
+    }
+
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+        writePending(it.key(), it.value());
+}
+
+void EditJournal::writePending(const QString& id, QByteArray& pending)
+{
+    QFile* file = m_files.value(id);
+    if (!file)
+        return;
+
+    // 写入操作系统缓存即可：进程崩溃后数据仍会落盘
+    if (file->write(pending) != pending.size() || !file->flush())
+        qWarning("Cannot write edit journal %s: %s", qPrintable(file->fileName()), qPrintable(file->errorString()));
+}
+
+void EditJournal::writeBegin(const Operation& operation)
+{
+    delete m_files.take(operation.id);
+
+    // 新的文件头与快照先写入临时文件再原子替换，替换前旧日志仍然完整
+    const QString path = journalPath(m_directory, operation.id);
+    QSaveFile file(path);
+    bool ok = file.open(QIODevice::WriteOnly) && file.write(operation.record) == operation.record.size();
+    if (ok && operation.hasText)
+    {
+        const QByteArray raw(reinterpret_cast<const char*>(operation.text.constData()),
+                             operation.text.size() * qsizetype(sizeof(QChar)));
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        // 压缩级别取 1，优先速度
+        prepare(stream) << quint8(SnapshotRecord) << qCompress(raw, 1);
+        const QByteArray record = frame(payload);
+        ok = file.write(record) == record.size();
+    }
+    if (!ok || !file.commit())
+    {
+        qWarning("Cannot write edit journal %s: %s", qPrintable(path), qPrintable(file.errorString()));
+        return;
+    }
+
+    QFile* journal = new QFile(path);
+    if (!journal->open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning("Cannot open edit journal %s: %s", qPrintable(path), qPrintable(journal->errorString()));
+        delete journal;
+        return;
+    }
+    m_files.insert(operation.id, journal);
+}
+
+QVector<EditJournal::Recovered> EditJournal::recover(const QString& directory)
+{
+    QVector<Recovered> documents;
+    QDir dir(directory);
+    // 按修改时间从旧到新，恢复出的 Tab 大致保持打开顺序
+    const QFileInfoList files = dir.entryInfoList(QStringList() << QString("*") + JournalSuffix,
+                                                  QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo& info : files)
+    {
+        QFile file(info.filePath());
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        Recovered document;
+        if (replay(file.readAll(), &document))
+            documents.append(document);
+    }
+    return documents;
+}
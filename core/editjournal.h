@@ -0,0 +1,98 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include "textscan.h"
+
+class QFile;
+class QThread;
+
+// 崩溃恢复用的编辑日志：每个 Tab 一个只追加的日志文件，记录相对基准的每次修改（位置、删除长度、插入文本）。
+// 基准是磁盘上的文件（保存或加载后）或一份文本快照（未保存内容的恢复、压缩）。
+// GUI 线程只编码记录并放入队列，工作线程按提交间隔把同一批记录合并为每个文件一次写入；
+// 日志超过文档大小后以当前文本的快照重新开始，写入量与编辑量成正比，与文档大小无关
+class EditJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 崩溃后从日志重建的一个文档
+    struct Recovered
+    {
+        QString title;
+        QString filePath;
+        QString text;
+        TextFormat format;
+        QString error;      // 不为空时无法重建（例如基准文件已被修改）
+    };
+
+    explicit EditJournal(const QString& directory, QObject* parent = nullptr);
+    // 析构时写完队列中的记录
+    ~EditJournal();
+
+    QString directory() const { return m_directory; }
+
+    // 以磁盘上的 filePath 为基准开始新日志（filePath 为空表示空文档），返回日志编号
+    QString begin(const QString& title, const QString& filePath);
+    // 以 text 为基准开始新日志（QString 隐式共享，压缩与写盘在工作线程中进行）
+    QString begin(const QString& title, const QString& filePath, const QString& text);
+    void append(const QString& id, int position, int removedLength, const QString& inserted);
+    // 更换基准：保存或重新加载后以磁盘文件为基准；压缩时以当前文本为基准
+    void rebase(const QString& id, const QString& title, const QString& filePath);
+    void rebase(const QString& id, const QString& title, const QString& filePath, const QString& text);
+    // 删除日志（Tab 关闭）
+    void end(const QString& id);
+    // 自上次更换基准以来写入的记录超过文档大小时应压缩
+    bool shouldCompact(const QString& id, qint64 documentLength) const;
+
+    // 等待队列中的记录全部写入
+    void flush();
+    // 正常退出（会话已保存）后删除目录中的全部日志
+    void discardAll();
+
+    // 读取目录中遗留的日志并在各自的基准上重放；只返回确有未保存修改的文档
+    static QVector<Recovered> recover(const QString& directory);
+
+private:
+    struct Operation
+    {
+        enum Kind { Begin, Append, End, DiscardAll };
+        Kind kind = Append;
+        QString id;
+        QByteArray record;      // Begin 时为文件头，Append 时为编辑记录
+        QString text;           // Begin 时的基准快照
+        bool hasText = false;
+    };
+
+    void enqueue(Operation&& operation);
+    QString beginOperation(QString id, const QString& title, const QString& filePath, const QString* text);
+    void run();
+    void process(QVector<Operation>& batch);
+    void writePending(const QString& id, QByteArray& pending);
+    void writeBegin(const Operation& operation);
+
+    QString m_directory;
+    QHash<QString, qint64> m_journalBytes;     // GUI 线程：自上次更换基准以来的记录字节数
+
+    // 以下由 m_mutex 保护
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_idle;
+    QVector<Operation> m_queue;
+    qint64 m_queuedBytes;
+    quint64 m_enqueued;
+    quint64 m_committed;
+    bool m_flushRequested;
+    bool m_stopping;
+
+    // 以下只在工作线程中使用
+    QHash<QString, QFile*> m_files;
+    QThread* m_thread;
+};
+
+#endif // EDITJOURNAL_H
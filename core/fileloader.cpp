@@ -0,0 +1,132 @@
+#include "fileloader.h"
+#include <QFile>
+#include <QThread>
+
+namespace {
+    // 每次读取的字节数，兼顾 GUI 线程单次插入的耗时
+    const qint64 ChunkSize = 1024 * 1024;
+    // 同时在途（已解码但尚未插入文档）的文本块上限
+    const int MaxChunksInFlight = 4;
+}
+
+FileLoader::FileLoader(const QString& filePath, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_lineCount(0)
+    , m_invalidSequences(0)
+    , m_thread(nullptr)
+    , m_chunkSlots(MaxChunksInFlight)
+    , m_cancelled(false)
+{
+}
+
+FileLoader::~FileLoader()
+{
+    cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FileLoader::start()
+{
+    if (m_thread)
+        return;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void FileLoader::cancel()
+{
+    m_cancelled = true;
+}
+
+void FileLoader::chunkConsumed()
+{
+    m_chunkSlots.release();
+}
+
+bool FileLoader::acquireChunkSlot()
+{
+    // 等待 GUI 线程消费，避免整份文件以文本块形式堆积在事件队列中
+    while (!m_chunkSlots.tryAcquire(1, 50))
+    {
+        if (m_cancelled)
+            return false;
+    }
+    return !m_cancelled;
+}
+
+void FileLoader::run()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit failed(file.errorString());
+        return;
+    }
+
+    const qint64 totalBytes = file.size();
+    qint64 bytesRead = 0;
+    bool firstChunk = true;
+
+    QStringDecoder decoder;
+    TextScanner scanner;
+    QByteArray buffer(ChunkSize, Qt::Uninitialized);
+
+    while (!m_cancelled)
+    {
+        qint64 n = file.read(buffer.data(), ChunkSize);
+        if (n < 0)
+        {
+            emit failed(file.errorString());
+            return;
+        }
+        if (n == 0)
+            break;
+        bytesRead += n;
+
+        char* data = buffer.data();
+        if (firstChunk)
+        {
+            // 用第一块判断编码并跳过 BOM
+            int bomLength = 0;
+            m_format = TextFormat::detect(data, n, &bomLength);
+            decoder = m_format.createDecoder();
+            scanner = TextScanner(m_format.encoding == TextFormat::Utf8);
+            data += bomLength;
+            n -= bomLength;
+            firstChunk = false;
+        }
+
+        QString text;
+        if (m_format.isByteOriented())
+        {
+            // CR 与 LF 不会出现在 UTF-8 / GB18030 的多字节序列内部，可以在解码前按字节规范化
+            n = scanner.processBytes(data, n);
+            text = decoder.decode(QByteArrayView(data, n));
+        }
+        else
+        {
+            text = decoder.decode(QByteArrayView(data, n));
+            scanner.processText(text);
+        }
+
+        if (!acquireChunkSlot())
+            return;
+
+        emit chunkReady(text);
+        emit progress(bytesRead, totalBytes);
+    }
+
+    if (m_cancelled)
+        return;
+
+    m_format.lineEnding = scanner.dominantLineEnding();
+    m_lineCount = scanner.lineCount();
+    m_invalidSequences = scanner.invalidSequences();
+    emit finished();
+}
@@ -0,0 +1,55 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QSemaphore>
+#include <atomic>
+#include "textscan.h"
+
+class QThread;
+
+// 后台分块加载文件：工作线程负责检测编码、规范换行与解码，GUI 线程逐块插入文档。
+// 在途的文本块数量有上限，峰值内存接近最终文档大小。
+class FileLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileLoader(const QString& filePath, QObject* parent = nullptr);
+    ~FileLoader();
+
+    void start();
+    void cancel();
+
+    // GUI 线程插入完一个文本块后调用，释放一个在途名额
+    void chunkConsumed();
+
+    QString filePath() const { return m_filePath; }
+    bool isCancelled() const { return m_cancelled.load(); }
+
+    // 以下结果在 finished() 之后有效
+    TextFormat format() const { return m_format; }
+    qint64 lineCount() const { return m_lineCount; }
+    qint64 invalidSequences() const { return m_invalidSequences; }
+
+signals:
+    void chunkReady(const QString& text);
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished();
+    void failed(const QString& error);
+
+private:
+    void run();
+    bool acquireChunkSlot();
+
+    QString m_filePath;
+    TextFormat m_format;
+    qint64 m_lineCount;
+    qint64 m_invalidSequences;
+    QThread* m_thread;
+    QSemaphore m_chunkSlots;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // FILELOADER_H
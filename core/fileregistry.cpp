@@ -0,0 +1,190 @@
+#include "fileregistry.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+    // 保存时编辑器常先删除再重命名，连续的事件合并后再检查
+    const int DebounceMs = 300;
+}
+
+FileIdentity FileIdentity::of(const QString& filePath)
+{
+    FileIdentity identity;
+#ifdef Q_OS_WIN
+    HANDLE handle = CreateFileW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(filePath).utf16()),
+                                0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return identity;
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(handle, &info))
+    {
+        identity.device = info.dwVolumeSerialNumber;
+        identity.inode = (quint64(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    }
+    CloseHandle(handle);
+#else
+    struct stat st;
+    if (::stat(QFile::encodeName(filePath).constData(), &st) == 0)
+    {
+        identity.device = quint64(st.st_dev);
+        identity.inode = quint64(st.st_ino);
+    }
+#endif
+    return identity;
+}
+
+FileRegistry::FileRegistry(QObject* parent)
+    : QObject(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &FileRegistry::onPathChanged);
+    connect(&m_debounce, &QTimer::timeout, this, &FileRegistry::flushChanges);
+}
+
+QString FileRegistry::canonicalPath(const QString& filePath)
+{
+    // 文件不存在时 canonicalFilePath 为空，退回到规范化的绝对路径
+    QFileInfo info(filePath);
+    QString canonical = info.canonicalFilePath();
+    return canonical.isEmpty() ? QDir::cleanPath(info.absoluteFilePath()) : canonical;
+}
+
+FileRegistry::Entry FileRegistry::stat(const QString& canonicalPath)
+{
+    Entry entry;
+    entry.canonicalPath = canonicalPath;
+    entry.identity = FileIdentity::of(canonicalPath);
+    QFileInfo info(canonicalPath);
+    if (info.exists())
+    {
+        entry.modified = info.lastModified();
+        entry.size = info.size();
+    }
+    return entry;
+}
+
+void FileRegistry::add(QObject* owner, const QString& filePath)
+{
+    if (filePath.isEmpty())
+    {
+        remove(owner);
+        return;
+    }
+
+    const QString oldPath = m_entries.value(owner).canonicalPath;
+    unlink(owner);
+    connect(owner, &QObject::destroyed, this, &FileRegistry::onOwnerDestroyed, Qt::UniqueConnection);
+
+    Entry entry = stat(canonicalPath(filePath));
+    m_entries.insert(owner, entry);
+    m_byPath.insert(entry.canonicalPath, owner);
+    if (entry.identity.isValid())
+        m_byIdentity.insert(entry.identity, owner);
+    if (!m_watcher.files().contains(entry.canonicalPath))
+        m_watcher.addPath(entry.canonicalPath);
+
+    // 另存为之后不再监视原来的文件
+    if (!oldPath.isEmpty() && oldPath != entry.canonicalPath && !m_byPath.contains(oldPath))
+    {
+        m_watcher.removePath(oldPath);
+        m_changedPaths.remove(oldPath);
+    }
+}
+
+void FileRegistry::remove(QObject* owner)
+{
+    auto it = m_entries.constFind(owner);
+    if (it == m_entries.constEnd())
+        return;
+
+    const QString path = it->canonicalPath;
+    unlink(owner);
+    m_entries.remove(owner);
+    disconnect(owner, &QObject::destroyed, this, &FileRegistry::onOwnerDestroyed);
+    if (!m_byPath.contains(path))
+        m_watcher.removePath(path);
+}
+
+void FileRegistry::onOwnerDestroyed(QObject* owner)
+{
+    remove(owner);
+}
+
+void FileRegistry::unlink(QObject* owner)
+{
+    auto it = m_entries.constFind(owner);
+    if (it == m_entries.constEnd())
+        return;
+
+    if (m_byPath.value(it->canonicalPath) == owner)
+        m_byPath.remove(it->canonicalPath);
+    if (it->identity.isValid() && m_byIdentity.value(it->identity) == owner)
+        m_byIdentity.remove(it->identity);
+}
+
+QObject* FileRegistry::find(const QString& filePath) const
+{
+    // 先按身份查找（覆盖硬链接），文件不可访问时再按规范路径查找
+    FileIdentity identity = FileIdentity::of(filePath);
+    if (identity.isValid())
+    {
+        if (QObject* owner = m_byIdentity.value(identity))
+            return owner;
+    }
+    return m_byPath.value(canonicalPath(filePath));
+}
+
+void FileRegistry::onPathChanged(const QString& path)
+{
+    m_changedPaths.insert(path);
+    m_debounce.start();
+}
+
+void FileRegistry::flushChanges()
+{
+    const QSet<QString> paths = std::exchange(m_changedPaths, QSet<QString>());
+    for (const QString& path : paths)
+    {
+        QObject* owner = m_byPath.value(path);
+        if (!owner)
+            continue;
+
+        Entry& entry = m_entries[owner];
+        Entry current = stat(path);
+        if (!QFileInfo::exists(path))
+        {
+            // 文件被删除或移走；监视随之失效，再次保存（add）后恢复
+            if (entry.size >= 0)
+            {
+                entry.size = -1;
+                emit fileRemoved(owner, path);
+            }
+            continue;
+        }
+
+        // 原子替换（写临时文件后重命名）之后监视会失效，需要重新加入
+        if (!m_watcher.files().contains(path))
+            m_watcher.addPath(path);
+
+        if (current.identity == entry.identity && current.modified == entry.modified && current.size == entry.size)
+            continue;
+
+        if (entry.identity.isValid() && m_byIdentity.value(entry.identity) == owner)
+            m_byIdentity.remove(entry.identity);
+        entry = current;
+        if (entry.identity.isValid())
+            m_byIdentity.insert(entry.identity, owner);
+        emit fileChanged(owner, path);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef FILEREGISTRY_H
+#define FILEREGISTRY_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+// 文件的物理身份：POSIX 上是设备号与 inode，Windows 上是卷序列号与文件索引。
+// 符号链接、含 .. 的路径与硬链接指向同一文件时身份相同
+struct FileIdentity
+{
+    quint64 device = 0;
+    quint64 inode = 0;
+
+    bool isValid() const { return inode != 0; }
+    static FileIdentity of(const QString& filePath);
+};
+
+inline bool operator==(const FileIdentity& a, const FileIdentity& b)
+{
+    return a.device == b.device && a.inode == b.inode;
+}
+
+inline size_t qHash(const FileIdentity& identity, size_t seed = 0)
+{
+    return qHashMulti(seed, identity.device, identity.inode);
+}
+
+// 已打开文件的登记表：按文件身份与规范路径 O(1) 查重，并监视磁盘上的修改。
+// 监视事件合并去抖后，只有修改时间、大小或身份确实变化时才通知（自身保存后调用 add 刷新即可忽略）
+class FileRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileRegistry(QObject* parent = nullptr);
+
+    // 登记或更新 owner 对应的文件；filePath 为空时等同于 remove。owner 销毁时自动移除
+    void add(QObject* owner, const QString& filePath);
+    void remove(QObject* owner);
+    // 返回已打开该文件的 owner，没有时返回 nullptr
+    QObject* find(const QString& filePath) const;
+
+    static QString canonicalPath(const QString& filePath);
+
+signals:
+    void fileChanged(QObject* owner, const QString& filePath);
+    void fileRemoved(QObject* owner, const QString& filePath);
+
+private slots:
+    void onPathChanged(const QString& path);
+    void flushChanges();
+    void onOwnerDestroyed(QObject* owner);
+
+private:
+    struct Entry
+    {
+        QString canonicalPath;
+        FileIdentity identity;
+        QDateTime modified;
+        qint64 size = -1;
+    };
+
+    static Entry stat(const QString& canonicalPath);
+    void unlink(QObject* owner);
+
+    QHash<QObject*, Entry> m_entries;
+    QHash<FileIdentity, QObject*> m_byIdentity;
+    QHash<QString, QObject*> m_byPath;
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QSet<QString> m_changedPaths;
+};
+
+#endif // FILEREGISTRY_H
@@ -0,0 +1,100 @@
+#include "filereloader.h"
+#include <QFile>
+#include <QThread>
+
+FileReloader::FileReloader(const QString& filePath, const QString& currentText, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_currentText(currentText)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+}
+
+FileReloader::~FileReloader()
+{
+    cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FileReloader::start()
+{
+    if (m_thread)
+        return;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void FileReloader::cancel()
+{
+    m_cancelled = true;
+}
+
+bool FileReloader::readText(const QString& filePath, QString* text, TextFormat* format, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    // 与 FileLoader 相同的检测与规范化，只是一次读入整个文件（普通 Tab 的文件不超过大文件阈值）
+    QByteArray bytes = file.readAll();
+    if (file.error() != QFileDevice::NoError)
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    decodeText(bytes, text, format);
+    return true;
+}
+
+void FileReloader::decodeText(QByteArray& bytes, QString* text, TextFormat* format)
+{
+    int bomLength = 0;
+    TextFormat detected = TextFormat::detect(bytes.constData(), bytes.size(), &bomLength);
+    QStringDecoder decoder = detected.createDecoder();
+    TextScanner scanner(detected.encoding == TextFormat::Utf8);
+    if (detected.isByteOriented())
+    {
+        qint64 n = scanner.processBytes(bytes.data() + bomLength, bytes.size() - bomLength);
+        *text = decoder.decode(QByteArrayView(bytes.constData() + bomLength, n));
+    }
+    else
+    {
+        *text = decoder.decode(QByteArrayView(bytes.constData() + bomLength, bytes.size() - bomLength));
+        scanner.processText(*text);
+    }
+    detected.lineEnding = scanner.dominantLineEnding();
+    if (format)
+        *format = detected;
+}
+
+void FileReloader::run()
+{
+    QString error;
+    if (!readText(m_filePath, &m_text, &m_format, &error))
+    {
+        emit failed(error);
+        return;
+    }
+
+    if (m_cancelled)
+        return;
+
+    m_edits = TextDiff::compute(m_currentText, m_text, &m_cancelled);
+    m_currentText.clear();
+
+    if (m_cancelled)
+        return;
+    emit finished();
+}
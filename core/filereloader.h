@@ -0,0 +1,55 @@
+#ifndef FILERELOADER_H
+#define FILERELOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "textdiff.h"
+#include "textscan.h"
+
+class QThread;
+
+// 磁盘上的文件被其他程序修改后的重新加载：工作线程读取并解码新内容，
+// 与当前文本快照按行比较，GUI 线程只需应用变化的区段
+class FileReloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // currentText 是编辑器当前文本的快照（QString 隐式共享，不会复制）
+    FileReloader(const QString& filePath, const QString& currentText, QObject* parent = nullptr);
+    ~FileReloader();
+
+    void start();
+    void cancel();
+
+    QString filePath() const { return m_filePath; }
+
+    // 以下结果在 finished() 之后有效；区段以快照中的位置表示，替换内容取自 text()
+    QString text() const { return m_text; }
+    TextFormat format() const { return m_format; }
+    QVector<TextDiff::Edit> edits() const { return m_edits; }
+
+    // 同步读取并解码整个文件，换行规范化为 \n；崩溃恢复重建文本时也使用
+    static bool readText(const QString& filePath, QString* text, TextFormat* format, QString* error);
+    // 解码已读入的文件内容（原地规范化 bytes）；批处理模式需要同时保留原始字节时使用
+    static void decodeText(QByteArray& bytes, QString* text, TextFormat* format);
+
+signals:
+    void finished();
+    void failed(const QString& error);
+
+private:
+    void run();
+
+    QString m_filePath;
+    QString m_currentText;
+    QString m_text;
+    TextFormat m_format;
+    QVector<TextDiff::Edit> m_edits;
+    QThread* m_thread;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // FILERELOADER_H
@@ -0,0 +1,172 @@
+#include "filesaver.h"
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // 每次编码并写入的字符数
+    const qsizetype TextChunkSize = 1024 * 1024;
+
+    bool syncFile(int fd)
+    {
+        if (fd < 0)
+            return true;
+#ifdef Q_OS_WIN
+        return _commit(fd) == 0;
+#else
+        return ::fsync(fd) == 0;
+#endif
+    }
+
+    // 重命名之后同步所在目录，保证目录项本身也已落盘
+    void syncParentDirectory(const QString& filePath)
+    {
+#ifndef Q_OS_WIN
+        QByteArray dir = QFile::encodeName(QFileInfo(filePath).absolutePath());
+        int fd = ::open(dir.constData(), O_RDONLY);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+#else
+        Q_UNUSED(filePath);
+#endif
+    }
+}
+
+FileSaver::FileSaver(const QString& filePath, const QString& text, const TextFormat& format, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_text(text)
+    , m_format(format)
+    , m_isSnapshot(false)
+    , m_total(text.size())
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+}
+
+FileSaver::FileSaver(const QString& filePath, const PieceTable::Snapshot& snapshot, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_snapshot(snapshot)
+    , m_isSnapshot(true)
+    , m_total(snapshot.size)
+    , m_thread(nullptr)
+    , m_cancelled(false)
+{
+}
+
+FileSaver::~FileSaver()
+{
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FileSaver::start()
+{
+    if (m_thread)
+        return;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void FileSaver::cancel()
+{
+    m_cancelled = true;
+}
+
+void FileSaver::run()
+{
+    m_timer.start();
+
+    // QSaveFile 先写入临时文件，commit() 时原子重命名；未提交时目标文件保持不变
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        emit failed(file.errorString());
+        return;
+    }
+
+    bool ok = m_isSnapshot ? writeSnapshot(file) : writeText(file);
+    if (m_cancelled)
+        return;
+    if (!ok || !file.flush() || !syncFile(file.handle()))
+    {
+        emit failed(file.errorString());
+        return;
+    }
+
+    qint64 bytesWritten = file.size();
+    if (!file.commit())
+    {
+        emit failed(file.errorString());
+        return;
+    }
+    syncParentDirectory(m_filePath);
+
+    emit finished(bytesWritten, m_timer.elapsed());
+}
+
+bool FileSaver::writeText(QSaveFile& file)
+{
+    // 按加载时记录的编码（含 BOM）与换行风格写回
+    QStringEncoder encoder = m_format.createEncoder();
+    const QString lineBreak = m_format.lineEnding == TextFormat::CRLF ? QStringLiteral("\r\n")
+                            : m_format.lineEnding == TextFormat::CR ? QStringLiteral("\r")
+                            : QString();
+    qint64 bytesWritten = 0;
+
+    for (qsizetype pos = 0; pos < m_text.size(); pos += TextChunkSize)
+    {
+        if (m_cancelled)
+            return false;
+
+        // 编码器保留状态，代理对被分块截断时也能正确编码
+        QStringView chunk = QStringView(m_text).mid(pos, TextChunkSize);
+        QByteArray bytes;
+        if (lineBreak.isEmpty())
+        {
+            bytes = encoder.encode(chunk);
+        }
+        else
+        {
+            QString converted = chunk.toString();
+            converted.replace(QLatin1Char('\n'), lineBreak);
+            bytes = encoder.encode(converted);
+        }
+        if (file.write(bytes) != bytes.size())
+            return false;
+
+        bytesWritten += bytes.size();
+        reportProgress(pos + qMin(TextChunkSize, m_text.size() - pos), bytesWritten);
+    }
+    return true;
+}
+
+bool FileSaver::writeSnapshot(QSaveFile& file)
+{
+    return m_snapshot.writeTo(&file, &m_cancelled, [this](qint64 bytesWritten) {
+        reportProgress(bytesWritten, bytesWritten);
+    });
+}
+
+void FileSaver::reportProgress(qint64 done, qint64 bytesWritten)
+{
+    qint64 elapsed = m_timer.elapsed();
+    double rate = elapsed > 0 ? bytesWritten * 1000.0 / elapsed : 0.0;
+    emit progress(done, m_total, rate);
+}
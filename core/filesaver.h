@@ -0,0 +1,56 @@
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include "piecetable.h"
+#include "textscan.h"
+
+class QThread;
+class QSaveFile;
+
+// 后台原子保存：GUI 线程只负责取快照，编码与写盘在工作线程中进行。
+// 先写入同目录的临时文件并 fsync，再原子重命名覆盖目标文件。
+class FileSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 普通文档的文本快照（QString 隐式共享，不会再次复制），按 format 的编码与换行风格写出
+    FileSaver(const QString& filePath, const QString& text, const TextFormat& format, QObject* parent = nullptr);
+    // 大文件的片段表快照
+    FileSaver(const QString& filePath, const PieceTable::Snapshot& snapshot, QObject* parent = nullptr);
+    // 析构时等待写盘完成；需要放弃保存时先调用 cancel()
+    ~FileSaver();
+
+    void start();
+    void cancel();
+
+    QString filePath() const { return m_filePath; }
+
+signals:
+    // done/total 对文本快照以字符计、对片段表快照以字节计；速率始终以写出的字节计
+    void progress(qint64 done, qint64 total, double bytesPerSecond);
+    void finished(qint64 bytesWritten, qint64 elapsedMs);
+    void failed(const QString& error);
+
+private:
+    void run();
+    bool writeText(QSaveFile& file);
+    bool writeSnapshot(QSaveFile& file);
+    void reportProgress(qint64 done, qint64 bytesWritten);
+
+    QString m_filePath;
+    QString m_text;
+    TextFormat m_format;
+    PieceTable::Snapshot m_snapshot;
+    bool m_isSnapshot;
+    qint64 m_total;
+    QElapsedTimer m_timer;
+    QThread* m_thread;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // FILESAVER_H
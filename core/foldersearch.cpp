@@ -0,0 +1,309 @@
+#include "foldersearch.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QThread>
+#include <cstring>
+
+namespace {
+    // 每个文件最多保存的匹配数，以及整个查找最多保存的结果数
+    const int MaxMatchesPerFile = 1000;
+    const qint64 MaxResults = 100000;
+    // 结果行最多显示的字节数
+    const qsizetype MaxLineBytes = 300;
+    // 开头这么多字节中含 NUL 的文件视为二进制文件
+    const qsizetype BinaryProbeBytes = 8192;
+    const int DrainIntervalMs = 100;
+
+    inline bool isWordByte(char c)
+    {
+        // 非 ASCII 字节属于多字节字符，按单词字符处理
+        const uchar u = uchar(c);
+        return u >= 0x80 || (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_';
+    }
+}
+
+FolderSearch::FolderSearch(QObject* parent)
+    : QObject(parent)
+    , m_pending(0)
+    , m_runningWorkers(0)
+    , m_cancelled(false)
+    , m_files(0)
+    , m_bytes(0)
+    , m_matchCount(0)
+    , m_storedResults(0)
+    , m_truncated(false)
+{
+    m_drainTimer.setInterval(DrainIntervalMs);
+    connect(&m_drainTimer, &QTimer::timeout, this, &FolderSearch::drainResults);
+}
+
+FolderSearch::~FolderSearch()
+{
+    m_cancelled = true;
+    stopThreads();
+}
+
+void FolderSearch::start(const QString& directory, const QString& pattern, const SearchOptions& options,
+                         const QStringList& nameFilters)
+{
+    m_cancelled = true;
+    stopThreads();
+
+    m_needle = pattern.toUtf8();
+    m_options = options;
+    m_nameFilters = nameFilters;
+    m_cancelled = false;
+    m_files = 0;
+    m_bytes = 0;
+    m_matchCount = 0;
+    m_results.clear();
+    m_storedResults = 0;
+    m_truncated = false;
+
+    const int count = qMax(1, QThread::idealThreadCount());
+    m_queues.clear();
+    for (int i = 0; i < count; ++i)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+
+    m_pending = 1;
+    m_queues[0]->tasks.push_back(Task{ directory, true });
+    m_runningWorkers = count;
+
+    m_timer.start();
+    for (int i = 0; i < count; ++i)
+    {
+        QThread* thread = QThread::create([this, i]() { runWorker(i); });
+        m_threads.append(thread);
+        thread->start();
+    }
+    m_drainTimer.start();
+}
+
+void FolderSearch::cancel()
+{
+    // 工作线程退出后由 drainResults 发出 finished
+    m_cancelled = true;
+}
+
+void FolderSearch::stopThreads()
+{
+    for (QThread* thread : std::as_const(m_threads))
+    {
+        thread->wait();
+        delete thread;
+    }
+    m_threads.clear();
+    m_drainTimer.stop();
+}
+
+void FolderSearch::runWorker(int index)
+{
+    Task task;
+    int idleRounds = 0;
+    while (!m_cancelled)
+    {
+        if (takeTask(index, &task))
+        {
+            idleRounds = 0;
+            if (task.directory)
+                scanDirectory(index, task.path);
+            else
+                scanFile(task.path);
+            --m_pending;
+            continue;
+        }
+
+        if (m_pending.load() == 0)
+            break;
+        // 暂时没有可窃取的任务（其他线程还在列目录），稍后重试
+        if (++idleRounds < 64)
+            QThread::yieldCurrentThread();
+        else
+            QThread::usleep(200);
+    }
+    --m_runningWorkers;
+}
+
+bool FolderSearch::takeTask(int index, Task* task)
+{
+    // 自己的队列从队尾取，局部性更好
+    {
+        WorkQueue& own = *m_queues[index];
+        QMutexLocker locker(&own.mutex);
+        if (!own.tasks.empty())
+        {
+            *task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // 从其他线程的队首窃取，通常是较早入队的目录，能展开出更多任务
+    const int count = int(m_queues.size());
+    for (int offset = 1; offset < count; ++offset)
+    {
+        WorkQueue& victim = *m_queues[(index + offset) % count];
+        QMutexLocker locker(&victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            *task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void FolderSearch::pushTask(int index, const Task& task)
+{
+    // 先计数再入队，避免其他线程误以为已经没有任务
+    ++m_pending;
+    WorkQueue& own = *m_queues[index];
+    QMutexLocker locker(&own.mutex);
+    own.tasks.push_back(task);
+}
+
+void FolderSearch::scanDirectory(int index, const QString& path)
+{
+    // 默认不包含隐藏目录（如 .git），也不跟随目录的符号链接
+    QDirIterator dirs(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    while (dirs.hasNext() && !m_cancelled)
+        pushTask(index, Task{ dirs.next(), true });
+
+    QDirIterator files(path, m_nameFilters, QDir::Files | QDir::Readable);
+    while (files.hasNext() && !m_cancelled)
+        pushTask(index, Task{ files.next(), false });
+}
+
+bool FolderSearch::isWordBoundary(const char* data, qsizetype size, qsizetype start) const
+{
+    if (start > 0 && isWordByte(data[start - 1]))
+        return false;
+    const qsizetype end = start + m_needle.size();
+    return end >= size || !isWordByte(data[end]);
+}
+
+void FolderSearch::scanFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const qsizetype size = qsizetype(file.size());
+    ++m_files;
+    m_bytes += size;
+    if (size < m_needle.size() || size == 0)
+        return;
+
+    // 优先内存映射，映射失败（如特殊文件系统）时退回一次性读取
+    QByteArray fallback;
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data)
+    {
+        fallback = file.readAll();
+        data = fallback.constData();
+    }
+
+    if (std::memchr(data, 0, size_t(qMin(size, BinaryProbeBytes))))
+        return;
+
+    QVector<FolderMatch> matches;
+    qint64 found = 0;
+    qsizetype lineStart = 0;
+    qsizetype counted = 0;
+    int lineNumber = 0;
+    const qsizetype bom = (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+
+    qsizetype pos = TextSearcher::findBytes(data, size, m_needle, bom, m_options.caseSensitive);
+    while (pos >= 0 && !m_cancelled)
+    {
+        if (m_options.wholeWord && !isWordBoundary(data, size, pos))
+        {
+            pos = TextSearcher::findBytes(data, size, m_needle, pos + 1, m_options.caseSensitive);
+            continue;
+        }
+        ++found;
+
+        if (matches.size() < MaxMatchesPerFile)
+        {
+            // 从上一处匹配继续累计换行，整个文件只扫描一遍
+            while (counted < pos)
+            {
+                const char* newline = static_cast<const char*>(std::memchr(data + counted, '\n', size_t(pos - counted)));
+                if (!newline)
+                {
+                    counted = pos;
+                    break;
+                }
+                ++lineNumber;
+                lineStart = newline - data + 1;
+                counted = lineStart;
+            }
+
+            const qsizetype textStart = qMax(lineStart, bom);
+            const char* lineEndPtr = static_cast<const char*>(std::memchr(data + pos, '\n', size_t(size - pos)));
+            qsizetype lineEnd = lineEndPtr ? lineEndPtr - data : size;
+            if (lineEnd > textStart && data[lineEnd - 1] == '\r')
+                --lineEnd;
+
+            FolderMatch match;
+            match.filePath = path;
+            match.line = lineNumber;
+            match.column = int(QString::fromUtf8(data + textStart, pos - textStart).size());
+            match.lineText = QString::fromUtf8(data + textStart, qMin(lineEnd - textStart, MaxLineBytes)).trimmed();
+            matches.append(match);
+        }
+        pos = TextSearcher::findBytes(data, size, m_needle, pos + m_needle.size(), m_options.caseSensitive);
+    }
+
+    if (found == 0)
+        return;
+    m_matchCount += found;
+
+    QMutexLocker locker(&m_resultMutex);
+    for (const FolderMatch& match : std::as_const(matches))
+    {
+        if (m_storedResults >= MaxResults)
+        {
+            m_truncated = true;
+            break;
+        }
+        m_results.append(match);
+        ++m_storedResults;
+    }
+}
+
+FolderSearchStats FolderSearch::currentStats() const
+{
+    FolderSearchStats stats;
+    stats.files = m_files.load();
+    stats.bytes = m_bytes.load();
+    stats.matches = m_matchCount.load();
+    stats.elapsedMs = m_timer.elapsed();
+    stats.cancelled = m_cancelled.load();
+    return stats;
+}
+
+void FolderSearch::drainResults()
+{
+    const bool done = m_runningWorkers.load() == 0;
+    if (done)
+        stopThreads();
+
+    QVector<FolderMatch> batch;
+    bool truncated = false;
+    {
+        QMutexLocker locker(&m_resultMutex);
+        batch.swap(m_results);
+        truncated = m_truncated;
+    }
+    if (!batch.isEmpty())
+        emit resultsReady(batch);
+
+    FolderSearchStats stats = currentStats();
+    stats.truncated = truncated;
+    if (done)
+        emit finished(stats);
+    else
+        emit progress(stats);
+}
@@ -0,0 +1,106 @@
+#ifndef FOLDERSEARCH_H
+#define FOLDERSEARCH_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "textsearch.h"
+
+class QThread;
+
+// 行号与列号均从 0 开始，列号以 UTF-16 单元计，与编辑器中的位置一致
+struct FolderMatch
+{
+    QString filePath;
+    int line = 0;
+    int column = 0;
+    QString lineText;
+};
+
+struct FolderSearchStats
+{
+    qint64 files = 0;
+    qint64 bytes = 0;
+    qint64 matches = 0;
+    qint64 elapsedMs = 0;
+    bool truncated = false;     // 结果数超过上限，之后的匹配只计数不保存
+    bool cancelled = false;
+};
+
+// 在文件夹中并行查找字面量：每个工作线程有自己的任务队列（目录或文件），
+// 从队尾取任务，空闲时从其他线程的队首窃取。文件通过内存映射按字节扫描，
+// 结果在工作线程中累积，由 GUI 线程定时取走并分批发出
+class FolderSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FolderSearch(QObject* parent = nullptr);
+    // 析构时取消并等待所有工作线程退出
+    ~FolderSearch();
+
+    // nameFilters 为空时扫描所有文件；查找内容按 UTF-8 字节匹配
+    void start(const QString& directory, const QString& pattern, const SearchOptions& options,
+               const QStringList& nameFilters);
+    void cancel();
+    bool isRunning() const { return !m_threads.isEmpty(); }
+
+signals:
+    void resultsReady(const QVector<FolderMatch>& matches);
+    void progress(const FolderSearchStats& stats);
+    void finished(const FolderSearchStats& stats);
+
+private slots:
+    void drainResults();
+
+private:
+    struct Task
+    {
+        QString path;
+        bool directory = false;
+    };
+
+    struct WorkQueue
+    {
+        QMutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void runWorker(int index);
+    bool takeTask(int index, Task* task);
+    void pushTask(int index, const Task& task);
+    void scanDirectory(int index, const QString& path);
+    void scanFile(const QString& path);
+    bool isWordBoundary(const char* data, qsizetype size, qsizetype start) const;
+    FolderSearchStats currentStats() const;
+    void stopThreads();
+
+    QVector<QThread*> m_threads;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::atomic<qint64> m_pending;        // 已入队但尚未完成的任务数，降为 0 时查找结束
+    std::atomic<int> m_runningWorkers;
+    std::atomic<bool> m_cancelled;
+    std::atomic<qint64> m_files;
+    std::atomic<qint64> m_bytes;
+    std::atomic<qint64> m_matchCount;
+
+    QMutex m_resultMutex;
+    QVector<FolderMatch> m_results;       // 尚未发出的结果
+    qint64 m_storedResults;               // 受 m_resultMutex 保护
+    bool m_truncated;
+
+    QByteArray m_needle;
+    SearchOptions m_options;
+    QStringList m_nameFilters;
+    QTimer m_drainTimer;
+    QElapsedTimer m_timer;
+};
+
+#endif // FOLDERSEARCH_H
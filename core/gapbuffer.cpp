@@ -0,0 +1,83 @@
+#include "gapbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // 空隙用完时至少留出的大小
+    const int MinGap = 4096;
+}
+
+void GapBuffer::reset(QStringView text)
+{
+    m_data.assign(size_t(text.size()) + MinGap, 0);
+    std::memcpy(m_data.data(), text.utf16(), size_t(text.size()) * sizeof(char16_t));
+    m_gapStart = int(text.size());
+    m_gapEnd = int(m_data.size());
+}
+
+void GapBuffer::clear()
+{
+    std::vector<char16_t>().swap(m_data);
+    m_gapStart = 0;
+    m_gapEnd = 0;
+}
+
+void GapBuffer::moveGap(int position)
+{
+    if (position < m_gapStart)
+    {
+        const int count = m_gapStart - position;
+        std::memmove(m_data.data() + m_gapEnd - count, m_data.data() + position, size_t(count) * sizeof(char16_t));
+        m_gapStart -= count;
+        m_gapEnd -= count;
+    }
+    else if (position > m_gapStart)
+    {
+        const int count = position - m_gapStart;
+        std::memmove(m_data.data() + m_gapStart, m_data.data() + m_gapEnd, size_t(count) * sizeof(char16_t));
+        m_gapStart += count;
+        m_gapEnd += count;
+    }
+}
+
+void GapBuffer::ensureGap(int length)
+{
+    if (m_gapEnd - m_gapStart >= length)
+        return;
+
+    // 按当前大小的一半扩容，均摊后插入仍是 O(1)
+    const int tail = int(m_data.size()) - m_gapEnd;
+    const size_t newSize = m_data.size() + std::max<size_t>(size_t(length) + MinGap, m_data.size() / 2);
+    std::vector<char16_t> data(newSize, 0);
+    std::memcpy(data.data(), m_data.data(), size_t(m_gapStart) * sizeof(char16_t));
+    std::memcpy(data.data() + newSize - tail, m_data.data() + m_gapEnd, size_t(tail) * sizeof(char16_t));
+    m_data.swap(data);
+    m_gapEnd = int(newSize) - tail;
+}
+
+void GapBuffer::replace(int position, int length, QStringView text)
+{
+    position = std::clamp(position, 0, size());
+    length = std::clamp(length, 0, size() - position);
+
+    moveGap(position);
+    m_gapEnd += length;
+    ensureGap(int(text.size()));
+    std::memcpy(m_data.data() + m_gapStart, text.utf16(), size_t(text.size()) * sizeof(char16_t));
+    m_gapStart += int(text.size());
+}
+
+QString GapBuffer::mid(int position, int length) const
+{
+    position = std::clamp(position, 0, size());
+    length = std::clamp(length, 0, size() - position);
+
+    QString result(length, Qt::Uninitialized);
+    char16_t* out = reinterpret_cast<char16_t*>(result.data());
+    // 空隙之前与之后的两段分别复制
+    const int before = std::clamp(m_gapStart - position, 0, length);
+    std::memcpy(out, m_data.data() + position, size_t(before) * sizeof(char16_t));
+    const int gapLength = m_gapEnd - m_gapStart;
+    std::memcpy(out + before, m_data.data() + position + before + gapLength, size_t(length - before) * sizeof(char16_t));
+    return result;
+}
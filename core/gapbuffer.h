@@ -0,0 +1,34 @@
+#ifndef GAPBUFFER_H
+#define GAPBUFFER_H
+
+#include <QString>
+#include <QStringView>
+#include <vector>
+
+// UTF-16 间隙缓冲区：空隙停在最近一次编辑处，连续输入与删除是 O(1)，
+// 跳到别处编辑时只搬移两处之间的文本
+class GapBuffer
+{
+public:
+    GapBuffer() = default;
+
+    void reset(QStringView text);
+    void clear();
+
+    int size() const { return int(m_data.size()) - (m_gapEnd - m_gapStart); }
+    qint64 memoryUsage() const { return qint64(m_data.capacity()) * qint64(sizeof(char16_t)); }
+
+    // 把 [position, position + length) 替换为 text；超出末尾的部分按末尾截断
+    void replace(int position, int length, QStringView text);
+    QString mid(int position, int length) const;
+
+private:
+    void moveGap(int position);
+    void ensureGap(int length);
+
+    std::vector<char16_t> m_data;
+    int m_gapStart = 0;
+    int m_gapEnd = 0;
+};
+
+#endif // GAPBUFFER_H
@@ -0,0 +1,238 @@
+#include "latencytrace.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+    // 约 8 MB；按每次按键 5-6 个事件计，可以容纳数万次按键
+    const int TraceCapacity = 1 << 18;
+
+    struct TraceEvent
+    {
+        const char* name;
+        qint64 start;
+        qint64 duration;
+        quint32 track;
+    };
+
+    struct TraceBuffer
+    {
+        QMutex mutex;
+        std::vector<TraceEvent> events;
+        qint64 written = 0;   // 累计写入数，超过容量后从头覆盖
+        QHash<quint32, QString> trackNames;
+    };
+
+    std::atomic<bool> s_enabled(false);
+
+    TraceBuffer& traceBuffer()
+    {
+        static TraceBuffer buffer;
+        return buffer;
+    }
+
+    const QElapsedTimer& clock()
+    {
+        static const QElapsedTimer timer = []() {
+            QElapsedTimer t;
+            t.start();
+            return t;
+        }();
+        return timer;
+    }
+
+    QByteArray jsonString(const QString& text)
+    {
+        QByteArray result = "\"";
+        for (QChar c : text)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\' + QString(c).toUtf8();
+            else if (c.unicode() < 0x20)
+                result += QByteArray("\\u") + QByteArray::number(c.unicode(), 16).rightJustified(4, '0');
+            else
+                result += QString(c).toUtf8();
+        }
+        return result + '"';
+    }
+}
+
+// ============ LatencyHistogram 实现 ============
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    std::memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_max = 0;
+}
+
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    if (value < SubBuckets)
+        return int(value);
+
+    // magnitude 是最高位的位置；同一量级内取最高 SubBucketBits + 1 位决定子桶
+    int magnitude = 63 - qCountLeadingZeroBits(value);
+    if (magnitude > MaxMagnitude)
+        return BucketCount - 1;
+    int group = magnitude - SubBucketBits + 1;
+    int sub = int(value >> (magnitude - SubBucketBits)) - SubBuckets;
+    return group * SubBuckets + sub;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBuckets)
+        return index;
+
+    int group = index / SubBuckets;
+    qint64 lower = qint64(SubBuckets + index % SubBuckets) << (group - 1);
+    return lower + (qint64(1) << (group - 1)) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros)
+{
+    micros = qMax<qint64>(0, micros);
+    ++m_buckets[bucketIndex(quint64(micros))];
+    ++m_count;
+    m_max = qMax(m_max, micros);
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    qint64 target = qMax<qint64>(1, qint64(std::ceil(m_count * qBound(0.0, p, 100.0) / 100.0)));
+    qint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return qMin(bucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+// ============ LatencyTrace 实现 ============
+
+bool LatencyTrace::isEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void LatencyTrace::setEnabled(bool enabled)
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    // 缓冲区只在第一次开启时分配
+    if (enabled && buffer.events.empty())
+        buffer.events.resize(TraceCapacity);
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void LatencyTrace::clear()
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.written = 0;
+}
+
+int LatencyTrace::eventCount()
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    return int(qMin<qint64>(buffer.written, TraceCapacity));
+}
+
+qint64 LatencyTrace::now()
+{
+    return clock().nsecsElapsed();
+}
+
+void LatencyTrace::complete(const char* name, quint32 track, qint64 startNs, qint64 endNs)
+{
+    if (!isEnabled())
+        return;
+
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    if (buffer.events.empty())
+        return;
+    buffer.events[size_t(buffer.written % TraceCapacity)] = { name, startNs, endNs - startNs, track };
+    ++buffer.written;
+}
+
+void LatencyTrace::setTrackName(quint32 track, const QString& name)
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.trackNames.insert(track, name);
+}
+
+bool LatencyTrace::exportChromeTrace(const QString& filePath, QString* errorString)
+{
+    // 先在锁内复制事件，写盘不阻塞正在记录的编辑器
+    std::vector<TraceEvent> events;
+    QHash<quint32, QString> trackNames;
+    {
+        TraceBuffer& buffer = traceBuffer();
+        QMutexLocker locker(&buffer.mutex);
+        const qint64 count = qMin<qint64>(buffer.written, TraceCapacity);
+        events.reserve(size_t(count));
+        for (qint64 i = buffer.written - count; i < buffer.written; ++i)
+            events.push_back(buffer.events[size_t(i % TraceCapacity)]);
+        trackNames = buffer.trackNames;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+
+    // 时间戳与时长按 Chrome trace 约定以微秒表示
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"MarkdownEditor\"}}";
+    for (auto it = trackNames.constBegin(); it != trackNames.constEnd(); ++it)
+    {
+        out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(it.key())
+               + ",\"args\":{\"name\":" + jsonString(it.value()) + "}}";
+    }
+    for (const TraceEvent& event : events)
+    {
+        out += ",\n{\"name\":\"";
+        out += event.name;
+        out += "\",\"cat\":\"editor\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(event.track)
+               + ",\"ts\":" + QByteArray::number(event.start / 1000.0, 'f', 3)
+               + ",\"dur\":" + QByteArray::number(event.duration / 1000.0, 'f', 3) + '}';
+        if (out.size() > (1 << 20))
+        {
+            file.write(out);
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    file.write(out);
+
+    if (!file.commit())
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef LATENCYTRACE_H
+#define LATENCYTRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+// HDR 风格的延迟直方图：每个 2 的幂区间再线性分成 16 个子桶，相对误差约 6%，
+// 固定 512 个计数器覆盖 1 µs 到约 9 小时，记录一次只是几次位运算与一次自增
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 micros);
+    void reset();
+
+    qint64 count() const { return m_count; }
+    qint64 maxMicros() const { return m_max; }
+    // p 取 0-100，返回该分位所在桶的上界（微秒）；没有样本时返回 0
+    qint64 percentile(double p) const;
+
+private:
+    enum { SubBucketBits = 4, SubBuckets = 1 << SubBucketBits, MaxMagnitude = 34 };
+    enum { BucketCount = (MaxMagnitude - SubBucketBits + 2) * SubBuckets };
+
+    static int bucketIndex(quint64 value);
+    static qint64 bucketUpperBound(int index);
+
+    quint32 m_buckets[BucketCount];
+    qint64 m_count;
+    qint64 m_max;
+};
+
+// 进程级事件时间线，可导出为 Chrome trace（chrome://tracing、Perfetto）格式。
+// 关闭时 isEnabled() 之外没有任何开销；开启后事件写入固定容量的环形缓冲区，只保留最近的事件
+class LatencyTrace
+{
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+    static void clear();
+    static int eventCount();
+
+    // 单调时钟，纳秒，所有事件与直方图使用同一时间源
+    static qint64 now();
+
+    // name 必须是字符串字面量；track 对应时间线上的一行（每个编辑器一行）
+    static void complete(const char* name, quint32 track, qint64 startNs, qint64 endNs);
+    static void setTrackName(quint32 track, const QString& name);
+
+    static bool exportChromeTrace(const QString& filePath, QString* errorString = nullptr);
+};
+
+// 作用域计时：构造时记录开始时间，析构时写入一个完整事件
+class LatencyScope
+{
+public:
+    LatencyScope(const char* name, quint32 track)
+        : m_name(name)
+        , m_track(track)
+        , m_start(LatencyTrace::isEnabled() ? LatencyTrace::now() : -1)
+    {
+    }
+
+    ~LatencyScope()
+    {
+        if (m_start >= 0)
+            LatencyTrace::complete(m_name, m_track, m_start, LatencyTrace::now());
+    }
+
+private:
+    Q_DISABLE_COPY(LatencyScope)
+
+    const char* m_name;
+    quint32 m_track;
+    qint64 m_start;
+};
+
+#endif // LATENCYTRACE_H
@@ -0,0 +1,882 @@
+#include "markdownparser.h"
+
+namespace {
+    bool isSpace(QChar c)
+    {
+        return c == QLatin1Char(' ') || c == QLatin1Char('\t');
+    }
+
+    int skipSpaces(QStringView line, int pos)
+    {
+        while (pos < line.size() && isSpace(line.at(pos)))
+            ++pos;
+        return pos;
+    }
+
+    bool isBlank(QStringView line)
+    {
+        return skipSpaces(line, 0) >= line.size();
+    }
+
+    int indentWidth(QStringView line, int to)
+    {
+        int width = 0;
+        for (int i = 0; i < to; ++i)
+            width += line.at(i) == QLatin1Char('\t') ? 4 - width % 4 : 1;
+        return width;
+    }
+
+    int runLength(QStringView text, int pos, QChar c)
+    {
+        int n = 0;
+        while (pos + n < text.size() && text.at(pos + n) == c)
+            ++n;
+        return n;
+    }
+
+    QVector<QStringView> splitLines(QStringView text)
+    {
+        QVector<QStringView> lines;
+        qsizetype start = 0;
+        while (true)
+        {
+            qsizetype end = text.indexOf(QLatin1Char('\n'), start);
+            if (end < 0)
+            {
+                lines.append(text.mid(start));
+                break;
+            }
+            lines.append(text.mid(start, end - start));
+            start = end + 1;
+        }
+        return lines;
+    }
+
+    // 围栏起始标记的长度，不是围栏时返回 0
+    int openingFence(QStringView line, int pos, QChar* fenceChar)
+    {
+        if (pos >= line.size())
+            return 0;
+        QChar c = line.at(pos);
+        if (c != QLatin1Char('`') && c != QLatin1Char('~'))
+            return 0;
+
+        int n = runLength(line, pos, c);
+        if (n < 3)
+            return 0;
+        if (c == QLatin1Char('`') && line.indexOf(QLatin1Char('`'), pos + n) >= 0)
+            return 0;
+
+        *fenceChar = c;
+        return n;
+    }
+
+    bool isClosingFence(QStringView line, int pos, QChar fenceChar, int fenceLength)
+    {
+        int n = runLength(line, pos, fenceChar);
+        return n >= fenceLength && isBlank(line.mid(pos + n));
+    }
+
+    int atxLevel(QStringView line, int pos)
+    {
+        int n = runLength(line, pos, QLatin1Char('#'));
+        if (n < 1 || n > 6)
+            return 0;
+        if (pos + n < line.size() && !isSpace(line.at(pos + n)))
+            return 0;
+        return n;
+    }
+
+    bool isThematicBreak(QStringView line, int pos)
+    {
+        if (pos >= line.size())
+            return false;
+        QChar c = line.at(pos);
+        if (c != QLatin1Char('*') && c != QLatin1Char('-') && c != QLatin1Char('_'))
+            return false;
+
+        int count = 0;
+        for (int i = pos; i < line.size(); ++i)
+        {
+            if (line.at(i) == c)
+                ++count;
+            else if (!isSpace(line.at(i)))
+                return false;
+        }
+        return count >= 3;
+    }
+
+    // Setext 标题下划线："===" 为一级，"---" 为二级，其他返回 0
+    int setextLevel(QStringView line, int pos)
+    {
+        if (pos >= line.size())
+            return 0;
+        QChar c = line.at(pos);
+        if (c != QLatin1Char('=') && c != QLatin1Char('-'))
+            return 0;
+        if (!isBlank(line.mid(pos + runLength(line, pos, c))))
+            return 0;
+        return c == QLatin1Char('=') ? 1 : 2;
+    }
+
+    bool isHtmlStart(QStringView line, int pos)
+    {
+        if (pos + 1 >= line.size() || line.at(pos) != QLatin1Char('<'))
+            return false;
+        QChar next = line.at(pos + 1);
+        return next.isLetter() || next == QLatin1Char('/') || next == QLatin1Char('!') || next == QLatin1Char('?');
+    }
+
+    int listMarkerLength(QStringView line, int pos)
+    {
+        if (pos >= line.size())
+            return 0;
+
+        int end = pos;
+        QChar c = line.at(pos);
+        if (c == QLatin1Char('-') || c == QLatin1Char('*') || c == QLatin1Char('+'))
+        {
+            end = pos + 1;
+        }
+        else
+        {
+            while (end < line.size() && end - pos < 9 && line.at(end).isDigit())
+                ++end;
+            if (end == pos || end >= line.size())
+                return 0;
+            if (line.at(end) != QLatin1Char('.') && line.at(end) != QLatin1Char(')'))
+                return 0;
+            ++end;
+        }
+
+        if (end < line.size() && !isSpace(line.at(end)))
+            return 0;
+        return end - pos;
+    }
+
+    // 表格分隔行，如 "| --- | :---: |"
+    bool isTableDelimiter(QStringView line)
+    {
+        bool sawDash = false;
+        for (QChar c : line)
+        {
+            if (c == QLatin1Char('-'))
+                sawDash = true;
+            else if (c != QLatin1Char('|') && c != QLatin1Char(':') && !isSpace(c))
+                return false;
+        }
+        return sawDash && line.contains(QLatin1Char('|'));
+    }
+
+    QVector<QStringView> tableCells(QStringView line)
+    {
+        QStringView row = line.trimmed();
+        if (row.startsWith(QLatin1Char('|')))
+            row = row.mid(1);
+        if (row.endsWith(QLatin1Char('|')))
+            row.chop(1);
+
+        QVector<QStringView> cells;
+        for (QStringView cell : row.split(QLatin1Char('|')))
+            cells.append(cell.trimmed());
+        return cells;
+    }
+
+    void appendEscaped(QString& out, QChar c)
+    {
+        switch (c.unicode())
+        {
+        case '&': out += QLatin1String("&amp;"); break;
+        case '<': out += QLatin1String("&lt;"); break;
+        case '>': out += QLatin1String("&gt;"); break;
+        case '"': out += QLatin1String("&quot;"); break;
+        default: out += c; break;
+        }
+    }
+
+    QString escaped(QStringView text)
+    {
+        QString out;
+        out.reserve(text.size());
+        for (QChar c : text)
+            appendEscaped(out, c);
+        return out;
+    }
+
+    // 去掉每行至多 columns 个前导空格
+    QString stripIndent(const QVector<QStringView>& lines, int from, int to, int columns)
+    {
+        QString out;
+        for (int i = from; i < to; ++i)
+        {
+            QStringView line = lines[i];
+            int pos = 0;
+            while (pos < line.size() && pos < columns && isSpace(line.at(pos)))
+                ++pos;
+            if (i > from)
+                out += QLatin1Char('\n');
+            out += line.mid(pos);
+        }
+        return out;
+    }
+
+    // 查找闭合标记：前一个字符不能是空白
+    int findClosing(QStringView text, int from, QStringView marker)
+    {
+        qsizetype pos = text.indexOf(marker, from);
+        while (pos > 0 && text.at(pos - 1).isSpace())
+            pos = text.indexOf(marker, pos + 1);
+        return int(pos);
+    }
+
+    // 解析 [label](url "title")，成功时返回结束位置之后的下标，失败返回 -1
+    int parseLink(QStringView text, int pos, QStringView* label, QStringView* url)
+    {
+        int depth = 0;
+        int closeBracket = -1;
+        for (int i = pos; i < text.size(); ++i)
+        {
+            QChar c = text.at(i);
+            if (c == QLatin1Char('\\'))
+                ++i;
+            else if (c == QLatin1Char('['))
+                ++depth;
+            else if (c == QLatin1Char(']') && --depth == 0)
+            {
+                closeBracket = i;
+                break;
+            }
+        }
+        if (closeBracket < 0 || closeBracket + 1 >= text.size() || text.at(closeBracket + 1) != QLatin1Char('('))
+            return -1;
+
+        depth = 0;
+        int closeParen = -1;
+        for (int i = closeBracket + 1; i < text.size(); ++i)
+        {
+            QChar c = text.at(i);
+            if (c == QLatin1Char('('))
+                ++depth;
+            else if (c == QLatin1Char(')') && --depth == 0)
+            {
+                closeParen = i;
+                break;
+            }
+        }
+        if (closeParen < 0)
+            return -1;
+
+        QStringView target = text.mid(closeBracket + 2, closeParen - closeBracket - 2).trimmed();
+        qsizetype titleStart = target.indexOf(QLatin1String(" \""));
+        if (titleStart >= 0)
+            target = target.left(titleStart).trimmed();
+        if (target.startsWith(QLatin1Char('<')) && target.endsWith(QLatin1Char('>')))
+            target = target.mid(1, target.size() - 2);
+
+        *label = text.mid(pos + 1, closeBracket - pos - 1);
+        *url = target;
+        return closeParen + 1;
+    }
+
+    bool isAutolinkTarget(QStringView text)
+    {
+        if (text.isEmpty() || text.contains(QLatin1Char(' ')))
+            return false;
+        return text.startsWith(QLatin1String("http://")) || text.startsWith(QLatin1String("https://"))
+            || text.startsWith(QLatin1String("mailto:"));
+    }
+
+    QString renderList(const QVector<QStringView>& lines)
+    {
+        const QStringView first = lines.first();
+        const int firstPos = skipSpaces(first, 0);
+        const int firstMarker = listMarkerLength(first, firstPos);
+        const bool ordered = first.at(firstPos).isDigit();
+
+        // 按列表项收集内容，延续行去掉内容缩进
+        QVector<QString> items;
+        int contentIndent = 0;
+        bool sawBlank = false;
+        bool loose = false;
+        for (QStringView line : lines)
+        {
+            if (isBlank(line))
+            {
+                if (!items.isEmpty())
+                    items.last() += QLatin1Char('\n');
+                sawBlank = true;
+                continue;
+            }
+
+            const int pos = skipSpaces(line, 0);
+            const int marker = listMarkerLength(line, pos);
+            if (marker > 0 && (items.isEmpty() || pos < contentIndent))
+            {
+                if (sawBlank && !items.isEmpty())
+                    loose = true;
+
+                const int afterMarker = pos + marker;
+                const int contentStart = skipSpaces(line, afterMarker);
+                if (contentStart >= line.size() || contentStart - afterMarker > 4)
+                    contentIndent = afterMarker + 1;
+                else
+                    contentIndent = contentStart;
+                items.append(line.mid(qMin<int>(contentIndent, line.size())).toString());
+            }
+            else
+            {
+                if (sawBlank)
+                    loose = true;
+                items.last() += QLatin1Char('\n');
+                items.last() += line.mid(qMin(pos, contentIndent));
+            }
+            sawBlank = false;
+        }
+
+        QString html;
+        if (ordered)
+        {
+            int start = first.mid(firstPos, firstMarker - 1).toInt();
+            html = start == 1 ? QStringLiteral("<ol>\n") : QStringLiteral("<ol start=\"%1\">\n").arg(start);
+        }
+        else
+        {
+            html = QStringLiteral("<ul>\n");
+        }
+
+        for (const QString& item : items)
+        {
+            QStringView body(item);
+            html += QLatin1String("<li>");
+
+            // 任务列表
+            if (body.startsWith(QLatin1String("[ ] ")))
+            {
+                html += QChar(0x2610);
+                html += QLatin1Char(' ');
+                body = body.mid(4);
+            }
+            else if (body.startsWith(QLatin1String("[x] ")) || body.startsWith(QLatin1String("[X] ")))
+            {
+                html += QChar(0x2611);
+                html += QLatin1Char(' ');
+                body = body.mid(4);
+            }
+
+            // 紧凑列表中的段落不包 <p>
+            for (const MarkdownSourceBlock& block : MarkdownParser::splitBlocks(body))
+            {
+                if (!loose && MarkdownParser::classify(block.source) == MarkdownParser::Paragraph)
+                    html += MarkdownParser::renderInline(block.source);
+                else
+                    html += MarkdownParser::renderBlock(block.source);
+            }
+            html += QLatin1String("</li>\n");
+        }
+
+        html += ordered ? QLatin1String("</ol>\n") : QLatin1String("</ul>\n");
+        return html;
+    }
+
+    QString renderTable(const QVector<QStringView>& lines)
+    {
+        QVector<QString> alignments;
+        for (QStringView cell : tableCells(lines[1]))
+        {
+            bool left = cell.startsWith(QLatin1Char(':'));
+            bool right = cell.endsWith(QLatin1Char(':'));
+            if (left && right)
+                alignments.append(QStringLiteral(" align=\"center\""));
+            else if (right)
+                alignments.append(QStringLiteral(" align=\"right\""));
+            else if (left)
+                alignments.append(QStringLiteral(" align=\"left\""));
+            else
+                alignments.append(QString());
+        }
+
+        auto renderRow = [&alignments](QStringView line, const char* tag) {
+            QString row = QStringLiteral("<tr>");
+            const QVector<QStringView> cells = tableCells(line);
+            for (int i = 0; i < cells.size(); ++i)
+            {
+                row += QStringLiteral("<%1%2>").arg(QLatin1String(tag), alignments.value(i));
+                row += MarkdownParser::renderInline(cells[i]);
+                row += QStringLiteral("</%1>").arg(QLatin1String(tag));
+            }
+            return row + QStringLiteral("</tr>\n");
+        };
+
+        QString html = QStringLiteral("<table>\n<thead>\n");
+        html += renderRow(lines[0], "th");
+        html += QLatin1String("</thead>\n<tbody>\n");
+        for (int i = 2; i < lines.size(); ++i)
+            html += renderRow(lines[i], "td");
+        html += QLatin1String("</tbody>\n</table>\n");
+        return html;
+    }
+}
+
+// ============ MarkdownParser 实现 ============
+QVector<MarkdownSourceBlock> MarkdownParser::splitBlocks(QStringView text)
+{
+    QVector<MarkdownSourceBlock> blocks;
+    const QVector<QStringView> lines = splitLines(text);
+
+    int blockStart = -1;   // 当前块的首行
+    int blockEnd = -1;     // 当前块的最后一个非空行
+    BlockKind kind = Blank;
+    QChar fenceChar;
+    int fenceLength = 0;
+
+    auto flush = [&]() {
+        if (blockStart < 0)
+            return;
+        const QStringView first = lines[blockStart];
+        const QStringView last = lines[blockEnd];
+        const qsizetype begin = first.data() - text.data();
+        const qsizetype end = last.data() + last.size() - text.data();
+
+        MarkdownSourceBlock block;
+        block.source = text.mid(begin, end - begin).toString();
+        block.startLine = blockStart;
+        block.lineCount = blockEnd - blockStart + 1;
+        blocks.append(block);
+
+        blockStart = -1;
+        kind = Blank;
+    };
+    auto begin = [&](int line, BlockKind newKind) {
+        flush();
+        blockStart = blockEnd = line;
+        kind = newKind;
+    };
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const QStringView line = lines[i];
+
+        if (kind == FencedCode)
+        {
+            blockEnd = i;
+            if (isClosingFence(line, skipSpaces(line, 0), fenceChar, fenceLength))
+                flush();
+            continue;
+        }
+
+        if (isBlank(line))
+        {
+            // 列表与缩进代码中的空行由下一个非空行决定是否延续
+            if (kind != List && kind != IndentedCode)
+                flush();
+            continue;
+        }
+
+        const int pos = skipSpaces(line, 0);
+        const int indent = indentWidth(line, pos);
+        const bool afterBlank = blockStart >= 0 && blockEnd < i - 1;
+
+        if (kind == Html)
+        {
+            blockEnd = i;
+            continue;
+        }
+        if (kind == IndentedCode)
+        {
+            if (indent >= 4)
+            {
+                blockEnd = i;
+                continue;
+            }
+            flush();
+        }
+        if (kind == List)
+        {
+            if (indent >= 2)
+            {
+                blockEnd = i;
+                continue;
+            }
+            if (afterBlank && listMarkerLength(line, pos) == 0)
+                flush();
+        }
+
+        if (indent >= 4 && kind == Blank)
+        {
+            begin(i, IndentedCode);
+            continue;
+        }
+
+        QChar fence;
+        int length = indent < 4 ? openingFence(line, pos, &fence) : 0;
+        if (length > 0)
+        {
+            begin(i, FencedCode);
+            fenceChar = fence;
+            fenceLength = length;
+            continue;
+        }
+
+        if (atxLevel(line, pos) > 0)
+        {
+            begin(i, Heading);
+            flush();
+            continue;
+        }
+        if (kind == Paragraph && setextLevel(line, pos) > 0)
+        {
+            blockEnd = i;
+            flush();
+            continue;
+        }
+        if (isThematicBreak(line, pos))
+        {
+            begin(i, ThematicBreak);
+            flush();
+            continue;
+        }
+        if (line.at(pos) == QLatin1Char('>'))
+        {
+            if (kind == BlockQuote)
+                blockEnd = i;
+            else
+                begin(i, BlockQuote);
+            continue;
+        }
+        if (listMarkerLength(line, pos) > 0)
+        {
+            if (kind == List)
+                blockEnd = i;
+            else
+                begin(i, List);
+            continue;
+        }
+        if (kind != Paragraph && isHtmlStart(line, pos))
+        {
+            begin(i, Html);
+            continue;
+        }
+        if (kind == Paragraph && blockStart == i - 1 && lines[blockStart].contains(QLatin1Char('|')) && isTableDelimiter(line))
+        {
+            blockEnd = i;
+            kind = Table;
+            continue;
+        }
+        if (kind == Table && !line.contains(QLatin1Char('|')))
+            flush();
+
+        // 段落、引用与列表的惰性延续行
+        if (kind == Blank)
+            begin(i, Paragraph);
+        else
+            blockEnd = i;
+    }
+    flush();
+
+    return blocks;
+}
+
+MarkdownParser::BlockKind MarkdownParser::classify(QStringView source)
+{
+    const QVector<QStringView> lines = splitLines(source);
+    const QStringView first = lines.first();
+    const int pos = skipSpaces(first, 0);
+    if (pos >= first.size())
+        return Blank;
+
+    QChar fence;
+    if (indentWidth(first, pos) >= 4)
+        return IndentedCode;
+    if (openingFence(first, pos, &fence) > 0)
+        return FencedCode;
+    if (atxLevel(first, pos) > 0)
+        return Heading;
+    if (lines.size() == 1 && isThematicBreak(first, pos))
+        return ThematicBreak;
+    if (first.at(pos) == QLatin1Char('>'))
+        return BlockQuote;
+    if (listMarkerLength(first, pos) > 0)
+        return List;
+    if (isHtmlStart(first, pos))
+        return Html;
+
+    if (lines.size() >= 2)
+    {
+        const QStringView last = lines.last();
+        if (setextLevel(last, skipSpaces(last, 0)) > 0)
+            return SetextHeading;
+        if (first.contains(QLatin1Char('|')) && isTableDelimiter(lines[1]))
+            return Table;
+    }
+    return Paragraph;
+}
+
+QString MarkdownParser::renderBlock(QStringView source)
+{
+    const QVector<QStringView> lines = splitLines(source);
+    const QStringView first = lines.first();
+    const int pos = skipSpaces(first, 0);
+
+    switch (classify(source))
+    {
+    case Heading:
+    {
+        int level = atxLevel(first, pos);
+        QStringView content = first.mid(pos + level).trimmed();
+        // 去掉可选的结尾 #
+        QStringView stripped = content;
+        while (stripped.endsWith(QLatin1Char('#')))
+            stripped.chop(1);
+        if (stripped.isEmpty() || isSpace(stripped.back()))
+            content = stripped.trimmed();
+        return QStringLiteral("<h%1>%2</h%1>\n").arg(level).arg(renderInline(content));
+    }
+    case SetextHeading:
+    {
+        const QStringView last = lines.last();
+        int level = setextLevel(last, skipSpaces(last, 0));
+        QStringView content = source.left(last.data() - source.data()).trimmed();
+        return QStringLiteral("<h%1>%2</h%1>\n").arg(level).arg(renderInline(content));
+    }
+    case ThematicBreak:
+        return QStringLiteral("<hr/>\n");
+    case FencedCode:
+    {
+        QChar fenceChar;
+        int length = openingFence(first, pos, &fenceChar);
+        QString info = first.mid(pos + length).trimmed().toString().section(QLatin1Char(' '), 0, 0);
+
+        int end = lines.size();
+        if (end > 1 && isClosingFence(lines.last(), skipSpaces(lines.last(), 0), fenceChar, length))
+            --end;
+
+        QString html = info.isEmpty()
+            ? QStringLiteral("<pre><code>")
+            : QStringLiteral("<pre><code class=\"language-%1\">").arg(escaped(info));
+        html += escaped(stripIndent(lines, 1, end, pos));
+        html += QLatin1String("</code></pre>\n");
+        return html;
+    }
+    case IndentedCode:
+        return QStringLiteral("<pre><code>%1</code></pre>\n").arg(escaped(stripIndent(lines, 0, lines.size(), 4)));
+    case BlockQuote:
+    {
+        // 去掉一层 ">"，惰性延续行原样保留
+        QString inner;
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            QStringView line = lines[i];
+            int p = skipSpaces(line, 0);
+            if (p < line.size() && line.at(p) == QLatin1Char('>'))
+            {
+                ++p;
+                if (p < line.size() && isSpace(line.at(p)))
+                    ++p;
+                line = line.mid(p);
+            }
+            if (i > 0)
+                inner += QLatin1Char('\n');
+            inner += line;
+        }
+        return QStringLiteral("<blockquote>\n%1</blockquote>\n").arg(renderBlocks(inner));
+    }
+    case List:
+        return renderList(lines);
+    case Table:
+        return renderTable(lines);
+    case Html:
+        return source.toString() + QLatin1Char('\n');
+    case Paragraph:
+        return QStringLiteral("<p>%1</p>\n").arg(renderInline(source.trimmed()));
+    case Blank:
+        break;
+    }
+    return QString();
+}
+
+QString MarkdownParser::renderBlocks(QStringView text)
+{
+    QString html;
+    for (const MarkdownSourceBlock& block : splitBlocks(text))
+        html += renderBlock(block.source);
+    return html;
+}
+
+QString MarkdownParser::renderInline(QStringView text)
+{
+    QString out;
+    out.reserve(text.size() + text.size() / 8);
+
+    const int n = text.size();
+    int i = 0;
+    while (i < n)
+    {
+        const QChar c = text.at(i);
+
+        if (c == QLatin1Char('\\') && i + 1 < n)
+        {
+            QChar next = text.at(i + 1);
+            if (next == QLatin1Char('\n'))
+                out += QLatin1String("<br/>");
+            else if (next.isPunct() || next.isSymbol())
+                appendEscaped(out, next);
+            else
+            {
+                out += c;
+                appendEscaped(out, next);
+            }
+            i += 2;
+            continue;
+        }
+
+        // 行内代码
+        if (c == QLatin1Char('`'))
+        {
+            const int run = runLength(text, i, c);
+            int close = -1;
+            for (int j = i + run; j < n; )
+            {
+                if (text.at(j) != c)
+                {
+                    ++j;
+                    continue;
+                }
+                int k = runLength(text, j, c);
+                if (k == run)
+                {
+                    close = j;
+                    break;
+                }
+                j += k;
+            }
+
+            if (close < 0)
+            {
+                out += QString(run, c);
+                i += run;
+                continue;
+            }
+
+            QStringView code = text.mid(i + run, close - i - run);
+            if (code.size() >= 2 && code.front() == QLatin1Char(' ') && code.back() == QLatin1Char(' '))
+                code = code.mid(1, code.size() - 2);
+            out += QLatin1String("<code>") + escaped(code) + QLatin1String("</code>");
+            i = close + run;
+            continue;
+        }
+
+        // 图片与链接
+        if (c == QLatin1Char('[') || (c == QLatin1Char('!') && i + 1 < n && text.at(i + 1) == QLatin1Char('[')))
+        {
+            const bool image = (c == QLatin1Char('!'));
+            QStringView label;
+            QStringView url;
+            int end = parseLink(text, image ? i + 1 : i, &label, &url);
+            if (end > 0)
+            {
+                if (image)
+                    out += QStringLiteral("<img src=\"%1\" alt=\"%2\"/>").arg(escaped(url), escaped(label));
+                else
+                    out += QStringLiteral("<a href=\"%1\">%2</a>").arg(escaped(url), renderInline(label));
+                i = end;
+                continue;
+            }
+            out += c;
+            ++i;
+            continue;
+        }
+
+        // 自动链接与行内 HTML
+        if (c == QLatin1Char('<'))
+        {
+            qsizetype close = text.indexOf(QLatin1Char('>'), i + 1);
+            if (close > 0)
+            {
+                QStringView inner = text.mid(i + 1, close - i - 1);
+                if (isAutolinkTarget(inner))
+                {
+                    QString target = escaped(inner);
+                    out += QStringLiteral("<a href=\"%1\">%1</a>").arg(target);
+                    i = int(close) + 1;
+                    continue;
+                }
+                if (isHtmlStart(text, i))
+                {
+                    out += text.mid(i, close - i + 1);
+                    i = int(close) + 1;
+                    continue;
+                }
+            }
+            out += QLatin1String("&lt;");
+            ++i;
+            continue;
+        }
+
+        // 强调、加粗与删除线
+        if (c == QLatin1Char('*') || c == QLatin1Char('_') || c == QLatin1Char('~'))
+        {
+            const int run = runLength(text, i, c);
+            const bool intraword = c == QLatin1Char('_') && i > 0 && text.at(i - 1).isLetterOrNumber();
+            const bool opens = i + run < n && !text.at(i + run).isSpace() && !intraword;
+
+            if (opens && (c != QLatin1Char('~') || run == 2))
+            {
+                const int markerLength = qMin(run, 3);
+                const QString marker(markerLength, c);
+                int close = findClosing(text, i + markerLength, marker);
+                if (close > 0)
+                {
+                    QString inner = renderInline(text.mid(i + markerLength, close - i - markerLength));
+                    if (c == QLatin1Char('~'))
+                        out += QLatin1String("<s>") + inner + QLatin1String("</s>");
+                    else if (markerLength == 3)
+                        out += QLatin1String("<strong><em>") + inner + QLatin1String("</em></strong>");
+                    else if (markerLength == 2)
+                        out += QLatin1String("<strong>") + inner + QLatin1String("</strong>");
+                    else
+                        out += QLatin1String("<em>") + inner + QLatin1String("</em>");
+                    i = close + markerLength;
+                    continue;
+                }
+            }
+            out += QString(run, c);
+            i += run;
+            continue;
+        }
+
+        // 行尾两个空格为硬换行
+        if (c == QLatin1Char('\n'))
+        {
+            if (out.endsWith(QLatin1String("  ")))
+            {
+                while (out.endsWith(QLatin1Char(' ')))
+                    out.chop(1);
+                out += QLatin1String("<br/>");
+            }
+            out += c;
+            ++i;
+            continue;
+        }
+
+        appendEscaped(out, c);
+        ++i;
+    }
+    return out;
+}
+
+QString MarkdownParser::toHtml(const QString& text, const QString& title)
+{
+    return htmlHeader(title) + renderBlocks(text) + htmlFooter();
+}
+
+QString MarkdownParser::htmlHeader(const QString& title)
+{
+    QString html = QStringLiteral("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n");
+    html += QStringLiteral("<title>%1</title>\n</head>\n<body>\n").arg(escaped(title));
+    return html;
+}
+
+QString MarkdownParser::htmlFooter()
+{
+    return QStringLiteral("</body>\n</html>\n");
+}
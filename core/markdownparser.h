@@ -0,0 +1,40 @@
+#ifndef MARKDOWNPARSER_H
+#define MARKDOWNPARSER_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// 顶层块：源码片段（不含结尾换行）及其在文档中的起始行
+struct MarkdownSourceBlock
+{
+    QString source;
+    int startLine = 0;
+    int lineCount = 0;
+};
+
+// 轻量 Markdown 解析与 HTML 渲染，不依赖 GUI，可在工作线程中使用。
+// 文档先切分为互不依赖的顶层块，每块可单独渲染与缓存。
+class MarkdownParser
+{
+public:
+    enum BlockKind { Paragraph, Heading, SetextHeading, ThematicBreak, FencedCode, IndentedCode,
+                     BlockQuote, List, Table, Html, Blank };
+
+    static QVector<MarkdownSourceBlock> splitBlocks(QStringView text);
+    static BlockKind classify(QStringView source);
+
+    // 单个顶层块的 HTML
+    static QString renderBlock(QStringView source);
+    // 整个文档（或容器块内部）的 HTML 片段
+    static QString renderBlocks(QStringView text);
+    static QString renderInline(QStringView text);
+
+    // 完整的 HTML 文档
+    static QString toHtml(const QString& text, const QString& title = QString());
+    // 完整文档的开头与结尾，流式导出时在其间逐块写出 renderBlock 的结果
+    static QString htmlHeader(const QString& title);
+    static QString htmlFooter();
+};
+
+#endif // MARKDOWNPARSER_H
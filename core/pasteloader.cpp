@@ -0,0 +1,173 @@
+#include "pasteloader.h"
+#include "filereloader.h"
+#include "textscan.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <cstring>
+#include <utility>
+
+namespace {
+    // 每块的字符数：GUI 线程插入一块（含增量高亮与布局）应在一帧左右完成
+    const qsizetype ChunkChars = 256 * 1024;
+    // 同时在途（已切好但尚未插入文档）的文本块上限
+    const int MaxChunksInFlight = 4;
+    // 判断二进制文件时检查的开头字节数
+    const qint64 BinaryProbeBytes = 8192;
+
+    // 开头含有零字节的文件视为二进制文件；UTF-16 文本本身含有大量零字节，不在此列
+    bool isBinaryFile(const QString& filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;   // 打不开的文件由 readText 报告错误
+        const QByteArray head = file.read(BinaryProbeBytes);
+        int bomLength = 0;
+        if (!TextFormat::detect(head.constData(), head.size(), &bomLength).isByteOriented())
+            return false;
+        return std::memchr(head.constData(), 0, size_t(head.size())) != nullptr;
+    }
+}
+
+PasteLoader::PasteLoader(const QString& text, QObject* parent)
+    : QObject(parent)
+    , m_text(text)
+    , m_total(text.size())
+    , m_lineCount(0)
+    , m_inserted(false)
+    , m_thread(nullptr)
+    , m_chunkSlots(MaxChunksInFlight)
+    , m_cancelled(false)
+{
+}
+
+PasteLoader::PasteLoader(const QStringList& filePaths, QObject* parent)
+    : QObject(parent)
+    , m_filePaths(filePaths)
+    , m_total(0)
+    , m_lineCount(0)
+    , m_inserted(false)
+    , m_thread(nullptr)
+    , m_chunkSlots(MaxChunksInFlight)
+    , m_cancelled(false)
+{
+    for (const QString& filePath : filePaths)
+        m_total += QFileInfo(filePath).size();
+}
+
+PasteLoader::~PasteLoader()
+{
+    cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void PasteLoader::start()
+{
+    if (m_thread)
+        return;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void PasteLoader::cancel()
+{
+    m_cancelled = true;
+}
+
+void PasteLoader::chunkConsumed()
+{
+    m_chunkSlots.release();
+}
+
+bool PasteLoader::acquireChunkSlot()
+{
+    // 等待 GUI 线程消费，避免整段文本以文本块形式堆积在事件队列中
+    while (!m_chunkSlots.tryAcquire(1, 50))
+    {
+        if (m_cancelled)
+            return false;
+    }
+    return !m_cancelled;
+}
+
+void PasteLoader::run()
+{
+    if (m_filePaths.isEmpty())
+    {
+        // 剪贴板中的 CRLF 与单独的 CR 统一为 LF
+        QString text = m_text;
+        m_text.clear();
+        TextScanner scanner(false);
+        scanner.processText(text);
+        if (!emitChunks(text, 0, m_total))
+            return;
+    }
+    else
+    {
+        qint64 done = 0;
+        for (const QString& filePath : std::as_const(m_filePaths))
+        {
+            const qint64 size = QFileInfo(filePath).size();
+            if (isBinaryFile(filePath))
+            {
+                m_skippedFiles.append(filePath);
+                done += size;
+                continue;
+            }
+
+            QString text;
+            QString error;
+            if (!FileReloader::readText(filePath, &text, nullptr, &error))
+            {
+                emit failed(error);
+                return;
+            }
+            if (m_cancelled || !emitChunks(text, done, size))
+                return;
+            done += size;
+        }
+    }
+
+    if (m_cancelled)
+        return;
+
+    // 最后一行没有换行符
+    if (m_inserted)
+        ++m_lineCount;
+    emit finished();
+}
+
+bool PasteLoader::emitChunks(const QString& text, qint64 done, qint64 weight)
+{
+    // 尽量在换行之后切分，使每块都是完整的行；单行超过一块时避免拆开代理对
+    qsizetype from = 0;
+    while (from < text.size())
+    {
+        qsizetype to = qMin(text.size(), from + ChunkChars);
+        if (to < text.size())
+        {
+            // 只在本块之内查找，超长的单行不会每块都回扫到文本开头
+            const qsizetype lineEnd = QStringView(text).mid(from, to - from).lastIndexOf(u'\n');
+            if (lineEnd >= 0)
+                to = from + lineEnd + 1;
+            else if (text.at(to - 1).isHighSurrogate())
+                --to;
+        }
+
+        if (!acquireChunkSlot())
+            return false;
+
+        const QString chunk = text.mid(from, to - from);
+        m_lineCount += chunk.count(QLatin1Char('\n'));
+        m_inserted = true;
+        emit chunkReady(chunk);
+        from = to;
+        emit progress(done + weight * from / text.size(), m_total);
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef PASTELOADER_H
+#define PASTELOADER_H
+
+#include <QObject>
+#include <QSemaphore>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+
+class QThread;
+
+// 大段粘贴与拖放文件的准备：工作线程负责读取与解码文件、规范换行，并在行边界处切成文本块，
+// 开头含有零字节的二进制文件跳过不插入；
+// GUI 线程每轮事件循环只插入一块，插入期间界面保持响应。在途的文本块数量有上限
+class PasteLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 剪贴板文本（QString 隐式共享，不会复制）
+    explicit PasteLoader(const QString& text, QObject* parent = nullptr);
+    // 拖放的文件，按顺序读取、解码并依次插入
+    explicit PasteLoader(const QStringList& filePaths, QObject* parent = nullptr);
+    ~PasteLoader();
+
+    void start();
+    void cancel();
+
+    // GUI 线程插入完一个文本块后调用，释放一个在途名额
+    void chunkConsumed();
+
+    bool isCancelled() const { return m_cancelled.load(); }
+    // 在 finished() 之后有效；没有插入任何文本时为 0
+    qint64 lineCount() const { return m_lineCount; }
+    // 作为二进制文件跳过的文件，在 finished() 之后有效
+    QStringList skippedFiles() const { return m_skippedFiles; }
+
+signals:
+    void chunkReady(const QString& text);
+    // 文本以字符计，文件以字节计
+    void progress(qint64 done, qint64 total);
+    void finished();
+    void failed(const QString& error);
+
+private:
+    void run();
+    bool emitChunks(const QString& text, qint64 done, qint64 weight);
+    bool acquireChunkSlot();
+
+    QString m_text;
+    QStringList m_filePaths;
+    QStringList m_skippedFiles;
+    qint64 m_total;
+    qint64 m_lineCount;
+    bool m_inserted;
+    QThread* m_thread;
+    QSemaphore m_chunkSlots;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // PASTELOADER_H
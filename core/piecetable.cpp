@@ -0,0 +1,490 @@
+#include "piecetable.h"
+#include <QFile>
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // 保存时每次写入的最大字节数
+    const qint64 WriteChunkSize = 4 * 1024 * 1024;
+
+    qint64 countNewlinesIn(const char* data, qint64 length)
+    {
+        return std::count(data, data + length, '\n');
+    }
+}
+
+// ============ MappedFile 实现 ============
+MappedFile::MappedFile()
+    : m_file(nullptr)
+    , m_data(nullptr)
+    , m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_file)
+    {
+        if (m_data)
+            m_file->unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        delete m_file;
+    }
+}
+
+bool MappedFile::open(const QString& filePath, QString* errorString)
+{
+    m_file = new QFile(filePath);
+    if (!m_file->open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+            *errorString = m_file->errorString();
+        return false;
+    }
+
+    m_size = m_file->size();
+    if (m_size == 0)
+        return true;
+
+    uchar* data = m_file->map(0, m_size);
+    if (!data)
+    {
+        if (errorString)
+            *errorString = m_file->errorString();
+        return false;
+    }
+
+    m_data = reinterpret_cast<const char*>(data);
+    return true;
+}
+
+// ============ SparseLineIndex 实现 ============
+SparseLineIndex SparseLineIndex::build(const char* data, qint64 size, const std::atomic<bool>* cancel)
+{
+    SparseLineIndex index;
+    index.m_checkpoints.push_back(0);
+
+    qint64 newlines = 0;
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end)
+    {
+        if (cancel && (newlines % Stride) == 0 && cancel->load())
+            return SparseLineIndex();
+
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl)
+            break;
+
+        ++newlines;
+        if (newlines % Stride == 0)
+            index.m_checkpoints.push_back(nl + 1 - data);
+        p = nl + 1;
+    }
+
+    index.m_newlineCount = newlines;
+    return index;
+}
+
+qint64 SparseLineIndex::newlinesBefore(const char* data, qint64 offset) const
+{
+    auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), offset);
+    qint64 k = (it - m_checkpoints.begin()) - 1;
+    qint64 checkpoint = m_checkpoints[k];
+    return k * Stride + countNewlinesIn(data + checkpoint, offset - checkpoint);
+}
+
+qint64 SparseLineIndex::lineStart(const char* data, qint64 size, qint64 line) const
+{
+    if (line <= 0)
+        return 0;
+    if (line > m_newlineCount)
+        return -1;
+
+    qint64 k = line / Stride;
+    qint64 pos = m_checkpoints[k];
+    for (qint64 remaining = line - k * Stride; remaining > 0; --remaining)
+    {
+        const char* nl = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        pos = nl - data + 1;
+    }
+    return pos;
+}
+
+// ============ PieceTable 实现 ============
+PieceTable::PieceTable()
+    : m_size(0)
+    , m_revision(0)
+    , m_modified(false)
+{
+}
+
+bool PieceTable::open(const QString& filePath, QString* errorString)
+{
+    auto mapped = std::make_shared<MappedFile>();
+    if (!mapped->open(filePath, errorString))
+        return false;
+
+    clear();
+    m_original = mapped;
+    m_size = mapped->size();
+    if (m_size > 0)
+        m_pieces.push_back({ Original, 0, m_size, -1 });
+    return true;
+}
+
+void PieceTable::clear()
+{
+    m_original.reset();
+    m_added.clear();
+    m_pieces.clear();
+    m_lineIndex = SparseLineIndex();
+    m_size = 0;
+    ++m_revision;
+    m_modified = false;
+}
+
+const char* PieceTable::pieceData(const Piece& piece) const
+{
+    if (piece.source == Original)
+        return m_original->data() + piece.start;
+    return m_added.constData() + piece.start;
+}
+
+qint64 PieceTable::countNewlines(const Piece& piece, qint64 offset, qint64 length) const
+{
+    if (piece.source == Added)
+        return countNewlinesIn(pieceData(piece) + offset, length);
+
+    if (!m_lineIndex.isValid())
+        return -1;
+
+    const char* data = m_original->data();
+    qint64 begin = piece.start + offset;
+    return m_lineIndex.newlinesBefore(data, begin + length) - m_lineIndex.newlinesBefore(data, begin);
+}
+
+size_t PieceTable::findPiece(qint64 pos, qint64* pieceStart) const
+{
+    qint64 start = 0;
+    for (size_t i = 0; i < m_pieces.size(); ++i)
+    {
+        if (pos < start + m_pieces[i].length)
+        {
+            *pieceStart = start;
+            return i;
+        }
+        start += m_pieces[i].length;
+    }
+
+    *pieceStart = start;
+    return m_pieces.size();
+}
+
+void PieceTable::insert(qint64 pos, const QByteArray& text)
+{
+    if (text.isEmpty())
+        return;
+
+    pos = qBound<qint64>(0, pos, m_size);
+    const qint64 addStart = m_added.size();
+    m_added.append(text);
+
+    Piece piece = { Added, addStart, text.size(), countNewlinesIn(text.constData(), text.size()) };
+
+    qint64 pieceStart = 0;
+    size_t i = findPiece(pos, &pieceStart);
+
+    if (pos == pieceStart)
+    {
+        // 连续输入：紧跟在上一个追加片段之后时直接扩展，避免片段数随按键增长
+        if (i > 0)
+        {
+            Piece& previous = m_pieces[i - 1];
+            if (previous.source == Added && previous.start + previous.length == addStart)
+            {
+                previous.length += piece.length;
+                previous.newlines += piece.newlines;
+                m_size += piece.length;
+                ++m_revision;
+                m_modified = true;
+                return;
+            }
+        }
+        m_pieces.insert(m_pieces.begin() + i, piece);
+    }
+    else
+    {
+        const Piece target = m_pieces[i];
+        qint64 offset = pos - pieceStart;
+
+        Piece left = { target.source, target.start, offset, -1 };
+        Piece right = { target.source, target.start + offset, target.length - offset, -1 };
+        if (target.newlines >= 0)
+        {
+            left.newlines = countNewlines(target, 0, offset);
+            right.newlines = target.newlines - left.newlines;
+        }
+
+        m_pieces[i] = left;
+        m_pieces.insert(m_pieces.begin() + i + 1, { piece, right });
+    }
+
+    m_size += piece.length;
+    ++m_revision;
+    m_modified = true;
+}
+
+void PieceTable::remove(qint64 pos, qint64 length)
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    length = qMin(length, m_size - pos);
+    if (length <= 0)
+        return;
+
+    const qint64 end = pos + length;
+    qint64 pieceStart = 0;
+    const size_t first = findPiece(pos, &pieceStart);
+
+    std::vector<Piece> replacement;
+    size_t last = first;
+    qint64 cursor = pieceStart;
+    while (last < m_pieces.size() && cursor < end)
+    {
+        const Piece& piece = m_pieces[last];
+        const qint64 pieceEnd = cursor + piece.length;
+
+        // 保留片段落在删除范围之外的左右两部分
+        if (cursor < pos)
+        {
+            qint64 keep = pos - cursor;
+            qint64 newlines = piece.newlines >= 0 ? countNewlines(piece, 0, keep) : -1;
+            replacement.push_back({ piece.source, piece.start, keep, newlines });
+        }
+        if (pieceEnd > end)
+        {
+            qint64 offset = end - cursor;
+            qint64 keep = pieceEnd - end;
+            qint64 newlines = piece.newlines >= 0 ? countNewlines(piece, offset, keep) : -1;
+            replacement.push_back({ piece.source, piece.start + offset, keep, newlines });
+        }
+
+        cursor = pieceEnd;
+        ++last;
+    }
+
+    m_pieces.erase(m_pieces.begin() + first, m_pieces.begin() + last);
+    m_pieces.insert(m_pieces.begin() + first, replacement.begin(), replacement.end());
+
+    m_size -= length;
+    ++m_revision;
+    m_modified = true;
+}
+
+QByteArray PieceTable::read(qint64 pos, qint64 length) const
+{
+    QByteArray result;
+    pos = qBound<qint64>(0, pos, m_size);
+    length = qMin(length, m_size - pos);
+    if (length <= 0)
+        return result;
+
+    result.reserve(length);
+    qint64 pieceStart = 0;
+    size_t i = findPiece(pos, &pieceStart);
+    qint64 offset = pos - pieceStart;
+    while (length > 0 && i < m_pieces.size())
+    {
+        const Piece& piece = m_pieces[i];
+        qint64 n = qMin(length, piece.length - offset);
+        result.append(pieceData(piece) + offset, n);
+        length -= n;
+        offset = 0;
+        ++i;
+    }
+    return result;
+}
+
+char PieceTable::at(qint64 pos) const
+{
+    qint64 pieceStart = 0;
+    size_t i = findPiece(pos, &pieceStart);
+    if (i >= m_pieces.size())
+        return '\0';
+    return pieceData(m_pieces[i])[pos - pieceStart];
+}
+
+qint64 PieceTable::lineStartBefore(qint64 pos) const
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    qint64 pieceStart = 0;
+    size_t i = findPiece(pos, &pieceStart);
+
+    // 从 pos 向前逐片段查找换行符
+    qint64 limit = pos - pieceStart;
+    while (true)
+    {
+        if (i < m_pieces.size())
+        {
+            const char* data = pieceData(m_pieces[i]);
+            for (qint64 k = limit - 1; k >= 0; --k)
+            {
+                if (data[k] == '\n')
+                    return pieceStart + k + 1;
+            }
+        }
+        if (i == 0)
+            return 0;
+
+        --i;
+        limit = m_pieces[i].length;
+        pieceStart -= limit;
+    }
+}
+
+qint64 PieceTable::lineEnd(qint64 pos) const
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    qint64 pieceStart = 0;
+    size_t i = findPiece(pos, &pieceStart);
+    qint64 offset = pos - pieceStart;
+    for (; i < m_pieces.size(); ++i)
+    {
+        const Piece& piece = m_pieces[i];
+        const char* data = pieceData(piece);
+        const void* nl = std::memchr(data + offset, '\n', piece.length - offset);
+        if (nl)
+            return pieceStart + (static_cast<const char*>(nl) - data);
+
+        pieceStart += piece.length;
+        offset = 0;
+    }
+    return m_size;
+}
+
+qint64 PieceTable::nextLineStart(qint64 pos) const
+{
+    qint64 end = lineEnd(pos);
+    return end < m_size ? end + 1 : -1;
+}
+
+void PieceTable::setOriginalLineIndex(const SparseLineIndex& index)
+{
+    m_lineIndex = index;
+    if (!m_lineIndex.isValid())
+        return;
+
+    for (Piece& piece : m_pieces)
+    {
+        if (piece.newlines < 0)
+            piece.newlines = countNewlines(piece, 0, piece.length);
+    }
+}
+
+qint64 PieceTable::lineCount() const
+{
+    qint64 newlines = 0;
+    for (const Piece& piece : m_pieces)
+    {
+        if (piece.newlines < 0)
+            return -1;
+        newlines += piece.newlines;
+    }
+    return newlines + 1;
+}
+
+qint64 PieceTable::lineNumberAt(qint64 pos) const
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    qint64 newlines = 0;
+    qint64 start = 0;
+    for (const Piece& piece : m_pieces)
+    {
+        if (piece.newlines < 0)
+            return -1;
+
+        if (pos < start + piece.length)
+            return newlines + countNewlines(piece, 0, pos - start);
+
+        newlines += piece.newlines;
+        start += piece.length;
+    }
+    return newlines;
+}
+
+qint64 PieceTable::lineStart(qint64 line) const
+{
+    if (line <= 0)
+        return 0;
+
+    qint64 newlines = 0;
+    qint64 start = 0;
+    for (const Piece& piece : m_pieces)
+    {
+        if (piece.newlines < 0)
+            return -1;
+
+        if (newlines + piece.newlines >= line)
+        {
+            // 目标行首紧跟在本片段内第 (line - newlines) 个换行符之后
+            qint64 nth = line - newlines;
+            if (piece.source == Original)
+            {
+                const char* data = m_original->data();
+                qint64 before = m_lineIndex.newlinesBefore(data, piece.start);
+                qint64 offset = m_lineIndex.lineStart(data, m_original->size(), before + nth);
+                return start + (offset - piece.start);
+            }
+
+            const char* data = pieceData(piece);
+            qint64 offset = 0;
+            for (; nth > 0; --nth)
+            {
+                const char* nl = static_cast<const char*>(std::memchr(data + offset, '\n', piece.length - offset));
+                offset = nl - data + 1;
+            }
+            return start + offset;
+        }
+
+        newlines += piece.newlines;
+        start += piece.length;
+    }
+    return -1;
+}
+
+PieceTable::Snapshot PieceTable::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.original = m_original;
+    snapshot.added = m_added;
+    snapshot.pieces = m_pieces;
+    snapshot.size = m_size;
+    return snapshot;
+}
+
+bool PieceTable::Snapshot::writeTo(QIODevice* device, const std::atomic<bool>* cancel,
+                                   const std::function<void(qint64)>& onProgress) const
+{
+    qint64 total = 0;
+    for (const Piece& piece : pieces)
+    {
+        const char* data = piece.source == Original
+            ? original->data() + piece.start
+            : added.constData() + piece.start;
+
+        for (qint64 written = 0; written < piece.length; )
+        {
+            if (cancel && cancel->load())
+                return false;
+
+            qint64 n = qMin(WriteChunkSize, piece.length - written);
+            if (device->write(data + written, n) != n)
+                return false;
+            written += n;
+            total += n;
+            if (onProgress)
+                onProgress(total);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef PIECETABLE_H
+#define PIECETABLE_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QFile;
+class QIODevice;
+
+// 原始文件的只读内存映射，由 PieceTable 及其快照共享
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const QString& filePath, QString* errorString = nullptr);
+
+    const char* data() const { return m_data; }
+    qint64 size() const { return m_size; }
+
+private:
+    QFile* m_file;
+    const char* m_data;
+    qint64 m_size;
+};
+
+// 原始文件的稀疏行索引：每 Stride 行记录一次行首偏移，
+// 其余位置在检查点之间用 memchr 补齐，内存占用与行数无关紧要
+class SparseLineIndex
+{
+public:
+    static const qint64 Stride = 1024;
+
+    // 在工作线程中扫描整个映射；cancel 置位时提前返回空索引
+    static SparseLineIndex build(const char* data, qint64 size, const std::atomic<bool>* cancel = nullptr);
+
+    bool isValid() const { return !m_checkpoints.empty(); }
+    qint64 newlineCount() const { return m_newlineCount; }
+
+    // [0, offset) 内的换行符个数
+    qint64 newlinesBefore(const char* data, qint64 offset) const;
+    // 第 line 行（从 0 开始）的行首偏移
+    qint64 lineStart(const char* data, qint64 size, qint64 line) const;
+
+private:
+    std::vector<qint64> m_checkpoints;
+    qint64 m_newlineCount = 0;
+};
+
+// 片段表：原始文件（内存映射，只读）+ 追加缓冲区（只增不改）。
+// 所有偏移均为 UTF-8 字节偏移；内存占用只随编辑量增长。
+class PieceTable
+{
+public:
+    enum Source { Original, Added };
+
+    struct Piece
+    {
+        Source source;
+        qint64 start;
+        qint64 length;
+        qint64 newlines;  // 片段内换行符个数，原始片段在行索引就绪前为 -1
+    };
+
+    // 保存用的只读快照：共享原始映射，并持有追加缓冲区的隐式共享副本
+    struct Snapshot
+    {
+        std::shared_ptr<const MappedFile> original;
+        QByteArray added;
+        std::vector<Piece> pieces;
+        qint64 size = 0;
+
+        bool writeTo(QIODevice* device, const std::atomic<bool>* cancel = nullptr,
+                     const std::function<void(qint64)>& onProgress = nullptr) const;
+    };
+
+    PieceTable();
+
+    bool open(const QString& filePath, QString* errorString = nullptr);
+    void clear();
+
+    qint64 size() const { return m_size; }
+    bool isModified() const { return m_modified; }
+    void setModified(bool modified) { m_modified = modified; }
+    // 每次编辑递增，用于判断快照之后是否又有修改
+    quint64 revision() const { return m_revision; }
+
+    std::shared_ptr<const MappedFile> original() const { return m_original; }
+
+    void insert(qint64 pos, const QByteArray& text);
+    void remove(qint64 pos, qint64 length);
+    QByteArray read(qint64 pos, qint64 length) const;
+    char at(qint64 pos) const;
+
+    // 行边界（不依赖行索引）
+    qint64 lineStartBefore(qint64 pos) const;
+    qint64 lineEnd(qint64 pos) const;
+    qint64 nextLineStart(qint64 pos) const;
+
+    // 行号（依赖原始文件的行索引）
+    void setOriginalLineIndex(const SparseLineIndex& index);
+    bool hasLineIndex() const { return m_lineIndex.isValid() || !m_original; }
+    qint64 lineCount() const;
+    qint64 lineNumberAt(qint64 pos) const;
+    qint64 lineStart(qint64 line) const;
+
+    Snapshot snapshot() const;
+
+private:
+    const char* pieceData(const Piece& piece) const;
+    qint64 countNewlines(const Piece& piece, qint64 offset, qint64 length) const;
+    // 定位 pos 所在片段，返回片段下标与片段起始的全局偏移
+    size_t findPiece(qint64 pos, qint64* pieceStart) const;
+
+    std::shared_ptr<const MappedFile> m_original;
+    QByteArray m_added;
+    std::vector<Piece> m_pieces;
+    SparseLineIndex m_lineIndex;
+    qint64 m_size;
+    quint64 m_revision;
+    bool m_modified;
+};
+
+#endif // PIECETABLE_H
@@ -0,0 +1,147 @@
+#include "sessionstore.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUuid>
+
+namespace {
+    const char* const ManifestName = "session.json";
+    const char* const ContentsSuffix = ".md";
+    const int FormatVersion = 1;
+
+    bool writeFile(const QString& path, const QByteArray& data)
+    {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        if (file.write(data) != data.size())
+        {
+            file.cancelWriting();
+            return false;
+        }
+        return file.commit();
+    }
+}
+
+SessionStore::SessionStore(const QString& directory)
+    : m_directory(directory)
+{
+}
+
+bool SessionStore::load(Session* session) const
+{
+    QFile file(QDir(m_directory).filePath(ManifestName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    QJsonObject root = document.object();
+    if (root.value("version").toInt() != FormatVersion)
+        return false;
+
+    session->tabs.clear();
+    const QJsonArray tabs = root.value("tabs").toArray();
+    session->tabs.reserve(tabs.size());
+    for (const QJsonValue& value : tabs)
+    {
+        QJsonObject object = value.toObject();
+        SessionTab tab;
+        tab.title = object.value("title").toString();
+        tab.filePath = object.value("filePath").toString();
+        tab.largeFile = object.value("largeFile").toBool();
+        tab.anchor = object.value("anchor").toInt();
+        tab.position = object.value("position").toInt();
+        tab.verticalScroll = object.value("verticalScroll").toInt();
+        tab.horizontalScroll = object.value("horizontalScroll").toInt();
+        tab.line = qint64(object.value("line").toDouble());
+        tab.contentsFile = object.value("contentsFile").toString();
+        tab.format.encoding = TextFormat::Encoding(qBound(int(TextFormat::Utf8), object.value("encoding").toInt(), int(TextFormat::Gb18030)));
+        tab.format.hasBom = object.value("bom").toBool();
+        tab.format.lineEnding = TextFormat::LineEnding(qBound(int(TextFormat::LF), object.value("lineEnding").toInt(), int(TextFormat::CR)));
+        if (tab.title.isEmpty())
+            continue;
+        session->tabs.append(tab);
+    }
+
+    session->currentIndex = qBound(0, root.value("currentIndex").toInt(), qMax(0, int(session->tabs.size()) - 1));
+    session->untitledCount = root.value("untitledCount").toInt();
+    session->showPreview = root.value("showPreview").toBool(true);
+    return !session->tabs.isEmpty();
+}
+
+bool SessionStore::save(Session& session) const
+{
+    QDir dir(m_directory);
+    if (!dir.mkpath("."))
+        return false;
+
+    bool ok = true;
+    QSet<QString> referenced;
+    QJsonArray tabs;
+    for (SessionTab& tab : session.tabs)
+    {
+        if (tab.hasContents)
+        {
+            // 每次写出都用新文件名，写入失败时不会破坏上一次会话引用的内容
+            QString name = QUuid::createUuid().toString(QUuid::Id128) + ContentsSuffix;
+            if (writeFile(dir.filePath(name), tab.contents.toUtf8()))
+                tab.contentsFile = name;
+            else
+                ok = false;
+        }
+        if (!tab.contentsFile.isEmpty())
+            referenced.insert(tab.contentsFile);
+
+        QJsonObject object;
+        object.insert("title", tab.title);
+        object.insert("filePath", tab.filePath);
+        object.insert("largeFile", tab.largeFile);
+        object.insert("anchor", tab.anchor);
+        object.insert("position", tab.position);
+        object.insert("verticalScroll", tab.verticalScroll);
+        object.insert("horizontalScroll", tab.horizontalScroll);
+        object.insert("line", double(tab.line));
+        object.insert("contentsFile", tab.contentsFile);
+        object.insert("encoding", int(tab.format.encoding));
+        object.insert("bom", tab.format.hasBom);
+        object.insert("lineEnding", int(tab.format.lineEnding));
+        tabs.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("version", FormatVersion);
+    root.insert("currentIndex", session.currentIndex);
+    root.insert("untitledCount", session.untitledCount);
+    root.insert("showPreview", session.showPreview);
+    root.insert("tabs", tabs);
+    if (!writeFile(dir.filePath(ManifestName), QJsonDocument(root).toJson(QJsonDocument::Indented)))
+        return false;
+
+    // 清单写入成功后再清理不再引用的内容文件
+    const QStringList files = dir.entryList(QStringList() << QString("*") + ContentsSuffix, QDir::Files);
+    for (const QString& name : files)
+    {
+        if (!referenced.contains(name))
+            dir.remove(name);
+    }
+    return ok;
+}
+
+QString SessionStore::readContents(const SessionTab& tab) const
+{
+    if (tab.contentsFile.isEmpty())
+        return QString();
+
+    QFile file(QDir(m_directory).filePath(tab.contentsFile));
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromUtf8(file.readAll());
+}
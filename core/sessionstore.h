@@ -0,0 +1,51 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QString>
+#include <QVector>
+#include "textscan.h"
+
+// 会话中的一个 Tab。未保存的内容单独存放在会话目录下的文件中，
+// 启动时只读取清单，内容等到该 Tab 真正恢复时才读取
+struct SessionTab
+{
+    QString title;
+    QString filePath;
+    bool largeFile = false;
+    int anchor = 0;
+    int position = 0;
+    int verticalScroll = 0;
+    int horizontalScroll = 0;
+    qint64 line = 0;            // 大文件模式下光标所在行
+    TextFormat format;          // 编码、BOM 与换行风格，恢复后保存时按原样写回
+    QString contentsFile;       // 未保存内容所在的文件名，为空表示没有未保存内容
+    QString contents;           // 保存会话时待写出的未保存内容
+    bool hasContents = false;
+};
+
+struct Session
+{
+    QVector<SessionTab> tabs;
+    int currentIndex = 0;
+    int untitledCount = 0;
+    bool showPreview = true;
+};
+
+// 会话清单为 JSON，未保存内容为 UTF-8 文本，均通过 QSaveFile 原子写入
+class SessionStore
+{
+public:
+    explicit SessionStore(const QString& directory);
+
+    QString directory() const { return m_directory; }
+
+    bool load(Session* session) const;
+    // 写出 hasContents 的 Tab 的内容，保留其余 Tab 引用的内容文件，删除不再引用的内容文件
+    bool save(Session& session) const;
+    QString readContents(const SessionTab& tab) const;
+
+private:
+    QString m_directory;
+};
+
+#endif // SESSIONSTORE_H
@@ -0,0 +1,339 @@
+#include "spelldictionary.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QLocale>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 文件布局：Header，随后 nodeCount 个 Node 与 edgeCount 个 Edge，均为本机字节序（词典在本机编译）。
+// 每个节点的出边连续存放并按字符排序，查找时二分；0 号节点为根
+struct SpellDictionary::Node
+{
+    quint32 firstEdge;
+    quint32 edgeCount;   // 最高位表示到此为止是一个完整的词
+};
+
+struct SpellDictionary::Edge
+{
+    quint16 label;       // UTF-16 单元
+    quint16 reserved;
+    quint32 target;
+};
+
+namespace {
+    const char Magic[4] = { 'M', 'D', 'W', 'G' };
+    const quint32 FormatVersion = 1;
+    const quint32 FinalFlag = 0x80000000u;
+
+    struct Header
+    {
+        char magic[4];
+        quint32 version;
+        quint32 nodeCount;
+        quint32 edgeCount;
+    };
+
+    // 编译时的节点：出边指向节点下标
+    struct BuildNode
+    {
+        bool final = false;
+        std::vector<std::pair<char16_t, quint32>> edges;
+    };
+
+    QMutex s_registryMutex;
+    QHash<QString, std::weak_ptr<const SpellDictionary>> s_registry;
+    // 默认词典的查找与编译只做一次，所有 Tab 共用结果（包括找不到的情况）
+    QMutex s_defaultMutex;
+    bool s_defaultResolved = false;
+    std::shared_ptr<const SpellDictionary> s_default;
+
+    QStringList readWords(QFile& file)
+    {
+        QStringList words;
+        while (!file.atEnd())
+        {
+            QString word = QString::fromUtf8(file.readLine()).trimmed();
+            const int flags = int(word.indexOf(QLatin1Char('/')));
+            if (flags >= 0)
+                word.truncate(flags);
+            if (word.isEmpty() || word.startsWith(QLatin1Char('#')))
+                continue;
+            words.append(word);
+        }
+        // Hunspell .dic 的首行是词数
+        if (!words.isEmpty())
+        {
+            bool isCount = false;
+            words.first().toInt(&isCount);
+            if (isCount)
+                words.removeFirst();
+        }
+        return words;
+    }
+}
+
+// ============ SpellDictionary 实现 ============
+SpellDictionary::~SpellDictionary()
+{
+    // 映射随 m_file 关闭而解除
+}
+
+std::shared_ptr<const SpellDictionary> SpellDictionary::open(const QString& path, QString* error)
+{
+    const QString key = QFileInfo(path).absoluteFilePath();
+    QMutexLocker locker(&s_registryMutex);
+    if (std::shared_ptr<const SpellDictionary> existing = s_registry.value(key).lock())
+        return existing;
+
+    std::shared_ptr<SpellDictionary> dictionary(new SpellDictionary);
+    if (!dictionary->load(key, error))
+        return nullptr;
+    s_registry.insert(key, dictionary);
+    return dictionary;
+}
+
+bool SpellDictionary::load(const QString& path, QString* error)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    const uchar* data = size >= qint64(sizeof(Header)) ? m_file.map(0, size) : nullptr;
+    if (!data)
+    {
+        if (error)
+            *error = QStringLiteral("Not a spelling dictionary: %1").arg(path);
+        return false;
+    }
+
+    // 只校验头部与总长度；越界的边在查找时检查，打开不随词典大小变慢
+    const Header* header = reinterpret_cast<const Header*>(data);
+    const qint64 expected = qint64(sizeof(Header)) + qint64(header->nodeCount) * qint64(sizeof(Node))
+                          + qint64(header->edgeCount) * qint64(sizeof(Edge));
+    if (memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != FormatVersion
+        || header->nodeCount == 0 || expected != size)
+    {
+        if (error)
+            *error = QStringLiteral("Not a spelling dictionary: %1").arg(path);
+        return false;
+    }
+
+    m_nodeCount = header->nodeCount;
+    m_edgeCount = header->edgeCount;
+    m_nodes = reinterpret_cast<const Node*>(data + sizeof(Header));
+    m_edges = reinterpret_cast<const Edge*>(data + sizeof(Header) + sizeof(Node) * m_nodeCount);
+    return true;
+}
+
+bool SpellDictionary::contains(QStringView word) const
+{
+    if (word.isEmpty())
+        return false;
+
+    quint32 node = 0;
+    for (QChar c : word)
+    {
+        const Node& current = m_nodes[node];
+        const quint32 count = current.edgeCount & ~FinalFlag;
+        if (current.firstEdge > m_edgeCount || count > m_edgeCount - current.firstEdge)
+            return false;
+
+        const Edge* begin = m_edges + current.firstEdge;
+        const Edge* end = begin + count;
+        const Edge* edge = std::lower_bound(begin, end, c.unicode(), [](const Edge& e, char16_t label) {
+            return e.label < label;
+        });
+        if (edge == end || edge->label != c.unicode() || edge->target >= m_nodeCount)
+            return false;
+        node = edge->target;
+    }
+    return m_nodes[node].edgeCount & FinalFlag;
+}
+
+bool SpellDictionary::compile(const QString& wordListPath, const QString& outputPath, QString* error)
+{
+    QFile input(wordListPath);
+    if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (error)
+            *error = input.errorString();
+        return false;
+    }
+
+    // 按 UTF-16 单元排序，保证每个节点的出边按字符递增追加
+    QStringList words = readWords(input);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // 增量构造最小化 DAWG（Daciuk 等的有序输入算法）：与前一个词的公共前缀之后的节点不会再变化，
+    // 立即与已登记的等价节点（是否为词尾、出边完全相同）合并
+    std::vector<BuildNode> nodes(1);
+    std::unordered_map<std::string, quint32> registry;
+    std::vector<quint32> path(1, 0);
+
+    auto signature = [&nodes](quint32 id) {
+        const BuildNode& node = nodes[id];
+        std::string key(1, node.final ? '1' : '0');
+        for (const auto& edge : node.edges)
+        {
+            key.append(reinterpret_cast<const char*>(&edge.first), sizeof(edge.first));
+            key.append(reinterpret_cast<const char*>(&edge.second), sizeof(edge.second));
+        }
+        return key;
+    };
+    auto minimize = [&](size_t depth) {
+        for (size_t k = path.size() - 1; k > depth; --k)
+        {
+            const quint32 child = path[k];
+            const auto inserted = registry.emplace(signature(child), child);
+            if (!inserted.second)
+                nodes[path[k - 1]].edges.back().second = inserted.first->second;
+        }
+        path.resize(depth + 1);
+    };
+
+    QString previous;
+    for (const QString& word : std::as_const(words))
+    {
+        size_t common = 0;
+        while (common < size_t(word.size()) && common < size_t(previous.size()) && word.at(common) == previous.at(common))
+            ++common;
+        minimize(common);
+
+        for (size_t k = common; k < size_t(word.size()); ++k)
+        {
+            const quint32 id = quint32(nodes.size());
+            nodes.emplace_back();
+            nodes[path.back()].edges.emplace_back(word.at(k).unicode(), id);
+            path.push_back(id);
+        }
+        nodes[path.back()].final = true;
+        previous = word;
+    }
+    minimize(0);
+
+    // 被合并掉的节点不再可达，按广度优先重新编号，只写出可达的节点
+    std::vector<qint64> newId(nodes.size(), -1);
+    std::vector<quint32> order(1, 0);
+    newId[0] = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        for (const auto& edge : nodes[order[i]].edges)
+        {
+            if (newId[edge.second] < 0)
+            {
+                newId[edge.second] = qint64(order.size());
+                order.push_back(edge.second);
+            }
+        }
+    }
+
+    std::vector<Node> packedNodes;
+    std::vector<Edge> packedEdges;
+    packedNodes.reserve(order.size());
+    for (quint32 id : order)
+    {
+        const BuildNode& node = nodes[id];
+        packedNodes.push_back({ quint32(packedEdges.size()), quint32(node.edges.size()) | (node.final ? FinalFlag : 0) });
+        for (const auto& edge : node.edges)
+            packedEdges.push_back({ quint16(edge.first), 0, quint32(newId[edge.second]) });
+    }
+
+    Header header;
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.nodeCount = quint32(packedNodes.size());
+    header.edgeCount = quint32(packedEdges.size());
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly))
+    {
+        if (error)
+            *error = output.errorString();
+        return false;
+    }
+    const qint64 nodeBytes = qint64(packedNodes.size() * sizeof(Node));
+    const qint64 edgeBytes = qint64(packedEdges.size() * sizeof(Edge));
+    if (output.write(reinterpret_cast<const char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || output.write(reinterpret_cast<const char*>(packedNodes.data()), nodeBytes) != nodeBytes
+        || output.write(reinterpret_cast<const char*>(packedEdges.data()), edgeBytes) != edgeBytes)
+    {
+        if (error)
+            *error = output.errorString();
+        output.cancelWriting();
+        return false;
+    }
+    if (!output.commit())
+    {
+        if (error)
+            *error = output.errorString();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const SpellDictionary> SpellDictionary::defaultDictionary()
+{
+    QMutexLocker locker(&s_defaultMutex);
+    if (s_defaultResolved)
+        return s_default;
+    s_defaultResolved = true;
+
+    const QString language = QLocale::system().name();
+    QStringList names = { language, language.left(2), QStringLiteral("en_US"), QStringLiteral("en") };
+    names.removeDuplicates();
+
+    const QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                                 + QStringLiteral("/dictionaries");
+    const QStringList directories = {
+        cacheDirectory,
+        QCoreApplication::applicationDirPath() + QStringLiteral("/dictionaries"),
+    };
+
+    for (const QString& name : std::as_const(names))
+    {
+        // 已编译的词典：直接映射
+        for (const QString& directory : directories)
+        {
+            const QString path = directory + QLatin1Char('/') + name + QStringLiteral(".dawg");
+            if (QFileInfo::exists(path) && (s_default = open(path)))
+                return s_default;
+        }
+        // 只有词表：编译一次，之后的启动直接映射编译结果
+        for (const QString& directory : directories)
+        {
+            const QString source = directory + QLatin1Char('/') + name + QStringLiteral(".txt");
+            const QString target = cacheDirectory + QLatin1Char('/') + name + QStringLiteral(".dawg");
+            if (QFileInfo::exists(source) && QDir().mkpath(cacheDirectory) && compile(source, target)
+                && (s_default = open(target)))
+                return s_default;
+        }
+    }
+
+#if defined(Q_OS_UNIX)
+    // 系统自带的英文词表
+    const QString systemWords = QStringLiteral("/usr/share/dict/words");
+    const QString target = cacheDirectory + QStringLiteral("/words.dawg");
+    if (QFileInfo::exists(target) && QFileInfo(target).lastModified() >= QFileInfo(systemWords).lastModified()
+        && (s_default = open(target)))
+        return s_default;
+    if (QFileInfo::exists(systemWords) && QDir().mkpath(cacheDirectory) && compile(systemWords, target))
+        s_default = open(target);
+#endif
+    return s_default;
+}
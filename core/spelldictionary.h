@@ -0,0 +1,42 @@
+#ifndef SPELLDICTIONARY_H
+#define SPELLDICTIONARY_H
+
+#include <QFile>
+#include <QString>
+#include <QStringView>
+#include <memory>
+
+// 拼写词典。词表预先编译为 DAWG（共享前缀与后缀的最小化字典树）的二进制文件，
+// 打开时只做内存映射，不解析、不分配，启动开销与词典大小无关；
+// 同一文件在进程内只映射一次，由所有 Tab 的检查线程共享（映射只读，可跨线程并发查询）
+class SpellDictionary
+{
+public:
+    ~SpellDictionary();
+
+    // 打开编译好的词典文件；同一路径已打开时返回同一个实例
+    static std::shared_ptr<const SpellDictionary> open(const QString& path, QString* error = nullptr);
+    // 把每行一个词的 UTF-8 词表编译为词典文件。忽略空行、# 开头的注释与 Hunspell 式的 /标记
+    static bool compile(const QString& wordListPath, const QString& outputPath, QString* error = nullptr);
+    // 按系统语言查找词典：优先使用已编译的 <语言>.dawg；只有词表（<语言>.txt、/usr/share/dict/words）
+    // 时先编译到应用数据目录。编译可能耗时，应在工作线程中调用。找不到时返回空指针
+    static std::shared_ptr<const SpellDictionary> defaultDictionary();
+
+    // 精确查找（区分大小写），开销与词长成正比
+    bool contains(QStringView word) const;
+
+private:
+    struct Node;
+    struct Edge;
+
+    SpellDictionary() = default;
+    bool load(const QString& path, QString* error);
+
+    QFile m_file;
+    const Node* m_nodes = nullptr;
+    const Edge* m_edges = nullptr;
+    quint32 m_nodeCount = 0;
+    quint32 m_edgeCount = 0;
+};
+
+#endif // SPELLDICTIONARY_H
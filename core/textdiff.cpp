@@ -0,0 +1,141 @@
+#include "textdiff.h"
+#include <QHash>
+#include <vector>
+
+namespace {
+    // 中间部分的编辑距离上限（按行计）；回溯路径的内存与其平方成正比
+    const int MaxEditDistance = 2000;
+}
+
+QVector<TextDiff::Line> TextDiff::splitLines(const QString& text)
+{
+    // 每行包含结尾的换行符；最后一行可能没有换行（也可能为空）
+    QVector<Line> lines;
+    const QChar* data = text.constData();
+    int start = 0;
+    for (int i = 0; i < text.size(); ++i)
+    {
+        if (data[i] == QLatin1Char('\n'))
+        {
+            lines.append({ start, i + 1 - start, qHash(QStringView(data + start, i + 1 - start)) });
+            start = i + 1;
+        }
+    }
+    lines.append({ start, int(text.size()) - start, qHash(QStringView(data + start, text.size() - start)) });
+    return lines;
+}
+
+QVector<TextDiff::Edit> TextDiff::compute(const QString& before, const QString& after, const std::atomic<bool>* cancelled)
+{
+    QVector<Edit> edits;
+    if (before == after)
+        return edits;
+
+    const QVector<Line> a = splitLines(before);
+    const QVector<Line> b = splitLines(after);
+    auto same = [&](int i, int j) {
+        return a[i].hash == b[j].hash
+               && QStringView(before).mid(a[i].start, a[i].length) == QStringView(after).mid(b[j].start, b[j].length);
+    };
+
+    // 去掉相同的首尾行
+    int prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && same(prefix, prefix))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix
+           && same(a.size() - 1 - suffix, b.size() - 1 - suffix))
+        ++suffix;
+
+    const int n = int(a.size()) - prefix - suffix;
+    const int m = int(b.size()) - prefix - suffix;
+
+    // 把行区间 [a0, a1) -> [b0, b1) 转成字符区段
+    auto addHunk = [&](int a0, int a1, int b0, int b1) {
+        const int position = a0 < a.size() ? a[a0].start : int(before.size());
+        const int end = a1 < a.size() ? a[a1].start : int(before.size());
+        const int newPosition = b0 < b.size() ? b[b0].start : int(after.size());
+        const int newEnd = b1 < b.size() ? b[b1].start : int(after.size());
+        edits.append({ position, end - position, newPosition, newEnd - newPosition });
+    };
+
+    // Myers 差分：v[k] 是第 d 步在对角线 k 上能到达的最远 x，每步的 v 保存下来用于回溯
+    const int max = qMin(n + m, MaxEditDistance);
+    const int offset = max + 1;
+    std::vector<int> v(size_t(2 * offset + 1), 0);
+    std::vector<std::vector<int>> trace;
+    int found = -1;
+    for (int d = 0; d <= max && found < 0; ++d)
+    {
+        if (cancelled && cancelled->load())
+            return QVector<Edit>();
+
+        trace.push_back(v);
+        for (int k = -d; k <= d; k += 2)
+        {
+            int x;
+            if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                x = v[offset + k + 1];
+            else
+                x = v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && same(prefix + x, prefix + y))
+            {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m)
+            {
+                found = d;
+                break;
+            }
+        }
+    }
+
+    if (found < 0)
+    {
+        // 差异过大，中间部分整体替换
+        addHunk(prefix, prefix + n, prefix, prefix + m);
+        return edits;
+    }
+
+    // 回溯得到对角线片段（相同行），两段相同行之间的部分即为一个替换区段
+    struct Snake { int x, y, length; };
+    std::vector<Snake> snakes;
+    int x = n;
+    int y = m;
+    for (int d = found; d > 0; --d)
+    {
+        const std::vector<int>& pv = trace[size_t(d)];
+        const int k = x - y;
+        int prevK;
+        if (k == -d || (k != d && pv[offset + k - 1] < pv[offset + k + 1]))
+            prevK = k + 1;
+        else
+            prevK = k - 1;
+        const int prevX = pv[offset + prevK];
+        const int prevY = prevX - prevK;
+        const int startX = prevK == k + 1 ? prevX : prevX + 1;
+        const int startY = startX - k;
+        if (x > startX)
+            snakes.push_back({ startX, startY, x - startX });
+        x = prevX;
+        y = prevY;
+    }
+    if (x > 0)
+        snakes.push_back({ 0, 0, x });
+
+    int lastX = 0;
+    int lastY = 0;
+    for (auto it = snakes.rbegin(); it != snakes.rend(); ++it)
+    {
+        if (it->x > lastX || it->y > lastY)
+            addHunk(prefix + lastX, prefix + it->x, prefix + lastY, prefix + it->y);
+        lastX = it->x + it->length;
+        lastY = it->y + it->length;
+    }
+    if (n > lastX || m > lastY)
+        addHunk(prefix + lastX, prefix + n, prefix + lastY, prefix + m);
+    return edits;
+}
@@ -0,0 +1,37 @@
+#ifndef TEXTDIFF_H
+#define TEXTDIFF_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// 按行比较两段文本，得到把 before 变成 after 所需的最少替换区段。
+// 先去掉首尾相同的行，中间部分用 Myers 差分；编辑距离超过上限时把中间部分整体视为一次替换
+class TextDiff
+{
+public:
+    // before 中 [position, position + length) 替换为 after 中 [newPosition, newPosition + newLength)
+    struct Edit
+    {
+        int position;
+        int length;
+        int newPosition;
+        int newLength;
+    };
+
+    // 返回的区段按位置升序且互不重叠；cancelled 置位时提前返回空结果
+    static QVector<Edit> compute(const QString& before, const QString& after,
+                                 const std::atomic<bool>* cancelled = nullptr);
+
+private:
+    struct Line
+    {
+        int start;
+        int length;
+        size_t hash;
+    };
+
+    static QVector<Line> splitLines(const QString& text);
+};
+
+#endif // TEXTDIFF_H
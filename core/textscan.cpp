@@ -0,0 +1,364 @@
+#include "textscan.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTSCAN_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TEXTSCAN_NEON
+#endif
+
+namespace {
+    const int BlockSize = 16;
+
+    // 检查一组 16 字节：不含 CR（allowHigh 为 false 时还要求全部为 ASCII）时返回 true，并给出其中 LF 的个数
+    inline bool scanBlock(const char* p, bool allowHigh, int* lineFeeds)
+    {
+#if defined(TEXTSCAN_SSE2)
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int cr = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        const int high = allowHigh ? 0 : _mm_movemask_epi8(v);
+        if (cr | high)
+            return false;
+        *lineFeeds = qPopulationCount(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))));
+        return true;
+#elif defined(TEXTSCAN_NEON)
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        if (vmaxvq_u8(vceqq_u8(v, vdupq_n_u8('\r'))) != 0)
+            return false;
+        if (!allowHigh && vmaxvq_u8(v) >= 0x80)
+            return false;
+        *lineFeeds = vaddvq_u8(vshrq_n_u8(vceqq_u8(v, vdupq_n_u8('\n')), 7));
+        return true;
+#else
+        int count = 0;
+        for (int i = 0; i < BlockSize; ++i)
+        {
+            const uchar c = uchar(p[i]);
+            if (c == '\r' || (!allowHigh && c >= 0x80))
+                return false;
+            count += (c == '\n');
+        }
+        *lineFeeds = count;
+        return true;
+#endif
+    }
+}
+
+// ============ TextFormat 实现 ============
+QString TextFormat::encodingName() const
+{
+    switch (encoding)
+    {
+    case Utf16LE: return QStringLiteral("UTF-16 LE");
+    case Utf16BE: return QStringLiteral("UTF-16 BE");
+    case Gb18030: return QStringLiteral("GB18030");
+    case Utf8: break;
+    }
+    return QStringLiteral("UTF-8");
+}
+
+QString TextFormat::lineEndingName() const
+{
+    switch (lineEnding)
+    {
+    case CRLF: return QStringLiteral("CRLF");
+    case CR: return QStringLiteral("CR");
+    case LF: break;
+    }
+    return QStringLiteral("LF");
+}
+
+QStringDecoder TextFormat::createDecoder() const
+{
+    switch (encoding)
+    {
+    case Utf16LE:
+        return QStringDecoder(QStringConverter::Utf16LE);
+    case Utf16BE:
+        return QStringDecoder(QStringConverter::Utf16BE);
+    case Gb18030:
+    {
+        // GB18030 依赖 ICU 等系统支持，不可用时退回系统本地编码（中文 Windows 上即 GBK）
+        QStringDecoder decoder("GB18030");
+        if (decoder.isValid())
+            return decoder;
+        return QStringDecoder(QStringConverter::System);
+    }
+    case Utf8:
+        break;
+    }
+    return QStringDecoder(QStringConverter::Utf8);
+}
+
+QStringEncoder TextFormat::createEncoder() const
+{
+    const QStringConverter::Flags flags = hasBom ? QStringConverter::Flag::WriteBom : QStringConverter::Flag::Default;
+    switch (encoding)
+    {
+    case Utf16LE:
+        return QStringEncoder(QStringConverter::Utf16LE, flags);
+    case Utf16BE:
+        return QStringEncoder(QStringConverter::Utf16BE, flags);
+    case Gb18030:
+    {
+        QStringEncoder encoder("GB18030", flags);
+        if (encoder.isValid())
+            return encoder;
+        return QStringEncoder(QStringConverter::System, flags);
+    }
+    case Utf8:
+        break;
+    }
+    return QStringEncoder(QStringConverter::Utf8, flags);
+}
+
+TextFormat TextFormat::detect(const char* data, qint64 size, int* bomLength)
+{
+    TextFormat format;
+    *bomLength = 0;
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+
+    if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+    {
+        format.hasBom = true;
+        *bomLength = 3;
+        return format;
+    }
+    if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE)
+    {
+        format.encoding = Utf16LE;
+        format.hasBom = true;
+        *bomLength = 2;
+        return format;
+    }
+    if (size >= 2 && bytes[0] == 0xFE && bytes[1] == 0xFF)
+    {
+        format.encoding = Utf16BE;
+        format.hasBom = true;
+        *bomLength = 2;
+        return format;
+    }
+
+    // 无 BOM 的 UTF-16：以 ASCII 为主的文本中零字节集中在奇数或偶数位置
+    const qint64 sample = qMin<qint64>(size, 4096) & ~qint64(1);
+    qint64 evenZeros = 0;
+    qint64 oddZeros = 0;
+    for (qint64 i = 0; i < sample; i += 2)
+    {
+        evenZeros += (bytes[i] == 0);
+        oddZeros += (bytes[i + 1] == 0);
+    }
+    if (sample > 0 && oddZeros > sample / 4 && evenZeros == 0)
+    {
+        format.encoding = Utf16LE;
+        return format;
+    }
+    if (sample > 0 && evenZeros > sample / 4 && oddZeros == 0)
+    {
+        format.encoding = Utf16BE;
+        return format;
+    }
+
+    // 能通过 UTF-8 校验的按 UTF-8 处理，否则按 GB18030（兼容 GBK / GB2312）
+    if (!TextScanner::isValidUtf8(data, size))
+        format.encoding = Gb18030;
+    return format;
+}
+
+// ============ TextScanner 实现 ============
+TextScanner::TextScanner(bool validateUtf8)
+    : m_validateUtf8(validateUtf8)
+    , m_afterCr(false)
+    , m_need(0)
+    , m_lower(0x80)
+    , m_upper(0xBF)
+    , m_lineFeeds(0)
+    , m_crlf(0)
+    , m_loneCr(0)
+    , m_invalid(0)
+{
+}
+
+bool TextScanner::isValidUtf8(const char* data, qint64 size)
+{
+    TextScanner scanner;
+    qint64 i = 0;
+    while (i < size)
+    {
+        int lineFeeds = 0;
+        if (i + BlockSize <= size && scanner.m_need == 0 && scanBlock(data + i, false, &lineFeeds))
+        {
+            i += BlockSize;
+            continue;
+        }
+
+        const qint64 end = qMin<qint64>(i + BlockSize, size);
+        for (; i < end; ++i)
+        {
+            const uchar c = uchar(data[i]);
+            if (c >= 0x80 || scanner.m_need > 0)
+                scanner.validateByte(c);
+        }
+        if (scanner.m_invalid > 0)
+            return false;
+    }
+    // 样本末尾被截断的序列不算错误
+    return true;
+}
+
+qint64 TextScanner::processBytes(char* data, qint64 size)
+{
+    qint64 out = 0;
+    qint64 i = 0;
+    while (i < size)
+    {
+        // 快速路径：整组为 ASCII（GB18030 时允许高位字节）且不含 CR，只需计数 LF 并搬移
+        int lineFeeds = 0;
+        if (i + BlockSize <= size && m_need == 0 && !m_afterCr && scanBlock(data + i, !m_validateUtf8, &lineFeeds))
+        {
+            if (out != i)
+                std::memmove(data + out, data + i, BlockSize);
+            m_lineFeeds += lineFeeds;
+            out += BlockSize;
+            i += BlockSize;
+            continue;
+        }
+
+        // 慢速路径：逐字节处理这一组（或剩余的尾部）
+        const qint64 end = qMin<qint64>(i + BlockSize, size);
+        for (; i < end; ++i)
+        {
+            const uchar c = uchar(data[i]);
+            if (c == '\r')
+            {
+                // 先按单独的 CR 输出为 LF，若紧跟 LF 再改记为 CRLF
+                if (m_validateUtf8 && m_need > 0)
+                    validateByte(c);
+                data[out++] = '\n';
+                ++m_loneCr;
+                m_afterCr = true;
+                continue;
+            }
+            if (c == '\n')
+            {
+                if (m_afterCr)
+                {
+                    --m_loneCr;
+                    ++m_crlf;
+                    m_afterCr = false;
+                    continue;
+                }
+                ++m_lineFeeds;
+            }
+            m_afterCr = false;
+
+            if (m_validateUtf8 && (c >= 0x80 || m_need > 0))
+                validateByte(c);
+            data[out++] = char(c);
+        }
+    }
+    return out;
+}
+
+void TextScanner::processText(QString& text)
+{
+    QChar* data = text.data();
+    const qsizetype size = text.size();
+    qsizetype out = 0;
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        const QChar c = data[i];
+        if (c == QLatin1Char('\r'))
+        {
+            data[out++] = QLatin1Char('\n');
+            ++m_loneCr;
+            m_afterCr = true;
+            continue;
+        }
+        if (c == QLatin1Char('\n'))
+        {
+            if (m_afterCr)
+            {
+                --m_loneCr;
+                ++m_crlf;
+                m_afterCr = false;
+                continue;
+            }
+            ++m_lineFeeds;
+        }
+        m_afterCr = false;
+        data[out++] = c;
+    }
+    text.truncate(out);
+}
+
+TextFormat::LineEnding TextScanner::dominantLineEnding() const
+{
+    if (m_crlf > 0 && m_crlf >= m_lineFeeds && m_crlf >= m_loneCr)
+        return TextFormat::CRLF;
+    if (m_loneCr > m_lineFeeds)
+        return TextFormat::CR;
+    return TextFormat::LF;
+}
+
+void TextScanner::validateByte(uchar byte)
+{
+    if (m_need > 0)
+    {
+        if (byte >= m_lower && byte <= m_upper)
+        {
+            --m_need;
+            m_lower = 0x80;
+            m_upper = 0xBF;
+            return;
+        }
+        // 序列被截断：记一处错误，当前字节重新作为首字节判断
+        ++m_invalid;
+        m_need = 0;
+        m_lower = 0x80;
+        m_upper = 0xBF;
+    }
+
+    if (byte < 0x80)
+        return;
+
+    if (byte >= 0xC2 && byte <= 0xDF)
+    {
+        m_need = 1;
+    }
+    else if (byte == 0xE0)
+    {
+        m_need = 2;
+        m_lower = 0xA0;   // 排除超长编码
+    }
+    else if (byte == 0xED)
+    {
+        m_need = 2;
+        m_upper = 0x9F;   // 排除代理区
+    }
+    else if (byte >= 0xE1 && byte <= 0xEF)
+    {
+        m_need = 2;
+    }
+    else if (byte == 0xF0)
+    {
+        m_need = 3;
+        m_lower = 0x90;
+    }
+    else if (byte == 0xF4)
+    {
+        m_need = 3;
+        m_upper = 0x8F;   // 不超过 U+10FFFF
+    }
+    else if (byte >= 0xF1 && byte <= 0xF3)
+    {
+        m_need = 3;
+    }
+    else
+    {
+        ++m_invalid;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef TEXTSCAN_H
+#define TEXTSCAN_H
+
+#include <QString>
+#include <QStringDecoder>
+#include <QStringEncoder>
+
+// 文件的编码、BOM 与换行风格：加载时检测，保存时按原样写回
+struct TextFormat
+{
+    enum Encoding { Utf8 = 0, Utf16LE, Utf16BE, Gb18030 };
+    enum LineEnding { LF = 0, CRLF, CR };
+
+    Encoding encoding = Utf8;
+    bool hasBom = false;
+    LineEnding lineEnding = LF;
+
+    QString encodingName() const;
+    QString lineEndingName() const;
+    bool isByteOriented() const { return encoding == Utf8 || encoding == Gb18030; }
+
+    QStringDecoder createDecoder() const;
+    QStringEncoder createEncoder() const;
+
+    // 根据文件开头的字节判断编码，bomLength 返回需要跳过的 BOM 字节数
+    static TextFormat detect(const char* data, qint64 size, int* bomLength);
+};
+
+// 加载时的单遍扫描：统计换行、校验 UTF-8，并把 CRLF 与单独的 CR 原地规范为 LF。
+// 16 字节一组用 SIMD 判断，纯 ASCII 且不含 CR 的分组只做换行计数与搬移；
+// 跨块的状态（未完成的 UTF-8 序列、末尾的 CR）保存在扫描器中
+class TextScanner
+{
+public:
+    explicit TextScanner(bool validateUtf8 = true);
+
+    // 处理一块 UTF-8 / GB18030 字节，返回规范化后的长度
+    qint64 processBytes(char* data, qint64 size);
+    // 处理一块已解码的文本（UTF-16 文件使用）
+    void processText(QString& text);
+
+    qint64 lineCount() const { return m_lineFeeds + m_crlf + m_loneCr + 1; }
+    qint64 invalidSequences() const { return m_invalid + (m_need > 0 ? 1 : 0); }
+    // 出现次数最多的换行风格，没有换行时为 LF
+    TextFormat::LineEnding dominantLineEnding() const;
+
+    // 校验一段样本是否为合法 UTF-8，末尾被截断的序列不算错误
+    static bool isValidUtf8(const char* data, qint64 size);
+
+private:
+    void validateByte(uchar byte);
+
+    bool m_validateUtf8;
+    bool m_afterCr;       // 上一个字节是 CR（已输出为 LF），紧随的 LF 需要丢弃
+    int m_need;           // 当前 UTF-8 序列还需要的后续字节数
+    uchar m_lower;        // 下一个后续字节的取值范围（排除超长编码与代理区）
+    uchar m_upper;
+    qint64 m_lineFeeds;
+    qint64 m_crlf;
+    qint64 m_loneCr;
+    qint64 m_invalid;
+};
+
+#endif // TEXTSCAN_H
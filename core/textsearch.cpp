@@ -0,0 +1,331 @@
+#include "textsearch.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTSEARCH_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TEXTSEARCH_NEON
+#endif
+
+namespace {
+    const qsizetype LanesPerBlock = 8;   // 一个 128 位向量容纳 8 个 UTF-16 单元
+    const qsizetype BytesPerBlock = 16;
+
+    // 正则每次只在一段窗口内匹配，窗口之间检查取消
+    const qsizetype RegexWindowChars = 1024 * 1024;
+    // 窗口两侧多带的文本，供后顾、前瞻与 \b 判断
+    const qsizetype RegexMarginChars = 4096;
+
+    inline char asciiLower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+    inline char asciiUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? char(c - ('a' - 'A')) : c;
+    }
+
+    inline bool bytesEqualAt(const char* p, QByteArrayView needle, bool caseSensitive)
+    {
+        if (caseSensitive)
+            return std::memcmp(p, needle.data(), size_t(needle.size())) == 0;
+        for (qsizetype k = 0; k < needle.size(); ++k)
+        {
+            if (asciiLower(p[k]) != asciiLower(needle[k]))
+                return false;
+        }
+        return true;
+    }
+
+    inline bool isWordChar(QChar c)
+    {
+        return c.isLetterOrNumber() || c == QLatin1Char('_');
+    }
+
+    inline bool equalsAt(const char16_t* p, QStringView needle, bool caseSensitive)
+    {
+        return QStringView(p, needle.size()).compare(needle, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive) == 0;
+    }
+}
+
+TextSearcher::TextSearcher(const QString& pattern, const SearchOptions& options)
+    : m_pattern(pattern)
+    , m_options(options)
+    , m_valid(!pattern.isEmpty())
+{
+    if (!m_options.regex || pattern.isEmpty())
+        return;
+
+    QString expression = m_options.wholeWord ? QString("\\b(?:%1)\\b").arg(pattern) : pattern;
+    QRegularExpression::PatternOptions flags = QRegularExpression::MultilineOption;
+    if (!m_options.caseSensitive)
+        flags |= QRegularExpression::CaseInsensitiveOption;
+    m_regex = QRegularExpression(expression, flags);
+    m_valid = m_regex.isValid();
+    if (!m_valid)
+        m_error = m_regex.errorString();
+    else
+        m_regex.optimize();
+}
+
+qsizetype TextSearcher::findLiteral(QStringView haystack, QStringView needle, qsizetype from, bool caseSensitive)
+{
+    const qsizetype n = needle.size();
+    const qsizetype size = haystack.size();
+    if (n == 0 || from < 0 || size - from < n)
+        return -1;
+
+    // 非 ASCII 字符的大小写折叠不止两种形式，交给 Qt 的通用实现
+    const QChar first = needle.front();
+    const QChar last = needle.back();
+    if (!caseSensitive && (first.unicode() >= 0x80 || last.unicode() >= 0x80))
+        return haystack.indexOf(needle, from, Qt::CaseInsensitive);
+
+    const char16_t firstA = caseSensitive ? first.unicode() : first.toLower().unicode();
+    const char16_t firstB = caseSensitive ? first.unicode() : first.toUpper().unicode();
+    const char16_t lastA = caseSensitive ? last.unicode() : last.toLower().unicode();
+    const char16_t lastB = caseSensitive ? last.unicode() : last.toUpper().unicode();
+
+    const char16_t* h = haystack.utf16();
+    const qsizetype end = size - n + 1;   // 候选起点的上界（不含）
+    qsizetype i = from;
+
+#if defined(TEXTSEARCH_SSE2)
+    const __m128i vFirstA = _mm_set1_epi16(short(firstA));
+    const __m128i vFirstB = _mm_set1_epi16(short(firstB));
+    const __m128i vLastA = _mm_set1_epi16(short(lastA));
+    const __m128i vLastB = _mm_set1_epi16(short(lastB));
+    for (; i + LanesPerBlock <= end; i += LanesPerBlock)
+    {
+        // 同时比较 8 个候选起点的首字符与对应的尾字符，两者都相等的才需要完整校验
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + n - 1));
+        const __m128i eqHead = _mm_or_si128(_mm_cmpeq_epi16(head, vFirstA), _mm_cmpeq_epi16(head, vFirstB));
+        const __m128i eqTail = _mm_or_si128(_mm_cmpeq_epi16(tail, vLastA), _mm_cmpeq_epi16(tail, vLastB));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_and_si128(eqHead, eqTail)));
+        while (mask)
+        {
+            const int bit = qCountTrailingZeroBits(mask);
+            const qsizetype candidate = i + bit / 2;
+            if (equalsAt(h + candidate, needle, caseSensitive))
+                return candidate;
+            mask &= ~(3u << bit);
+        }
+    }
+#elif defined(TEXTSEARCH_NEON)
+    const uint16x8_t vFirstA = vdupq_n_u16(firstA);
+    const uint16x8_t vFirstB = vdupq_n_u16(firstB);
+    const uint16x8_t vLastA = vdupq_n_u16(lastA);
+    const uint16x8_t vLastB = vdupq_n_u16(lastB);
+    for (; i + LanesPerBlock <= end; i += LanesPerBlock)
+    {
+        const uint16x8_t head = vld1q_u16(reinterpret_cast<const uint16_t*>(h + i));
+        const uint16x8_t tail = vld1q_u16(reinterpret_cast<const uint16_t*>(h + i + n - 1));
+        const uint16x8_t eqHead = vorrq_u16(vceqq_u16(head, vFirstA), vceqq_u16(head, vFirstB));
+        const uint16x8_t eqTail = vorrq_u16(vceqq_u16(tail, vLastA), vceqq_u16(tail, vLastB));
+        // 每个通道收窄为一个字节，得到 64 位掩码
+        quint64 mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(vandq_u16(eqHead, eqTail))), 0);
+        while (mask)
+        {
+            const int bit = qCountTrailingZeroBits(mask);
+            const qsizetype candidate = i + bit / 8;
+            if (equalsAt(h + candidate, needle, caseSensitive))
+                return candidate;
+            mask &= ~(quint64(0xFF) << bit);
+        }
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        const char16_t c = h[i];
+        const char16_t t = h[i + n - 1];
+        if ((c == firstA || c == firstB) && (t == lastA || t == lastB) && equalsAt(h + i, needle, caseSensitive))
+            return i;
+    }
+    return -1;
+}
+
+qsizetype TextSearcher::findBytes(const char* data, qsizetype size, QByteArrayView needle, qsizetype from, bool caseSensitive)
+{
+    const qsizetype n = needle.size();
+    if (n == 0 || from < 0 || size - from < n)
+        return -1;
+
+    const char firstA = caseSensitive ? needle.front() : asciiLower(needle.front());
+    const char firstB = caseSensitive ? needle.front() : asciiUpper(needle.front());
+    const char lastA = caseSensitive ? needle.back() : asciiLower(needle.back());
+    const char lastB = caseSensitive ? needle.back() : asciiUpper(needle.back());
+
+    const qsizetype end = size - n + 1;
+    qsizetype i = from;
+
+#if defined(TEXTSEARCH_SSE2)
+    const __m128i vFirstA = _mm_set1_epi8(firstA);
+    const __m128i vFirstB = _mm_set1_epi8(firstB);
+    const __m128i vLastA = _mm_set1_epi8(lastA);
+    const __m128i vLastB = _mm_set1_epi8(lastB);
+    for (; i + BytesPerBlock <= end; i += BytesPerBlock)
+    {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+        const __m128i eqHead = _mm_or_si128(_mm_cmpeq_epi8(head, vFirstA), _mm_cmpeq_epi8(head, vFirstB));
+        const __m128i eqTail = _mm_or_si128(_mm_cmpeq_epi8(tail, vLastA), _mm_cmpeq_epi8(tail, vLastB));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_and_si128(eqHead, eqTail)));
+        while (mask)
+        {
+            const int bit = qCountTrailingZeroBits(mask);
+            if (bytesEqualAt(data + i + bit, needle, caseSensitive))
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#elif defined(TEXTSEARCH_NEON)
+    const uint8x16_t vFirstA = vdupq_n_u8(uchar(firstA));
+    const uint8x16_t vFirstB = vdupq_n_u8(uchar(firstB));
+    const uint8x16_t vLastA = vdupq_n_u8(uchar(lastA));
+    const uint8x16_t vLastB = vdupq_n_u8(uchar(lastB));
+    for (; i + BytesPerBlock <= end; i += BytesPerBlock)
+    {
+        const uint8x16_t head = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        const uint8x16_t tail = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i + n - 1));
+        const uint8x16_t eqHead = vorrq_u8(vceqq_u8(head, vFirstA), vceqq_u8(head, vFirstB));
+        const uint8x16_t eqTail = vorrq_u8(vceqq_u8(tail, vLastA), vceqq_u8(tail, vLastB));
+        // 每个字节收窄为 4 位，得到 64 位掩码
+        quint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vandq_u8(eqHead, eqTail)), 4)), 0);
+        while (mask)
+        {
+            const int bit = qCountTrailingZeroBits(mask);
+            if (bytesEqualAt(data + i + bit / 4, needle, caseSensitive))
+                return i + bit / 4;
+            mask &= ~(quint64(0xF) << bit);
+        }
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        const char c = data[i];
+        const char t = data[i + n - 1];
+        if ((c == firstA || c == firstB) && (t == lastA || t == lastB) && bytesEqualAt(data + i, needle, caseSensitive))
+            return i;
+    }
+    return -1;
+}
+
+bool TextSearcher::isWordBoundary(QStringView text, qsizetype start, qsizetype length) const
+{
+    if (start > 0 && isWordChar(text[start - 1]))
+        return false;
+    const qsizetype end = start + length;
+    return end >= text.size() || !isWordChar(text[end]);
+}
+
+void TextSearcher::findAll(const QString& text, qsizetype from, qsizetype to,
+                           const std::function<bool(const SearchMatch&)>& callback,
+                           const std::atomic<bool>* cancelled) const
+{
+    if (!m_valid)
+        return;
+    from = qMax<qsizetype>(0, from);
+    to = qMin(to, text.size());
+
+    if (m_options.regex)
+    {
+        // 逐个窗口匹配：即使很久没有匹配，每处理一个窗口也会检查一次取消
+        qsizetype pos = from;
+        while (pos < to)
+        {
+            if (cancelled && cancelled->load())
+                return;
+
+            const qsizetype windowEnd = qMin(to, pos + RegexWindowChars);
+            const qsizetype viewStart = qMax<qsizetype>(0, pos - RegexMarginChars);
+            const qsizetype viewEnd = qMin(text.size(), windowEnd + RegexMarginChars);
+            const QStringView view = QStringView(text).mid(viewStart, viewEnd - viewStart);
+
+            qsizetype next = windowEnd;
+            QRegularExpressionMatchIterator it = m_regex.globalMatchView(view, pos - viewStart);
+            while (it.hasNext())
+            {
+                QRegularExpressionMatch match = it.next();
+                const qsizetype start = viewStart + match.capturedStart();
+                if (start >= windowEnd)
+                    break;
+
+                qsizetype length = match.capturedLength();
+                const bool clipped = start + length >= viewEnd && viewEnd < text.size();
+                if (clipped)
+                {
+                    // 匹配一直延伸到视图末尾，可能被截断：在全文上从同一位置重新匹配，之后从其末尾另起窗口
+                    match = m_regex.match(text, start, QRegularExpression::NormalMatch,
+                                          QRegularExpression::AnchorAtOffsetMatchOption);
+                    length = match.hasMatch() ? match.capturedLength() : 0;
+                    next = start + qMax<qsizetype>(1, length);
+                }
+                else
+                {
+                    next = qMax(next, start + length);
+                }
+
+                // 零长度匹配（如 ^ 或 \b）无法高亮与替换，跳过
+                if (length > 0 && !callback(SearchMatch{ int(start), int(length) }))
+                    return;
+                if (clipped)
+                    break;
+            }
+            pos = next;
+        }
+        return;
+    }
+
+    const QStringView haystack = QStringView(text).left(qMin(text.size(), to + m_pattern.size() - 1));
+    const int length = int(m_pattern.size());
+    qsizetype pos = from;
+    while ((pos = findLiteral(haystack, m_pattern, pos, m_options.caseSensitive)) >= 0)
+    {
+        if (m_options.wholeWord && !isWordBoundary(text, pos, length))
+        {
+            ++pos;
+            continue;
+        }
+        if (!callback(SearchMatch{ int(pos), length }))
+            return;
+        pos += length;
+    }
+}
+
+QString TextSearcher::replacementFor(const QString& subject, const SearchMatch& match, const QString& replacement) const
+{
+    if (!m_options.regex)
+        return replacement;
+
+    const QRegularExpressionMatch captured = m_regex.match(subject, match.start, QRegularExpression::NormalMatch,
+                                                           QRegularExpression::AnchorAtOffsetMatchOption);
+    QString result;
+    result.reserve(replacement.size());
+    for (qsizetype i = 0; i < replacement.size(); ++i)
+    {
+        const QChar c = replacement[i];
+        if (c != QLatin1Char('\\') || i + 1 == replacement.size())
+        {
+            result += c;
+            continue;
+        }
+
+        const QChar next = replacement[++i];
+        if (next.isDigit())
+            result += captured.captured(next.digitValue());
+        else if (next == QLatin1Char('n'))
+            result += QLatin1Char('\n');
+        else if (next == QLatin1Char('t'))
+            result += QLatin1Char('\t');
+        else
+            result += next;
+    }
+    return result;
+}
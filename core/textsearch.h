@@ -0,0 +1,63 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <QRegularExpression>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+struct SearchOptions
+{
+    bool caseSensitive = false;
+    bool wholeWord = false;
+    bool regex = false;
+};
+
+// 匹配在文本中的位置，以 UTF-16 单元计，与 QTextDocument 的字符位置一致
+struct SearchMatch
+{
+    int start = 0;
+    int length = 0;
+};
+
+// 在文本快照上查找，可在工作线程中使用。字面量查找先用 SIMD 同时比较
+// 模式的首尾字符筛出候选位置再逐一校验；正则模式使用 QRegularExpression，
+// 按固定大小的窗口分段匹配
+class TextSearcher
+{
+public:
+    TextSearcher(const QString& pattern, const SearchOptions& options);
+
+    bool isValid() const { return m_valid; }
+    QString errorString() const { return m_error; }
+    const SearchOptions& options() const { return m_options; }
+
+    // 依次报告起点位于 [from, to) 内的匹配（正则匹配可能延伸到 to 之后），callback 返回 false 时停止。
+    // cancelled 置位时尽快返回，正则模式下匹配很少时也能及时响应
+    void findAll(const QString& text, qsizetype from, qsizetype to,
+                 const std::function<bool(const SearchMatch&)>& callback,
+                 const std::atomic<bool>* cancelled = nullptr) const;
+
+    // 一处匹配的替换文本。正则模式下展开 \0-\9 捕获组以及 \n、\t、\\；
+    // subject 必须是查找时使用的同一份文本
+    QString replacementFor(const QString& subject, const SearchMatch& match, const QString& replacement) const;
+
+    // 从 from 开始查找 needle 第一次出现的位置，找不到时返回 -1
+    static qsizetype findLiteral(QStringView haystack, QStringView needle, qsizetype from, bool caseSensitive);
+    // 字节版本，用于直接扫描映射到内存的 UTF-8 文件；不区分大小写时只折叠 ASCII 字母
+    static qsizetype findBytes(const char* data, qsizetype size, QByteArrayView needle, qsizetype from, bool caseSensitive);
+
+private:
+    bool isWordBoundary(QStringView text, qsizetype start, qsizetype length) const;
+
+    QString m_pattern;
+    SearchOptions m_options;
+    QRegularExpression m_regex;
+    bool m_valid;
+    QString m_error;
+};
+
+#endif // TEXTSEARCH_H
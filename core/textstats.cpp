@@ -0,0 +1,173 @@
+#include "textstats.h"
+#include <QChar>
+#include <QtAlgorithms>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTSTATS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TEXTSTATS_NEON
+#endif
+
+namespace {
+    const int LanesPerBlock = 8;
+    const int WordsPerMinute = 200;
+    const int CjkPerMinute = 400;
+
+    enum CharClass { Separator, Word, Cjk, Mark };
+
+    inline bool isAsciiWordChar(char16_t c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '_' || c == '\'';
+    }
+
+    bool isCjk(char32_t c)
+    {
+        return (c >= 0x3040 && c <= 0x30FF)     // 平假名、片假名
+            || (c >= 0x31F0 && c <= 0x31FF)     // 片假名语音扩展
+            || (c >= 0x3400 && c <= 0x4DBF)     // 扩展 A
+            || (c >= 0x4E00 && c <= 0x9FFF)     // 基本区
+            || (c >= 0xF900 && c <= 0xFAFF)     // 兼容表意文字
+            || (c >= 0x20000 && c <= 0x3FFFF);  // 扩展 B 及之后
+    }
+
+    CharClass classify(char32_t c)
+    {
+        if (c < 0x80)
+            return isAsciiWordChar(char16_t(c)) ? Word : Separator;
+        if (isCjk(c))
+            return Cjk;
+        if (c == 0x2019)                        // 弯引号形式的撇号
+            return Word;
+        if (QChar::isMark(c))
+            return Mark;
+        return QChar::isLetterOrNumber(c) ? Word : Separator;
+    }
+
+    // 一组 8 个单元都是 ASCII 时返回 true，并给出其中词字符与换行的位掩码（第 i 位对应第 i 个单元）
+    inline bool scanAscii(const char16_t* p, uint* wordMask, uint* lineFeedMask)
+    {
+#if defined(TEXTSTATS_SSE2)
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i zero = _mm_setzero_si128();
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xFF80))), zero)) != 0xFFFF)
+            return false;
+
+        // 全部小于 0x80，有符号比较即可；字母先折叠为小写
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi16(0x20));
+        const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi16(lower, _mm_set1_epi16('a' - 1)),
+                                            _mm_cmplt_epi16(lower, _mm_set1_epi16('z' + 1)));
+        const __m128i digit = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16('0' - 1)),
+                                            _mm_cmplt_epi16(v, _mm_set1_epi16('9' + 1)));
+        const __m128i extra = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('_')),
+                                           _mm_cmpeq_epi16(v, _mm_set1_epi16('\'')));
+        const __m128i word = _mm_or_si128(_mm_or_si128(alpha, digit), extra);
+        const __m128i lineFeed = _mm_cmpeq_epi16(v, _mm_set1_epi16('\n'));
+        // 16 位通道收窄为字节后每个通道对应掩码的一位
+        *wordMask = uint(_mm_movemask_epi8(_mm_packs_epi16(word, zero)));
+        *lineFeedMask = uint(_mm_movemask_epi8(_mm_packs_epi16(lineFeed, zero)));
+        return true;
+#elif defined(TEXTSTATS_NEON)
+        const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(p));
+        if (vmaxvq_u16(v) >= 0x80)
+            return false;
+
+        const uint16x8_t lower = vorrq_u16(v, vdupq_n_u16(0x20));
+        const uint16x8_t alpha = vandq_u16(vcgeq_u16(lower, vdupq_n_u16('a')), vcleq_u16(lower, vdupq_n_u16('z')));
+        const uint16x8_t digit = vandq_u16(vcgeq_u16(v, vdupq_n_u16('0')), vcleq_u16(v, vdupq_n_u16('9')));
+        const uint16x8_t extra = vorrq_u16(vceqq_u16(v, vdupq_n_u16('_')), vceqq_u16(v, vdupq_n_u16('\'')));
+        const uint16x8_t word = vorrq_u16(vorrq_u16(alpha, digit), extra);
+        const uint16x8_t lineFeed = vceqq_u16(v, vdupq_n_u16('\n'));
+        // 每个通道收窄为一个字节，与各自的位权相与后求和得到位掩码
+        static const uint8_t weights[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x8_t bits = vld1_u8(weights);
+        *wordMask = vaddv_u8(vand_u8(vmovn_u16(word), bits));
+        *lineFeedMask = vaddv_u8(vand_u8(vmovn_u16(lineFeed), bits));
+        return true;
+#else
+        uint word = 0;
+        uint lineFeed = 0;
+        for (int i = 0; i < LanesPerBlock; ++i)
+        {
+            if (p[i] >= 0x80)
+                return false;
+            word |= uint(isAsciiWordChar(p[i])) << i;
+            lineFeed |= uint(p[i] == '\n') << i;
+        }
+        *wordMask = word;
+        *lineFeedMask = lineFeed;
+        return true;
+#endif
+    }
+}
+
+// ============ TextStats 实现 ============
+int TextStats::readingMinutes() const
+{
+    const double minutes = double(words - cjkCharacters) / WordsPerMinute + double(cjkCharacters) / CjkPerMinute;
+    return int(std::ceil(minutes));
+}
+
+TextStats TextStats::count(QStringView text)
+{
+    TextStats stats;
+    const char16_t* p = text.utf16();
+    const qsizetype size = text.size();
+    bool inWord = false;
+    qsizetype i = 0;
+
+    while (i < size)
+    {
+        uint wordMask = 0;
+        uint lineFeedMask = 0;
+        if (i + LanesPerBlock <= size && scanAscii(p + i, &wordMask, &lineFeedMask))
+        {
+            // 词首是前一个单元不是词字符的词字符；前一组最后一个单元的状态移入第 0 位
+            const uint previous = ((wordMask << 1) | uint(inWord)) & 0xFF;
+            stats.words += qPopulationCount(wordMask & ~previous);
+            stats.characters += LanesPerBlock - qPopulationCount(lineFeedMask);
+            inWord = wordMask & 0x80;
+            i += LanesPerBlock;
+            continue;
+        }
+
+        // 逐字符处理到下一个分组边界，代理对合并为一个码点
+        const qsizetype end = qMin(size, i + LanesPerBlock);
+        while (i < end)
+        {
+            char32_t c = p[i++];
+            if (QChar::isHighSurrogate(c) && i < size && QChar::isLowSurrogate(p[i]))
+                c = QChar::surrogateToUcs4(char16_t(c), p[i++]);
+
+            if (c == '\n' || c == QChar::ParagraphSeparator || c == QChar::LineSeparator)
+            {
+                inWord = false;
+                continue;
+            }
+            ++stats.characters;
+            switch (classify(c))
+            {
+            case Word:
+                if (!inWord)
+                    ++stats.words;
+                inWord = true;
+                break;
+            case Cjk:
+                ++stats.words;
+                ++stats.cjkCharacters;
+                inWord = false;
+                break;
+            case Mark:
+                // 组合符号附着在前一个字符上，不改变词的边界
+                break;
+            case Separator:
+                inWord = false;
+                break;
+            }
+        }
+    }
+    return stats;
+}
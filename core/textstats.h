@@ -0,0 +1,38 @@
+#ifndef TEXTSTATS_H
+#define TEXTSTATS_H
+
+#include <QStringView>
+
+// 一段文本的字数统计。词是字母、数字（以及 ' 与 _）组成的连续串；
+// 中日文没有空格分词，每个汉字与假名各算一个词。字符数以 Unicode 码点计，不含换行
+struct TextStats
+{
+    qint64 words = 0;
+    qint64 cjkCharacters = 0;   // words 中属于中日文字符的部分
+    qint64 characters = 0;
+
+    TextStats& operator+=(const TextStats& other)
+    {
+        words += other.words;
+        cjkCharacters += other.cjkCharacters;
+        characters += other.characters;
+        return *this;
+    }
+
+    TextStats& operator-=(const TextStats& other)
+    {
+        words -= other.words;
+        cjkCharacters -= other.cjkCharacters;
+        characters -= other.characters;
+        return *this;
+    }
+
+    // 阅读时间（分钟，向上取整）：西文按每分钟 200 词，中日文按每分钟 400 字
+    int readingMinutes() const;
+
+    // 8 个 UTF-16 单元一组用 SIMD 判断，纯 ASCII 的分组直接由掩码得到词首个数，
+    // 含非 ASCII 字符的分组逐字符按 Unicode 类别判断
+    static TextStats count(QStringView text);
+};
+
+#endif // TEXTSTATS_H
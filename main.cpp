@@ -1,12 +1,34 @@
 #include <QApplication>
+#include <QCoreApplication>
+#include <cstdio>
 #include "ui/notepad.h"
+#include "core/batchprocessor.h"
 
 int main(int argc, char *argv[])
 {
+    // 批处理模式只需要 QCoreApplication，不创建任何窗口部件，可在没有显示器的 CI 环境中运行
+    if (BatchProcessor::isRequested(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+        QCoreApplication::setOrganizationName("WavesTop");
+        QCoreApplication::setApplicationName("MarkdownEditor");
+
+        BatchProcessor::Options options;
+        QString error;
+        if (!BatchProcessor::parseArguments(app.arguments(), &options, &error))
+        {
+            std::fputs(error.toLocal8Bit().constData(), stderr);
+            return 2;
+        }
+        return BatchProcessor(options).run();
+    }
+
     QApplication app(argc, argv);
-    
+    QApplication::setOrganizationName("WavesTop");
+    QApplication::setApplicationName("MarkdownEditor");
+
     Notepad window;
     window.show();
-    
+
     return app.exec();
 }
@@ -1,6 +1,25 @@
 #include "codeeditor.h"
+#include "markdownhighlighter.h"
+#include "minimap.h"
+#include "documentstatistics.h"
+#include "spellchecker.h"
+#include "undomanager.h"
+#include "../core/pasteloader.h"
+#include "../core/textsearch.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QDropEvent>
+#include <QFileInfo>
+#include <QMenu>
+#include <QMimeData>
+#include <QMouseEvent>
 #include <QPainter>
+#include <QScrollBar>
 #include <QTextBlock>
+#include <QUrl>
+#include <algorithm>
+#include <atomic>
 
 // 主题颜色（与 notepad.cpp 中保持一致）
 namespace EditorTheme {
@@ -10,23 +29,100 @@ namespace EditorTheme {
     const QColor foreground(248, 248, 242);    // #f8f8f2
     const QColor foregroundDim(117, 113, 94);  // #75715e
     const QColor currentLine(50, 50, 45);      // 当前行背景
+    const QColor selection(73, 72, 62);        // #49483e，光标处单词的其他出现位置
+}
+
+namespace {
+    // 超过该数量的输入仍未绘制（如编辑器不可见）时不再累积
+    const int MaxPendingInputs = 256;
+
+    // 光标停下多久之后更新单词高亮
+    const int OccurrenceDelayMs = 150;
+    // 缓存高亮结果的单词数
+    const int OccurrenceCacheWords = 16;
+    // 单次扫描记录的出现位置上限
+    const int MaxOccurrences = 1000;
+    // 选中文本作为高亮目标时的最大长度
+    const int MaxOccurrenceLength = 200;
+
+    // 超过该长度的粘贴改为后台准备、分块插入
+    const qsizetype LargeInsertChars = 1024 * 1024;
+    // 拖放的文件达到该大小时不插入，作为新 Tab 打开（与 Notepad 中的大文件阈值一致）
+    const qint64 LargeDropBytes = 256LL * 1024 * 1024;
+
+    std::atomic<quint32> s_nextTraceTrack(0);
+
+    inline bool isWordChar(QChar c)
+    {
+        return c.isLetterOrNumber() || c == QLatin1Char('_');
+    }
+
+    bool byPosition(const QTextCursor &a, const QTextCursor &b)
+    {
+        return a.position() < b.position();
+    }
 }
 
 CodeEditor::CodeEditor(QWidget *parent)
     : QPlainTextEdit(parent)
+    , m_lineNumberAreaWidth(0)
+    , m_digitWidth(0)
+    , m_occurrenceCache(OccurrenceCacheWords)
+    , m_cursorColumn(0)
+    , m_columnSelecting(false)
+    , m_columnAnchorBlock(0)
+    , m_columnAnchorColumn(0)
+    , m_pasteLoader(nullptr)
+    , m_insertRevision(0)
+    , m_dropping(false)
+    , m_traceTrack(++s_nextTraceTrack)
 {
+    LatencyTrace::setTrackName(m_traceTrack, QString("Editor %1").arg(m_traceTrack));
     m_lineNumberArea = new LineNumberArea(this);
+    // 缩略图先于高亮器连接 contentsChange：高亮器在同一通知中重新高亮并报告块号时，
+    // 缩略图的图块已按编辑后的行号调整
+    m_minimap = new Minimap(this);
+    m_minimap->hide();
+    m_highlighter = new MarkdownHighlighter(this);
+    connect(m_highlighter, &MarkdownHighlighter::blockStatesChanged, m_minimap, &Minimap::invalidateBlockStates);
+    m_undoManager = new UndoManager(this);
+    m_statistics = new DocumentStatistics(document(), this);
+    m_spellChecker = new SpellChecker(this);
+    updateDigitCache();
 
     connect(this, &CodeEditor::blockCountChanged, this, &CodeEditor::updateLineNumberAreaWidth);
     connect(this, &CodeEditor::updateRequest, this, &CodeEditor::updateLineNumberArea);
     connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
 
+    // 单词高亮在光标停下后才扫描；滚动后视口外的部分需要补扫
+    m_occurrenceTimer.setSingleShot(true);
+    m_occurrenceTimer.setInterval(OccurrenceDelayMs);
+    connect(&m_occurrenceTimer, &QTimer::timeout, this, &CodeEditor::updateOccurrences);
+    connect(this, &CodeEditor::cursorPositionChanged, &m_occurrenceTimer, qOverload<>(&QTimer::start));
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        if (!m_occurrenceKey.isEmpty() || !m_extraCursors.isEmpty())
+            m_occurrenceTimer.start();
+    });
+
     updateLineNumberAreaWidth(0);
     highlightCurrentLine();
 }
 
-int CodeEditor::lineNumberAreaWidth()
+void CodeEditor::updateDigitCache()
 {
+    m_digitWidth = fontMetrics().horizontalAdvance(QLatin1Char('9'));
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        m_digits[digit].setTextFormat(Qt::PlainText);
+        m_digits[digit].setText(QString(QChar(QLatin1Char('0' + digit))));
+        m_digits[digit].prepare(QTransform(), font());
+    }
+}
+
+void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
+{
+    LatencyScope scope("blockCountChanged", m_traceTrack);
+
     int digits = 1;
     int max = qMax(1, blockCount());
     while (max >= 10)
@@ -35,17 +131,47 @@ int CodeEditor::lineNumberAreaWidth()
         ++digits;
     }
 
-    int space = 16 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
-    return space;
+    // 只有位数或字体变化时才重新设置视口边距
+    int width = 16 + m_digitWidth * digits;
+    if (width == m_lineNumberAreaWidth)
+        return;
+
+    m_lineNumberAreaWidth = width;
+    updateViewportMargins();
 }
 
-void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
+void CodeEditor::setMinimapVisible(bool visible)
+{
+    if (visible == !m_minimap->isHidden())
+        return;
+
+    m_minimap->setVisible(visible);
+    updateViewportMargins();
+}
+
+void CodeEditor::updateViewportMargins()
 {
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    // 左侧留给行号，右侧（滚动条以内）留给缩略图
+    const int minimapWidth = m_minimap->isHidden() ? 0 : Minimap::preferredWidth();
+    setViewportMargins(m_lineNumberAreaWidth, 0, minimapWidth, 0);
+
+    QRect cr = contentsRect();
+    m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), m_lineNumberAreaWidth, cr.height()));
+    const QRect vr = viewport()->geometry();
+    m_minimap->setGeometry(QRect(vr.right() + 1, vr.top(), minimapWidth, vr.height()));
+}
+
+void CodeEditor::goToLine(int line)
+{
+    QTextCursor cursor(document()->findBlockByNumber(qBound(0, line, blockCount() - 1)));
+    setTextCursor(cursor);
+    centerCursor();
 }
 
 void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
 {
+    LatencyScope scope("updateRequest", m_traceTrack);
+
     if (dy)
         m_lineNumberArea->scroll(0, dy);
     else
@@ -55,16 +181,179 @@ void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
         updateLineNumberAreaWidth(0);
 }
 
+void CodeEditor::visibleBlockRange(int *first, int *last) const
+{
+    QTextBlock block = firstVisibleBlock();
+    *first = block.blockNumber();
+    *last = *first;
+
+    int number = *first;
+    int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
+    const int height = viewport()->height();
+    while (block.isValid() && top <= height)
+    {
+        *last = number++;
+        top += qRound(blockBoundingRect(block).height());
+        block = block.next();
+    }
+}
+
 void CodeEditor::resizeEvent(QResizeEvent *e)
 {
     QPlainTextEdit::resizeEvent(e);
 
     QRect cr = contentsRect();
     m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+    const QRect vr = viewport()->geometry();
+    m_minimap->setGeometry(QRect(vr.right() + 1, vr.top(), m_minimap->width(), vr.height()));
+}
+
+void CodeEditor::changeEvent(QEvent *e)
+{
+    QPlainTextEdit::changeEvent(e);
+
+    // 只读状态切换后（如文件加载完成）刷新当前行高亮
+    if (e->type() == QEvent::ReadOnlyChange)
+        highlightCurrentLine();
+
+    // 缩放等字体变化后重建数字缓存与行号区宽度
+    if (e->type() == QEvent::FontChange)
+    {
+        updateDigitCache();
+        m_lineNumberAreaWidth = 0;
+        updateLineNumberAreaWidth(0);
+    }
+}
+
+void CodeEditor::keyPressEvent(QKeyEvent *e)
+{
+    const qint64 start = LatencyTrace::now();
+    const int revision = document()->revision();
+    const int position = textCursor().position();
+    prepareEdit();
+
+    if (m_pasteLoader && e->key() == Qt::Key_Escape)
+    {
+        cancelInsert();
+        e->accept();
+    }
+    else if (handleMultiCursorKey(e))
+    {
+        e->accept();
+    }
+    // 文档自带的撤销栈已关闭，快捷键转给 UndoManager
+    else if (e->matches(QKeySequence::Undo) || e->matches(QKeySequence::Redo))
+    {
+        LatencyScope scope(e->matches(QKeySequence::Undo) ? "undo" : "redo", m_traceTrack);
+        if (!isReadOnly())
+        {
+            if (e->matches(QKeySequence::Undo))
+                m_undoManager->undo();
+            else
+                m_undoManager->redo();
+        }
+        e->accept();
+    }
+    else
+    {
+        // 包含文档修改、增量布局以及由此同步触发的信号处理
+        LatencyScope scope("keyPress", m_traceTrack);
+        QPlainTextEdit::keyPressEvent(e);
+    }
+    beginInput(start, revision, position);
+}
+
+void CodeEditor::contextMenuEvent(QContextMenuEvent *e)
+{
+    // 标准菜单中的撤销/重做指向文档自带的撤销栈，改为指向 UndoManager
+    prepareEdit();
+    QMenu *menu = createStandardContextMenu(e->pos());
+    const QList<QAction *> actions = menu->actions();
+    for (QAction *action : actions)
+    {
+        if (action->objectName() == QLatin1String("edit-undo"))
+        {
+            disconnect(action, &QAction::triggered, nullptr, nullptr);
+            action->setEnabled(!isReadOnly() && m_undoManager->canUndo());
+            connect(action, &QAction::triggered, m_undoManager, &UndoManager::undo);
+        }
+        else if (action->objectName() == QLatin1String("edit-redo"))
+        {
+            disconnect(action, &QAction::triggered, nullptr, nullptr);
+            action->setEnabled(!isReadOnly() && m_undoManager->canRedo());
+            connect(action, &QAction::triggered, m_undoManager, &UndoManager::redo);
+        }
+    }
+    menu->exec(e->globalPos());
+    delete menu;
+}
+
+void CodeEditor::inputMethodEvent(QInputMethodEvent *e)
+{
+    const qint64 start = LatencyTrace::now();
+    const int revision = document()->revision();
+    const int position = textCursor().position();
+    prepareEdit();
+    {
+        LatencyScope scope("inputMethod", m_traceTrack);
+        // 输入法提交的文字插入到每个光标处；组字过程只在主光标处显示
+        if (!m_extraCursors.isEmpty() && e->preeditString().isEmpty() && !e->commitString().isEmpty()
+            && !isReadOnly())
+        {
+            const QString text = e->commitString();
+            editAtCursors([&text](QTextCursor &cursor, int) { cursor.insertText(text); });
+            e->accept();
+        }
+        else
+        {
+            clearExtraCursors();
+            QPlainTextEdit::inputMethodEvent(e);
+        }
+    }
+    beginInput(start, revision, position);
+}
+
+void CodeEditor::beginInput(qint64 start, int revision, int position)
+{
+    // 只统计改变了文本或光标的输入，修饰键等不会引起重绘的按键不计入
+    if (document()->revision() == revision && textCursor().position() == position)
+        return;
+    if (m_pendingInputs.size() < MaxPendingInputs)
+        m_pendingInputs.append(start);
+}
+
+void CodeEditor::paintEvent(QPaintEvent *e)
+{
+    const qint64 start = LatencyTrace::now();
+    QPlainTextEdit::paintEvent(e);
+    if (!m_extraCursors.isEmpty())
+        paintExtraCursors();
+    const qint64 end = LatencyTrace::now();
+
+    m_paintLatency.record((end - start) / 1000);
+    LatencyTrace::complete("paint", m_traceTrack, start, end);
+
+    // 同一帧内合并绘制的多次输入分别计入直方图，时间线上只画最早的一次
+    if (!m_pendingInputs.isEmpty())
+    {
+        for (qint64 input : std::as_const(m_pendingInputs))
+            m_inputLatency.record((end - input) / 1000);
+        LatencyTrace::complete("inputToPaint", m_traceTrack, m_pendingInputs.first(), end);
+        m_pendingInputs.clear();
+    }
+}
+
+void CodeEditor::resetLatency()
+{
+    m_inputLatency.reset();
+    m_paintLatency.reset();
+    m_pendingInputs.clear();
 }
 
 void CodeEditor::highlightCurrentLine()
 {
+    LatencyScope scope("highlightCurrentLine", m_traceTrack);
+
     QList<QTextEdit::ExtraSelection> extraSelections;
 
     if (!isReadOnly())
@@ -78,11 +367,70 @@ void CodeEditor::highlightCurrentLine()
         extraSelections.append(selection);
     }
 
+    // 光标仍在上次扫描的单词上时显示缓存的出现位置；缓存只覆盖视口附近，数量有上限
+    if (!m_occurrenceKey.isEmpty() && occurrenceKey(textCursor()) == m_occurrenceKey)
+    {
+        const Occurrences *occurrences = m_occurrenceCache.object(m_occurrenceKey);
+        if (occurrences && occurrences->revision == document()->revision())
+        {
+            const int length = int(m_occurrenceKey.size()) - 2;
+            QTextEdit::ExtraSelection selection;
+            selection.format.setBackground(EditorTheme::selection);
+            selection.cursor = QTextCursor(document());
+            for (int start : occurrences->starts)
+            {
+                selection.cursor.setPosition(start);
+                selection.cursor.setPosition(start + length, QTextCursor::KeepAnchor);
+                extraSelections.append(selection);
+            }
+        }
+    }
+
+    // 附加光标的选区只取视口上下各一屏之内的
+    if (!m_extraCursors.isEmpty())
+    {
+        int from = 0;
+        int to = 0;
+        visiblePositionRange(&from, &to);
+        const int margin = to - from;
+        QTextCursor probe(document());
+        probe.setPosition(qMax(0, from - margin));
+        auto it = std::lower_bound(m_extraCursors.cbegin(), m_extraCursors.cend(), probe, byPosition);
+        for (; it != m_extraCursors.cend() && it->position() <= to + margin; ++it)
+        {
+            if (!it->hasSelection())
+                continue;
+            QTextEdit::ExtraSelection selection;
+            selection.format.setBackground(palette().highlight());
+            selection.format.setForeground(palette().highlightedText());
+            selection.cursor = *it;
+            extraSelections.append(selection);
+        }
+    }
+
+    extraSelections.append(m_spellSelections);
+    extraSelections.append(m_searchSelections);
     setExtraSelections(extraSelections);
 }
 
+void CodeEditor::setSearchSelections(const QList<QTextEdit::ExtraSelection> &selections)
+{
+    m_searchSelections = selections;
+    highlightCurrentLine();
+}
+
+void CodeEditor::setSpellSelections(const QList<QTextEdit::ExtraSelection> &selections)
+{
+    if (selections.isEmpty() && m_spellSelections.isEmpty())
+        return;
+    m_spellSelections = selections;
+    highlightCurrentLine();
+}
+
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
+    LatencyScope scope("gutterPaint", m_traceTrack);
+
     QPainter painter(m_lineNumberArea);
     painter.fillRect(event->rect(), EditorTheme::backgroundDark);
 
@@ -94,20 +442,24 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
     // 当前行号
     int currentBlockNumber = textCursor().blockNumber();
 
+    painter.setPen(EditorTheme::foregroundDim);
+    const int right = m_lineNumberArea->width() - 8;
+
     while (block.isValid() && top <= event->rect().bottom())
     {
         if (block.isVisible() && bottom >= event->rect().top())
         {
-            QString number = QString::number(blockNumber + 1);
-            
             // 当前行号高亮
             if (blockNumber == currentBlockNumber)
+            {
                 painter.setPen(EditorTheme::foreground);
-            else
+                drawLineNumber(painter, blockNumber + 1, right, top);
                 painter.setPen(EditorTheme::foregroundDim);
-            
-            painter.drawText(0, top, m_lineNumberArea->width() - 8, fontMetrics().height(),
-                             Qt::AlignRight | Qt::AlignVCenter, number);
+            }
+            else
+            {
+                drawLineNumber(painter, blockNumber + 1, right, top);
+            }
         }
 
         block = block.next();
@@ -116,3 +468,641 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
         ++blockNumber;
     }
 }
+
+void CodeEditor::drawLineNumber(QPainter &painter, int number, int right, int top)
+{
+    // 从个位开始向左逐位绘制
+    int x = right;
+    do
+    {
+        x -= m_digitWidth;
+        painter.drawStaticText(x, top, m_digits[number % 10]);
+        number /= 10;
+    } while (number > 0);
+}
+
+// ============ 单词高亮 ============
+void CodeEditor::visiblePositionRange(int *from, int *to) const
+{
+    int first = 0;
+    int last = 0;
+    visibleBlockRange(&first, &last);
+    *from = document()->findBlockByNumber(first).position();
+    const QTextBlock block = document()->findBlockByNumber(last);
+    *to = block.position() + block.length() - 1;
+}
+
+QString CodeEditor::occurrenceKey(const QTextCursor &cursor) const
+{
+    // 有选区时按字面匹配选中的文本（只限单行），否则按整词匹配光标处的单词
+    if (cursor.hasSelection())
+    {
+        const QString text = cursor.selectedText();
+        if (text.size() > MaxOccurrenceLength || text.contains(QChar::ParagraphSeparator) || text.trimmed().isEmpty())
+            return QString();
+        return QLatin1String("s:") + text;
+    }
+
+    const QString text = cursor.block().text();
+    int begin = cursor.positionInBlock();
+    int end = begin;
+    while (begin > 0 && isWordChar(text.at(begin - 1)))
+        --begin;
+    while (end < text.size() && isWordChar(text.at(end)))
+        ++end;
+    if (begin == end)
+        return QString();
+    return QLatin1String("w:") + text.mid(begin, end - begin);
+}
+
+const CodeEditor::Occurrences *CodeEditor::findOccurrences(const QString &key, int firstBlock, int lastBlock)
+{
+    Occurrences *cached = m_occurrenceCache.object(key);
+    if (cached && cached->revision == document()->revision() && cached->firstBlock <= firstBlock
+        && cached->lastBlock >= lastBlock)
+        return cached;
+
+    Occurrences *result = new Occurrences;
+    result->revision = document()->revision();
+    result->firstBlock = firstBlock;
+    result->lastBlock = lastBlock;
+
+    const bool wholeWord = key.startsWith(QLatin1String("w:"));
+    const QStringView needle = QStringView(key).mid(2);
+    int number = firstBlock;
+    for (QTextBlock block = document()->findBlockByNumber(firstBlock); block.isValid() && number <= lastBlock;
+         block = block.next(), ++number)
+    {
+        const QString text = block.text();
+        for (qsizetype at = TextSearcher::findLiteral(text, needle, 0, true); at >= 0;
+             at = TextSearcher::findLiteral(text, needle, at + needle.size(), true))
+        {
+            if (wholeWord && ((at > 0 && isWordChar(text.at(at - 1)))
+                              || (at + needle.size() < text.size() && isWordChar(text.at(at + needle.size())))))
+                continue;
+            result->starts.append(block.position() + int(at));
+        }
+        // 达到上限后缓存只覆盖已扫描的块，滚动到后面时重新扫描
+        if (result->starts.size() >= MaxOccurrences)
+        {
+            result->lastBlock = number;
+            break;
+        }
+    }
+
+    m_occurrenceCache.insert(key, result);
+    return result;
+}
+
+void CodeEditor::updateOccurrences()
+{
+    m_occurrenceKey = occurrenceKey(textCursor());
+    if (!m_occurrenceKey.isEmpty())
+    {
+        int first = 0;
+        int last = 0;
+        visibleBlockRange(&first, &last);
+        const int margin = last - first + 1;
+        findOccurrences(m_occurrenceKey, qMax(0, first - margin), qMin(blockCount() - 1, last + margin));
+    }
+    highlightCurrentLine();
+}
+
+// ============ 多光标 ============
+QList<QTextCursor> CodeEditor::allCursors(int *primary) const
+{
+    QList<QTextCursor> cursors = m_extraCursors;
+    const QTextCursor cursor = textCursor();
+    const auto it = std::lower_bound(cursors.begin(), cursors.end(), cursor, byPosition);
+    *primary = int(it - cursors.begin());
+    cursors.insert(it, cursor);
+    return cursors;
+}
+
+void CodeEditor::setCursors(const QList<QTextCursor> &cursors, int primary)
+{
+    // 按位置排序并去掉重合的光标，主光标优先保留
+    QVector<int> order(cursors.size());
+    for (int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&cursors](int a, int b) {
+        return byPosition(cursors.at(a), cursors.at(b));
+    });
+
+    QList<QTextCursor> extras;
+    int previous = -1;
+    bool previousIsPrimary = false;
+    for (int index : order)
+    {
+        const QTextCursor &cursor = cursors.at(index);
+        if (previous >= 0 && cursor.position() == cursors.at(previous).position())
+        {
+            if (index != primary)
+                continue;
+            if (!previousIsPrimary)
+                extras.removeLast();
+        }
+        if (index != primary)
+            extras.append(cursor);
+        previous = index;
+        previousIsPrimary = index == primary;
+    }
+
+    m_extraCursors = extras;
+    setTextCursor(cursors.at(primary));
+    highlightCurrentLine();
+    viewport()->update();
+}
+
+void CodeEditor::clearExtraCursors()
+{
+    if (m_extraCursors.isEmpty())
+        return;
+    m_extraCursors.clear();
+    highlightCurrentLine();
+    viewport()->update();
+}
+
+void CodeEditor::editAtCursors(const std::function<void(QTextCursor &cursor, int index)> &edit)
+{
+    // 从后往前逐个光标修改，每次只通知被改动的一小段；在 UndoManager 中记为一组，一次撤销全部还原。
+    // 不使用 QTextDocument 的编辑块：块内的修改会合并成从第一个到最后一个光标的整段通知，
+    // 高亮、统计等都要重新处理整段，开销随光标间距增长
+    int primary = 0;
+    QList<QTextCursor> cursors = allCursors(&primary);
+    m_undoManager->beginGroup();
+    for (int i = int(cursors.size()) - 1; i >= 0; --i)
+    {
+        m_undoManager->prepareEdit(cursors[i].selectionStart(), cursors[i].selectionEnd());
+        edit(cursors[i], i);
+    }
+    m_undoManager->endGroup();
+    setCursors(cursors, primary);
+    ensureCursorVisible();
+}
+
+void CodeEditor::moveCursors(QTextCursor::MoveOperation operation, QTextCursor::MoveMode mode)
+{
+    int primary = 0;
+    QList<QTextCursor> cursors = allCursors(&primary);
+    for (QTextCursor &cursor : cursors)
+        cursor.movePosition(operation, mode);
+    setCursors(cursors, primary);
+    ensureCursorVisible();
+}
+
+void CodeEditor::addCursorOnAdjacentLine(int direction)
+{
+    int primary = 0;
+    QList<QTextCursor> cursors = allCursors(&primary);
+    if (m_extraCursors.isEmpty())
+        m_cursorColumn = textCursor().positionInBlock();
+
+    const QTextBlock edge = direction < 0 ? cursors.first().block() : cursors.last().block();
+    const QTextBlock block = direction < 0 ? edge.previous() : edge.next();
+    if (!block.isValid())
+        return;
+
+    QTextCursor cursor(block);
+    cursor.setPosition(block.position() + qMin(m_cursorColumn, block.length() - 1));
+    cursors.append(cursor);
+    setCursors(cursors, int(cursors.size()) - 1);
+    ensureCursorVisible();
+}
+
+void CodeEditor::selectNextOccurrence()
+{
+    QTextCursor cursor = textCursor();
+    if (!cursor.hasSelection())
+    {
+        cursor.select(QTextCursor::WordUnderCursor);
+        if (cursor.hasSelection())
+            setTextCursor(cursor);
+        return;
+    }
+
+    // 从最后一个光标之后开始查找，到文末后回到开头
+    const QString text = cursor.selectedText();
+    int primary = 0;
+    QList<QTextCursor> cursors = allCursors(&primary);
+    QTextCursor found = document()->find(text, cursors.last().selectionEnd(), QTextDocument::FindCaseSensitively);
+    if (found.isNull())
+        found = document()->find(text, 0, QTextDocument::FindCaseSensitively);
+    if (found.isNull())
+        return;
+    for (const QTextCursor &existing : cursors)
+    {
+        if (existing.selectionStart() == found.selectionStart())
+            return;
+    }
+
+    cursors.append(found);
+    setCursors(cursors, int(cursors.size()) - 1);
+    ensureCursorVisible();
+}
+
+bool CodeEditor::handleMultiCursorKey(QKeyEvent *e)
+{
+    const Qt::KeyboardModifiers modifiers = e->modifiers() & ~Qt::KeypadModifier;
+    if (e->key() == Qt::Key_D && modifiers == Qt::ControlModifier)
+    {
+        LatencyScope scope("selectNext", m_traceTrack);
+        selectNextOccurrence();
+        return true;
+    }
+    if ((e->key() == Qt::Key_Up || e->key() == Qt::Key_Down) && modifiers == (Qt::ControlModifier | Qt::AltModifier))
+    {
+        addCursorOnAdjacentLine(e->key() == Qt::Key_Up ? -1 : 1);
+        return true;
+    }
+    if (m_extraCursors.isEmpty())
+        return false;
+
+    switch (e->key())
+    {
+    case Qt::Key_Shift:
+    case Qt::Key_Control:
+    case Qt::Key_Alt:
+    case Qt::Key_Meta:
+        return false;
+    case Qt::Key_Escape:
+        clearExtraCursors();
+        return true;
+    default:
+        break;
+    }
+
+    LatencyScope scope("multiCursor", m_traceTrack);
+    int primary = 0;
+    if (e->matches(QKeySequence::Copy) || e->matches(QKeySequence::Cut))
+    {
+        // 各选区按光标顺序逐行拼接
+        QStringList parts;
+        const QList<QTextCursor> cursors = allCursors(&primary);
+        for (const QTextCursor &cursor : cursors)
+        {
+            if (cursor.hasSelection())
+                parts.append(cursor.selectedText().replace(QChar::ParagraphSeparator, QLatin1Char('\n')));
+        }
+        if (!parts.isEmpty())
+            QApplication::clipboard()->setText(parts.join(QLatin1Char('\n')));
+        if (e->matches(QKeySequence::Cut) && !isReadOnly())
+            editAtCursors([](QTextCursor &cursor, int) { cursor.removeSelectedText(); });
+        return true;
+    }
+    if (e->matches(QKeySequence::Paste))
+    {
+        // 剪贴板的行数与光标数相同时每个光标各粘贴一行，否则每处都粘贴全部内容
+        if (isReadOnly())
+            return true;
+        const QString text = QApplication::clipboard()->text();
+        const QStringList lines = text.split(QLatin1Char('\n'));
+        const bool distribute = lines.size() == m_extraCursors.size() + 1;
+        editAtCursors([&](QTextCursor &cursor, int index) {
+            cursor.insertText(distribute ? lines.at(index) : text);
+        });
+        return true;
+    }
+
+    const QTextCursor::MoveMode mode = (modifiers & Qt::ShiftModifier) ? QTextCursor::KeepAnchor : QTextCursor::MoveAnchor;
+    const bool byWord = modifiers & Qt::ControlModifier;
+    switch (e->key())
+    {
+    case Qt::Key_Left:
+        moveCursors(byWord ? QTextCursor::WordLeft : QTextCursor::Left, mode);
+        return true;
+    case Qt::Key_Right:
+        moveCursors(byWord ? QTextCursor::NextWord : QTextCursor::Right, mode);
+        return true;
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+        if (byWord)
+            break;
+        moveCursors(e->key() == Qt::Key_Up ? QTextCursor::Up : QTextCursor::Down, mode);
+        return true;
+    case Qt::Key_Home:
+    case Qt::Key_End:
+        if (byWord)
+            break;
+        moveCursors(e->key() == Qt::Key_Home ? QTextCursor::StartOfBlock : QTextCursor::EndOfBlock, mode);
+        return true;
+    default:
+        break;
+    }
+
+    if (!isReadOnly() && !(modifiers & (Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier)))
+    {
+        switch (e->key())
+        {
+        case Qt::Key_Backspace:
+            editAtCursors([](QTextCursor &cursor, int) {
+                if (cursor.hasSelection())
+                    cursor.removeSelectedText();
+                else
+                    cursor.deletePreviousChar();
+            });
+            return true;
+        case Qt::Key_Delete:
+            editAtCursors([](QTextCursor &cursor, int) {
+                if (cursor.hasSelection())
+                    cursor.removeSelectedText();
+                else
+                    cursor.deleteChar();
+            });
+            return true;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            editAtCursors([](QTextCursor &cursor, int) { cursor.insertBlock(); });
+            return true;
+        case Qt::Key_Tab:
+            editAtCursors([](QTextCursor &cursor, int) { cursor.insertText(QStringLiteral("\t")); });
+            return true;
+        default:
+            break;
+        }
+
+        const QString text = e->text();
+        if (!text.isEmpty() && text.at(0).isPrint())
+        {
+            editAtCursors([&text](QTextCursor &cursor, int) { cursor.insertText(text); });
+            return true;
+        }
+    }
+
+    // 其余按键（翻页、全选、撤销等）只作用于主光标
+    clearExtraCursors();
+    return false;
+}
+
+void CodeEditor::mousePressEvent(QMouseEvent *e)
+{
+    const QPoint pos = e->position().toPoint();
+    if (e->button() == Qt::LeftButton && e->modifiers() == (Qt::AltModifier | Qt::ShiftModifier))
+    {
+        m_columnSelecting = true;
+        m_columnAnchorBlock = cursorForPosition(pos).blockNumber();
+        m_columnAnchorColumn = columnAt(pos.x());
+        updateColumnSelection(pos);
+        e->accept();
+        return;
+    }
+    if (e->button() == Qt::LeftButton && e->modifiers() == Qt::AltModifier)
+    {
+        // 点在已有光标上时移除它，否则在该处添加光标并设为主光标
+        const QTextCursor cursor = cursorForPosition(pos);
+        int primary = 0;
+        QList<QTextCursor> cursors = allCursors(&primary);
+        for (int i = 0; i < cursors.size(); ++i)
+        {
+            if (cursors.at(i).position() != cursor.position() || cursors.size() == 1)
+                continue;
+            cursors.removeAt(i);
+            if (i < primary || primary == cursors.size())
+                --primary;
+            setCursors(cursors, primary);
+            e->accept();
+            return;
+        }
+        cursors.append(cursor);
+        setCursors(cursors, int(cursors.size()) - 1);
+        e->accept();
+        return;
+    }
+    if (e->button() == Qt::LeftButton)
+        clearExtraCursors();
+    QPlainTextEdit::mousePressEvent(e);
+}
+
+void CodeEditor::mouseMoveEvent(QMouseEvent *e)
+{
+    if (m_columnSelecting && (e->buttons() & Qt::LeftButton))
+    {
+        updateColumnSelection(e->position().toPoint());
+        e->accept();
+        return;
+    }
+    QPlainTextEdit::mouseMoveEvent(e);
+}
+
+void CodeEditor::mouseReleaseEvent(QMouseEvent *e)
+{
+    if (m_columnSelecting && e->button() == Qt::LeftButton)
+    {
+        m_columnSelecting = false;
+        e->accept();
+        return;
+    }
+    QPlainTextEdit::mouseReleaseEvent(e);
+}
+
+int CodeEditor::columnAt(int x) const
+{
+    // 按等宽字体换算，制表符按一列计
+    const qreal offset = x - contentOffset().x() - document()->documentMargin();
+    return qMax(0, qRound(offset / fontMetrics().horizontalAdvance(QLatin1Char(' '))));
+}
+
+void CodeEditor::updateColumnSelection(const QPoint &pos)
+{
+    // 锚点与当前位置围成的矩形内每行一个光标，短于起始列的行光标停在行尾
+    const int block = cursorForPosition(pos).blockNumber();
+    const int column = columnAt(pos.x());
+    const int first = qMin(block, m_columnAnchorBlock);
+    const int last = qMax(block, m_columnAnchorBlock);
+
+    QList<QTextCursor> cursors;
+    int primary = 0;
+    int number = first;
+    for (QTextBlock b = document()->findBlockByNumber(first); b.isValid() && number <= last; b = b.next(), ++number)
+    {
+        const int length = b.length() - 1;
+        QTextCursor cursor(b);
+        cursor.setPosition(b.position() + qMin(m_columnAnchorColumn, length));
+        cursor.setPosition(b.position() + qMin(column, length), QTextCursor::KeepAnchor);
+        if (number == block)
+            primary = int(cursors.size());
+        cursors.append(cursor);
+    }
+    if (!cursors.isEmpty())
+        setCursors(cursors, primary);
+}
+
+void CodeEditor::paintExtraCursors()
+{
+    // 只绘制视口内的附加光标
+    int from = 0;
+    int to = 0;
+    visiblePositionRange(&from, &to);
+    QTextCursor probe(document());
+    probe.setPosition(from);
+
+    QPainter painter(viewport());
+    auto it = std::lower_bound(m_extraCursors.cbegin(), m_extraCursors.cend(), probe, byPosition);
+    for (; it != m_extraCursors.cend() && it->position() <= to; ++it)
+    {
+        const QRect rect = cursorRect(*it);
+        painter.fillRect(rect.x(), rect.y(), qMax(1, cursorWidth()), rect.height(), EditorTheme::foreground);
+    }
+}
+
+// ============ 大段插入 ============
+bool CodeEditor::canInsertFromMimeData(const QMimeData *source) const
+{
+    if (source->hasUrls())
+    {
+        const QList<QUrl> urls = source->urls();
+        for (const QUrl &url : urls)
+        {
+            if (url.isLocalFile())
+                return true;
+        }
+    }
+    return QPlainTextEdit::canInsertFromMimeData(source);
+}
+
+void CodeEditor::insertFromMimeData(const QMimeData *source)
+{
+    // 上一次插入完成之前不接受新的插入
+    if (m_pasteLoader)
+        return;
+    // 拖放时文档可能已删去原处的选区（尚未通知），不能在此重新记录
+    if (!m_dropping)
+        prepareEdit();
+
+    // 拖放的本地文件插入其内容；大文件交给常规的打开流程，在新 Tab 中以大文件模式打开
+    QStringList filePaths;
+    QStringList largeFiles;
+    if (source->hasUrls())
+    {
+        const QList<QUrl> urls = source->urls();
+        for (const QUrl &url : urls)
+        {
+            const QFileInfo fileInfo(url.toLocalFile());
+            if (!url.isLocalFile() || !fileInfo.isFile())
+                continue;
+            if (fileInfo.size() >= LargeDropBytes)
+                largeFiles.append(fileInfo.filePath());
+            else
+                filePaths.append(fileInfo.filePath());
+        }
+    }
+    if (!largeFiles.isEmpty())
+        emit openFilesRequested(largeFiles);
+    if (!filePaths.isEmpty())
+        startInsert(new PasteLoader(filePaths, this));
+    if (!filePaths.isEmpty() || !largeFiles.isEmpty())
+        return;
+
+    if (source->hasText())
+    {
+        const QString text = source->text();
+        if (text.size() >= LargeInsertChars)
+        {
+            startInsert(new PasteLoader(text, this));
+            return;
+        }
+    }
+    QPlainTextEdit::insertFromMimeData(source);
+}
+
+void CodeEditor::dropEvent(QDropEvent *e)
+{
+    // 在编辑器内拖动选中的文字时，原处选区的删除与落点的插入合并为一次通知，
+    // 因此从选区到落点整段记下修改前的内容
+    if (!m_pasteLoader)
+    {
+        int from = cursorForPosition(e->position().toPoint()).position();
+        int to = from;
+        if (e->source() == this || e->source() == viewport())
+        {
+            const QTextCursor cursor = textCursor();
+            from = qMin(from, cursor.selectionStart());
+            to = qMax(to, cursor.selectionEnd());
+        }
+        m_undoManager->prepareEdit(from, to);
+    }
+    m_dropping = true;
+    QPlainTextEdit::dropEvent(e);
+    m_dropping = false;
+}
+
+void CodeEditor::prepareEdit()
+{
+    const QTextCursor cursor = textCursor();
+    m_undoManager->prepareEdit(cursor.selectionStart(), cursor.selectionEnd());
+}
+
+void CodeEditor::startInsert(PasteLoader *loader)
+{
+    clearExtraCursors();
+    m_pasteLoader = loader;
+    m_insertRevision = document()->revision();
+
+    // 插入期间只读：各块的修改在撤销历史中是一组，不能混入其他编辑
+    setReadOnly(true);
+    m_undoManager->beginGroup();
+    m_insertCursor = textCursor();
+    m_insertCursor.removeSelectedText();
+
+    connect(loader, &PasteLoader::chunkReady, this, [this, loader](const QString &text) {
+        if (m_pasteLoader != loader || loader->isCancelled())
+            return;
+        LatencyScope scope("insertChunk", m_traceTrack);
+        m_insertCursor.insertText(text);
+        loader->chunkConsumed();
+    });
+    connect(loader, &PasteLoader::progress, this, [this, loader](qint64 done, qint64 total) {
+        if (m_pasteLoader == loader)
+            emit insertProgress(done, total);
+    });
+    connect(loader, &PasteLoader::finished, this, [this, loader]() {
+        if (m_pasteLoader != loader)
+            return;
+        const qint64 lineCount = loader->lineCount();
+        const QStringList skippedFiles = loader->skippedFiles();
+        // 拖放的文件全是二进制文件时什么也没插入，还原被替换的选区
+        finishInsert(lineCount == 0 && !skippedFiles.isEmpty());
+        emit insertFinished(lineCount, skippedFiles);
+    });
+    connect(loader, &PasteLoader::failed, this, [this, loader](const QString &error) {
+        if (m_pasteLoader != loader)
+            return;
+        finishInsert(true);
+        emit insertFailed(error);
+    });
+
+    emit insertProgress(0, 0);
+    loader->start();
+}
+
+void CodeEditor::cancelInsert()
+{
+    if (m_pasteLoader)
+        finishInsert(true);
+}
+
+void CodeEditor::finishInsert(bool rollBack)
+{
+    // 可能在加载器自己的信号中调用，延后删除
+    PasteLoader *loader = m_pasteLoader;
+    m_pasteLoader = nullptr;
+    loader->cancel();
+    loader->deleteLater();
+
+    m_undoManager->endGroup();
+    setReadOnly(false);
+
+    if (rollBack)
+    {
+        // 已插入的部分（以及被替换的选区）作为一组整体撤销
+        if (document()->revision() != m_insertRevision)
+            m_undoManager->undo();
+    }
+    else
+    {
+        setTextCursor(m_insertCursor);
+        ensureCursorVisible();
+    }
+    m_insertCursor = QTextCursor();
+    emit insertEnded();
+}
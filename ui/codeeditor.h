@@ -1,9 +1,23 @@
 #ifndef CODEEDITOR_H
 #define CODEEDITOR_H
 
+#include <QCache>
 #include <QPlainTextEdit>
+#include <QStaticText>
+#include <QStringList>
+#include <QTimer>
+#include <QVarLengthArray>
+#include <functional>
+#include "../core/latencytrace.h"
 
+class QPainter;
+class DocumentStatistics;
 class LineNumberArea;
+class MarkdownHighlighter;
+class PasteLoader;
+class Minimap;
+class SpellChecker;
+class UndoManager;
 
 class CodeEditor : public QPlainTextEdit
 {
@@ -13,18 +27,148 @@ public:
     explicit CodeEditor(QWidget *parent = nullptr);
 
     void lineNumberAreaPaintEvent(QPaintEvent *event);
-    int lineNumberAreaWidth();
+    int lineNumberAreaWidth() const { return m_lineNumberAreaWidth; }
+
+    // 行号均从 0 开始。QTextDocument 的块表是随编辑增量维护的平衡树，
+    // 按行号或字符位置查找都是 O(log n)，这里直接用它作为行索引
+    int lineCount() const { return blockCount(); }
+    void goToLine(int line);
+
+    // 当前视口内首末文本块的块号
+    void visibleBlockRange(int *first, int *last) const;
+
+    MarkdownHighlighter *highlighter() const { return m_highlighter; }
+    // 取代 QTextDocument 自带撤销栈的撤销历史
+    UndoManager *undoManager() const { return m_undoManager; }
+
+    // 视口右侧的文档缩略图，默认隐藏
+    Minimap *minimap() const { return m_minimap; }
+    void setMinimapVisible(bool visible);
+
+    // 随编辑增量维护的字数统计
+    DocumentStatistics *statistics() const { return m_statistics; }
+    // 后台拼写检查，默认关闭
+    SpellChecker *spellChecker() const { return m_spellChecker; }
+
+    // 查找结果等附加高亮，与当前行高亮合并显示
+    void setSearchSelections(const QList<QTextEdit::ExtraSelection> &selections);
+    // 拼写错误的波浪下划线，由 SpellChecker 设置
+    void setSpellSelections(const QList<QTextEdit::ExtraSelection> &selections);
+
+    // 主光标之外的附加光标：Alt+单击添加，Alt+Shift+拖动列选择，Ctrl+Alt+上/下在相邻行添加，
+    // Ctrl+D 选中下一处相同文本；Esc 或普通单击清除
+    bool hasExtraCursors() const { return !m_extraCursors.isEmpty(); }
+    void clearExtraCursors();
+    void selectNextOccurrence();
+
+    // 输入延迟：从按键事件到其结果绘制到视口的时间；绘制耗时：单次视口重绘的时间。
+    // 每个编辑器（即每个 Tab）各自统计
+    const LatencyHistogram &inputLatency() const { return m_inputLatency; }
+    const LatencyHistogram &paintLatency() const { return m_paintLatency; }
+    void resetLatency();
+    // 在导出的时间线中对应的行
+    quint32 traceTrack() const { return m_traceTrack; }
+
+    // 大段粘贴与拖放文件在后台准备、分块插入，期间编辑器只读，整个插入记为一组撤销步骤
+    bool isInserting() const { return m_pasteLoader != nullptr; }
+    // 放弃插入并撤销已插入的部分
+    void cancelInsert();
+
+signals:
+    void insertProgress(qint64 done, qint64 total);
+    // skippedFiles 为拖放文件中作为二进制文件跳过的文件
+    void insertFinished(qint64 lineCount, const QStringList &skippedFiles);
+    void insertFailed(const QString &error);
+    // 插入结束（完成、失败或取消），编辑器恢复可写
+    void insertEnded();
+    // 拖放的文件过大，应作为新 Tab 打开而不是插入
+    void openFilesRequested(const QStringList &filePaths);
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+    void inputMethodEvent(QInputMethodEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    bool canInsertFromMimeData(const QMimeData *source) const override;
+    void insertFromMimeData(const QMimeData *source) override;
+    void dropEvent(QDropEvent *event) override;
 
 private slots:
     void updateLineNumberAreaWidth(int newBlockCount);
     void highlightCurrentLine();
     void updateLineNumberArea(const QRect &rect, int dy);
+    void updateOccurrences();
 
 private:
+    void updateDigitCache();
+    void updateViewportMargins();
+    void drawLineNumber(QPainter &painter, int number, int right, int top);
+    void beginInput(qint64 start, int revision, int position);
+    void visiblePositionRange(int *from, int *to) const;
+
+    // 光标处单词的其他出现位置：只扫描视口及上下各一屏，按单词缓存
+    struct Occurrences
+    {
+        int revision = -1;
+        int firstBlock = 0;
+        int lastBlock = -1;
+        QVector<int> starts;
+    };
+    QString occurrenceKey(const QTextCursor &cursor) const;
+    const Occurrences *findOccurrences(const QString &key, int firstBlock, int lastBlock);
+
+    // 多光标
+    bool handleMultiCursorKey(QKeyEvent *event);
+    QList<QTextCursor> allCursors(int *primary) const;   // 按位置排序，primary 返回主光标的下标
+    void setCursors(const QList<QTextCursor> &cursors, int primary);
+    void editAtCursors(const std::function<void(QTextCursor &cursor, int index)> &edit);
+    void moveCursors(QTextCursor::MoveOperation operation, QTextCursor::MoveMode mode);
+    void addCursorOnAdjacentLine(int direction);
+    void updateColumnSelection(const QPoint &pos);
+    int columnAt(int x) const;
+    void paintExtraCursors();
+
+    // 记下主光标一带修改前的文本，撤销历史从中取得被删除的内容
+    void prepareEdit();
+    void startInsert(PasteLoader *loader);
+    void finishInsert(bool rollBack);
+
     QWidget *m_lineNumberArea;
+    int m_lineNumberAreaWidth;
+    int m_digitWidth;
+    QStaticText m_digits[10];   // 预排版的 0-9，绘制行号时不再构造字符串
+    MarkdownHighlighter *m_highlighter;
+    UndoManager *m_undoManager;
+    Minimap *m_minimap;
+    DocumentStatistics *m_statistics;
+    SpellChecker *m_spellChecker;
+    QList<QTextEdit::ExtraSelection> m_searchSelections;
+    QList<QTextEdit::ExtraSelection> m_spellSelections;
+
+    QTimer m_occurrenceTimer;
+    QString m_occurrenceKey;                        // 当前高亮的单词，为空时不高亮
+    QCache<QString, Occurrences> m_occurrenceCache;
+
+    QList<QTextCursor> m_extraCursors;   // 按位置排序，不含主光标
+    int m_cursorColumn;                  // Ctrl+Alt+上/下添加光标时保持的列
+    bool m_columnSelecting;
+    int m_columnAnchorBlock;
+    int m_columnAnchorColumn;
+
+    PasteLoader *m_pasteLoader;   // 正在进行的大段插入，没有时为 nullptr
+    QTextCursor m_insertCursor;   // 插入点，随每块插入前移
+    int m_insertRevision;         // 开始插入时的文档版本
+    bool m_dropping;              // 正在处理拖放，修改前的窗口已由 dropEvent 记下
+
+    LatencyHistogram m_inputLatency;
+    LatencyHistogram m_paintLatency;
+    QVarLengthArray<qint64, 16> m_pendingInputs;   // 已处理但尚未绘制的输入事件的时间戳
+    quint32 m_traceTrack;
 };
 
 class LineNumberArea : public QWidget
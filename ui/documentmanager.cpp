@@ -0,0 +1,218 @@
+#include "documentmanager.h"
+#include "codeeditor.h"
+#include "undomanager.h"
+#include <QScrollBar>
+#include <QTextDocument>
+#include <algorithm>
+
+namespace {
+    // 常驻文档每个字符的估算内存：UTF-16 文本、块与排版信息、高亮格式
+    const qint64 BytesPerChar = 6;
+    // 编辑停止后多久重新检查预算
+    const int EnforceDelayMs = 1000;
+}
+
+DocumentManager::DocumentManager(QObject* parent)
+    : QObject(parent)
+    , m_active(nullptr)
+    , m_tick(0)
+    , m_budget(256LL * 1024 * 1024)
+{
+    m_enforceTimer.setSingleShot(true);
+    m_enforceTimer.setInterval(EnforceDelayMs);
+    connect(&m_enforceTimer, &QTimer::timeout, this, &DocumentManager::enforceBudget);
+}
+
+void DocumentManager::setMemoryBudget(qint64 bytes)
+{
+    m_budget = qMax<qint64>(0, bytes);
+    enforceBudget();
+}
+
+void DocumentManager::addEditor(CodeEditor* editor)
+{
+    Entry entry;
+    entry.lastUsed = ++m_tick;
+    m_entries.insert(editor, entry);
+
+    connect(editor->document(), &QTextDocument::contentsChanged, &m_enforceTimer, qOverload<>(&QTimer::start));
+    m_enforceTimer.start();
+}
+
+void DocumentManager::removeEditor(CodeEditor* editor)
+{
+    if (!m_entries.remove(editor))
+        return;
+
+    disconnect(editor->document(), nullptr, &m_enforceTimer, nullptr);
+    if (m_active == editor)
+        m_active = nullptr;
+    emit statsChanged();
+}
+
+void DocumentManager::activate(CodeEditor* editor)
+{
+    auto it = m_entries.find(editor);
+    if (it == m_entries.end())
+        return;
+
+    m_active = editor;
+    it->lastUsed = ++m_tick;
+    if (it->dehydrated)
+        rehydrate(editor, *it);
+
+    enforceBudget();
+}
+
+bool DocumentManager::isDehydrated(CodeEditor* editor) const
+{
+    auto it = m_entries.constFind(editor);
+    return it != m_entries.constEnd() && it->dehydrated;
+}
+
+QString DocumentManager::text(CodeEditor* editor) const
+{
+    auto it = m_entries.constFind(editor);
+    if (it != m_entries.constEnd() && it->dehydrated)
+        return QString::fromUtf8(qUncompress(it->snapshot));
+    return editor->toPlainText();
+}
+
+bool DocumentManager::isModified(CodeEditor* editor) const
+{
+    auto it = m_entries.constFind(editor);
+    if (it != m_entries.constEnd() && it->dehydrated)
+        return it->modified;
+    return editor->document()->isModified();
+}
+
+DocumentManager::ViewState DocumentManager::viewState(CodeEditor* editor) const
+{
+    auto it = m_entries.constFind(editor);
+    if (it != m_entries.constEnd() && it->dehydrated)
+        return it->view;
+    return captureViewState(editor);
+}
+
+void DocumentManager::applyViewState(CodeEditor* editor, const ViewState& state)
+{
+    const int last = editor->document()->characterCount() - 1;
+    QTextCursor cursor(editor->document());
+    cursor.setPosition(qBound(0, state.anchor, last));
+    cursor.setPosition(qBound(0, state.position, last), QTextCursor::KeepAnchor);
+    editor->setTextCursor(cursor);
+    editor->verticalScrollBar()->setValue(state.verticalScroll);
+    editor->horizontalScrollBar()->setValue(state.horizontalScroll);
+}
+
+int DocumentManager::residentCount() const
+{
+    int count = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        count += it->dehydrated ? 0 : 1;
+    return count;
+}
+
+int DocumentManager::dehydratedCount() const
+{
+    return m_entries.size() - residentCount();
+}
+
+qint64 DocumentManager::residentBytes() const
+{
+    qint64 bytes = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+    {
+        if (!it->dehydrated)
+            bytes += estimatedBytes(it.key());
+    }
+    return bytes;
+}
+
+qint64 DocumentManager::dehydratedBytes() const
+{
+    qint64 bytes = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        bytes += it->snapshot.size();
+    return bytes;
+}
+
+void DocumentManager::enforceBudget()
+{
+    qint64 resident = residentBytes();
+    if (resident > m_budget)
+    {
+        QVector<CodeEditor*> candidates;
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        {
+            CodeEditor* editor = it.key();
+            if (it->dehydrated || editor == m_active)
+                continue;
+            if (m_canDehydrate && !m_canDehydrate(editor))
+                continue;
+            candidates.append(editor);
+        }
+
+        // 有撤销历史的 Tab 更可能继续编辑，优先脱水没有撤销历史的 Tab，其次按最近使用时间
+        std::sort(candidates.begin(), candidates.end(), [this](CodeEditor* a, CodeEditor* b) {
+            bool undoA = a->undoManager()->canUndo();
+            bool undoB = b->undoManager()->canUndo();
+            if (undoA != undoB)
+                return !undoA;
+            return m_entries.value(a).lastUsed < m_entries.value(b).lastUsed;
+        });
+
+        for (CodeEditor* editor : std::as_const(candidates))
+        {
+            if (resident <= m_budget)
+                break;
+            resident -= estimatedBytes(editor);
+            dehydrate(editor, m_entries[editor]);
+            emit editorDehydrated(editor);
+        }
+    }
+
+    emit statsChanged();
+}
+
+qint64 DocumentManager::estimatedBytes(CodeEditor* editor)
+{
+    return qint64(editor->document()->characterCount()) * BytesPerChar + editor->undoManager()->memoryUsage();
+}
+
+DocumentManager::ViewState DocumentManager::captureViewState(CodeEditor* editor)
+{
+    ViewState state;
+    QTextCursor cursor = editor->textCursor();
+    state.anchor = cursor.anchor();
+    state.position = cursor.position();
+    state.verticalScroll = editor->verticalScrollBar()->value();
+    state.horizontalScroll = editor->horizontalScrollBar()->value();
+    return state;
+}
+
+void DocumentManager::dehydrate(CodeEditor* editor, Entry& entry)
+{
+    entry.view = captureViewState(editor);
+    entry.modified = editor->document()->isModified();
+
+    // 压缩级别取 1，优先速度
+    entry.snapshot = qCompress(editor->toPlainText().toUtf8(), 1);
+    entry.dehydrated = true;
+
+    // 撤销历史保留在 UndoManager 中，恢复的文本与脱水前一致，历史中的位置仍然有效
+    editor->undoManager()->setEnabled(false);
+    editor->clearExtraCursors();
+    editor->clear();
+    editor->document()->setModified(false);
+}
+
+void DocumentManager::rehydrate(CodeEditor* editor, Entry& entry)
+{
+    editor->setPlainText(QString::fromUtf8(qUncompress(entry.snapshot)));
+    editor->undoManager()->setEnabled(true);
+    editor->document()->setModified(entry.modified);
+    entry.snapshot.clear();
+    entry.dehydrated = false;
+    applyViewState(editor, entry.view);
+}
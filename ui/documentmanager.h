@@ -0,0 +1,81 @@
+#ifndef DOCUMENTMANAGER_H
+#define DOCUMENTMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <functional>
+
+class CodeEditor;
+
+// 按内存预算管理普通 Tab 的文档：超出预算时，把最久未使用的非活动 Tab 脱水为
+// 压缩快照（连同光标、滚动位置与修改状态），Tab 被选中时再恢复
+class DocumentManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 光标与滚动位置
+    struct ViewState
+    {
+        int anchor = 0;
+        int position = 0;
+        int verticalScroll = 0;
+        int horizontalScroll = 0;
+    };
+
+    explicit DocumentManager(QObject* parent = nullptr);
+
+    qint64 memoryBudget() const { return m_budget; }
+    void setMemoryBudget(qint64 bytes);
+    // 返回 false 的编辑器不会被脱水（如正在加载或保存）
+    void setCanDehydrate(const std::function<bool(CodeEditor*)>& predicate) { m_canDehydrate = predicate; }
+
+    void addEditor(CodeEditor* editor);
+    void removeEditor(CodeEditor* editor);
+    // 标记为最近使用，已脱水的立即恢复，然后按预算脱水其他 Tab
+    void activate(CodeEditor* editor);
+    bool isDehydrated(CodeEditor* editor) const;
+    // 文档全文，已脱水时从快照解压
+    QString text(CodeEditor* editor) const;
+    // 修改状态与视图状态，已脱水时取自快照
+    bool isModified(CodeEditor* editor) const;
+    ViewState viewState(CodeEditor* editor) const;
+    static void applyViewState(CodeEditor* editor, const ViewState& state);
+
+    int residentCount() const;
+    int dehydratedCount() const;
+    qint64 residentBytes() const;
+    qint64 dehydratedBytes() const;
+
+public slots:
+    void enforceBudget();
+
+signals:
+    void editorDehydrated(CodeEditor* editor);
+    void statsChanged();
+
+private:
+    struct Entry
+    {
+        quint64 lastUsed = 0;
+        bool dehydrated = false;
+        QByteArray snapshot;      // 压缩后的 UTF-8 文本
+        ViewState view;
+        bool modified = false;
+    };
+
+    static qint64 estimatedBytes(CodeEditor* editor);
+    static ViewState captureViewState(CodeEditor* editor);
+    void dehydrate(CodeEditor* editor, Entry& entry);
+    void rehydrate(CodeEditor* editor, Entry& entry);
+
+    QHash<CodeEditor*, Entry> m_entries;
+    std::function<bool(CodeEditor*)> m_canDehydrate;
+    CodeEditor* m_active;
+    quint64 m_tick;
+    qint64 m_budget;
+    QTimer m_enforceTimer;
+};
+
+#endif // DOCUMENTMANAGER_H
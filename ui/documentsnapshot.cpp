@@ -0,0 +1,98 @@
+#include "documentsnapshot.h"
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+    // 每轮事件循环复制的字符数，约几毫秒
+    const int ChunkChars = 2 * 1024 * 1024;
+
+    // 与 toPlainText() 的结果一致：段落与行分隔符换成换行，不换行空格换成空格
+    void toPlainChars(QChar* data, qsizetype from, qsizetype to)
+    {
+        for (qsizetype i = from; i < to; ++i)
+        {
+            if (data[i] == QChar::ParagraphSeparator || data[i] == QChar::LineSeparator)
+                data[i] = QLatin1Char('\n');
+            else if (data[i] == QChar::Nbsp)
+                data[i] = QLatin1Char(' ');
+        }
+    }
+}
+
+DocumentSnapshot::DocumentSnapshot(QTextDocument* document, QObject* parent)
+    : QObject(parent)
+    , m_document(document)
+    , m_copied(0)
+    , m_lastRevision(document->revision())
+{
+    m_chunkTimer.setSingleShot(true);
+    m_chunkTimer.setInterval(0);
+    connect(&m_chunkTimer, &QTimer::timeout, this, &DocumentSnapshot::copyChunk);
+    connect(document, &QTextDocument::contentsChange, this, &DocumentSnapshot::onContentsChange);
+}
+
+void DocumentSnapshot::start()
+{
+    m_text.reserve(m_document->characterCount());
+    copyChunk();
+}
+
+void DocumentSnapshot::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // 高亮等只改格式的通知不改变文档版本
+    const int revision = m_document->revision();
+    if (charsRemoved == charsAdded && revision == m_lastRevision)
+        return;
+    m_lastRevision = revision;
+    if (position >= m_copied)
+        return;
+
+    // 修改完全落在已复制部分之内（不含 m_copied 之前的段落分隔符）时，把它同步到副本中，
+    // 持续在文档开头一带输入也不会让复制无法完成
+    if (position + charsRemoved < m_copied)
+    {
+        QTextCursor cursor(m_document);
+        cursor.setPosition(position);
+        cursor.setPosition(position + charsAdded, QTextCursor::KeepAnchor);
+        QString inserted = cursor.selectedText();
+        toPlainChars(inserted.data(), 0, inserted.size());
+        m_text.replace(position, charsRemoved, inserted);
+        m_copied += charsAdded - charsRemoved;
+        return;
+    }
+
+    // 修改越过了已复制的末尾：从修改位置所在块的起点继续复制
+    m_copied = m_document->findBlock(position).position();
+    m_text.truncate(m_copied);
+}
+
+void DocumentSnapshot::copyChunk()
+{
+    if (!m_document)
+        return;
+
+    // 已复制部分没有被修改过，m_copied 仍是一个块的起点
+    QTextBlock block = m_document->findBlock(m_copied);
+    const qsizetype from = m_text.size();
+    const qsizetype target = from + ChunkChars;
+    while (block.isValid() && m_text.size() < target)
+    {
+        m_text += block.text();
+        if (block.next().isValid())
+            m_text += QLatin1Char('\n');
+        m_copied = block.position() + block.length();
+        block = block.next();
+    }
+
+    toPlainChars(m_text.data(), from, m_text.size());
+
+    if (block.isValid())
+    {
+        m_chunkTimer.start();
+        return;
+    }
+
+    disconnect(m_document, nullptr, this, nullptr);
+    emit finished(m_text, m_document->revision());
+}
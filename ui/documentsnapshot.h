@@ -0,0 +1,39 @@
+#ifndef DOCUMENTSNAPSHOT_H
+#define DOCUMENTSNAPSHOT_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+class QTextDocument;
+
+// 在 GUI 线程分块复制文档全文（QTextDocument 只能在 GUI 线程读取）：每轮事件循环复制一段块，
+// 大文档保存时界面不会卡在一次完整的复制上。已复制部分的修改直接同步到副本中，
+// 未复制部分的修改随后一并复制，因此完成时的文本与版本号对应同一时刻的文档
+class DocumentSnapshot : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentSnapshot(QTextDocument* document, QObject* parent = nullptr);
+
+    // 不超过一段的文档在 start() 中直接完成
+    void start();
+
+signals:
+    void finished(const QString& text, int revision);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void copyChunk();
+
+private:
+    QPointer<QTextDocument> m_document;
+    QString m_text;
+    int m_copied;         // 已复制到的文档位置（下一个块的起点）
+    int m_lastRevision;
+    QTimer m_chunkTimer;
+};
+
+#endif // DOCUMENTSNAPSHOT_H
@@ -0,0 +1,149 @@
+#include "documentstatistics.h"
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+    // 一个块的计数；加入与析构时分别把自己计入、移出总数
+    class BlockStats : public QTextBlockUserData
+    {
+    public:
+        BlockStats(const std::shared_ptr<TextStats>& total, const TextStats& stats)
+            : m_total(total)
+            , m_stats(stats)
+        {
+            *m_total += m_stats;
+        }
+
+        ~BlockStats() override
+        {
+            *m_total -= m_stats;
+        }
+
+        const TextStats& stats() const { return m_stats; }
+
+        void setStats(const TextStats& stats)
+        {
+            *m_total -= m_stats;
+            m_stats = stats;
+            *m_total += m_stats;
+        }
+
+    private:
+        std::shared_ptr<TextStats> m_total;
+        TextStats m_stats;
+    };
+
+    BlockStats* blockStats(const QTextBlock& block)
+    {
+        return dynamic_cast<BlockStats*>(block.userData());
+    }
+}
+
+// ============ DocumentStatistics 实现 ============
+DocumentStatistics::DocumentStatistics(QTextDocument* document, QObject* parent)
+    : QObject(parent)
+    , m_document(document)
+    , m_total(std::make_shared<TextStats>())
+    , m_generation(0)
+    , m_lastRevision(document->revision())
+    , m_cachedGeneration(-1)
+    , m_cachedFirst(-1)
+    , m_cachedLast(-1)
+{
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+        block.setUserData(new BlockStats(m_total, TextStats::count(block.text())));
+
+    connect(document, &QTextDocument::contentsChange, this, &DocumentStatistics::onContentsChange);
+}
+
+void DocumentStatistics::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // 高亮等只改格式的通知不改变文档版本，也不影响选区缓存
+    const int revision = m_document->revision();
+    if (charsRemoved != charsAdded || revision != m_lastRevision)
+        ++m_generation;
+    m_lastRevision = revision;
+
+    // 被删除的块已随块析构移出总数；只需重新计数编辑后覆盖修改区间的块
+    const TextStats before = *m_total;
+    QTextBlock block = m_document->findBlock(position);
+    const QTextBlock last = m_document->findBlock(qMin(position + charsAdded, m_document->characterCount() - 1));
+    for (; block.isValid(); block = block.next())
+    {
+        const TextStats stats = TextStats::count(block.text());
+        if (BlockStats* data = blockStats(block))
+            data->setStats(stats);
+        else
+            block.setUserData(new BlockStats(m_total, stats));
+        if (block == last)
+            break;
+    }
+
+    const TextStats& after = *m_total;
+    if (after.words != before.words || after.characters != before.characters)
+        emit changed();
+}
+
+TextStats DocumentStatistics::selection(const QTextCursor& cursor) const
+{
+    TextStats stats;
+    if (!cursor.hasSelection())
+        return stats;
+
+    const QTextBlock first = m_document->findBlock(cursor.selectionStart());
+    const QTextBlock last = m_document->findBlock(cursor.selectionEnd());
+    const int startColumn = cursor.selectionStart() - first.position();
+    const int endColumn = cursor.selectionEnd() - last.position();
+
+    if (first == last)
+        return TextStats::count(QStringView(first.text()).mid(startColumn, endColumn - startColumn));
+
+    // 中间整块为块号 [firstNumber + 1, lastNumber)；一端不变时只处理另一端移动经过的块，
+    // 移动距离超过整个区间时直接重新合计
+    const int firstNumber = first.blockNumber();
+    const int lastNumber = last.blockNumber();
+    const int span = lastNumber - firstNumber - 1;
+    if (m_cachedGeneration == m_generation && m_cachedFirst == firstNumber && m_cachedLast != lastNumber
+        && qAbs(lastNumber - m_cachedLast) < span)
+    {
+        if (lastNumber > m_cachedLast)
+            m_cachedMiddle += sumBlocks(qMax(m_cachedLast, firstNumber + 1), lastNumber);
+        else
+            m_cachedMiddle -= sumBlocks(qMax(lastNumber, firstNumber + 1), m_cachedLast);
+    }
+    else if (m_cachedGeneration == m_generation && m_cachedLast == lastNumber && m_cachedFirst != firstNumber
+             && qAbs(firstNumber - m_cachedFirst) < span)
+    {
+        if (firstNumber < m_cachedFirst)
+            m_cachedMiddle += sumBlocks(firstNumber + 1, qMin(m_cachedFirst + 1, lastNumber));
+        else
+            m_cachedMiddle -= sumBlocks(m_cachedFirst + 1, qMin(firstNumber + 1, lastNumber));
+    }
+    else if (m_cachedGeneration != m_generation || m_cachedFirst != firstNumber || m_cachedLast != lastNumber)
+    {
+        m_cachedMiddle = sumBlocks(firstNumber + 1, lastNumber);
+    }
+    m_cachedGeneration = m_generation;
+    m_cachedFirst = firstNumber;
+    m_cachedLast = lastNumber;
+
+    stats += TextStats::count(QStringView(first.text()).mid(startColumn));
+    stats += m_cachedMiddle;
+    stats += TextStats::count(QStringView(last.text()).left(endColumn));
+    return stats;
+}
+
+TextStats DocumentStatistics::sumBlocks(int from, int to) const
+{
+    TextStats stats;
+    QTextBlock block = m_document->findBlockByNumber(from);
+    for (int number = from; number < to && block.isValid(); ++number, block = block.next())
+    {
+        if (const BlockStats* data = blockStats(block))
+            stats += data->stats();
+        else
+            stats += TextStats::count(block.text());
+    }
+    return stats;
+}
@@ -0,0 +1,49 @@
+#ifndef DOCUMENTSTATISTICS_H
+#define DOCUMENTSTATISTICS_H
+
+#include <QObject>
+#include <memory>
+#include "../core/textstats.h"
+
+class QTextCursor;
+class QTextDocument;
+
+// 文档的字数统计，随编辑增量维护：每个文本块的计数缓存在块的 userData 中，
+// 编辑只重新计数被修改的块，并按新旧差值调整总数；被删除的块在析构时从总数中减去自己。
+// 每次按键的开销只与被修改的块的长度有关，与文档大小无关
+class DocumentStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentStatistics(QTextDocument* document, QObject* parent = nullptr);
+
+    TextStats total() const { return *m_total; }
+    // 选区的统计：中间的整块使用缓存，只对首尾的部分块重新计数。
+    // 中间整块的合计按首尾块号缓存，拖动选区时只累加或减去移动经过的块
+    TextStats selection(const QTextCursor& cursor) const;
+
+signals:
+    void changed();
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+    // 块号在 [from, to) 内的块的合计
+    TextStats sumBlocks(int from, int to) const;
+
+    QTextDocument* m_document;
+    // 与各块的缓存共享：文档可能晚于本对象销毁，块析构时仍需访问总数
+    std::shared_ptr<TextStats> m_total;
+    // 文本每次修改时递增，使选区缓存失效（撤销会让文档版本号回退，不能直接用）
+    int m_generation;
+    int m_lastRevision;
+    // 上一次选区中间整块（块号 (first, last) 之间）的合计
+    mutable int m_cachedGeneration;
+    mutable int m_cachedFirst;
+    mutable int m_cachedLast;
+    mutable TextStats m_cachedMiddle;
+};
+
+#endif // DOCUMENTSTATISTICS_H
@@ -0,0 +1,663 @@
+#include "findbar.h"
+#include "codeeditor.h"
+#include "undomanager.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QThread>
+#include <QToolButton>
+#include <QVBoxLayout>
+#include <algorithm>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace FindTheme {
+    const QColor backgroundDark(30, 31, 28);   // #1e1f1c
+    const QColor foregroundDim(117, 113, 94);  // #75715e
+    const QColor accent(249, 38, 114);         // #f92672 (pink)
+    const QColor match(102, 96, 52);           // 匹配高亮
+}
+
+namespace {
+    const int SearchDelayMs = 150;
+    // 全文结果每攒够这么多条或经过这么久就送回一次
+    const int BatchSize = 50000;
+    const int BatchIntervalMs = 50;
+    // 视口内最多设置的高亮数量
+    const int MaxHighlights = 2000;
+    // 不超过该数量的全部替换逐处编辑，否则整体替换首末匹配之间的文本
+    const int StepwiseReplaceLimit = 1000;
+
+    QToolButton* createToggle(const QString& text, const QString& toolTip, QWidget* parent)
+    {
+        QToolButton* button = new QToolButton(parent);
+        button->setText(text);
+        button->setToolTip(toolTip);
+        button->setCheckable(true);
+        button->setAutoRaise(true);
+        return button;
+    }
+
+    QToolButton* createButton(const QString& text, QWidget* parent)
+    {
+        QToolButton* button = new QToolButton(parent);
+        button->setText(text);
+        button->setAutoRaise(true);
+        return button;
+    }
+}
+
+FindBar::FindBar(QWidget* parent)
+    : QWidget(parent)
+    , m_worker(nullptr)
+    , m_cancelled(std::make_shared<std::atomic<bool>>(false))
+    , m_textRevision(-1)
+    , m_generation(0)
+    , m_searching(false)
+    , m_complete(false)
+    , m_pendingNavigate(0)
+{
+    setAutoFillBackground(true);
+    QPalette pal = palette();
+    pal.setColor(QPalette::Window, FindTheme::backgroundDark);
+    setPalette(pal);
+    setFont(QFont("SF Pro Text", 11));
+
+    m_findEdit = new QLineEdit(this);
+    m_findEdit->setPlaceholderText("Find");
+    m_findEdit->setClearButtonEnabled(true);
+    m_caseButton = createToggle("Aa", "Match Case", this);
+    m_wordButton = createToggle("W", "Whole Word", this);
+    m_regexButton = createToggle(".*", "Regular Expression", this);
+    m_countLabel = new QLabel(this);
+    m_countLabel->setMinimumWidth(110);
+    QPalette labelPal = m_countLabel->palette();
+    labelPal.setColor(QPalette::WindowText, FindTheme::foregroundDim);
+    m_countLabel->setPalette(labelPal);
+    QToolButton* previousButton = createButton("↑", this);
+    previousButton->setToolTip("Find Previous (Shift+Enter)");
+    QToolButton* nextButton = createButton("↓", this);
+    nextButton->setToolTip("Find Next (Enter)");
+    QToolButton* closeButton = createButton("×", this);
+    closeButton->setToolTip("Close (Esc)");
+
+    QHBoxLayout* findRow = new QHBoxLayout();
+    findRow->setSpacing(4);
+    findRow->addWidget(m_findEdit, 1);
+    findRow->addWidget(m_caseButton);
+    findRow->addWidget(m_wordButton);
+    findRow->addWidget(m_regexButton);
+    findRow->addWidget(m_countLabel);
+    findRow->addWidget(previousButton);
+    findRow->addWidget(nextButton);
+    findRow->addWidget(closeButton);
+
+    m_replaceRow = new QWidget(this);
+    m_replaceEdit = new QLineEdit(m_replaceRow);
+    m_replaceEdit->setPlaceholderText("Replace");
+    QToolButton* replaceButton = createButton("Replace", m_replaceRow);
+    QToolButton* replaceAllButton = createButton("Replace All", m_replaceRow);
+    QHBoxLayout* replaceRow = new QHBoxLayout(m_replaceRow);
+    replaceRow->setContentsMargins(0, 0, 0, 0);
+    replaceRow->setSpacing(4);
+    replaceRow->addWidget(m_replaceEdit, 1);
+    replaceRow->addWidget(replaceButton);
+    replaceRow->addWidget(replaceAllButton);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 4, 8, 4);
+    layout->setSpacing(4);
+    layout->addLayout(findRow);
+    layout->addWidget(m_replaceRow);
+
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(SearchDelayMs);
+
+    connect(&m_searchTimer, &QTimer::timeout, this, &FindBar::startSearch);
+    connect(m_findEdit, &QLineEdit::textChanged, this, &FindBar::scheduleSearch);
+    connect(m_caseButton, &QToolButton::toggled, this, &FindBar::scheduleSearch);
+    connect(m_wordButton, &QToolButton::toggled, this, &FindBar::scheduleSearch);
+    connect(m_regexButton, &QToolButton::toggled, this, &FindBar::scheduleSearch);
+    connect(m_findEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (QApplication::keyboardModifiers() & Qt::ShiftModifier)
+            findPrevious();
+        else
+            findNext();
+    });
+    connect(m_replaceEdit, &QLineEdit::returnPressed, this, &FindBar::replaceCurrent);
+    connect(previousButton, &QToolButton::clicked, this, &FindBar::findPrevious);
+    connect(nextButton, &QToolButton::clicked, this, &FindBar::findNext);
+    connect(closeButton, &QToolButton::clicked, this, &FindBar::hide);
+    connect(replaceButton, &QToolButton::clicked, this, &FindBar::replaceCurrent);
+    connect(replaceAllButton, &QToolButton::clicked, this, &FindBar::replaceAll);
+}
+
+FindBar::~FindBar()
+{
+    // 等待所有（包括已放弃的）工作线程退出，之后不会再有结果投递到这里
+    stopWorker();
+    const QList<QThread*> workers = findChildren<QThread*>(QString(), Qt::FindDirectChildrenOnly);
+    for (QThread* worker : workers)
+        worker->wait();
+}
+
+void FindBar::setEditor(CodeEditor* editor)
+{
+    if (editor == m_editor)
+        return;
+
+    stopWorker();
+    if (m_editor)
+    {
+        m_editor->setSearchSelections(QList<QTextEdit::ExtraSelection>());
+        disconnect(m_editor, nullptr, this, nullptr);
+        disconnect(m_editor->document(), nullptr, this, nullptr);
+        disconnect(m_editor->verticalScrollBar(), nullptr, this, nullptr);
+    }
+
+    m_editor = editor;
+    clearResults();
+
+    if (editor)
+    {
+        // 文档变化后旧结果的位置失效，先清除高亮再重新查找
+        connect(editor->document(), &QTextDocument::contentsChange, this, [this]() {
+            if (!isVisible() || m_findEdit->text().isEmpty())
+                return;
+            clearResults();
+            scheduleSearch();
+        });
+        connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &FindBar::updateHighlights);
+        connect(editor, &CodeEditor::cursorPositionChanged, this, &FindBar::updateCountLabel);
+    }
+
+    if (isVisible())
+        startSearch();
+    else
+        updateCountLabel();
+}
+
+void FindBar::showFind()
+{
+    m_replaceRow->hide();
+    show();
+
+    // 有选中的单行文本时用作查找内容
+    if (m_editor)
+    {
+        QString selected = m_editor->textCursor().selectedText();
+        if (!selected.isEmpty() && !selected.contains(QChar::ParagraphSeparator))
+            m_findEdit->setText(selected);
+    }
+    m_findEdit->setFocus();
+    m_findEdit->selectAll();
+}
+
+void FindBar::showReplace()
+{
+    showFind();
+    m_replaceRow->show();
+}
+
+SearchOptions FindBar::currentOptions() const
+{
+    SearchOptions options;
+    options.caseSensitive = m_caseButton->isChecked();
+    options.wholeWord = m_wordButton->isChecked();
+    options.regex = m_regexButton->isChecked();
+    return options;
+}
+
+QString FindBar::documentText()
+{
+    // toPlainText() 在 GUI 线程深拷贝全文；文档没有变化时（如连续输入查找词）复用上一份副本，
+    // 副本是隐式共享的，交给工作线程时不再复制
+    QTextDocument* document = m_editor->document();
+    if (m_textDocument != document || m_textRevision != document->revision())
+    {
+        m_text = m_editor->toPlainText();
+        m_textDocument = document;
+        m_textRevision = document->revision();
+    }
+    return m_text;
+}
+
+void FindBar::startWorker(const std::function<void()>& run)
+{
+    m_worker = QThread::create(run);
+    m_worker->setParent(this);
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start();
+}
+
+void FindBar::stopWorker()
+{
+    // 不等待旧的工作线程：置位它的取消标志（下一个正则窗口或下一处匹配时生效），
+    // 它结束后自行删除，送回的结果按 m_generation 丢弃
+    if (m_worker)
+    {
+        *m_cancelled = true;
+        m_worker = nullptr;
+    }
+    m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_searching = false;
+    // 已投递但尚未处理的结果随之作废
+    ++m_generation;
+}
+
+void FindBar::clearResults()
+{
+    m_viewportMatches.clear();
+    m_matches.clear();
+    m_complete = false;
+    m_error.clear();
+    if (m_editor)
+        m_editor->setSearchSelections(QList<QTextEdit::ExtraSelection>());
+}
+
+void FindBar::scheduleSearch()
+{
+    m_searchTimer.start();
+}
+
+void FindBar::visibleRange(int* from, int* to) const
+{
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+    QTextDocument* document = m_editor->document();
+    QTextBlock lastBlock = document->findBlockByNumber(last);
+    *from = document->findBlockByNumber(first).position();
+    *to = lastBlock.position() + lastBlock.length();
+}
+
+void FindBar::startSearch()
+{
+    m_searchTimer.stop();
+    stopWorker();
+    clearResults();
+
+    const QString pattern = m_findEdit->text();
+    if (!m_editor || !isVisible() || pattern.isEmpty())
+    {
+        m_pendingNavigate = 0;
+        updateCountLabel();
+        return;
+    }
+
+    int viewFrom = 0;
+    int viewTo = 0;
+    visibleRange(&viewFrom, &viewTo);
+
+    // 工作线程只读这份副本
+    const QString text = documentText();
+    const SearchOptions options = currentOptions();
+    const int generation = m_generation;
+    const std::shared_ptr<std::atomic<bool>> cancelled = m_cancelled;
+    m_searching = true;
+    startWorker([this, text, pattern, options, viewFrom, viewTo, generation, cancelled]() {
+        TextSearcher searcher(pattern, options);
+        if (!searcher.isValid())
+        {
+            QString error = searcher.errorString();
+            QMetaObject::invokeMethod(this, [this, generation, error]() { finishSearch(generation, error); }, Qt::QueuedConnection);
+            return;
+        }
+
+        // 先查找视口范围，让可见的高亮尽快出现
+        QVector<SearchMatch> batch;
+        searcher.findAll(text, viewFrom, viewTo, [&](const SearchMatch& match) {
+            batch.append(match);
+            return !*cancelled;
+        }, cancelled.get());
+        if (*cancelled)
+            return;
+        QMetaObject::invokeMethod(this, [this, generation, batch]() { appendMatches(generation, batch, true); }, Qt::QueuedConnection);
+        batch.clear();
+
+        // 再查找全文，分批送回
+        QElapsedTimer timer;
+        timer.start();
+        searcher.findAll(text, 0, text.size(), [&](const SearchMatch& match) {
+            batch.append(match);
+            if (batch.size() >= BatchSize || timer.hasExpired(BatchIntervalMs))
+            {
+                QMetaObject::invokeMethod(this, [this, generation, batch]() { appendMatches(generation, batch, false); }, Qt::QueuedConnection);
+                batch.clear();
+                timer.restart();
+            }
+            return !*cancelled;
+        }, cancelled.get());
+        if (*cancelled)
+            return;
+
+        // 析构时会等待线程退出，投递给已销毁对象的事件也会被丢弃
+        QMetaObject::invokeMethod(this, [this, generation, batch]() {
+            appendMatches(generation, batch, false);
+            finishSearch(generation, QString());
+        }, Qt::QueuedConnection);
+    });
+    updateCountLabel();
+}
+
+void FindBar::appendMatches(int generation, const QVector<SearchMatch>& matches, bool viewport)
+{
+    if (generation != m_generation)
+        return;
+
+    if (viewport)
+        m_viewportMatches = matches;
+    else
+        m_matches += matches;
+
+    updateHighlights();
+    updateCountLabel();
+}
+
+void FindBar::finishSearch(int generation, const QString& error)
+{
+    if (generation != m_generation)
+        return;
+
+    m_searching = false;
+    m_complete = error.isEmpty();
+    m_error = error;
+    m_viewportMatches.clear();
+    updateHighlights();
+    updateCountLabel();
+
+    if (m_pendingNavigate != 0)
+    {
+        int direction = m_pendingNavigate;
+        m_pendingNavigate = 0;
+        navigate(direction);
+    }
+}
+
+void FindBar::updateHighlights()
+{
+    if (!m_editor || !isVisible())
+        return;
+
+    int from = 0;
+    int to = 0;
+    visibleRange(&from, &to);
+
+    // 全文结果已经覆盖视口时使用全文结果，否则先用视口结果
+    const bool fullCoversView = m_complete || (!m_matches.isEmpty() && m_matches.last().start >= to);
+    const QVector<SearchMatch>& source = fullCoversView ? m_matches : m_viewportMatches;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    auto it = std::lower_bound(source.cbegin(), source.cend(), from, [](const SearchMatch& match, int position) {
+        return match.start + match.length <= position;
+    });
+    for (; it != source.cend() && it->start < to && selections.size() < MaxHighlights; ++it)
+    {
+        QTextEdit::ExtraSelection selection;
+        selection.format.setBackground(FindTheme::match);
+        selection.cursor = QTextCursor(m_editor->document());
+        selection.cursor.setPosition(it->start);
+        selection.cursor.setPosition(it->start + it->length, QTextCursor::KeepAnchor);
+        selections.append(selection);
+    }
+    m_editor->setSearchSelections(selections);
+}
+
+void FindBar::updateCountLabel()
+{
+    QPalette pal = m_countLabel->palette();
+    pal.setColor(QPalette::WindowText, m_error.isEmpty() ? FindTheme::foregroundDim : FindTheme::accent);
+    m_countLabel->setPalette(pal);
+    m_countLabel->setToolTip(m_error);
+
+    if (!m_error.isEmpty())
+    {
+        m_countLabel->setText("Invalid pattern");
+        return;
+    }
+    if (m_findEdit->text().isEmpty() || !m_editor)
+    {
+        m_countLabel->clear();
+        return;
+    }
+    if (!m_complete)
+    {
+        m_countLabel->setText(m_matches.isEmpty() ? QString("Searching…") : QString("%1 found…").arg(m_matches.size()));
+        return;
+    }
+    if (m_matches.isEmpty())
+    {
+        m_countLabel->setText("No results");
+        return;
+    }
+
+    // 当前选中的正好是某处匹配时显示其序号
+    QTextCursor cursor = m_editor->textCursor();
+    auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), cursor.selectionStart(),
+                               [](const SearchMatch& match, int position) { return match.start < position; });
+    if (it != m_matches.cend() && it->start == cursor.selectionStart() && it->start + it->length == cursor.selectionEnd())
+        m_countLabel->setText(QString("%1 of %2").arg(it - m_matches.cbegin() + 1).arg(m_matches.size()));
+    else
+        m_countLabel->setText(QString("%1 matches").arg(m_matches.size()));
+}
+
+void FindBar::findNext()
+{
+    navigate(1);
+}
+
+void FindBar::findPrevious()
+{
+    navigate(-1);
+}
+
+void FindBar::navigate(int direction)
+{
+    if (!m_editor)
+        return;
+    if (!isVisible())
+    {
+        showFind();
+        return;
+    }
+
+    // 查找尚未完成时记下方向，结果就绪后再跳转
+    if (m_searchTimer.isActive() || m_searching)
+    {
+        m_pendingNavigate = direction;
+        if (m_searchTimer.isActive())
+            startSearch();
+        return;
+    }
+    if (m_matches.isEmpty())
+    {
+        if (!m_findEdit->text().isEmpty() && m_error.isEmpty())
+            emit message("No results for: " + m_findEdit->text());
+        return;
+    }
+
+    QTextCursor cursor = m_editor->textCursor();
+    auto byStart = [](const SearchMatch& match, int position) { return match.start < position; };
+    if (direction > 0)
+    {
+        auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), cursor.selectionEnd(), byStart);
+        selectMatch(it != m_matches.cend() ? *it : m_matches.first());
+    }
+    else
+    {
+        auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), cursor.selectionStart(), byStart);
+        selectMatch(it != m_matches.cbegin() ? *(it - 1) : m_matches.last());
+    }
+}
+
+void FindBar::selectMatch(const SearchMatch& match)
+{
+    QTextCursor cursor(m_editor->document());
+    cursor.setPosition(match.start);
+    cursor.setPosition(match.start + match.length, QTextCursor::KeepAnchor);
+    m_editor->setTextCursor(cursor);
+    updateCountLabel();
+}
+
+void FindBar::replaceCurrent()
+{
+    if (!m_editor || m_editor->isReadOnly() || m_findEdit->text().isEmpty())
+        return;
+
+    // 当前选中的文本是一处完整匹配时才替换，然后跳到下一处
+    QTextCursor cursor = m_editor->textCursor();
+    if (cursor.hasSelection())
+    {
+        const QString selected = cursor.selectedText().replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+        TextSearcher searcher(m_findEdit->text(), currentOptions());
+        bool isMatch = false;
+        searcher.findAll(selected, 0, 1, [&](const SearchMatch& match) {
+            isMatch = match.start == 0 && match.length == selected.size();
+            return false;
+        });
+        if (isMatch)
+        {
+            m_editor->undoManager()->prepareEdit(cursor.selectionStart(), cursor.selectionEnd());
+            cursor.insertText(searcher.replacementFor(selected, SearchMatch{ 0, int(selected.size()) }, m_replaceEdit->text()));
+            m_editor->setTextCursor(cursor);
+        }
+    }
+    findNext();
+}
+
+void FindBar::replaceAll()
+{
+    if (!m_editor || m_editor->isReadOnly() || m_findEdit->text().isEmpty())
+        return;
+
+    m_searchTimer.stop();
+    stopWorker();
+    m_pendingNavigate = 0;
+
+    const QString text = documentText();
+    const int revision = m_editor->document()->revision();
+    const QString pattern = m_findEdit->text();
+    const QString replacement = m_replaceEdit->text();
+    const SearchOptions options = currentOptions();
+    const int generation = m_generation;
+    const std::shared_ptr<std::atomic<bool>> cancelled = m_cancelled;
+    m_searching = true;
+    emit message("Replacing…");
+
+    startWorker([this, text, revision, pattern, replacement, options, generation, cancelled]() {
+        TextSearcher searcher(pattern, options);
+        ReplaceResult result;
+        QString span;
+        int lastEnd = 0;
+        searcher.findAll(text, 0, text.size(), [&](const SearchMatch& match) {
+            const QString replaced = searcher.replacementFor(text, match, replacement);
+            if (result.count == 0)
+                result.spanStart = match.start;
+            else
+                span += QStringView(text).mid(lastEnd, match.start - lastEnd);
+            span += replaced;
+            lastEnd = match.start + match.length;
+
+            if (result.count < StepwiseReplaceLimit)
+            {
+                result.matches.append(match);
+                result.replacements.append(replaced);
+            }
+            ++result.count;
+            return !*cancelled;
+        }, cancelled.get());
+        if (*cancelled)
+            return;
+
+        if (result.count > StepwiseReplaceLimit)
+        {
+            result.matches.clear();
+            result.replacements.clear();
+            result.spanEnd = lastEnd;
+            result.spanText = span;
+        }
+        QMetaObject::invokeMethod(this, [this, generation, revision, result]() {
+            applyReplaceAll(generation, revision, result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FindBar::applyReplaceAll(int generation, int revision, const ReplaceResult& result)
+{
+    if (generation != m_generation || !m_editor)
+        return;
+    m_searching = false;
+
+    // 计算期间文档又被编辑过，快照中的位置已失效
+    if (m_editor->document()->revision() != revision)
+    {
+        emit message("Document changed during Replace All — nothing was replaced");
+        scheduleSearch();
+        return;
+    }
+    if (result.count == 0)
+    {
+        emit message("No results for: " + m_findEdit->text());
+        return;
+    }
+
+    // 整批替换放在一个编辑块中，撤销一次即可还原；编辑块结束时只通知一次覆盖全部替换的整段
+    if (!result.matches.isEmpty())
+        m_editor->undoManager()->prepareEdit(result.matches.first().start, result.matches.last().start + result.matches.last().length);
+    else
+        m_editor->undoManager()->prepareEdit(result.spanStart, result.spanEnd);
+    QTextCursor cursor(m_editor->document());
+    cursor.beginEditBlock();
+    if (!result.matches.isEmpty())
+    {
+        for (int i = int(result.matches.size()) - 1; i >= 0; --i)
+        {
+            const SearchMatch& match = result.matches[i];
+            cursor.setPosition(match.start);
+            cursor.setPosition(match.start + match.length, QTextCursor::KeepAnchor);
+            cursor.insertText(result.replacements[i]);
+        }
+    }
+    else
+    {
+        cursor.setPosition(result.spanStart);
+        cursor.setPosition(result.spanEnd, QTextCursor::KeepAnchor);
+        cursor.insertText(result.spanText);
+    }
+    cursor.endEditBlock();
+
+    emit message(QString("Replaced %1 occurrences").arg(result.count));
+}
+
+void FindBar::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape)
+    {
+        hide();
+        if (m_editor)
+            m_editor->setFocus();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+void FindBar::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    scheduleSearch();
+}
+
+void FindBar::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    m_searchTimer.stop();
+    stopWorker();
+    clearResults();
+    m_text = QString();
+    m_textDocument = nullptr;
+    m_pendingNavigate = 0;
+}
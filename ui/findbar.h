@@ -0,0 +1,105 @@
+#ifndef FINDBAR_H
+#define FINDBAR_H
+
+#include <QWidget>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "../core/textsearch.h"
+
+class CodeEditor;
+class QLabel;
+class QLineEdit;
+class QTextDocument;
+class QThread;
+class QToolButton;
+
+// 查找/替换栏：在工作线程中查找文档快照，先送回视口内的结果，再分批送回全文结果；
+// 编辑器中只为视口内的匹配设置高亮。全部替换在工作线程中计算，作为一次可撤销的编辑应用
+class FindBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FindBar(QWidget* parent = nullptr);
+    ~FindBar();
+
+    // 当前 Tab 的编辑器，大文件 Tab 时为空
+    void setEditor(CodeEditor* editor);
+    void showFind();
+    void showReplace();
+
+public slots:
+    void findNext();
+    void findPrevious();
+    void replaceCurrent();
+    void replaceAll();
+
+signals:
+    void message(const QString& text);
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void scheduleSearch();
+    void startSearch();
+    void updateHighlights();
+    void updateCountLabel();
+
+private:
+    struct ReplaceResult
+    {
+        int count = 0;
+        // 匹配较少时逐处替换；较多时把首末匹配之间的文本整体替换为 spanText
+        QVector<SearchMatch> matches;
+        QStringList replacements;
+        int spanStart = 0;
+        int spanEnd = 0;
+        QString spanText;
+    };
+
+    SearchOptions currentOptions() const;
+    QString documentText();
+    void startWorker(const std::function<void()>& run);
+    void stopWorker();
+    void clearResults();
+    void appendMatches(int generation, const QVector<SearchMatch>& matches, bool viewport);
+    void finishSearch(int generation, const QString& error);
+    void applyReplaceAll(int generation, int revision, const ReplaceResult& result);
+    void navigate(int direction);
+    void selectMatch(const SearchMatch& match);
+    void visibleRange(int* from, int* to) const;
+
+    QPointer<CodeEditor> m_editor;
+    QLineEdit* m_findEdit;
+    QLineEdit* m_replaceEdit;
+    QToolButton* m_caseButton;
+    QToolButton* m_wordButton;
+    QToolButton* m_regexButton;
+    QLabel* m_countLabel;
+    QWidget* m_replaceRow;
+
+    QPointer<QThread> m_worker;
+    // 每个工作线程各有一个取消标志；放弃的线程不再等待，取消后自行结束并删除
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    // 最近一次取得的全文副本，文档版本不变时复用；查找栏隐藏时释放
+    QString m_text;
+    QPointer<QTextDocument> m_textDocument;
+    int m_textRevision;
+    int m_generation;          // 每次查找或替换递增，丢弃过期的结果
+    QTimer m_searchTimer;
+
+    QVector<SearchMatch> m_viewportMatches;
+    QVector<SearchMatch> m_matches;   // 按位置排序的全文结果，查找进行中时只包含已送回的部分
+    bool m_searching;
+    bool m_complete;
+    int m_pendingNavigate;     // 结果就绪后待执行的跳转方向
+    QString m_error;
+};
+
+#endif // FINDBAR_H
@@ -0,0 +1,233 @@
+#include "findinfolderpanel.h"
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QToolButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace PanelTheme {
+    const QColor background(39, 40, 34);       // #272822
+    const QColor backgroundDark(30, 31, 28);   // #1e1f1c
+    const QColor foreground(248, 248, 242);    // #f8f8f2
+    const QColor foregroundDim(117, 113, 94);  // #75715e
+    const QColor accentYellow(230, 219, 116);  // #e6db74
+}
+
+namespace {
+    const int LineRole = Qt::UserRole;
+    const int ColumnRole = Qt::UserRole + 1;
+    const int PathRole = Qt::UserRole + 2;
+    const char* const DefaultFilters = "*.md, *.markdown, *.txt";
+
+    QString formatRate(double perSecond)
+    {
+        if (perSecond >= 1024.0 * 1024.0)
+            return QString("%1 MB").arg(perSecond / (1024.0 * 1024.0), 0, 'f', 1);
+        return QString("%1 KB").arg(perSecond / 1024.0, 0, 'f', 1);
+    }
+}
+
+FindInFolderPanel::FindInFolderPanel(QWidget* parent)
+    : QDockWidget("Find in Folder", parent)
+    , m_search(new FolderSearch(this))
+{
+    setObjectName("FindInFolderPanel");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
+
+    QWidget* content = new QWidget(this);
+    content->setAutoFillBackground(true);
+    QPalette pal = content->palette();
+    pal.setColor(QPalette::Window, PanelTheme::backgroundDark);
+    content->setPalette(pal);
+    content->setFont(QFont("SF Pro Text", 11));
+
+    m_patternEdit = new QLineEdit(content);
+    m_patternEdit->setPlaceholderText("Find");
+    m_caseButton = new QToolButton(content);
+    m_caseButton->setText("Aa");
+    m_caseButton->setToolTip("Match Case");
+    m_caseButton->setCheckable(true);
+    m_caseButton->setAutoRaise(true);
+    m_wordButton = new QToolButton(content);
+    m_wordButton->setText("W");
+    m_wordButton->setToolTip("Whole Word");
+    m_wordButton->setCheckable(true);
+    m_wordButton->setAutoRaise(true);
+    m_searchButton = new QPushButton("Search", content);
+
+    m_folderEdit = new QLineEdit(content);
+    m_folderEdit->setPlaceholderText("Folder");
+    QToolButton* browseButton = new QToolButton(content);
+    browseButton->setText("…");
+    browseButton->setToolTip("Choose Folder");
+    m_filterEdit = new QLineEdit(DefaultFilters, content);
+    m_filterEdit->setPlaceholderText("File filters, e.g. *.md (empty for all files)");
+
+    m_results = new QTreeWidget(content);
+    m_results->setHeaderHidden(true);
+    m_results->setUniformRowHeights(true);
+    m_results->setFrameShape(QFrame::NoFrame);
+    QPalette treePal = m_results->palette();
+    treePal.setColor(QPalette::Base, PanelTheme::background);
+    treePal.setColor(QPalette::Text, PanelTheme::foreground);
+    m_results->setPalette(treePal);
+
+    m_statsLabel = new QLabel(content);
+    QPalette labelPal = m_statsLabel->palette();
+    labelPal.setColor(QPalette::WindowText, PanelTheme::foregroundDim);
+    m_statsLabel->setPalette(labelPal);
+
+    QHBoxLayout* patternRow = new QHBoxLayout();
+    patternRow->addWidget(m_patternEdit, 1);
+    patternRow->addWidget(m_caseButton);
+    patternRow->addWidget(m_wordButton);
+    patternRow->addWidget(m_searchButton);
+
+    QHBoxLayout* folderRow = new QHBoxLayout();
+    folderRow->addWidget(m_folderEdit, 2);
+    folderRow->addWidget(browseButton);
+    folderRow->addWidget(m_filterEdit, 1);
+
+    QVBoxLayout* layout = new QVBoxLayout(content);
+    layout->setContentsMargins(8, 4, 8, 4);
+    layout->setSpacing(4);
+    layout->addLayout(patternRow);
+    layout->addLayout(folderRow);
+    layout->addWidget(m_results, 1);
+    layout->addWidget(m_statsLabel);
+    setWidget(content);
+
+    connect(m_searchButton, &QPushButton::clicked, this, &FindInFolderPanel::onSearchClicked);
+    connect(m_patternEdit, &QLineEdit::returnPressed, this, &FindInFolderPanel::onSearchClicked);
+    connect(m_folderEdit, &QLineEdit::returnPressed, this, &FindInFolderPanel::onSearchClicked);
+    connect(browseButton, &QToolButton::clicked, this, &FindInFolderPanel::onBrowse);
+    connect(m_results, &QTreeWidget::itemActivated, this, &FindInFolderPanel::onItemActivated);
+    connect(m_search, &FolderSearch::resultsReady, this, &FindInFolderPanel::onResultsReady);
+    connect(m_search, &FolderSearch::progress, this, &FindInFolderPanel::onProgress);
+    connect(m_search, &FolderSearch::finished, this, &FindInFolderPanel::onFinished);
+}
+
+void FindInFolderPanel::activate(const QString& folder, const QString& pattern)
+{
+    if (m_folderEdit->text().isEmpty())
+        m_folderEdit->setText(folder.isEmpty() ? QDir::homePath() : folder);
+    if (!pattern.isEmpty())
+        m_patternEdit->setText(pattern);
+
+    show();
+    raise();
+    m_patternEdit->setFocus();
+    m_patternEdit->selectAll();
+}
+
+void FindInFolderPanel::onBrowse()
+{
+    QString folder = QFileDialog::getExistingDirectory(
+        this,
+        "Choose Folder",
+        m_folderEdit->text().isEmpty() ? QDir::homePath() : m_folderEdit->text(),
+        QFileDialog::ShowDirsOnly | QFileDialog::DontUseNativeDialog
+    );
+    if (!folder.isEmpty())
+        m_folderEdit->setText(folder);
+}
+
+void FindInFolderPanel::onSearchClicked()
+{
+    // 查找进行中时按钮用于停止
+    if (m_search->isRunning())
+    {
+        m_search->cancel();
+        return;
+    }
+
+    const QString pattern = m_patternEdit->text();
+    const QString folder = QDir::cleanPath(m_folderEdit->text());
+    if (pattern.isEmpty())
+        return;
+    if (!QFileInfo(folder).isDir())
+    {
+        m_statsLabel->setText("Folder does not exist: " + folder);
+        return;
+    }
+
+    const QStringList filters = m_filterEdit->text().split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+
+    SearchOptions options;
+    options.caseSensitive = m_caseButton->isChecked();
+    options.wholeWord = m_wordButton->isChecked();
+
+    m_results->clear();
+    m_fileItems.clear();
+    m_searchButton->setText("Stop");
+    m_statsLabel->setText("Searching…");
+    m_search->start(QFileInfo(folder).absoluteFilePath(), pattern, options, filters);
+}
+
+void FindInFolderPanel::onResultsReady(const QVector<FolderMatch>& matches)
+{
+    m_results->setUpdatesEnabled(false);
+    for (const FolderMatch& match : matches)
+    {
+        QTreeWidgetItem* fileItem = m_fileItems.value(match.filePath);
+        if (!fileItem)
+        {
+            fileItem = new QTreeWidgetItem(m_results);
+            fileItem->setText(0, QDir(m_folderEdit->text()).relativeFilePath(match.filePath));
+            fileItem->setToolTip(0, match.filePath);
+            fileItem->setForeground(0, PanelTheme::accentYellow);
+            fileItem->setData(0, PathRole, match.filePath);
+            fileItem->setData(0, LineRole, -1);
+            fileItem->setExpanded(true);
+            m_fileItems.insert(match.filePath, fileItem);
+        }
+
+        QTreeWidgetItem* item = new QTreeWidgetItem(fileItem);
+        item->setText(0, QString("%1: %2").arg(match.line + 1).arg(match.lineText));
+        item->setData(0, PathRole, match.filePath);
+        item->setData(0, LineRole, match.line);
+        item->setData(0, ColumnRole, match.column);
+    }
+    m_results->setUpdatesEnabled(true);
+}
+
+QString FindInFolderPanel::statsText(const FolderSearchStats& stats) const
+{
+    const double seconds = qMax<qint64>(1, stats.elapsedMs) / 1000.0;
+    QString text = QString("%1 matches in %2 files · %3 files/s · %4/s · %5 ms")
+                       .arg(stats.matches)
+                       .arg(m_fileItems.size())
+                       .arg(qRound64(stats.files / seconds))
+                       .arg(formatRate(stats.bytes / seconds))
+                       .arg(stats.elapsedMs);
+    text += QString(" (%1 files scanned)").arg(stats.files);
+    if (stats.truncated)
+        text += " — results truncated";
+    return text;
+}
+
+void FindInFolderPanel::onProgress(const FolderSearchStats& stats)
+{
+    m_statsLabel->setText("Searching… " + statsText(stats));
+}
+
+void FindInFolderPanel::onFinished(const FolderSearchStats& stats)
+{
+    m_searchButton->setText("Search");
+    m_statsLabel->setText((stats.cancelled ? "Cancelled: " : QString()) + statsText(stats));
+}
+
+void FindInFolderPanel::onItemActivated(QTreeWidgetItem* item)
+{
+    const int line = item->data(0, LineRole).toInt();
+    const QString path = item->data(0, PathRole).toString();
+    if (path.isEmpty())
+        return;
+    emit openRequested(path, qMax(0, line), line < 0 ? 0 : item->data(0, ColumnRole).toInt());
+}
@@ -0,0 +1,53 @@
+#ifndef FINDINFOLDERPANEL_H
+#define FINDINFOLDERPANEL_H
+
+#include <QDockWidget>
+#include <QHash>
+#include "../core/foldersearch.h"
+
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QToolButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// 在文件夹中查找的结果面板：结果按文件分组，随查找进度分批加入；
+// 双击结果时请求在编辑器中打开对应文件并定位到该行
+class FindInFolderPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FindInFolderPanel(QWidget* parent = nullptr);
+
+    // 显示面板并聚焦查找框，folder 非空时作为默认文件夹
+    void activate(const QString& folder, const QString& pattern);
+
+signals:
+    void openRequested(const QString& filePath, int line, int column);
+
+private slots:
+    void onSearchClicked();
+    void onBrowse();
+    void onResultsReady(const QVector<FolderMatch>& matches);
+    void onProgress(const FolderSearchStats& stats);
+    void onFinished(const FolderSearchStats& stats);
+    void onItemActivated(QTreeWidgetItem* item);
+
+private:
+    QString statsText(const FolderSearchStats& stats) const;
+
+    FolderSearch* m_search;
+    QLineEdit* m_patternEdit;
+    QLineEdit* m_folderEdit;
+    QLineEdit* m_filterEdit;
+    QToolButton* m_caseButton;
+    QToolButton* m_wordButton;
+    QPushButton* m_searchButton;
+    QTreeWidget* m_results;
+    QLabel* m_statsLabel;
+    QHash<QString, QTreeWidgetItem*> m_fileItems;
+};
+
+#endif // FINDINFOLDERPANEL_H
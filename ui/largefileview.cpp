@@ -0,0 +1,584 @@
+#include "largefileview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QScrollBar>
+#include <QThread>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace EditorTheme {
+    const QColor background(39, 40, 34);       // #272822
+    const QColor backgroundDark(30, 31, 28);   // #1e1f1c
+    const QColor foreground(248, 248, 242);    // #f8f8f2
+    const QColor foregroundDim(117, 113, 94);  // #75715e
+    const QColor currentLine(50, 50, 45);      // 当前行背景
+}
+
+namespace {
+    // 单行最多解码显示的字节数，避免超长行拖慢绘制
+    const qint64 MaxLineBytes = 64 * 1024;
+    const int TextMargin = 4;
+    const int TabWidth = 4;
+
+    QString expandTabs(const QString& text)
+    {
+        if (!text.contains(QLatin1Char('\t')))
+            return text;
+
+        QString result;
+        result.reserve(text.size() + 16);
+        for (QChar ch : text)
+        {
+            if (ch == QLatin1Char('\t'))
+                result.append(QString(TabWidth - result.size() % TabWidth, QLatin1Char(' ')));
+            else
+                result.append(ch);
+        }
+        return result;
+    }
+}
+
+LargeFileView::LargeFileView(QWidget* parent)
+    : QAbstractScrollArea(parent)
+    , m_indexThread(nullptr)
+    , m_cancelIndex(false)
+    , m_topOffset(0)
+    , m_cursor(0)
+    , m_preferredColumn(0)
+    , m_xOffset(0)
+    , m_scrollShift(0)
+    , m_gutterWidth(0)
+    , m_maxLineWidth(0)
+    , m_syncingScrollBars(false)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    updateGutterWidth();
+}
+
+LargeFileView::~LargeFileView()
+{
+    stopIndexing();
+}
+
+bool LargeFileView::openFile(const QString& filePath, QString* errorString)
+{
+    stopIndexing();
+    if (!m_buffer.open(filePath, errorString))
+        return false;
+
+    m_topOffset = 0;
+    m_cursor = 0;
+    m_preferredColumn = 0;
+    m_xOffset = 0;
+    m_maxLineWidth = 0;
+
+    updateGutterWidth();
+    updateScrollBars();
+    startIndexing();
+    viewport()->update();
+    emit cursorPositionChanged();
+    return true;
+}
+
+void LargeFileView::fileSaved(const QString& filePath, quint64 snapshotRevision)
+{
+    if (m_buffer.revision() != snapshotRevision)
+        return;
+
+    // 重新映射保存后的文件，编辑占用的追加缓冲区随之释放
+    const qint64 cursor = m_cursor;
+    const qint64 top = m_topOffset;
+    if (!openFile(filePath))
+        return;
+
+    m_cursor = qMin(cursor, m_buffer.size());
+    setTopOffset(m_buffer.lineStartBefore(top));
+    emit cursorPositionChanged();
+}
+
+void LargeFileView::startIndexing()
+{
+    std::shared_ptr<const MappedFile> original = m_buffer.original();
+    if (!original)
+        return;
+
+    m_cancelIndex = false;
+    m_indexThread = QThread::create([this, original]() {
+        SparseLineIndex index = SparseLineIndex::build(original->data(), original->size(), &m_cancelIndex);
+        if (m_cancelIndex)
+            return;
+
+        QMetaObject::invokeMethod(this, [this, original, index]() {
+            if (m_buffer.original() != original)
+                return;
+            m_buffer.setOriginalLineIndex(index);
+            updateGutterWidth();
+            viewport()->update();
+            emit lineIndexReady();
+            emit cursorPositionChanged();
+        }, Qt::QueuedConnection);
+    });
+    m_indexThread->start(QThread::LowPriority);
+}
+
+void LargeFileView::stopIndexing()
+{
+    if (!m_indexThread)
+        return;
+
+    m_cancelIndex = true;
+    m_indexThread->wait();
+    delete m_indexThread;
+    m_indexThread = nullptr;
+}
+
+qint64 LargeFileView::cursorLineNumber() const
+{
+    return m_buffer.lineNumberAt(m_cursor);
+}
+
+qint64 LargeFileView::cursorColumn() const
+{
+    qint64 lineStart = m_buffer.lineStartBefore(m_cursor);
+    return QString::fromUtf8(m_buffer.read(lineStart, m_cursor - lineStart)).size();
+}
+
+void LargeFileView::goToLine(qint64 line)
+{
+    qint64 offset = m_buffer.lineStart(line);
+    if (offset < 0)
+        return;
+
+    setTopOffset(offset);
+    scrollLines(-visibleRows() / 2);
+    setCursorOffset(offset);
+}
+
+void LargeFileView::updateGutterWidth()
+{
+    // 行索引未就绪时按平均行长估算位数
+    qint64 lines = m_buffer.lineCount();
+    if (lines < 0)
+        lines = m_buffer.size() / 32;
+
+    int digits = 1;
+    qint64 max = qMax<qint64>(1, lines);
+    while (max >= 10)
+    {
+        max /= 10;
+        ++digits;
+    }
+
+    m_gutterWidth = 16 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+}
+
+void LargeFileView::updateScrollBars()
+{
+    // 字节偏移可能超过 int 范围，按需右移后映射到滚动条
+    m_scrollShift = 0;
+    while ((m_buffer.size() >> m_scrollShift) > (1 << 30))
+        ++m_scrollShift;
+
+    m_syncingScrollBars = true;
+    QScrollBar* vbar = verticalScrollBar();
+    vbar->setRange(0, int(m_buffer.size() >> m_scrollShift));
+    vbar->setPageStep(qMax(1, int((qint64(visibleRows()) * 64) >> m_scrollShift)));
+    vbar->setValue(int(m_topOffset >> m_scrollShift));
+    m_syncingScrollBars = false;
+
+    updateHorizontalRange();
+}
+
+void LargeFileView::updateHorizontalRange()
+{
+    m_syncingScrollBars = true;
+    QScrollBar* hbar = horizontalScrollBar();
+    int textWidth = viewport()->width() - m_gutterWidth - TextMargin;
+    hbar->setRange(0, qMax(m_xOffset, m_maxLineWidth - textWidth));
+    hbar->setPageStep(qMax(1, textWidth));
+    hbar->setValue(m_xOffset);
+    m_syncingScrollBars = false;
+}
+
+int LargeFileView::visibleRows() const
+{
+    return qMax(1, viewport()->height() / fontMetrics().height());
+}
+
+QString LargeFileView::lineText(qint64 lineStart, qint64 end) const
+{
+    QString text = QString::fromUtf8(m_buffer.read(lineStart, qMin(end - lineStart, MaxLineBytes)));
+    if (text.endsWith(QLatin1Char('\r')))
+        text.chop(1);
+    return text;
+}
+
+qint64 LargeFileView::offsetForColumn(qint64 lineStart, qint64 column) const
+{
+    QString text = lineText(lineStart, m_buffer.lineEnd(lineStart));
+    return lineStart + text.left(column).toUtf8().size();
+}
+
+qint64 LargeFileView::previousCharStart(qint64 pos) const
+{
+    if (pos <= 0)
+        return 0;
+
+    // 跳过 UTF-8 续字节
+    qint64 p = pos - 1;
+    while (p > 0 && pos - p < 4 && (uchar(m_buffer.at(p)) & 0xC0) == 0x80)
+        --p;
+    return p;
+}
+
+qint64 LargeFileView::nextCharEnd(qint64 pos) const
+{
+    if (pos >= m_buffer.size())
+        return m_buffer.size();
+
+    uchar lead = uchar(m_buffer.at(pos));
+    int length = 1;
+    if ((lead & 0xE0) == 0xC0)
+        length = 2;
+    else if ((lead & 0xF0) == 0xE0)
+        length = 3;
+    else if ((lead & 0xF8) == 0xF0)
+        length = 4;
+    return qMin(pos + length, m_buffer.size());
+}
+
+void LargeFileView::setCursorOffset(qint64 pos, bool keepColumn)
+{
+    m_cursor = qBound<qint64>(0, pos, m_buffer.size());
+    if (!keepColumn)
+        m_preferredColumn = cursorColumn();
+
+    ensureCursorVisible();
+    viewport()->update();
+    emit cursorPositionChanged();
+}
+
+void LargeFileView::setTopOffset(qint64 offset)
+{
+    m_topOffset = qBound<qint64>(0, offset, m_buffer.size());
+
+    m_syncingScrollBars = true;
+    verticalScrollBar()->setValue(int(m_topOffset >> m_scrollShift));
+    m_syncingScrollBars = false;
+
+    viewport()->update();
+}
+
+void LargeFileView::scrollLines(int lines)
+{
+    qint64 top = m_topOffset;
+    for (; lines > 0; --lines)
+    {
+        qint64 next = m_buffer.nextLineStart(top);
+        if (next < 0)
+            break;
+        top = next;
+    }
+    for (; lines < 0 && top > 0; ++lines)
+        top = m_buffer.lineStartBefore(top - 1);
+
+    setTopOffset(top);
+}
+
+void LargeFileView::ensureCursorVisible()
+{
+    const qint64 lineStart = m_buffer.lineStartBefore(m_cursor);
+    const int rows = visibleRows();
+
+    if (lineStart < m_topOffset)
+    {
+        setTopOffset(lineStart);
+    }
+    else
+    {
+        bool visible = false;
+        qint64 offset = m_topOffset;
+        for (int row = 0; row < rows && offset >= 0; ++row)
+        {
+            if (offset == lineStart)
+            {
+                visible = true;
+                break;
+            }
+            offset = m_buffer.nextLineStart(offset);
+        }
+
+        // 光标在可见区域下方：让光标行成为最后一个可见行
+        if (!visible)
+        {
+            qint64 top = lineStart;
+            for (int row = 1; row < rows && top > 0; ++row)
+                top = m_buffer.lineStartBefore(top - 1);
+            setTopOffset(top);
+        }
+    }
+
+    // 水平方向
+    const QString prefix = expandTabs(QString::fromUtf8(m_buffer.read(lineStart, qMin(m_cursor - lineStart, MaxLineBytes))));
+    const int caretX = fontMetrics().horizontalAdvance(prefix);
+    const int textWidth = viewport()->width() - m_gutterWidth - TextMargin;
+    if (caretX < m_xOffset)
+        m_xOffset = caretX;
+    else if (caretX > m_xOffset + textWidth - 10)
+        m_xOffset = caretX - textWidth + 10;
+    m_xOffset = qMax(0, m_xOffset);
+    updateHorizontalRange();
+}
+
+void LargeFileView::insertText(const QByteArray& text)
+{
+    const qint64 pos = m_cursor;
+    m_buffer.insert(pos, text);
+    if (pos < m_topOffset)
+        m_topOffset += text.size();
+
+    updateScrollBars();
+    setCursorOffset(pos + text.size());
+}
+
+void LargeFileView::removeText(qint64 pos, qint64 length)
+{
+    if (length <= 0)
+        return;
+
+    m_buffer.remove(pos, length);
+    if (pos + length <= m_topOffset)
+        m_topOffset -= length;
+    else if (pos < m_topOffset)
+        m_topOffset = m_buffer.lineStartBefore(pos);
+
+    updateScrollBars();
+    setCursorOffset(pos);
+}
+
+void LargeFileView::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    const QRect area = viewport()->rect();
+    painter.fillRect(event->rect(), EditorTheme::background);
+    painter.fillRect(QRect(0, 0, m_gutterWidth, area.height()), EditorTheme::backgroundDark);
+
+    const QFontMetrics metrics = fontMetrics();
+    const int lineHeight = metrics.height();
+    const QRect textArea(m_gutterWidth, 0, area.width() - m_gutterWidth, area.height());
+    const int textX = m_gutterWidth + TextMargin - m_xOffset;
+    const qint64 cursorLineStart = m_buffer.lineStartBefore(m_cursor);
+
+    // 行号依赖后台建立的行索引，就绪前不绘制
+    qint64 lineNumber = m_buffer.lineNumberAt(m_topOffset);
+    int widest = 0;
+
+    qint64 offset = m_topOffset;
+    for (int y = 0; offset >= 0 && y < area.height(); y += lineHeight)
+    {
+        const qint64 end = m_buffer.lineEnd(offset);
+        const bool isCurrent = (offset == cursorLineStart);
+
+        if (lineNumber >= 0)
+        {
+            painter.setPen(isCurrent ? EditorTheme::foreground : EditorTheme::foregroundDim);
+            painter.drawText(0, y, m_gutterWidth - 8, lineHeight, Qt::AlignRight | Qt::AlignVCenter,
+                             QString::number(lineNumber + 1));
+            ++lineNumber;
+        }
+
+        painter.save();
+        painter.setClipRect(textArea);
+        if (isCurrent)
+            painter.fillRect(QRect(m_gutterWidth, y, textArea.width(), lineHeight), EditorTheme::currentLine);
+
+        const QString text = expandTabs(lineText(offset, end));
+        painter.setPen(EditorTheme::foreground);
+        painter.drawText(textX, y + metrics.ascent(), text);
+        widest = qMax(widest, metrics.horizontalAdvance(text));
+
+        if (isCurrent && hasFocus())
+        {
+            const QString prefix = expandTabs(QString::fromUtf8(m_buffer.read(offset, qMin(m_cursor - offset, MaxLineBytes))));
+            painter.fillRect(textX + metrics.horizontalAdvance(prefix), y, 1, lineHeight, EditorTheme::foreground);
+        }
+        painter.restore();
+
+        offset = end < m_buffer.size() ? end + 1 : -1;
+    }
+
+    // 只在出现更宽的行时扩展水平滚动范围
+    if (widest > m_maxLineWidth)
+    {
+        m_maxLineWidth = widest;
+        QMetaObject::invokeMethod(this, [this]() { updateHorizontalRange(); }, Qt::QueuedConnection);
+    }
+}
+
+void LargeFileView::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LargeFileView::changeEvent(QEvent* event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange)
+    {
+        updateGutterWidth();
+        updateScrollBars();
+    }
+}
+
+void LargeFileView::scrollContentsBy(int dx, int dy)
+{
+    if (m_syncingScrollBars)
+        return;
+
+    if (dy)
+    {
+        qint64 offset = qint64(verticalScrollBar()->value()) << m_scrollShift;
+        m_topOffset = m_buffer.lineStartBefore(qMin(offset, m_buffer.size()));
+    }
+    if (dx)
+        m_xOffset = horizontalScrollBar()->value();
+
+    viewport()->update();
+}
+
+void LargeFileView::wheelEvent(QWheelEvent* event)
+{
+    const QPoint delta = event->angleDelta();
+    if (delta.y() != 0)
+        scrollLines(-delta.y() / 40);
+    if (delta.x() != 0)
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
+    event->accept();
+}
+
+void LargeFileView::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton)
+    {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    // 定位点击的行
+    const QFontMetrics metrics = fontMetrics();
+    qint64 lineStart = m_topOffset;
+    for (int row = event->position().toPoint().y() / metrics.height(); row > 0; --row)
+    {
+        qint64 next = m_buffer.nextLineStart(lineStart);
+        if (next < 0)
+            break;
+        lineStart = next;
+    }
+
+    // 按字符宽度累加定位列
+    const QString text = lineText(lineStart, m_buffer.lineEnd(lineStart));
+    const int x = event->position().toPoint().x() - m_gutterWidth - TextMargin + m_xOffset;
+    int advance = 0;
+    int visualColumn = 0;
+    int column = 0;
+    for (; column < text.size(); ++column)
+    {
+        int width;
+        int span = 1;
+        if (text.at(column) == QLatin1Char('\t'))
+        {
+            span = TabWidth - visualColumn % TabWidth;
+            width = metrics.horizontalAdvance(QLatin1Char(' ')) * span;
+        }
+        else
+        {
+            width = metrics.horizontalAdvance(text.at(column));
+        }
+
+        if (advance + width / 2 > x)
+            break;
+        advance += width;
+        visualColumn += span;
+    }
+
+    setFocus();
+    setCursorOffset(lineStart + text.left(column).toUtf8().size());
+}
+
+void LargeFileView::keyPressEvent(QKeyEvent* event)
+{
+    const bool ctrl = event->modifiers() & Qt::ControlModifier;
+    const qint64 lineStart = m_buffer.lineStartBefore(m_cursor);
+
+    switch (event->key())
+    {
+    case Qt::Key_Left:
+        setCursorOffset(previousCharStart(m_cursor));
+        return;
+    case Qt::Key_Right:
+        setCursorOffset(nextCharEnd(m_cursor));
+        return;
+    case Qt::Key_Up:
+        if (lineStart > 0)
+            setCursorOffset(offsetForColumn(m_buffer.lineStartBefore(lineStart - 1), m_preferredColumn), true);
+        return;
+    case Qt::Key_Down:
+    {
+        qint64 next = m_buffer.nextLineStart(m_cursor);
+        if (next >= 0)
+            setCursorOffset(offsetForColumn(next, m_preferredColumn), true);
+        return;
+    }
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+    {
+        const int rows = event->key() == Qt::Key_PageUp ? -visibleRows() : visibleRows();
+        qint64 target = lineStart;
+        for (int i = 0; i < qAbs(rows); ++i)
+        {
+            qint64 next = rows > 0 ? m_buffer.nextLineStart(target)
+                                   : (target > 0 ? m_buffer.lineStartBefore(target - 1) : -1);
+            if (next < 0)
+                break;
+            target = next;
+        }
+        scrollLines(rows);
+        setCursorOffset(offsetForColumn(target, m_preferredColumn), true);
+        return;
+    }
+    case Qt::Key_Home:
+        setCursorOffset(ctrl ? 0 : lineStart);
+        return;
+    case Qt::Key_End:
+        setCursorOffset(ctrl ? m_buffer.size() : offsetForColumn(lineStart, MaxLineBytes));
+        return;
+    case Qt::Key_Backspace:
+    {
+        qint64 start = previousCharStart(m_cursor);
+        removeText(start, m_cursor - start);
+        return;
+    }
+    case Qt::Key_Delete:
+        removeText(m_cursor, nextCharEnd(m_cursor) - m_cursor);
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        insertText(QByteArray("\n"));
+        return;
+    default:
+        break;
+    }
+
+    const QString text = event->text();
+    if (!ctrl && !text.isEmpty() && (text.at(0).isPrint() || text.at(0) == QLatin1Char('\t')))
+    {
+        insertText(text.toUtf8());
+        return;
+    }
+
+    QAbstractScrollArea::keyPressEvent(event);
+}
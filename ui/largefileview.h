@@ -0,0 +1,79 @@
+#ifndef LARGEFILEVIEW_H
+#define LARGEFILEVIEW_H
+
+#include <QAbstractScrollArea>
+#include <atomic>
+#include "../core/piecetable.h"
+
+class QThread;
+
+// 超大文件视图：文本保存在 PieceTable（内存映射 + 追加缓冲区）中，
+// 只对可见行解码、排版和绘制，打开与滚动的开销与文件大小无关
+class LargeFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit LargeFileView(QWidget* parent = nullptr);
+    ~LargeFileView();
+
+    bool openFile(const QString& filePath, QString* errorString = nullptr);
+    // 后台保存完成后调用：快照之后没有新的编辑时重新映射保存后的文件
+    void fileSaved(const QString& filePath, quint64 snapshotRevision);
+
+    PieceTable& buffer() { return m_buffer; }
+    bool isModified() const { return m_buffer.isModified(); }
+
+    // 光标所在行号（从 0 开始），行索引尚未建立时返回 -1
+    qint64 cursorLineNumber() const;
+    qint64 cursorColumn() const;
+    void goToLine(qint64 line);
+
+signals:
+    void cursorPositionChanged();
+    void lineIndexReady();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    void startIndexing();
+    void stopIndexing();
+    void updateGutterWidth();
+    void updateScrollBars();
+    void updateHorizontalRange();
+
+    QString lineText(qint64 lineStart, qint64 end) const;
+    qint64 offsetForColumn(qint64 lineStart, qint64 column) const;
+    qint64 previousCharStart(qint64 pos) const;
+    qint64 nextCharEnd(qint64 pos) const;
+    int visibleRows() const;
+
+    void setCursorOffset(qint64 pos, bool keepColumn = false);
+    void setTopOffset(qint64 offset);
+    void scrollLines(int lines);
+    void ensureCursorVisible();
+    void insertText(const QByteArray& text);
+    void removeText(qint64 pos, qint64 length);
+
+    PieceTable m_buffer;
+    QThread* m_indexThread;
+    std::atomic<bool> m_cancelIndex;
+
+    qint64 m_topOffset;        // 首个可见行的行首偏移
+    qint64 m_cursor;           // 光标的字节偏移
+    qint64 m_preferredColumn;  // 上下移动时保持的列
+    int m_xOffset;
+    int m_scrollShift;         // 字节偏移映射到滚动条数值时的右移位数
+    int m_gutterWidth;
+    int m_maxLineWidth;
+    bool m_syncingScrollBars;
+};
+
+#endif // LARGEFILEVIEW_H
@@ -0,0 +1,696 @@
+#include "markdownhighlighter.h"
+#include "codeeditor.h"
+#include "outlineindex.h"
+#include <QTextDocument>
+#include <QElapsedTimer>
+#include <QFont>
+#include <limits>
+
+// 语法颜色（与 notepad.cpp 中保持一致）
+namespace SyntaxTheme {
+    const QColor pink(249, 38, 114);      // #f92672
+    const QColor green(166, 226, 46);     // #a6e22e
+    const QColor yellow(230, 219, 116);   // #e6db74
+    const QColor orange(253, 151, 31);    // #fd971f
+    const QColor blue(102, 217, 239);     // #66d9ef
+    const QColor purple(174, 129, 255);   // #ae81ff
+    const QColor comment(117, 113, 94);   // #75715e
+}
+
+namespace {
+    // 编辑时同步高亮的时间预算，以及每个空闲分片的时间预算
+    const qint64 SyncBudgetNs = 2 * 1000 * 1000;
+    const qint64 SliceBudgetNs = 4 * 1000 * 1000;
+
+    bool isSpace(QChar c)
+    {
+        return c == QLatin1Char(' ') || c == QLatin1Char('\t');
+    }
+
+    int skipSpaces(const QString& text, int pos)
+    {
+        while (pos < text.size() && isSpace(text.at(pos)))
+            ++pos;
+        return pos;
+    }
+
+    bool isBlankFrom(const QString& text, int pos)
+    {
+        return skipSpaces(text, pos) >= text.size();
+    }
+
+    int indentWidth(const QString& text, int from, int to)
+    {
+        int width = 0;
+        for (int i = from; i < to; ++i)
+            width += text.at(i) == QLatin1Char('\t') ? 4 - width % 4 : 1;
+        return width;
+    }
+
+    int runLength(const QString& text, int pos, QChar c)
+    {
+        int n = 0;
+        while (pos + n < text.size() && text.at(pos + n) == c)
+            ++n;
+        return n;
+    }
+
+    void addFormat(QList<QTextLayout::FormatRange>& formats, int start, int length, const QTextCharFormat& format)
+    {
+        if (length <= 0)
+            return;
+        QTextLayout::FormatRange range;
+        range.start = start;
+        range.length = length;
+        range.format = format;
+        formats.append(range);
+    }
+
+    // 围栏起始标记（``` 或 ~~~），返回标记长度，不是围栏时返回 0
+    int openingFence(const QString& text, int pos, bool* tilde)
+    {
+        if (pos >= text.size())
+            return 0;
+        QChar c = text.at(pos);
+        if (c != QLatin1Char('`') && c != QLatin1Char('~'))
+            return 0;
+
+        int n = runLength(text, pos, c);
+        if (n < 3)
+            return 0;
+        // 反引号围栏的信息串中不能再出现反引号
+        if (c == QLatin1Char('`') && text.indexOf(QLatin1Char('`'), pos + n) >= 0)
+            return 0;
+
+        *tilde = (c == QLatin1Char('~'));
+        return n;
+    }
+
+    bool isClosingFence(const QString& text, int pos, const MarkdownBlockState& state)
+    {
+        QChar c = state.tildeFence ? QLatin1Char('~') : QLatin1Char('`');
+        int n = runLength(text, pos, c);
+        return n >= state.fenceLength && isBlankFrom(text, pos + n);
+    }
+
+    // ATX 标题的文字：去掉开头的 # 与可选的结尾 # 序列
+    QString atxTitle(const QString& text, int pos, int level)
+    {
+        int end = text.size();
+        while (end > pos && isSpace(text.at(end - 1)))
+            --end;
+        int closing = end;
+        while (closing > pos + level && text.at(closing - 1) == QLatin1Char('#'))
+            --closing;
+        if (closing < end && (closing == pos + level || isSpace(text.at(closing - 1))))
+            end = closing;
+        return text.mid(pos + level, end - pos - level).trimmed();
+    }
+
+    int atxLevel(const QString& text, int pos)
+    {
+        int n = runLength(text, pos, QLatin1Char('#'));
+        if (n < 1 || n > 6)
+            return 0;
+        if (pos + n < text.size() && !isSpace(text.at(pos + n)))
+            return 0;
+        return n;
+    }
+
+    bool isThematicBreak(const QString& text, int pos)
+    {
+        if (pos >= text.size())
+            return false;
+        QChar c = text.at(pos);
+        if (c != QLatin1Char('*') && c != QLatin1Char('-') && c != QLatin1Char('_'))
+            return false;
+
+        int count = 0;
+        for (int i = pos; i < text.size(); ++i)
+        {
+            if (text.at(i) == c)
+                ++count;
+            else if (!isSpace(text.at(i)))
+                return false;
+        }
+        return count >= 3;
+    }
+
+    bool isSetextUnderline(const QString& text, int pos)
+    {
+        if (pos >= text.size())
+            return false;
+        QChar c = text.at(pos);
+        if (c != QLatin1Char('=') && c != QLatin1Char('-'))
+            return false;
+        return isBlankFrom(text, pos + runLength(text, pos, c));
+    }
+
+    bool isHtmlBlockStart(const QString& text, int pos)
+    {
+        if (pos + 1 >= text.size() || text.at(pos) != QLatin1Char('<'))
+            return false;
+        QChar next = text.at(pos + 1);
+        return next.isLetter() || next == QLatin1Char('/') || next == QLatin1Char('!') || next == QLatin1Char('?');
+    }
+
+    // 列表标记（- * + 或 1. 1)）的长度，不是列表项时返回 0
+    int listMarkerLength(const QString& text, int pos)
+    {
+        if (pos >= text.size())
+            return 0;
+
+        int end = pos;
+        QChar c = text.at(pos);
+        if (c == QLatin1Char('-') || c == QLatin1Char('*') || c == QLatin1Char('+'))
+        {
+            end = pos + 1;
+        }
+        else
+        {
+            while (end < text.size() && end - pos < 9 && text.at(end).isDigit())
+                ++end;
+            if (end == pos || end >= text.size())
+                return 0;
+            if (text.at(end) != QLatin1Char('.') && text.at(end) != QLatin1Char(')'))
+                return 0;
+            ++end;
+        }
+
+        if (end < text.size() && !isSpace(text.at(end)))
+            return 0;
+        return end - pos;
+    }
+}
+
+// ============ MarkdownBlockState 实现 ============
+int MarkdownBlockState::encode() const
+{
+    return context
+         | (qMin(fenceLength, 63) << 2)
+         | (tildeFence ? 1 << 8 : 0)
+         | (qMin(quoteDepth, 15) << 9)
+         | (inList ? 1 << 13 : 0)
+         | (previousBlank ? 1 << 14 : 0)
+         | (paragraph ? 1 << 15 : 0);
+}
+
+MarkdownBlockState MarkdownBlockState::decode(int value)
+{
+    MarkdownBlockState state;
+    if (value < 0)
+        return state;
+
+    state.context = value & 0x3;
+    state.fenceLength = (value >> 2) & 0x3f;
+    state.tildeFence = value & (1 << 8);
+    state.quoteDepth = (value >> 9) & 0xf;
+    state.inList = value & (1 << 13);
+    state.previousBlank = value & (1 << 14);
+    state.paragraph = value & (1 << 15);
+    return state;
+}
+
+// ============ MarkdownHighlighter 实现 ============
+MarkdownHighlighter::MarkdownHighlighter(CodeEditor* editor)
+    : QObject(editor)
+    , m_editor(editor)
+    , m_document(editor->document())
+    , m_pendingFrom(-1)
+    , m_pendingUntil(-1)
+    , m_lastBlockCount(editor->document()->blockCount())
+    , m_applying(false)
+    , m_outline(new OutlineIndex(this))
+    , m_headingLevel(0)
+    , m_setextHeading(false)
+{
+    m_headingFormat.setForeground(SyntaxTheme::pink);
+    m_headingFormat.setFontWeight(QFont::Bold);
+    m_emphasisFormat.setForeground(SyntaxTheme::yellow);
+    m_emphasisFormat.setFontItalic(true);
+    m_strongFormat.setForeground(SyntaxTheme::orange);
+    m_strongFormat.setFontWeight(QFont::Bold);
+    m_codeFormat.setForeground(SyntaxTheme::green);
+    m_fenceFormat.setForeground(SyntaxTheme::comment);
+    m_linkFormat.setForeground(SyntaxTheme::blue);
+    m_urlFormat.setForeground(SyntaxTheme::comment);
+    m_urlFormat.setFontUnderline(true);
+    m_quoteFormat.setForeground(SyntaxTheme::comment);
+    m_quoteFormat.setFontItalic(true);
+    m_listFormat.setForeground(SyntaxTheme::orange);
+    m_htmlFormat.setForeground(SyntaxTheme::purple);
+    m_ruleFormat.setForeground(SyntaxTheme::comment);
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(0);
+
+    connect(&m_idleTimer, &QTimer::timeout, this, &MarkdownHighlighter::processPending);
+    connect(m_document, &QTextDocument::contentsChange, this, &MarkdownHighlighter::onContentsChange);
+    connect(editor, &CodeEditor::updateRequest, this, &MarkdownHighlighter::onViewportChanged);
+}
+
+void MarkdownHighlighter::rehighlightAll()
+{
+    m_idleTimer.stop();
+    m_pendingFrom = 0;
+    m_pendingUntil = m_document->blockCount() - 1;
+    highlightPending(std::numeric_limits<qint64>::max());
+}
+
+void MarkdownHighlighter::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    if (m_applying)
+        return;
+
+    const int blockCount = m_document->blockCount();
+    const int delta = blockCount - m_lastBlockCount;
+    m_lastBlockCount = blockCount;
+
+    // 插入到文档末尾时 position + charsAdded 越过最后一块，findBlock 返回无效块（块号 -1）
+    const int first = qMax(0, m_document->findBlock(position).blockNumber());
+    int last = m_document->findBlock(position + charsAdded).blockNumber();
+    if (last < 0)
+        last = blockCount - 1;
+    m_outline->blocksChanged(last, delta);
+
+    // 已有的待处理区间位于编辑点之后时，随增删的行数平移
+    if (m_pendingFrom >= 0)
+    {
+        if (m_pendingFrom > first)
+            m_pendingFrom = qMax(first, m_pendingFrom + delta);
+        if (m_pendingUntil > first)
+            m_pendingUntil = qMax(first, m_pendingUntil + delta);
+        m_pendingFrom = qMin(m_pendingFrom, first);
+        m_pendingUntil = qMax(m_pendingUntil, last);
+    }
+    else
+    {
+        m_pendingFrom = first;
+        m_pendingUntil = last;
+    }
+
+    // 通常只需重新高亮编辑所在的块；状态级联过长时先顾及可见块，剩余部分空闲时完成
+    if (!highlightPending(SyncBudgetNs))
+    {
+        highlightVisibleBlocks();
+        m_idleTimer.start();
+    }
+}
+
+void MarkdownHighlighter::onViewportChanged()
+{
+    if (m_pendingFrom >= 0)
+        highlightVisibleBlocks();
+}
+
+void MarkdownHighlighter::processPending()
+{
+    if (m_pendingFrom >= 0 && !highlightPending(SliceBudgetNs))
+        m_idleTimer.start();
+}
+
+bool MarkdownHighlighter::highlightPending(qint64 budgetNs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int number = m_pendingFrom;
+    QTextBlock block = m_document->findBlockByNumber(number);
+    MarkdownBlockState incoming = stateBefore(block);
+    int changedFrom = -1;
+    int changedTo = -1;
+
+    while (block.isValid())
+    {
+        const int oldState = block.userState();
+        incoming = highlightBlock(block, incoming);
+        updateOutline(block, number);
+        const int newState = incoming.encode();
+        block.setUserState(newState);
+        if (oldState != newState)
+        {
+            if (changedFrom < 0)
+                changedFrom = number;
+            changedTo = number;
+        }
+
+        // 越过编辑区间后，传出状态不变即说明后续块无需处理
+        if (number >= m_pendingUntil && oldState == newState)
+            break;
+
+        block = block.next();
+        ++number;
+
+        if (block.isValid() && timer.nsecsElapsed() > budgetNs)
+        {
+            m_pendingFrom = number;
+            if (changedFrom >= 0)
+                emit blockStatesChanged(changedFrom, changedTo);
+            return false;
+        }
+    }
+
+    m_pendingFrom = -1;
+    m_pendingUntil = -1;
+    if (changedFrom >= 0)
+        emit blockStatesChanged(changedFrom, changedTo);
+    return true;
+}
+
+void MarkdownHighlighter::highlightVisibleBlocks()
+{
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+
+    // 待处理区间起点之后的可见块都可能已过时（包括级联尚未到达、编辑区间之后的块），
+    // 按顺序重新高亮，每块以前一块刚算出的状态作为暂定输入
+    first = qMax(first, m_pendingFrom);
+    if (first > last)
+        return;
+    QTextBlock block = m_document->findBlockByNumber(first);
+    int changedFrom = -1;
+    int changedTo = -1;
+    for (int number = first; block.isValid() && number <= last; ++number)
+    {
+        const int oldState = block.userState();
+        const int newState = highlightBlock(block, stateBefore(block)).encode();
+        block.setUserState(newState);
+        updateOutline(block, number);
+        if (oldState != newState)
+        {
+            if (changedFrom < 0)
+                changedFrom = number;
+            changedTo = number;
+        }
+        block = block.next();
+    }
+    if (changedFrom >= 0)
+        emit blockStatesChanged(changedFrom, changedTo);
+
+    // 可见块的状态已按新输入更新，级联到达时会误以为状态没有变化而提前停止；
+    // 至少处理到可见区之后的第一块，由它未被改动过的旧状态判断是否还要继续
+    m_pendingUntil = qMax(m_pendingUntil, last + 1);
+}
+
+MarkdownBlockState MarkdownHighlighter::stateBefore(const QTextBlock& block) const
+{
+    QTextBlock previous = block.previous();
+    if (!previous.isValid())
+        return MarkdownBlockState();
+    return MarkdownBlockState::decode(previous.userState());
+}
+
+void MarkdownHighlighter::updateOutline(const QTextBlock& block, int number)
+{
+    m_outline->setHeading(number, m_headingLevel, m_headingTitle, m_setextHeading);
+    // 只修改 Setext 标题的文字行时状态不变，级联不会到达下划线，在这里顺带更新
+    if (m_headingLevel == 0)
+        m_outline->setSetextTitle(number + 1, block.text().trimmed());
+}
+
+MarkdownBlockState MarkdownHighlighter::highlightBlock(QTextBlock& block, const MarkdownBlockState& in)
+{
+    const QString text = block.text();
+    QList<QTextLayout::FormatRange> formats;
+    MarkdownBlockState out = in;
+    m_headingLevel = 0;
+    m_setextHeading = false;
+    m_headingTitle.clear();
+
+    // 引用标记 ">"，围栏代码内仅在外层本身处于引用中时识别
+    int pos = 0;
+    int depth = 0;
+    if (in.context == MarkdownBlockState::Normal || in.quoteDepth > 0)
+    {
+        int probe = skipSpaces(text, 0);
+        while (probe < text.size() && text.at(probe) == QLatin1Char('>'))
+        {
+            ++depth;
+            pos = probe = skipSpaces(text, probe + 1);
+        }
+        if (depth > 0)
+            addFormat(formats, 0, text.size(), m_quoteFormat);
+    }
+
+    const bool blank = isBlankFrom(text, pos);
+
+    if (in.context == MarkdownBlockState::FencedCode)
+    {
+        int start = skipSpaces(text, pos);
+        if (isClosingFence(text, start, in))
+        {
+            addFormat(formats, start, text.size() - start, m_fenceFormat);
+            out.context = MarkdownBlockState::Normal;
+            out.fenceLength = 0;
+            out.tildeFence = false;
+        }
+        else
+        {
+            addFormat(formats, pos, text.size() - pos, m_codeFormat);
+        }
+        out.previousBlank = false;
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    if (in.context == MarkdownBlockState::HtmlBlock)
+    {
+        if (blank)
+        {
+            out.context = MarkdownBlockState::Normal;
+            out.previousBlank = true;
+        }
+        else
+        {
+            addFormat(formats, pos, text.size() - pos, m_htmlFormat);
+        }
+        applyFormats(block, formats);
+        return out;
+    }
+
+    out.quoteDepth = depth;
+    if (blank)
+    {
+        out.previousBlank = true;
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    const int start = skipSpaces(text, pos);
+    const int indent = indentWidth(text, pos, start);
+    const bool wasBlank = in.previousBlank;
+    out.previousBlank = false;
+
+    // 缩进代码块
+    if (indent >= 4 && wasBlank && !in.inList)
+    {
+        addFormat(formats, pos, text.size() - pos, m_codeFormat);
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    bool tilde = false;
+    int fence = openingFence(text, start, &tilde);
+    if (fence > 0)
+    {
+        addFormat(formats, start, text.size() - start, m_fenceFormat);
+        out.context = MarkdownBlockState::FencedCode;
+        out.fenceLength = fence;
+        out.tildeFence = tilde;
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    if (const int level = atxLevel(text, start))
+    {
+        m_headingLevel = level;
+        m_headingTitle = atxTitle(text, start, level);
+        addFormat(formats, start, text.size() - start, m_headingFormat);
+        highlightInline(text, start, formats);
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    if (in.paragraph && isSetextUnderline(text, start))
+    {
+        m_headingLevel = text.at(start) == QLatin1Char('=') ? 1 : 2;
+        m_setextHeading = true;
+        m_headingTitle = block.previous().text().trimmed();
+        addFormat(formats, start, text.size() - start, m_headingFormat);
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    if (isThematicBreak(text, start))
+    {
+        addFormat(formats, start, text.size() - start, m_ruleFormat);
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    if (isHtmlBlockStart(text, start))
+    {
+        addFormat(formats, start, text.size() - start, m_htmlFormat);
+        out.context = MarkdownBlockState::HtmlBlock;
+        out.paragraph = false;
+        applyFormats(block, formats);
+        return out;
+    }
+
+    int contentStart = start;
+    int marker = listMarkerLength(text, start);
+    if (marker > 0)
+    {
+        addFormat(formats, start, marker, m_listFormat);
+        out.inList = true;
+        contentStart = start + marker;
+    }
+    else if (wasBlank && indent < 2)
+    {
+        out.inList = false;
+    }
+
+    highlightInline(text, contentStart, formats);
+    out.paragraph = true;
+    applyFormats(block, formats);
+    return out;
+}
+
+void MarkdownHighlighter::highlightInline(const QString& text, int from, QList<QTextLayout::FormatRange>& formats) const
+{
+    const int n = text.size();
+    const QStringView view(text);
+    int i = from;
+
+    while (i < n)
+    {
+        const QChar c = text.at(i);
+
+        // 转义字符
+        if (c == QLatin1Char('\\'))
+        {
+            i += 2;
+            continue;
+        }
+
+        // 行内代码：查找等长的反引号串
+        if (c == QLatin1Char('`'))
+        {
+            const int run = runLength(text, i, c);
+            int close = -1;
+            for (int j = i + run; j < n; )
+            {
+                if (text.at(j) != c)
+                {
+                    ++j;
+                    continue;
+                }
+                int k = runLength(text, j, c);
+                if (k == run)
+                {
+                    close = j;
+                    break;
+                }
+                j += k;
+            }
+
+            if (close >= 0)
+            {
+                addFormat(formats, i, close + run - i, m_codeFormat);
+                i = close + run;
+            }
+            else
+            {
+                i += run;
+            }
+            continue;
+        }
+
+        // 强调与加粗
+        if (c == QLatin1Char('*') || c == QLatin1Char('_'))
+        {
+            const int run = runLength(text, i, c);
+            const int markerLength = run >= 2 ? 2 : 1;
+            if (i + run < n && !text.at(i + run).isSpace())
+            {
+                const QString marker(markerLength, c);
+                int close = text.indexOf(marker, i + run);
+                while (close >= 0 && text.at(close - 1).isSpace())
+                    close = text.indexOf(marker, close + 1);
+
+                if (close >= 0)
+                {
+                    addFormat(formats, i, close + markerLength - i, markerLength == 2 ? m_strongFormat : m_emphasisFormat);
+                    i = close + markerLength;
+                    continue;
+                }
+            }
+            i += run;
+            continue;
+        }
+
+        // 链接与图片 [text](url)
+        if (c == QLatin1Char('['))
+        {
+            const int closeBracket = text.indexOf(QLatin1Char(']'), i + 1);
+            if (closeBracket > 0 && closeBracket + 1 < n && text.at(closeBracket + 1) == QLatin1Char('('))
+            {
+                const int closeParen = text.indexOf(QLatin1Char(')'), closeBracket + 2);
+                if (closeParen > 0)
+                {
+                    addFormat(formats, i, closeBracket + 1 - i, m_linkFormat);
+                    addFormat(formats, closeBracket + 1, closeParen - closeBracket, m_urlFormat);
+                    i = closeParen + 1;
+                    continue;
+                }
+            }
+            ++i;
+            continue;
+        }
+
+        // 自动链接 <https://...> 与裸 URL
+        if (c == QLatin1Char('<') || c == QLatin1Char('h'))
+        {
+            const int urlStart = c == QLatin1Char('<') ? i + 1 : i;
+            const QStringView rest = view.mid(urlStart);
+            const bool isUrl = rest.startsWith(QLatin1String("http://")) || rest.startsWith(QLatin1String("https://"));
+            const bool boundary = (i == 0 || !text.at(i - 1).isLetterOrNumber());
+            if (isUrl && boundary)
+            {
+                int end = urlStart;
+                while (end < n && !text.at(end).isSpace() && text.at(end) != QLatin1Char('>'))
+                    ++end;
+                if (c == QLatin1Char('<') && end < n)
+                    ++end;
+                addFormat(formats, i, end - i, m_urlFormat);
+                i = end;
+                continue;
+            }
+        }
+
+        ++i;
+    }
+}
+
+void MarkdownHighlighter::applyFormats(QTextBlock& block, const QList<QTextLayout::FormatRange>& formats)
+{
+    // 格式未变化时不触发重新排版
+    QTextLayout* layout = block.layout();
+    if (layout->formats() == formats)
+        return;
+
+    layout->setFormats(formats);
+
+    m_applying = true;
+    m_document->markContentsDirty(block.position(), block.length());
+    m_applying = false;
+}
@@ -0,0 +1,92 @@
+#ifndef MARKDOWNHIGHLIGHTER_H
+#define MARKDOWNHIGHLIGHTER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextLayout>
+
+class CodeEditor;
+class OutlineIndex;
+class QTextDocument;
+
+// 块之间传递的 Markdown 解析状态，编码后存放在 QTextBlock::userState() 中
+struct MarkdownBlockState
+{
+    enum Context { Normal = 0, FencedCode = 1, HtmlBlock = 2 };
+
+    int context = Normal;
+    int fenceLength = 0;
+    bool tildeFence = false;
+    int quoteDepth = 0;
+    bool inList = false;
+    bool previousBlank = true;
+    bool paragraph = false;
+
+    int encode() const;
+    static MarkdownBlockState decode(int value);
+};
+
+// 增量 Markdown 高亮：只重新高亮传入状态发生变化的块。
+// 编辑所在块同步处理，超出时间预算后先处理可见块，其余在空闲时分片完成。
+// 高亮的同时维护标题索引（大纲），索引只随被重新高亮的块更新
+class MarkdownHighlighter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MarkdownHighlighter(CodeEditor* editor);
+
+    bool isPending() const { return m_pendingFrom >= 0; }
+    // 同步完成全部高亮（基准测试与导出等场景使用）
+    void rehighlightAll();
+
+    OutlineIndex* outline() const { return m_outline; }
+
+signals:
+    // [first, last] 内的块重新高亮后解析状态（userState）发生了变化，块号为编辑后的编号。
+    // 格式不变时没有 contentsChange 通知，依赖块状态的视图（如缩略图）据此失效
+    void blockStatesChanged(int first, int last);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onViewportChanged();
+    void processPending();
+
+private:
+    bool highlightPending(qint64 budgetNs);
+    void highlightVisibleBlocks();
+    MarkdownBlockState stateBefore(const QTextBlock& block) const;
+    MarkdownBlockState highlightBlock(QTextBlock& block, const MarkdownBlockState& incoming);
+    void updateOutline(const QTextBlock& block, int number);
+    void highlightInline(const QString& text, int from, QList<QTextLayout::FormatRange>& formats) const;
+    void applyFormats(QTextBlock& block, const QList<QTextLayout::FormatRange>& formats);
+
+    CodeEditor* m_editor;
+    QTextDocument* m_document;
+    QTimer m_idleTimer;
+    int m_pendingFrom;    // 待处理区间起点（块号），-1 表示没有待处理的块
+    int m_pendingUntil;   // 越过该块且状态不再变化时即可停止
+    int m_lastBlockCount;
+    bool m_applying;
+    OutlineIndex* m_outline;
+    // 最近一次 highlightBlock 识别出的标题，级别为 0 表示不是标题
+    int m_headingLevel;
+    bool m_setextHeading;
+    QString m_headingTitle;
+
+    QTextCharFormat m_headingFormat;
+    QTextCharFormat m_emphasisFormat;
+    QTextCharFormat m_strongFormat;
+    QTextCharFormat m_codeFormat;
+    QTextCharFormat m_fenceFormat;
+    QTextCharFormat m_linkFormat;
+    QTextCharFormat m_urlFormat;
+    QTextCharFormat m_quoteFormat;
+    QTextCharFormat m_listFormat;
+    QTextCharFormat m_htmlFormat;
+    QTextCharFormat m_ruleFormat;
+};
+
+#endif // MARKDOWNHIGHLIGHTER_H
@@ -0,0 +1,374 @@
+#include "markdownpreview.h"
+#include "codeeditor.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QTextDocument>
+#include <QThread>
+#include <QMultiHash>
+#include <QtMath>
+#include <algorithm>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace PreviewTheme {
+    const QColor background(39, 40, 34);       // #272822
+    const QColor foregroundDim(117, 113, 94);  // #75715e
+}
+
+namespace {
+    const int Margin = 16;
+    const int BlockSpacing = 10;
+    // 两次渲染之间的最短与最长间隔，实际间隔随上一次渲染耗时自适应
+    const int MinDebounceMs = 16;
+    const int MaxDebounceMs = 250;
+    // 超过该字符数的文档不再实时预览
+    const int PreviewSizeLimit = 8 * 1024 * 1024;
+
+    const QString PreviewStyleSheet = QStringLiteral(
+        "h1, h2, h3, h4, h5, h6 { color: #f92672; }"
+        "a { color: #66d9ef; }"
+        "code { color: #a6e22e; font-family: Menlo, Consolas, monospace; }"
+        "pre { background-color: #1e1f1c; }"
+        "blockquote { color: #75715e; margin-left: 12px; }"
+        "th { color: #e6db74; }"
+        "table { border-collapse: collapse; }"
+        "th, td { border: 1px solid #49483e; padding: 4px; }");
+}
+
+MarkdownPreview::MarkdownPreview(CodeEditor* editor, QWidget* parent)
+    : QAbstractScrollArea(parent)
+    , m_editor(editor)
+    , m_worker(nullptr)
+    , m_cancelled(false)
+    , m_contentHeight(0)
+    , m_rendering(false)
+    , m_renderAgain(false)
+    , m_dirty(true)
+    , m_latencyPending(false)
+    , m_awaitingPaint(false)
+    , m_tooLarge(false)
+    , m_lastLatencyMs(0)
+{
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    verticalScrollBar()->setSingleStep(20);
+
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(MinDebounceMs);
+
+    connect(&m_debounceTimer, &QTimer::timeout, this, &MarkdownPreview::startRender);
+    connect(editor->document(), &QTextDocument::contentsChange, this, &MarkdownPreview::onContentsChange);
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &MarkdownPreview::syncToEditor);
+}
+
+MarkdownPreview::~MarkdownPreview()
+{
+    m_cancelled = true;
+    if (m_worker)
+    {
+        m_worker->wait();
+        delete m_worker;
+    }
+}
+
+void MarkdownPreview::onContentsChange()
+{
+    // 从第一次未反映到预览中的编辑开始计时
+    if (!m_latencyPending)
+    {
+        m_editTimer.start();
+        m_latencyPending = true;
+    }
+    scheduleRender();
+}
+
+void MarkdownPreview::releaseContent()
+{
+    for (const PreviewBlock& block : std::as_const(m_blocks))
+        delete block.document;
+    m_blocks.clear();
+    m_cache.clear();
+    layoutFrom(0);
+    m_dirty = true;
+    m_latencyPending = false;
+}
+
+void MarkdownPreview::scheduleRender()
+{
+    // 不可见（非当前 Tab）时只记下需要渲染，显示时再处理
+    if (!isVisible())
+    {
+        m_dirty = true;
+        return;
+    }
+    m_dirty = false;
+    m_debounceTimer.start();
+}
+
+void MarkdownPreview::startRender()
+{
+    // 同一时间只有一次渲染在进行，期间的编辑合并到下一次
+    if (m_rendering)
+    {
+        m_renderAgain = true;
+        return;
+    }
+    if (m_worker)
+    {
+        m_worker->wait();
+        delete m_worker;
+        m_worker = nullptr;
+    }
+
+    if (m_editor->document()->characterCount() > PreviewSizeLimit)
+    {
+        m_tooLarge = true;
+        for (const PreviewBlock& block : std::as_const(m_blocks))
+            delete block.document;
+        m_blocks.clear();
+        m_cache.clear();
+        layoutFrom(0);
+        m_latencyPending = false;
+        viewport()->update();
+        return;
+    }
+    m_tooLarge = false;
+    m_rendering = true;
+    m_renderAgain = false;
+
+    // 文本与缓存都是隐式共享的副本，工作线程只读
+    const QString text = m_editor->toPlainText();
+    const QHash<QString, QString> cache = m_cache;
+    m_worker = QThread::create([this, text, cache]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        RenderResult result;
+        result.blocks = MarkdownParser::splitBlocks(text);
+        result.html.reserve(result.blocks.size());
+        for (const MarkdownSourceBlock& block : std::as_const(result.blocks))
+        {
+            if (m_cancelled)
+                return;
+            auto it = cache.constFind(block.source);
+            QString html = it != cache.constEnd() ? it.value() : MarkdownParser::renderBlock(block.source);
+            result.cache.insert(block.source, html);
+            result.html.append(html);
+        }
+        result.elapsedMs = timer.elapsed();
+
+        // 析构时会等待线程退出，投递给已销毁对象的事件也会被丢弃
+        QMetaObject::invokeMethod(this, [this, result]() { applyResult(result); }, Qt::QueuedConnection);
+    });
+    m_worker->start();
+}
+
+void MarkdownPreview::applyResult(const RenderResult& result)
+{
+    m_rendering = false;
+    m_cache = result.cache;
+    m_debounceTimer.setInterval(qBound(MinDebounceMs, int(result.elapsedMs), MaxDebounceMs));
+
+    // 与上一次结果比较：公共前缀与后缀保持不动，只替换中间发生变化的块
+    const int oldCount = m_blocks.size();
+    const int newCount = result.blocks.size();
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && m_blocks[prefix].source == result.blocks[prefix].source)
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+           && m_blocks[oldCount - 1 - suffix].source == result.blocks[newCount - 1 - suffix].source)
+        ++suffix;
+
+    // 中间区间内源码相同的块（如整段移动）复用已排版的文档
+    QMultiHash<QString, QTextDocument*> reusable;
+    for (int i = prefix; i < oldCount - suffix; ++i)
+        reusable.insert(m_blocks[i].source, m_blocks[i].document);
+
+    QVector<PreviewBlock> blocks;
+    blocks.reserve(newCount);
+    blocks.append(m_blocks.mid(0, prefix));
+    for (int i = prefix; i < newCount - suffix; ++i)
+    {
+        PreviewBlock block;
+        block.source = result.blocks[i].source;
+        auto it = reusable.find(block.source);
+        if (it != reusable.end())
+        {
+            block.document = it.value();
+            reusable.erase(it);
+        }
+        else
+        {
+            block.document = createDocument(result.html[i]);
+        }
+        blocks.append(block);
+    }
+    blocks.append(m_blocks.mid(oldCount - suffix));
+    qDeleteAll(reusable);
+    m_blocks = blocks;
+
+    for (int i = 0; i < newCount; ++i)
+    {
+        m_blocks[i].startLine = result.blocks[i].startLine;
+        m_blocks[i].lineCount = result.blocks[i].lineCount;
+    }
+
+    const bool changed = (newCount - suffix > prefix) || oldCount != newCount;
+    if (changed)
+        layoutFrom(prefix);
+    syncToEditor();
+
+    if (m_renderAgain)
+    {
+        scheduleRender();
+    }
+    else if (changed)
+    {
+        m_awaitingPaint = true;
+        viewport()->update();
+    }
+    else
+    {
+        finishLatency();
+    }
+}
+
+QTextDocument* MarkdownPreview::createDocument(const QString& html)
+{
+    QTextDocument* document = new QTextDocument(this);
+    document->setUndoRedoEnabled(false);
+    document->setDocumentMargin(0);
+    document->setDefaultFont(font());
+    document->setDefaultStyleSheet(PreviewStyleSheet);
+    document->setHtml(html);
+    document->setTextWidth(contentWidth());
+    return document;
+}
+
+void MarkdownPreview::layoutFrom(int index)
+{
+    const int width = contentWidth();
+    qreal top = Margin;
+    if (index > 0 && index <= m_blocks.size())
+        top = m_blocks[index - 1].top + m_blocks[index - 1].height + BlockSpacing;
+
+    for (int i = index; i < m_blocks.size(); ++i)
+    {
+        PreviewBlock& block = m_blocks[i];
+        if (block.document->textWidth() != width)
+            block.document->setTextWidth(width);
+        block.top = top;
+        block.height = block.document->size().height();
+        top += block.height + BlockSpacing;
+    }
+    m_contentHeight = top + Margin;
+
+    QScrollBar* bar = verticalScrollBar();
+    bar->setPageStep(viewport()->height());
+    bar->setRange(0, qMax(0, qCeil(m_contentHeight) - viewport()->height()));
+    viewport()->update();
+}
+
+void MarkdownPreview::finishLatency()
+{
+    if (!m_latencyPending)
+        return;
+
+    m_latencyPending = false;
+    m_lastLatencyMs = m_editTimer.elapsed();
+    emit latencyMeasured(m_lastLatencyMs);
+}
+
+int MarkdownPreview::blockAt(qreal y) const
+{
+    auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), y, [](qreal value, const PreviewBlock& block) {
+        return value < block.top;
+    });
+    return qMax(0, int(it - m_blocks.cbegin()) - 1);
+}
+
+int MarkdownPreview::contentWidth() const
+{
+    return qMax(1, viewport()->width() - 2 * Margin);
+}
+
+void MarkdownPreview::syncToEditor()
+{
+    if (m_blocks.isEmpty())
+        return;
+
+    QScrollBar* editorBar = m_editor->verticalScrollBar();
+    QScrollBar* bar = verticalScrollBar();
+    if (editorBar->maximum() > 0 && editorBar->value() >= editorBar->maximum())
+    {
+        bar->setValue(bar->maximum());
+        return;
+    }
+
+    // 按编辑器首个可见行所在的块及块内比例定位
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+
+    auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), first, [](int line, const PreviewBlock& block) {
+        return line < block.startLine;
+    });
+    if (it == m_blocks.cbegin())
+    {
+        bar->setValue(0);
+        return;
+    }
+    --it;
+
+    qreal fraction = qBound(0.0, qreal(first - it->startLine) / qMax(1, it->lineCount), 1.0);
+    bar->setValue(qRound(it->top + fraction * it->height) - Margin);
+}
+
+void MarkdownPreview::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), PreviewTheme::background);
+
+    if (m_tooLarge)
+    {
+        painter.setPen(PreviewTheme::foregroundDim);
+        painter.drawText(viewport()->rect(), Qt::AlignCenter, "Preview is disabled for very large documents");
+        return;
+    }
+
+    // 只绘制与视口相交的块
+    const int scrollY = verticalScrollBar()->value();
+    const int height = viewport()->height();
+    for (int i = blockAt(scrollY); i < m_blocks.size(); ++i)
+    {
+        const PreviewBlock& block = m_blocks[i];
+        if (block.top - scrollY > height)
+            break;
+
+        painter.save();
+        painter.translate(Margin, block.top - scrollY);
+        block.document->drawContents(&painter, QRectF(0, 0, contentWidth(), block.height));
+        painter.restore();
+    }
+
+    if (m_awaitingPaint)
+    {
+        m_awaitingPaint = false;
+        finishLatency();
+    }
+}
+
+void MarkdownPreview::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    layoutFrom(0);
+    syncToEditor();
+}
+
+void MarkdownPreview::showEvent(QShowEvent* event)
+{
+    QAbstractScrollArea::showEvent(event);
+    if (m_dirty)
+        scheduleRender();
+}
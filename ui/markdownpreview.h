@@ -0,0 +1,89 @@
+#ifndef MARKDOWNPREVIEW_H
+#define MARKDOWNPREVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include "../core/markdownparser.h"
+
+class CodeEditor;
+class QTextDocument;
+class QThread;
+
+// 实时预览：在工作线程中切分并渲染顶层块，未变化的块复用缓存的 HTML；
+// 视图中每个顶层块对应一个独立排版的 QTextDocument，只替换发生变化的块
+class MarkdownPreview : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit MarkdownPreview(CodeEditor* editor, QWidget* parent = nullptr);
+    ~MarkdownPreview();
+
+    // 最近一次从编辑到预览完成绘制的耗时（毫秒）
+    qint64 lastLatencyMs() const { return m_lastLatencyMs; }
+    // 编辑器文档被脱水时释放已排版的块，再次显示时重新渲染
+    void releaseContent();
+
+signals:
+    void latencyMeasured(qint64 ms);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+
+private slots:
+    void onContentsChange();
+    void startRender();
+    void syncToEditor();
+
+private:
+    struct RenderResult
+    {
+        QVector<MarkdownSourceBlock> blocks;
+        QStringList html;
+        QHash<QString, QString> cache;
+        qint64 elapsedMs = 0;
+    };
+
+    struct PreviewBlock
+    {
+        QString source;
+        int startLine = 0;
+        int lineCount = 0;
+        QTextDocument* document = nullptr;
+        qreal top = 0;
+        qreal height = 0;
+    };
+
+    void scheduleRender();
+    void applyResult(const RenderResult& result);
+    QTextDocument* createDocument(const QString& html);
+    void layoutFrom(int index);
+    void finishLatency();
+    int blockAt(qreal y) const;
+    int contentWidth() const;
+
+    CodeEditor* m_editor;
+    QThread* m_worker;
+    std::atomic<bool> m_cancelled;
+    QTimer m_debounceTimer;
+    QElapsedTimer m_editTimer;
+
+    QHash<QString, QString> m_cache;   // 块源码 -> HTML，仅保留当前文档中的块
+    QVector<PreviewBlock> m_blocks;
+    qreal m_contentHeight;
+    bool m_rendering;
+    bool m_renderAgain;
+    bool m_dirty;
+    bool m_latencyPending;   // 有尚未反映到预览中的编辑
+    bool m_awaitingPaint;    // 结果已应用，等待下一次绘制完成计时
+    bool m_tooLarge;
+    qint64 m_lastLatencyMs;
+};
+
+#endif // MARKDOWNPREVIEW_H
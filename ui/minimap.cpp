@@ -0,0 +1,375 @@
+#include "minimap.h"
+#include "codeeditor.h"
+#include "markdownhighlighter.h"
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QThread>
+#include <algorithm>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace MinimapTheme {
+    const QColor background(34, 35, 30);
+    const QColor slider(255, 255, 255, 24);
+    const QColor text(248, 248, 242, 140);      // #f8f8f2
+    const QColor heading(249, 38, 114, 220);    // #f92672
+    const QColor code(166, 226, 46, 160);       // #a6e22e
+    const QColor quote(117, 113, 94, 200);      // #75715e
+}
+
+namespace {
+    const int LineHeight = 2;
+    const int Width = 100;
+    const int TabWidth = 4;
+    // 图块的目标行数；编辑使图块超过两倍时拆分，小于四分之一时与后一个合并
+    const int TileLines = 256;
+    // 快速滚动时排队的图块上限，超出时丢弃最早的请求
+    const int MaxQueuedJobs = 32;
+    const qint64 DefaultCacheBytes = 32 * 1024 * 1024;
+
+    enum LineKind : char { TextLine, HeadingLine, CodeLine, QuoteLine };
+
+    LineKind lineKind(const QString& text, const MarkdownBlockState& incoming)
+    {
+        if (incoming.context == MarkdownBlockState::FencedCode)
+            return CodeLine;
+
+        int pos = 0;
+        while (pos < text.size() && (text.at(pos) == QLatin1Char(' ') || text.at(pos) == QLatin1Char('\t')))
+            ++pos;
+        if (pos >= text.size())
+            return TextLine;
+
+        const QChar c = text.at(pos);
+        if (c == QLatin1Char('#'))
+            return HeadingLine;
+        if (c == QLatin1Char('>'))
+            return QuoteLine;
+        if (text.mid(pos, 3) == QLatin1String("```") || text.mid(pos, 3) == QLatin1String("~~~"))
+            return CodeLine;
+        return TextLine;
+    }
+}
+
+// ============ Minimap 实现 ============
+Minimap::Minimap(CodeEditor* editor)
+    : QWidget(editor)
+    , m_editor(editor)
+    , m_document(editor->document())
+    , m_nextId(1)
+    , m_lastBlockCount(editor->document()->blockCount())
+    , m_cache(DefaultCacheBytes)
+    , m_running(false)
+    , m_thread(nullptr)
+    , m_stopping(false)
+{
+    setCursor(Qt::PointingHandCursor);
+    resetTiles();
+
+    connect(m_document, &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+    connect(this, &Minimap::tileRendered, this, &Minimap::onTileRendered, Qt::QueuedConnection);
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, qOverload<>(&QWidget::update));
+    connect(editor->verticalScrollBar(), &QScrollBar::rangeChanged, this, qOverload<>(&QWidget::update));
+}
+
+Minimap::~Minimap()
+{
+    m_stopping = true;
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+int Minimap::preferredWidth()
+{
+    return Width;
+}
+
+void Minimap::setCacheLimit(qint64 bytes)
+{
+    m_cache.setMaxCost(qMax<qint64>(0, bytes));
+}
+
+void Minimap::resetTiles()
+{
+    m_tiles = makeTiles(0, m_document->blockCount());
+    m_cache.clear();
+    m_requested.clear();
+}
+
+std::vector<Minimap::Tile> Minimap::makeTiles(int start, int count)
+{
+    // 不超过两倍目标行数的保持为一个图块，否则按目标行数切分，余数并入最后一块
+    const int pieces = count > 2 * TileLines ? count / TileLines : 1;
+    std::vector<Tile> tiles(size_t(pieces));
+    for (int i = 0; i < pieces; ++i)
+    {
+        tiles[size_t(i)].start = start + i * TileLines;
+        tiles[size_t(i)].count = i + 1 < pieces ? TileLines : count - i * TileLines;
+        tiles[size_t(i)].id = m_nextId++;
+    }
+    return tiles;
+}
+
+int Minimap::tileAt(int line) const
+{
+    auto it = std::upper_bound(m_tiles.cbegin(), m_tiles.cend(), line,
+                               [](int value, const Tile& tile) { return value < tile.start; });
+    return qMax(0, int(it - m_tiles.cbegin()) - 1);
+}
+
+void Minimap::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    const int blockCount = m_document->blockCount();
+    const int delta = blockCount - m_lastBlockCount;
+    m_lastBlockCount = blockCount;
+
+    // 编辑后的块 [first, last] 在编辑前是 [first, last - delta]，按编辑前的图块编号查找
+    const int first = m_document->findBlock(position).blockNumber();
+    const int last = qMax(first, m_document->findBlock(position + charsAdded).blockNumber());
+    const int from = tileAt(first);
+    int to = tileAt(qMax(first, last - delta));
+
+    const int start = m_tiles[size_t(from)].start;
+    int count = m_tiles[size_t(to)].start + m_tiles[size_t(to)].count + delta - start;
+    if (count < TileLines / 4 && to + 1 < int(m_tiles.size()))
+    {
+        ++to;
+        count += m_tiles[size_t(to)].count;
+    }
+
+    // 只有覆盖被修改块的图块失效；之后的图块只平移起始行
+    for (int row = from; row <= to; ++row)
+    {
+        m_cache.remove(m_tiles[size_t(row)].id);
+        m_requested.remove(m_tiles[size_t(row)].id);
+    }
+    for (size_t row = size_t(to) + 1; row < m_tiles.size(); ++row)
+        m_tiles[row].start += delta;
+
+    std::vector<Tile> replacement = makeTiles(start, qMax(1, count));
+    if (int(replacement.size()) == to - from + 1)
+    {
+        std::copy(replacement.cbegin(), replacement.cend(), m_tiles.begin() + from);
+    }
+    else
+    {
+        m_tiles.erase(m_tiles.begin() + from, m_tiles.begin() + to + 1);
+        m_tiles.insert(m_tiles.begin() + from, replacement.cbegin(), replacement.cend());
+    }
+    update();
+}
+
+void Minimap::invalidateBlockStates(int first, int last)
+{
+    // 每行的颜色取决于前一块传出的状态，因此连同 last 的下一行；换新 id，在途的旧图像随之作废
+    const int lastLine = qMin(last + 1, m_document->blockCount() - 1);
+    for (int row = tileAt(first); row < int(m_tiles.size()) && m_tiles[size_t(row)].start <= lastLine; ++row)
+    {
+        Tile& tile = m_tiles[size_t(row)];
+        m_cache.remove(tile.id);
+        m_requested.remove(tile.id);
+        tile.id = m_nextId++;
+    }
+    update();
+}
+
+int Minimap::topLine() const
+{
+    // 文档比小地图高时按编辑器的滚动比例滚动
+    const int capacity = height() / LineHeight;
+    const int lines = m_document->blockCount();
+    if (lines <= capacity)
+        return 0;
+
+    const QScrollBar* bar = m_editor->verticalScrollBar();
+    const double ratio = bar->maximum() > 0 ? double(bar->value()) / bar->maximum() : 0.0;
+    return qRound(ratio * (lines - capacity));
+}
+
+void Minimap::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), MinimapTheme::background);
+
+    // 只贴可见范围内的图块，尚未缓存的交给工作线程，完成后再重绘
+    const int top = topLine();
+    const int bottom = top + height() / LineHeight + 1;
+    for (size_t row = size_t(tileAt(top)); row < m_tiles.size() && m_tiles[row].start < bottom; ++row)
+    {
+        const Tile& tile = m_tiles[row];
+        if (const QImage* image = m_cache.object(tile.id))
+        {
+            painter.drawImage(0, (tile.start - top) * LineHeight, *image);
+        }
+        else if (!m_requested.contains(tile.id))
+        {
+            m_requested.insert(tile.id);
+            schedule(makeJob(tile));
+        }
+    }
+
+    // 编辑器当前可见的区域
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+    painter.fillRect(QRect(0, (first - top) * LineHeight, width(), (last - first + 1) * LineHeight),
+                     MinimapTheme::slider);
+}
+
+void Minimap::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    // 图块按宽度光栅化，宽度变化后全部重画
+    if (event->oldSize().width() != width())
+    {
+        m_cache.clear();
+        m_requested.clear();
+    }
+}
+
+void Minimap::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton)
+        scrollToY(qRound(event->position().y()));
+}
+
+void Minimap::mouseMoveEvent(QMouseEvent* event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        scrollToY(qRound(event->position().y()));
+}
+
+void Minimap::wheelEvent(QWheelEvent* event)
+{
+    QCoreApplication::sendEvent(m_editor->verticalScrollBar(), event);
+}
+
+void Minimap::scrollToY(int y)
+{
+    // 点击的行移到编辑器中央
+    const int line = qBound(0, topLine() + y / LineHeight, m_document->blockCount() - 1);
+    QScrollBar* bar = m_editor->verticalScrollBar();
+    bar->setValue(line - bar->pageStep() / 2);
+}
+
+Minimap::Job Minimap::makeJob(const Tile& tile) const
+{
+    // 只取图块覆盖的行：按块号定位是 O(log n)，之后顺序遍历
+    Job job;
+    job.id = tile.id;
+    job.width = width();
+    job.lines.reserve(tile.count);
+    job.kinds.reserve(tile.count);
+
+    QTextBlock block = m_document->findBlockByNumber(tile.start);
+    MarkdownBlockState state;
+    if (block.previous().isValid())
+        state = MarkdownBlockState::decode(block.previous().userState());
+    for (int i = 0; i < tile.count && block.isValid(); ++i)
+    {
+        const QString text = block.text();
+        job.lines.append(text);
+        job.kinds.append(lineKind(text, state));
+        state = MarkdownBlockState::decode(block.userState());
+        block = block.next();
+    }
+    return job;
+}
+
+void Minimap::schedule(Job&& job)
+{
+    QMutexLocker locker(&m_mutex);
+    m_jobs.append(std::move(job));
+    if (m_jobs.size() > MaxQueuedJobs)
+    {
+        m_requested.remove(m_jobs.first().id);
+        m_jobs.removeFirst();
+    }
+
+    if (m_running)
+        return;
+
+    // 上一个工作线程已取空队列，等它退出后重新启动
+    m_running = true;
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void Minimap::run()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_jobs.isEmpty() || m_stopping)
+            {
+                m_running = false;
+                return;
+            }
+            // 后请求的先处理：滚动时最新可见的图块优先
+            job = m_jobs.takeLast();
+        }
+        emit tileRendered(job.id, render(job));
+    }
+}
+
+QImage Minimap::render(const Job& job)
+{
+    QImage image(qMax(1, job.width), qMax(1, int(job.lines.size()) * LineHeight), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const QRgb colors[] = {
+        qPremultiply(MinimapTheme::text.rgba()),
+        qPremultiply(MinimapTheme::heading.rgba()),
+        qPremultiply(MinimapTheme::code.rgba()),
+        qPremultiply(MinimapTheme::quote.rgba()),
+    };
+
+    // 每个字符一个像素，直接写扫描线，不经过 QPainter
+    for (int i = 0; i < job.lines.size(); ++i)
+    {
+        const QString& line = job.lines.at(i);
+        const QRgb color = colors[int(job.kinds.at(i))];
+        QRgb* pixels = reinterpret_cast<QRgb*>(image.scanLine(i * LineHeight));
+        int column = 0;
+        for (qsizetype j = 0; j < line.size() && column < image.width(); ++j)
+        {
+            const QChar c = line.at(j);
+            if (c == QLatin1Char('\t'))
+            {
+                column += TabWidth - column % TabWidth;
+                continue;
+            }
+            if (!c.isSpace())
+                pixels[column] = color;
+            ++column;
+        }
+    }
+    return image;
+}
+
+void Minimap::onTileRendered(quint64 id, const QImage& image)
+{
+    // 期间已失效（被编辑、被挤出队列或宽度变化）的图块直接丢弃
+    if (!m_requested.remove(id))
+        return;
+
+    m_cache.insert(id, new QImage(image), image.sizeInBytes());
+    update();
+}
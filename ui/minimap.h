@@ -0,0 +1,100 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+#include <atomic>
+#include <vector>
+
+class CodeEditor;
+class QTextDocument;
+class QThread;
+
+// 编辑器右侧的文档缩略图，每行 2 像素。文档按行切分为图块，
+// 图块在工作线程中光栅化，缓存在有内存上限的 LRU（QCache）中；
+// 编辑只让覆盖被修改块的图块失效，其后的图块只平移起始行、图像继续使用；
+// 高亮级联改变了块状态（如打开围栏代码块）时，受影响的图块也随之失效。
+// 绘制只贴可见的已缓存图块，滚动不随文档大小变慢
+class Minimap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit Minimap(CodeEditor* editor);
+    // 析构时等待正在光栅化的图块完成
+    ~Minimap();
+
+    static int preferredWidth();
+
+    qint64 cacheLimit() const { return m_cache.maxCost(); }
+    void setCacheLimit(qint64 bytes);
+
+public slots:
+    // 块 [first, last] 的解析状态已变化（连接到 MarkdownHighlighter::blockStatesChanged）
+    void invalidateBlockStates(int first, int last);
+
+signals:
+    // 工作线程发出，排队送到 GUI 线程
+    void tileRendered(quint64 id, const QImage& image);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onTileRendered(quint64 id, const QImage& image);
+
+private:
+    // 图块覆盖 [start, start + count) 行；id 随内容失效而更换，缓存以 id 为键
+    struct Tile
+    {
+        int start = 0;
+        int count = 0;
+        quint64 id = 0;
+    };
+
+    // 光栅化所需的行快照，在 GUI 线程中取出
+    struct Job
+    {
+        quint64 id = 0;
+        int width = 0;
+        QStringList lines;
+        QByteArray kinds;
+    };
+
+    void resetTiles();
+    std::vector<Tile> makeTiles(int start, int count);
+    int tileAt(int line) const;
+    int topLine() const;
+    void scrollToY(int y);
+    Job makeJob(const Tile& tile) const;
+    void schedule(Job&& job);
+    void run();
+    static QImage render(const Job& job);
+
+    CodeEditor* m_editor;
+    QTextDocument* m_document;
+    std::vector<Tile> m_tiles;     // 按起始行排序，首尾相接覆盖整个文档
+    quint64 m_nextId;
+    int m_lastBlockCount;
+    QCache<quint64, QImage> m_cache;
+    QSet<quint64> m_requested;
+
+    // 以下由 m_mutex 保护；工作线程只在有任务时存在，队列取空后退出
+    QMutex m_mutex;
+    QVector<Job> m_jobs;
+    bool m_running;
+    QThread* m_thread;
+    std::atomic<bool> m_stopping;
+};
+
+#endif // MINIMAP_H
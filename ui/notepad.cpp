@@ -4,7 +4,6 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QFile>
-#include <QTextStream>
 #include <QDir>
 #include <QFileInfo>
 #include <QFont>
@@ -14,6 +13,34 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QMouseEvent>
+#include <QPointer>
+#include <QSplitter>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QSettings>
+#include <QSignalBlocker>
+#include <QStandardPaths>
+#include <QCloseEvent>
+#include <QInputDialog>
+#include <QLocale>
+#include <QProgressDialog>
+#include <limits>
+#include "largefileview.h"
+#include "markdownpreview.h"
+#include "documentmanager.h"
+#include "documentsnapshot.h"
+#include "findbar.h"
+#include "findinfolderpanel.h"
+#include "outlinepanel.h"
+#include "minimap.h"
+#include "spellchecker.h"
+#include "documentstatistics.h"
+#include "undomanager.h"
+#include "../core/fileloader.h"
+#include "../core/filesaver.h"
+#include "../core/filereloader.h"
+#include "../core/fileregistry.h"
+#include "../core/editjournal.h"
 
 // ============ 颜色定义 ============
 namespace Theme {
@@ -28,16 +55,47 @@ namespace Theme {
     const QColor accentYellow(230, 219, 116);  // #e6db74
 }
 
+// 以 KB/MB/GB 显示字节数
+static QString formatBytes(qint64 bytes)
+{
+    if (bytes < 1024)
+        return QString("%1 B").arg(bytes);
+    if (bytes < 1024 * 1024)
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    if (bytes < 1024LL * 1024 * 1024)
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    return QString("%1 GB").arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+}
+
+// 超过该大小的文件改用 LargeFileView（PieceTable + 内存映射）打开
+static const qint64 LargeFileThreshold = 256LL * 1024 * 1024;
+
 // ============ CustomTabBar 实现 ============
+namespace {
+    // 标签位图缓存上限（KB）
+    const int TabPixmapCacheKB = 8 * 1024;
+
+    enum TabState { TabSelected = 1, TabHovered = 2, TabCloseHovered = 4 };
+
+    QRect closeButtonRectIn(const QRect& tabRect)
+    {
+        return QRect(tabRect.right() - 20, tabRect.center().y() - 6, 12, 12);
+    }
+}
+
 CustomTabBar::CustomTabBar(QWidget* parent)
     : QTabBar(parent)
     , m_hoverIndex(-1)
     , m_closeButtonHovered(false)
+    , m_pixmapCache(TabPixmapCacheKB)
 {
     setDrawBase(false);
     setExpanding(false);
     setElideMode(Qt::ElideRight);
     setMouseTracking(true);  // 启用鼠标追踪
+
+    m_tabFont = font();
+    m_tabFont.setPointSize(11);
 }
 
 QSize CustomTabBar::tabSizeHint(int index) const
@@ -52,21 +110,59 @@ QSize CustomTabBar::tabSizeHint(int index) const
 
 QRect CustomTabBar::closeButtonRect(int index) const
 {
-    QRect tabRect = this->tabRect(index);
-    return QRect(tabRect.right() - 20, tabRect.center().y() - 6, 12, 12);
+    return closeButtonRectIn(tabRect(index));
+}
+
+int CustomTabBar::tabIndexAt(const QPoint& pos) const
+{
+    // 标签按下标从左到右排列，按水平位置二分查找
+    int low = 0;
+    int high = count() - 1;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        QRect rect = tabRect(mid);
+        if (pos.x() < rect.left())
+            high = mid - 1;
+        else if (pos.x() > rect.right())
+            low = mid + 1;
+        else
+            return rect.contains(pos) ? mid : -1;
+    }
+    return -1;
+}
+
+int CustomTabBar::firstTabFrom(int x) const
+{
+    // 第一个右边界不小于 x 的标签
+    int low = 0;
+    int high = count();
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (tabRect(mid).right() < x)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+void CustomTabBar::updateTab(int index)
+{
+    if (index >= 0 && index < count())
+        update(tabRect(index));
 }
 
 void CustomTabBar::mousePressEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton)
     {
-        for (int i = 0; i < count(); i++)
+        int index = tabIndexAt(event->pos());
+        if (index >= 0 && closeButtonRect(index).contains(event->pos()))
         {
-            if (closeButtonRect(i).contains(event->pos()))
-            {
-                emit tabCloseClicked(i);
-                return;
-            }
+            emit tabCloseClicked(index);
+            return;
         }
     }
     QTabBar::mousePressEvent(event);
@@ -77,22 +173,15 @@ void CustomTabBar::mouseMoveEvent(QMouseEvent* event)
     int oldHoverIndex = m_hoverIndex;
     bool oldCloseHovered = m_closeButtonHovered;
     
-    m_hoverIndex = -1;
-    m_closeButtonHovered = false;
-    
-    for (int i = 0; i < count(); i++)
-    {
-        if (tabRect(i).contains(event->pos()))
-        {
-            m_hoverIndex = i;
-            m_closeButtonHovered = closeButtonRect(i).contains(event->pos());
-            break;
-        }
-    }
+    m_hoverIndex = tabIndexAt(event->pos());
+    m_closeButtonHovered = m_hoverIndex >= 0 && closeButtonRect(m_hoverIndex).contains(event->pos());
     
+    // 只重绘悬停状态发生变化的标签
     if (m_hoverIndex != oldHoverIndex || m_closeButtonHovered != oldCloseHovered)
     {
-        update();
+        updateTab(oldHoverIndex);
+        if (m_hoverIndex != oldHoverIndex)
+            updateTab(m_hoverIndex);
     }
     
     QTabBar::mouseMoveEvent(event);
@@ -100,94 +189,136 @@ void CustomTabBar::mouseMoveEvent(QMouseEvent* event)
 
 void CustomTabBar::leaveEvent(QEvent* event)
 {
+    int oldHoverIndex = m_hoverIndex;
     m_hoverIndex = -1;
     m_closeButtonHovered = false;
-    update();
+    updateTab(oldHoverIndex);
     QTabBar::leaveEvent(event);
 }
 
+void CustomTabBar::changeEvent(QEvent* event)
+{
+    QTabBar::changeEvent(event);
+    if (event->type() == QEvent::FontChange)
+    {
+        m_tabFont = font();
+        m_tabFont.setPointSize(11);
+        m_pixmapCache.clear();
+    }
+}
+
 void CustomTabBar::paintEvent(QPaintEvent* event)
 {
-    Q_UNUSED(event);
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
     
     // 绘制背景
-    painter.fillRect(rect(), Theme::backgroundDark);
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, Theme::backgroundDark);
     
-    for (int i = 0; i < count(); i++)
+    // 只绘制与重绘区域相交的标签
+    for (int i = firstTabFrom(dirty.left()); i < count(); i++)
     {
         QRect tabRect = this->tabRect(i);
+        if (tabRect.left() > dirty.right())
+            break;
+
         bool isSelected = (i == currentIndex());
         bool isHovered = (i == m_hoverIndex);
+        bool closeHovered = isHovered && m_closeButtonHovered;
+        painter.drawPixmap(tabRect.topLeft(), tabPixmap(i, isSelected, isHovered, closeHovered));
+    }
+}
+
+QPixmap CustomTabBar::tabPixmap(int index, bool isSelected, bool isHovered, bool closeHovered) const
+{
+    TabCacheKey key;
+    key.text = tabText(index);
+    key.size = tabRect(index).size();
+    key.state = (isSelected ? TabSelected : 0) | (isHovered ? TabHovered : 0) | (closeHovered ? TabCloseHovered : 0);
+    key.devicePixelRatio = devicePixelRatioF();
+
+    if (QPixmap* cached = m_pixmapCache.object(key))
+        return *cached;
+
+    QPixmap* pixmap = new QPixmap(key.size * key.devicePixelRatio);
+    pixmap->setDevicePixelRatio(key.devicePixelRatio);
+    pixmap->fill(Theme::backgroundDark);
+    {
+        QPainter painter(pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        renderTab(painter, QRect(QPoint(0, 0), key.size), key.text, isSelected, isHovered, closeHovered);
+    }
+
+    QPixmap result = *pixmap;
+    int cost = qMax(1, int(key.size.width() * key.size.height() * key.devicePixelRatio * key.devicePixelRatio * 4 / 1024));
+    m_pixmapCache.insert(key, pixmap, cost);
+    return result;
+}
+
+void CustomTabBar::renderTab(QPainter& painter, const QRect& tabRect, const QString& text,
+                             bool isSelected, bool isHovered, bool closeHovered) const
+{
+    // Tab 背景
+    QColor bgColor = Theme::backgroundDark;
+    if (isSelected)
+        bgColor = Theme::background;
+    else if (isHovered)
+        bgColor = Theme::backgroundLight;
+    
+    // 绘制圆角矩形背景（顶部圆角）
+    QPainterPath path;
+    int radius = 4;
+    path.moveTo(tabRect.left(), tabRect.bottom() + 1);
+    path.lineTo(tabRect.left(), tabRect.top() + radius);
+    path.quadTo(tabRect.left(), tabRect.top(), tabRect.left() + radius, tabRect.top());
+    path.lineTo(tabRect.right() - radius, tabRect.top());
+    path.quadTo(tabRect.right(), tabRect.top(), tabRect.right(), tabRect.top() + radius);
+    path.lineTo(tabRect.right(), tabRect.bottom() + 1);
+    path.closeSubpath();
+    
+    painter.fillPath(path, bgColor);
+    
+    // Tab 文字
+    QColor textColor = isSelected ? Theme::foreground : Theme::foregroundDim;
+    painter.setPen(textColor);
+    painter.setFont(m_tabFont);
+    
+    // 为关闭按钮留出空间
+    QRect textRect = tabRect.adjusted(10, 0, -24, 0);
+    QString elided = painter.fontMetrics().elidedText(text, Qt::ElideRight, textRect.width());
+    painter.drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft, elided);
+    
+    // 绘制关闭按钮（只在悬停时显示，或者选中时显示）
+    if (isSelected || isHovered)
+    {
+        QRect closeRect = closeButtonRectIn(tabRect);
         
-        // Tab 背景
-        QColor bgColor = Theme::backgroundDark;
-        if (isSelected)
-            bgColor = Theme::background;
-        else if (isHovered)
-            bgColor = Theme::backgroundLight;
-        
-        // 绘制圆角矩形背景（顶部圆角）
-        QPainterPath path;
-        int radius = 4;
-        path.moveTo(tabRect.left(), tabRect.bottom() + 1);
-        path.lineTo(tabRect.left(), tabRect.top() + radius);
-        path.quadTo(tabRect.left(), tabRect.top(), tabRect.left() + radius, tabRect.top());
-        path.lineTo(tabRect.right() - radius, tabRect.top());
-        path.quadTo(tabRect.right(), tabRect.top(), tabRect.right(), tabRect.top() + radius);
-        path.lineTo(tabRect.right(), tabRect.bottom() + 1);
-        path.closeSubpath();
-        
-        painter.fillPath(path, bgColor);
-        
-        // Tab 文字
-        QColor textColor = isSelected ? Theme::foreground : Theme::foregroundDim;
-        painter.setPen(textColor);
-        
-        QFont font = this->font();
-        font.setPointSize(11);
-        painter.setFont(font);
-        
-        // 为关闭按钮留出空间
-        QRect textRect = tabRect.adjusted(10, 0, -24, 0);
-        QString text = tabText(i);
-        text = painter.fontMetrics().elidedText(text, Qt::ElideRight, textRect.width());
-        painter.drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft, text);
-        
-        // 绘制关闭按钮（只在悬停时显示，或者选中时显示）
-        if (isSelected || isHovered)
+        if (closeHovered)
         {
-            QRect closeRect = closeButtonRect(i);
-            bool closeHovered = (i == m_hoverIndex && m_closeButtonHovered);
-            
-            if (closeHovered)
-            {
-                painter.setBrush(Theme::accent);
-                painter.setPen(Qt::NoPen);
-                painter.drawEllipse(closeRect);
-                painter.setPen(QPen(Theme::foreground, 1.5));
-            }
-            else
-            {
-                painter.setPen(QPen(Theme::foregroundDim, 1.2));
-            }
-            
-            // 绘制 X
-            int margin = 3;
-            painter.drawLine(closeRect.left() + margin, closeRect.top() + margin,
-                           closeRect.right() - margin, closeRect.bottom() - margin);
-            painter.drawLine(closeRect.right() - margin, closeRect.top() + margin,
-                           closeRect.left() + margin, closeRect.bottom() - margin);
+            painter.setBrush(Theme::accent);
+            painter.setPen(Qt::NoPen);
+            painter.drawEllipse(closeRect);
+            painter.setPen(QPen(Theme::foreground, 1.5));
         }
-        
-        // 选中的 Tab 底部高亮线
-        if (isSelected)
+        else
         {
-            painter.setPen(Qt::NoPen);
-            painter.setBrush(Theme::accentGreen);
-            painter.drawRect(tabRect.left() + 2, tabRect.bottom() - 1, tabRect.width() - 4, 2);
+            painter.setPen(QPen(Theme::foregroundDim, 1.2));
         }
+        
+        // 绘制 X
+        int margin = 3;
+        painter.drawLine(closeRect.left() + margin, closeRect.top() + margin,
+                       closeRect.right() - margin, closeRect.bottom() - margin);
+        painter.drawLine(closeRect.right() - margin, closeRect.top() + margin,
+                       closeRect.left() + margin, closeRect.bottom() - margin);
+    }
+    
+    // 选中的 Tab 底部高亮线
+    if (isSelected)
+    {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(Theme::accentGreen);
+        painter.drawRect(tabRect.left() + 2, tabRect.bottom() - 1, tabRect.width() - 4, 2);
     }
 }
 
@@ -206,10 +337,50 @@ CustomTabWidget::CustomTabWidget(QWidget* parent)
 // ============ Notepad 实现 ============
 Notepad::Notepad(QWidget *parent)
     : QMainWindow(parent)
+    , m_findBar(nullptr)
+    , m_findInFolder(nullptr)
+    , m_outlinePanel(nullptr)
+    , m_cancelLoadButton(nullptr)
+    , m_cancelLoadAction(nullptr)
+    , m_showPreviewAction(nullptr)
+    , m_showMinimapAction(nullptr)
+    , m_checkSpellingAction(nullptr)
+    , m_sessionStore(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/session")
     , m_untitledCount(0)
 {
     setWindowTitle("Markdown Editor");
     resize(1200, 800);
+
+    // 普通 Tab 的文档按内存预算脱水，预算可在配置中修改（单位 MB）
+    m_documents = new DocumentManager(this);
+    QSettings settings;
+    m_documents->setMemoryBudget(qint64(settings.value("memoryBudgetMB", 256).toInt()) * 1024 * 1024);
+    // 正在加载、保存或为导出取快照的文档不能脱水
+    m_documents->setCanDehydrate([this](CodeEditor* editor) {
+        QWidget* page = editor->parentWidget();
+        return !m_loaders.contains(editor) && !isSaving(page) && !editor->isInserting()
+               && !page->findChild<DocumentSnapshot*>(QString(), Qt::FindDirectChildrenOnly);
+    });
+    connect(m_documents, &DocumentManager::editorDehydrated, this, [this](CodeEditor* editor) {
+        if (MarkdownPreview* preview = previewAt(indexOfEditor(editor)))
+            preview->releaseContent();
+    });
+
+    // 已打开文件的登记表：按文件身份查重，并监视其他程序对文件的修改
+    m_files = new FileRegistry(this);
+    connect(m_files, &FileRegistry::fileChanged, this, &Notepad::onFileChangedOnDisk);
+    connect(m_files, &FileRegistry::fileRemoved, this, &Notepad::onFileRemovedOnDisk);
+
+    // 未保存的修改逐条写入崩溃恢复日志，下次启动时在磁盘文件上重放
+    m_journal = new EditJournal(m_sessionStore.directory() + "/journal", this);
+
+    // 会话中的其余 Tab 在首帧之后逐个恢复
+    m_restoreTimer.setInterval(50);
+    connect(&m_restoreTimer, &QTimer::timeout, this, &Notepad::restoreNextTab);
+
+    // 输入延迟只在状态栏显示时定期刷新
+    m_latencyTimer.setInterval(500);
+    connect(&m_latencyTimer, &QTimer::timeout, this, &Notepad::updateLatencyLabel);
     
     applyTheme();
     initUI();
@@ -217,6 +388,28 @@ Notepad::Notepad(QWidget *parent)
 
 Notepad::~Notepad()
 {
+    // 先停止后台加载线程、等待后台保存完成，再随窗口销毁编辑器
+    qDeleteAll(m_loaders);
+    m_loaders.clear();
+    qDeleteAll(m_snapshots);
+    m_snapshots.clear();
+    qDeleteAll(m_savers);
+    m_savers.clear();
+    qDeleteAll(m_reloadSnapshots);
+    m_reloadSnapshots.clear();
+    qDeleteAll(m_reloaders);
+    m_reloaders.clear();
+    // 未完成的导出被取消，目标文件不受影响
+    qDeleteAll(m_exporters);
+    m_exporters.clear();
+}
+
+void Notepad::closeEvent(QCloseEvent* event)
+{
+    // 会话保存了全部未保存内容，日志不再需要
+    if (saveSession())
+        m_journal->discardAll();
+    QMainWindow::closeEvent(event);
 }
 
 void Notepad::applyTheme()
@@ -247,12 +440,37 @@ void Notepad::applyTheme()
 
 void Notepad::initUI()
 {
+    // 查找栏位于编辑区下方，默认隐藏
+    m_findBar = new FindBar();
+    m_findBar->hide();
+    connect(m_findBar, &FindBar::message, this, [this](const QString& text) {
+        m_statusLabel->setText(text);
+    });
+
+    // 在文件夹中查找的结果面板停靠在底部，默认隐藏
+    m_findInFolder = new FindInFolderPanel(this);
+    m_findInFolder->hide();
+    addDockWidget(Qt::BottomDockWidgetArea, m_findInFolder);
+    connect(m_findInFolder, &FindInFolderPanel::openRequested, this, &Notepad::openFileAt);
+
+    // 当前文档的大纲停靠在左侧，默认隐藏
+    m_outlinePanel = new OutlinePanel(this);
+    m_outlinePanel->hide();
+    addDockWidget(Qt::LeftDockWidgetArea, m_outlinePanel);
+
     initMenuBar();
     initTabWidget();
     initStatusBar();
 
-    setCentralWidget(m_tabWidget);
-    onNewFile();
+    QWidget* central = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(central);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    layout->addWidget(m_tabWidget, 1);
+    layout->addWidget(m_findBar);
+    setCentralWidget(central);
+    if (!restoreSession())
+        onNewFile();
 }
 
 void Notepad::initMenuBar()
@@ -269,6 +487,9 @@ void Notepad::initMenuBar()
     QAction* openAction = fileMenu->addAction("Open File...");
     openAction->setShortcut(QKeySequence::Open);
     
+    m_cancelLoadAction = fileMenu->addAction("Cancel Loading");
+    m_cancelLoadAction->setEnabled(false);
+    
     fileMenu->addSeparator();
     
     QAction* saveAction = fileMenu->addAction("Save");
@@ -279,6 +500,11 @@ void Notepad::initMenuBar()
     
     fileMenu->addSeparator();
     
+    QAction* exportHtmlAction = fileMenu->addAction("Export to HTML...");
+    QAction* exportPdfAction = fileMenu->addAction("Export to PDF...");
+    
+    fileMenu->addSeparator();
+    
     QAction* closeTabAction = fileMenu->addAction("Close Tab");
     closeTabAction->setShortcut(QKeySequence("Ctrl+W"));
     
@@ -289,8 +515,11 @@ void Notepad::initMenuBar()
     
     connect(newAction, &QAction::triggered, this, &Notepad::onNewFile);
     connect(openAction, &QAction::triggered, this, &Notepad::onOpenFile);
+    connect(m_cancelLoadAction, &QAction::triggered, this, &Notepad::onCancelLoading);
     connect(saveAction, &QAction::triggered, this, &Notepad::onSaveFile);
     connect(saveAsAction, &QAction::triggered, this, &Notepad::onSaveAsFile);
+    connect(exportHtmlAction, &QAction::triggered, this, &Notepad::onExportHtml);
+    connect(exportPdfAction, &QAction::triggered, this, &Notepad::onExportPdf);
     connect(closeTabAction, &QAction::triggered, this, [this]() {
         onCloseTab(m_tabWidget->currentIndex());
     });
@@ -321,14 +550,44 @@ void Notepad::initMenuBar()
     QAction* selectAllAction = editMenu->addAction("Select All");
     selectAllAction->setShortcut(QKeySequence::SelectAll);
     
+    editMenu->addSeparator();
+    
+    QAction* findAction = editMenu->addAction("Find...");
+    findAction->setShortcut(QKeySequence::Find);
+
+    QAction* replaceAction = editMenu->addAction("Replace...");
+    replaceAction->setShortcut(QKeySequence("Ctrl+H"));
+
+    QAction* findNextAction = editMenu->addAction("Find Next");
+    findNextAction->setShortcut(QKeySequence::FindNext);
+
+    QAction* findPreviousAction = editMenu->addAction("Find Previous");
+    findPreviousAction->setShortcut(QKeySequence::FindPrevious);
+
+    QAction* findInFolderAction = editMenu->addAction("Find in Folder...");
+    findInFolderAction->setShortcut(QKeySequence("Ctrl+Shift+F"));
+
+    editMenu->addSeparator();
+    
+    QAction* goToLineAction = editMenu->addAction("Go to Line...");
+    goToLineAction->setShortcut(QKeySequence("Ctrl+G"));
+    
+    // 后台插入期间编辑器只读，撤销会打乱正在插入的文本
     connect(undoAction, &QAction::triggered, this, [this]() {
-        if (currentEditor()) currentEditor()->undo();
+        CodeEditor* editor = currentEditor();
+        if (editor && !editor->isReadOnly()) editor->undoManager()->undo();
     });
     connect(redoAction, &QAction::triggered, this, [this]() {
-        if (currentEditor()) currentEditor()->redo();
+        CodeEditor* editor = currentEditor();
+        if (editor && !editor->isReadOnly()) editor->undoManager()->redo();
     });
     connect(cutAction, &QAction::triggered, this, [this]() {
-        if (currentEditor()) currentEditor()->cut();
+        CodeEditor* editor = currentEditor();
+        if (!editor) return;
+        // 鼠标选中的选区可能不在撤销历史记下的窗口中
+        const QTextCursor cursor = editor->textCursor();
+        editor->undoManager()->prepareEdit(cursor.selectionStart(), cursor.selectionEnd());
+        editor->cut();
     });
     connect(copyAction, &QAction::triggered, this, [this]() {
         if (currentEditor()) currentEditor()->copy();
@@ -339,6 +598,24 @@ void Notepad::initMenuBar()
     connect(selectAllAction, &QAction::triggered, this, [this]() {
         if (currentEditor()) currentEditor()->selectAll();
     });
+    connect(findAction, &QAction::triggered, m_findBar, &FindBar::showFind);
+    connect(replaceAction, &QAction::triggered, m_findBar, &FindBar::showReplace);
+    connect(findNextAction, &QAction::triggered, m_findBar, &FindBar::findNext);
+    connect(findPreviousAction, &QAction::triggered, m_findBar, &FindBar::findPrevious);
+    connect(findInFolderAction, &QAction::triggered, this, [this]() {
+        // 默认在当前文件所在的文件夹中查找，并带上选中的单行文本
+        QString filePath = getFilePath(m_tabWidget->currentIndex());
+        QString folder = filePath.isEmpty() ? QString() : QFileInfo(filePath).absolutePath();
+        QString selected;
+        if (CodeEditor* editor = currentEditor())
+        {
+            selected = editor->textCursor().selectedText();
+            if (selected.contains(QChar::ParagraphSeparator))
+                selected.clear();
+        }
+        m_findInFolder->activate(folder, selected);
+    });
+    connect(goToLineAction, &QAction::triggered, this, &Notepad::onGoToLine);
     
     // View 菜单
     QMenu* viewMenu = menu->addMenu("View");
@@ -349,12 +626,85 @@ void Notepad::initMenuBar()
     QAction* zoomOutAction = viewMenu->addAction("Zoom Out");
     zoomOutAction->setShortcut(QKeySequence::ZoomOut);
     
+    viewMenu->addSeparator();
+
+    m_showPreviewAction = viewMenu->addAction("Show Preview");
+    m_showPreviewAction->setShortcut(QKeySequence("Ctrl+Shift+V"));
+    m_showPreviewAction->setCheckable(true);
+    m_showPreviewAction->setChecked(true);
+
+    m_showMinimapAction = viewMenu->addAction("Show Minimap");
+    m_showMinimapAction->setCheckable(true);
+    m_showMinimapAction->setChecked(QSettings().value("showMinimap", true).toBool());
+
+    m_checkSpellingAction = viewMenu->addAction("Check Spelling");
+    m_checkSpellingAction->setCheckable(true);
+    m_checkSpellingAction->setChecked(QSettings().value("checkSpelling", true).toBool());
+
+    QAction* outlineAction = m_outlinePanel->toggleViewAction();
+    outlineAction->setText("Show Outline");
+    outlineAction->setShortcut(QKeySequence("Ctrl+Shift+O"));
+    viewMenu->addAction(outlineAction);
+
+    viewMenu->addSeparator();
+
+    QAction* showLatencyAction = viewMenu->addAction("Show Input Latency");
+    showLatencyAction->setCheckable(true);
+
+    QAction* recordTraceAction = viewMenu->addAction("Record Latency Trace");
+    recordTraceAction->setCheckable(true);
+
+    QAction* exportTraceAction = viewMenu->addAction("Export Latency Trace...");
+
     connect(zoomInAction, &QAction::triggered, this, [this]() {
         if (currentEditor()) currentEditor()->zoomIn(2);
     });
     connect(zoomOutAction, &QAction::triggered, this, [this]() {
         if (currentEditor()) currentEditor()->zoomOut(2);
     });
+    connect(m_showPreviewAction, &QAction::toggled, this, [this](bool checked) {
+        for (int i = 0; i < m_tabWidget->count(); i++)
+        {
+            if (MarkdownPreview* preview = previewAt(i))
+                preview->setVisible(checked);
+        }
+    });
+    connect(m_showMinimapAction, &QAction::toggled, this, [this](bool checked) {
+        QSettings().setValue("showMinimap", checked);
+        for (int i = 0; i < m_tabWidget->count(); i++)
+        {
+            if (CodeEditor* editor = editorAt(i))
+                editor->setMinimapVisible(checked);
+        }
+    });
+    connect(m_checkSpellingAction, &QAction::toggled, this, [this](bool checked) {
+        QSettings().setValue("checkSpelling", checked);
+        for (int i = 0; i < m_tabWidget->count(); i++)
+        {
+            if (CodeEditor* editor = editorAt(i))
+                editor->spellChecker()->setEnabled(checked);
+        }
+    });
+    connect(showLatencyAction, &QAction::toggled, this, [this](bool checked) {
+        m_latencyLabel->setVisible(checked);
+        if (checked)
+        {
+            updateLatencyLabel();
+            m_latencyTimer.start();
+        }
+        else
+        {
+            m_latencyTimer.stop();
+        }
+    });
+    connect(recordTraceAction, &QAction::toggled, this, [this](bool checked) {
+        // 每次开始录制都从空的时间线开始
+        if (checked)
+            LatencyTrace::clear();
+        LatencyTrace::setEnabled(checked);
+        m_statusLabel->setText(checked ? "Recording latency trace" : QString("Latency trace stopped (%1 events)").arg(LatencyTrace::eventCount()));
+    });
+    connect(exportTraceAction, &QAction::triggered, this, &Notepad::exportLatencyTrace);
 }
 
 void Notepad::initTabWidget()
@@ -388,25 +738,72 @@ void Notepad::initStatusBar()
     m_cursorPosLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
     m_cursorPosLabel->setMinimumWidth(100);
     
+    // 字数统计，选区非空时显示选区的计数
+    m_statsLabel = new QLabel();
+    m_statsLabel->setFont(QFont("SF Pro Text", 11));
+    m_statsLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    
+    m_encodingLabel = new QLabel("UTF-8  LF");
+    m_encodingLabel->setFont(QFont("SF Pro Text", 11));
+    m_encodingLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+    m_memoryLabel = new QLabel();
+    m_memoryLabel->setFont(QFont("SF Pro Text", 11));
+    m_memoryLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    connect(m_documents, &DocumentManager::statsChanged, this, &Notepad::updateMemoryLabel);
+
+    // 输入延迟，默认隐藏，由 View 菜单开启
+    m_latencyLabel = new QLabel();
+    m_latencyLabel->setFont(QFont("SF Pro Text", 11));
+    m_latencyLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    m_latencyLabel->hide();
+    
+    // 加载大文件时显示的取消按钮
+    m_cancelLoadButton = new QToolButton();
+    m_cancelLoadButton->setDefaultAction(m_cancelLoadAction);
+    m_cancelLoadButton->setFont(QFont("SF Pro Text", 11));
+    m_cancelLoadButton->setAutoRaise(true);
+    m_cancelLoadButton->hide();
+    
     status->addWidget(m_statusLabel, 1);
+    status->addWidget(m_cancelLoadButton);
+    status->addPermanentWidget(m_memoryLabel);
+    status->addPermanentWidget(m_statsLabel);
+    status->addPermanentWidget(m_encodingLabel);
+    status->addPermanentWidget(m_latencyLabel);
     status->addPermanentWidget(m_cursorPosLabel);
 }
 
 CodeEditor* Notepad::currentEditor()
 {
-    return qobject_cast<CodeEditor*>(m_tabWidget->currentWidget());
+    return editorAt(m_tabWidget->currentIndex());
 }
 
 CodeEditor* Notepad::editorAt(int index)
 {
-    return qobject_cast<CodeEditor*>(m_tabWidget->widget(index));
+    // 普通 Tab 的页面是编辑器与预览组成的 QSplitter
+    QSplitter* page = qobject_cast<QSplitter*>(m_tabWidget->widget(index));
+    return page ? qobject_cast<CodeEditor*>(page->widget(0)) : nullptr;
 }
 
-CodeEditor* Notepad::createEditorTab(const QString& title, const QString& filePath)
+MarkdownPreview* Notepad::previewAt(int index)
+{
+    QSplitter* page = qobject_cast<QSplitter*>(m_tabWidget->widget(index));
+    return page ? qobject_cast<MarkdownPreview*>(page->widget(1)) : nullptr;
+}
+
+int Notepad::indexOfEditor(CodeEditor* editor)
+{
+    return editor ? m_tabWidget->indexOf(editor->parentWidget()) : -1;
+}
+
+LargeFileView* Notepad::largeViewAt(int index)
+{
+    return qobject_cast<LargeFileView*>(m_tabWidget->widget(index));
+}
+
+void Notepad::applyEditorAppearance(QAbstractScrollArea* editor)
 {
-    CodeEditor* editor = new CodeEditor();
-    editor->setProperty("filePath", filePath);
-    
     // 设置编辑器颜色
     QPalette editorPal = editor->palette();
     editorPal.setColor(QPalette::Base, Theme::background);
@@ -425,35 +822,228 @@ CodeEditor* Notepad::createEditorTab(const QString& title, const QString& filePa
     font.setStyleHint(QFont::Monospace);
     editor->setFont(font);
     
-    // Tab 宽度设置为 4 个空格
-    QFontMetrics metrics(font);
-    editor->setTabStopDistance(4 * metrics.horizontalAdvance(' '));
-    
     // 移除边框
     editor->setFrameShape(QFrame::NoFrame);
+}
+
+CodeEditor* Notepad::createEditorTab(const QString& title, const QString& filePath)
+{
+    QSplitter* page = createEditorPage(filePath);
+    CodeEditor* editor = populateEditorPage(page);
+
+    int index = m_tabWidget->addTab(page, title);
+    m_tabWidget->setCurrentIndex(index);
+
+    return editor;
+}
+
+QSplitter* Notepad::createEditorPage(const QString& filePath)
+{
+    // 普通 Tab 的页面：左侧编辑器，右侧实时预览。会话中尚未恢复的 Tab 只有空页面
+    QSplitter* page = new QSplitter(Qt::Horizontal);
+    page->setHandleWidth(1);
+    page->setChildrenCollapsible(false);
+    page->setProperty("filePath", filePath);
+    m_files->add(page, filePath);
+    return page;
+}
+
+CodeEditor* Notepad::populateEditorPage(QSplitter* page)
+{
+    CodeEditor* editor = new CodeEditor();
+    applyEditorAppearance(editor);
+    
+    // Tab 宽度设置为 4 个空格
+    QFontMetrics metrics(editor->font());
+    editor->setTabStopDistance(4 * metrics.horizontalAdvance(' '));
     
     // 连接光标位置变化信号
     connect(editor, &CodeEditor::cursorPositionChanged, this, &Notepad::updateCursorPosition);
+    // 统计只在当前 Tab 的内容或选区变化时刷新
+    auto updateStats = [this, editor]() {
+        if (editor == currentEditor())
+            updateStatsLabel();
+    };
+    connect(editor->statistics(), &DocumentStatistics::changed, this, updateStats);
+    connect(editor, &CodeEditor::selectionChanged, this, updateStats);
 
-    int index = m_tabWidget->addTab(editor, title);
-    m_tabWidget->setCurrentIndex(index);
+    // 大段粘贴与拖放的进度
+    connect(editor, &CodeEditor::insertProgress, this, [this](qint64 done, qint64 total) {
+        if (total <= 0)
+            m_statusLabel->setText("Preparing paste… (Esc to cancel)");
+        else
+            m_statusLabel->setText(QString("Pasting… %1% (Esc to cancel)").arg(int(done * 100 / total)));
+    });
+    connect(editor, &CodeEditor::insertFinished, this, [this](qint64 lineCount, const QStringList& skippedFiles) {
+        QStringList messages;
+        if (lineCount > 0 || skippedFiles.isEmpty())
+            messages << QString("Pasted %1 lines").arg(lineCount);
+        if (!skippedFiles.isEmpty())
+        {
+            QStringList names;
+            for (const QString& filePath : skippedFiles)
+                names << QFileInfo(filePath).fileName();
+            messages << "Skipped binary file(s): " + names.join(", ");
+        }
+        m_statusLabel->setText(messages.join(" — "));
+    });
+    connect(editor, &CodeEditor::openFilesRequested, this, [this](const QStringList& filePaths) {
+        for (const QString& filePath : filePaths)
+            openFile(filePath);
+    });
+    connect(editor, &CodeEditor::insertFailed, this, [this](const QString& error) {
+        m_statusLabel->setText("Paste failed: " + error);
+    });
+    // 插入期间推迟的重新加载
+    connect(editor, &CodeEditor::insertEnded, this, [this, editor]() {
+        if (m_staleTabs.remove(editor->parentWidget()))
+            reloadFromDisk(editor->parentWidget());
+    });
+
+    // 每个 Tab 常驻撤销历史的上限，超出部分写入磁盘日志
+    QSettings settings;
+    editor->undoManager()->setMemoryLimit(qint64(settings.value("undoMemoryMB", 32).toInt()) * 1024 * 1024);
+    // 缩略图图块缓存的上限
+    editor->minimap()->setCacheLimit(qint64(settings.value("minimapCacheMB", 32).toInt()) * 1024 * 1024);
+    editor->setMinimapVisible(m_showMinimapAction->isChecked());
+    editor->spellChecker()->setEnabled(m_checkSpellingAction->isChecked());
+
+    // 文本的每次修改写入崩溃恢复日志；日志超过文档大小后以当前文本为新基准
+    connect(editor->undoManager(), &UndoManager::contentsEdited, this,
+            [this, editor](int position, int removedLength, const QString& inserted) {
+        const QString id = m_journalIds.value(editor);
+        if (id.isEmpty())
+            return;
+        m_journal->append(id, position, removedLength, inserted);
+        if (m_journal->shouldCompact(id, editor->document()->characterCount()))
+            resetJournal(editor, true);
+    });
+
+    // 右侧为实时预览
+    MarkdownPreview* preview = new MarkdownPreview(editor);
+    preview->setVisible(m_showPreviewAction->isChecked());
+
+    page->addWidget(editor);
+    page->addWidget(preview);
+
+    // 在切换到新 Tab 之前登记，切换时即按最近使用处理
+    m_documents->addEditor(editor);
 
     return editor;
 }
 
 QString Notepad::getFilePath(int index)
 {
-    CodeEditor* editor = editorAt(index);
-    if (editor)
-        return editor->property("filePath").toString();
+    QWidget* widget = m_tabWidget->widget(index);
+    if (widget)
+        return widget->property("filePath").toString();
     return QString();
 }
 
 void Notepad::setFilePath(int index, const QString& path)
 {
-    CodeEditor* editor = editorAt(index);
-    if (editor)
-        editor->setProperty("filePath", path);
+    QWidget* widget = m_tabWidget->widget(index);
+    if (widget)
+    {
+        widget->setProperty("filePath", path);
+        m_files->add(widget, path);
+    }
+}
+
+TextFormat Notepad::textFormatAt(int index)
+{
+    TextFormat format;
+    QWidget* widget = m_tabWidget->widget(index);
+    if (widget && widget->property("encoding").isValid())
+    {
+        format.encoding = TextFormat::Encoding(widget->property("encoding").toInt());
+        format.hasBom = widget->property("hasBom").toBool();
+        format.lineEnding = TextFormat::LineEnding(widget->property("lineEnding").toInt());
+    }
+    return format;
+}
+
+void Notepad::setTextFormat(int index, const TextFormat& format)
+{
+    QWidget* widget = m_tabWidget->widget(index);
+    if (!widget)
+        return;
+
+    widget->setProperty("encoding", int(format.encoding));
+    widget->setProperty("hasBom", format.hasBom);
+    widget->setProperty("lineEnding", int(format.lineEnding));
+}
+
+void Notepad::updateEncodingLabel()
+{
+    TextFormat format = textFormatAt(m_tabWidget->currentIndex());
+    QString encoding = format.encodingName();
+    if (format.hasBom)
+        encoding += " BOM";
+    m_encodingLabel->setText(QString("%1  %2").arg(encoding, format.lineEndingName()));
+}
+
+void Notepad::updateMemoryLabel()
+{
+    QString text = QString("%1 resident").arg(m_documents->residentCount());
+    if (m_documents->dehydratedCount() > 0)
+        text += QString(" · %1 dehydrated").arg(m_documents->dehydratedCount());
+    text += QString(" · %1").arg(formatBytes(m_documents->residentBytes() + m_documents->dehydratedBytes()));
+    m_memoryLabel->setText(text);
+    m_memoryLabel->setToolTip(QString("Resident: %1\nDehydrated snapshots: %2\nBudget: %3")
+                              .arg(formatBytes(m_documents->residentBytes()),
+                                   formatBytes(m_documents->dehydratedBytes()),
+                                   formatBytes(m_documents->memoryBudget())));
+}
+
+void Notepad::updateLatencyLabel()
+{
+    CodeEditor* editor = currentEditor();
+    if (!editor || editor->inputLatency().count() == 0)
+    {
+        m_latencyLabel->setText("Input –");
+        m_latencyLabel->setToolTip(QString());
+        return;
+    }
+
+    auto ms = [](qint64 micros) { return QString::number(micros / 1000.0, 'f', 1); };
+    const LatencyHistogram& input = editor->inputLatency();
+    const LatencyHistogram& paint = editor->paintLatency();
+    m_latencyLabel->setText(QString("Input p50 %1 ms · p99 %2 ms").arg(ms(input.percentile(50)), ms(input.percentile(99))));
+    m_latencyLabel->setToolTip(QString("Keystroke to paint (%1 samples)\np50 %2 ms  p90 %3 ms  p99 %4 ms  max %5 ms\n"
+                                       "Viewport paint (%6 frames)\np50 %7 ms  p99 %8 ms  max %9 ms")
+                               .arg(input.count())
+                               .arg(ms(input.percentile(50)), ms(input.percentile(90)), ms(input.percentile(99)), ms(input.maxMicros()))
+                               .arg(paint.count())
+                               .arg(ms(paint.percentile(50)), ms(paint.percentile(99)), ms(paint.maxMicros())));
+}
+
+void Notepad::exportLatencyTrace()
+{
+    if (LatencyTrace::eventCount() == 0)
+    {
+        QMessageBox::information(this, "Export Latency Trace", "No trace events recorded. Enable View > Record Latency Trace first.");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "Export Latency Trace",
+        QDir::homePath() + "/markdowneditor-trace.json",
+        "Chrome Trace (*.json)",
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!LatencyTrace::exportChromeTrace(fileName, &error))
+    {
+        QMessageBox::warning(this, "Error", "Cannot write trace: " + error);
+        return;
+    }
+    m_statusLabel->setText(QString("Exported %1 trace events to %2").arg(LatencyTrace::eventCount()).arg(QFileInfo(fileName).fileName()));
 }
 
 void Notepad::updateTabTitle(int index, const QString& filePath)
@@ -476,13 +1066,48 @@ void Notepad::updateCursorPosition()
         int col = cursor.columnNumber() + 1;
         m_cursorPosLabel->setText(QString("Ln %1, Col %2").arg(line).arg(col));
     }
+    else if (LargeFileView* view = largeViewAt(m_tabWidget->currentIndex()))
+    {
+        // 行索引建立前行号未知
+        qint64 line = view->cursorLineNumber();
+        QString lineText = line >= 0 ? QString::number(line + 1) : QString("…");
+        m_cursorPosLabel->setText(QString("Ln %1, Col %2").arg(lineText).arg(view->cursorColumn() + 1));
+    }
+}
+
+void Notepad::updateStatsLabel()
+{
+    // 大文件视图不做统计
+    CodeEditor* editor = currentEditor();
+    if (!editor)
+    {
+        m_statsLabel->clear();
+        return;
+    }
+
+    const QLocale locale;
+    const TextStats total = editor->statistics()->total();
+    const QTextCursor cursor = editor->textCursor();
+    if (cursor.hasSelection())
+    {
+        const TextStats selected = editor->statistics()->selection(cursor);
+        m_statsLabel->setText(QString("%1 of %2 words · %3 of %4 chars")
+                              .arg(locale.toString(selected.words), locale.toString(total.words),
+                                   locale.toString(selected.characters), locale.toString(total.characters)));
+        return;
+    }
+
+    m_statsLabel->setText(QString("%1 words · %2 chars · %3 lines · %4 min read")
+                          .arg(locale.toString(total.words), locale.toString(total.characters),
+                               locale.toString(editor->blockCount()))
+                          .arg(total.readingMinutes()));
 }
 
 void Notepad::onNewFile()
 {
     m_untitledCount++;
     QString title = QString("untitled-%1").arg(m_untitledCount);
-    createEditorTab(title);
+    resetJournal(createEditorTab(title), false);
     m_statusLabel->setText("New file created");
 }
 
@@ -500,61 +1125,436 @@ void Notepad::onOpenFile()
     if (fileName.isEmpty())
         return;
 
-    // 检查文件是否已经打开
-    for (int i = 0; i < m_tabWidget->count(); i++)
-    {
-        if (getFilePath(i) == fileName)
-        {
-            m_tabWidget->setCurrentIndex(i);
-            return;
-        }
+    openFile(fileName);
+}
+
+void Notepad::openFile(const QString& fileName)
+{
+    // 检查文件是否已经打开：按文件身份比较，符号链接、.. 路径与硬链接都能识别
+    if (QWidget* page = qobject_cast<QWidget*>(m_files->find(fileName)))
+    {
+        m_tabWidget->setCurrentWidget(page);
+        return;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    QFileInfo fileInfo(fileName);
+    if (!fileInfo.isFile() || !fileInfo.isReadable())
     {
         QMessageBox::warning(this, "Error", "Cannot open file: " + fileName);
         return;
     }
 
-    QTextStream in(&file);
-    QString content = in.readAll();
-    file.close();
+    if (fileInfo.size() >= LargeFileThreshold)
+    {
+        openLargeFile(fileName);
+        return;
+    }
 
-    QFileInfo fileInfo(fileName);
     CodeEditor* editor = createEditorTab(fileInfo.fileName(), fileName);
-    editor->setPlainText(content);
 
     int currentIndex = m_tabWidget->currentIndex();
     m_tabWidget->setTabToolTip(currentIndex, fileName);
-    m_statusLabel->setText("Opened: " + fileName);
+
+    startLoading(editor, fileName);
 }
 
-void Notepad::onSaveFile()
+FileLoader* Notepad::startLoading(CodeEditor* editor, const QString& fileName)
 {
-    int currentIndex = m_tabWidget->currentIndex();
-    QString filePath = getFilePath(currentIndex);
+    QFileInfo fileInfo(fileName);
 
-    if (filePath.isEmpty())
+    // 加载期间只读，且不记录撤销历史
+    editor->setReadOnly(true);
+    editor->undoManager()->setEnabled(false);
+
+    FileLoader* loader = new FileLoader(fileName, this);
+    m_loaders.insert(editor, loader);
+
+    QPointer<FileLoader> guard(loader);
+    connect(loader, &FileLoader::chunkReady, editor, [editor, guard](const QString& text) {
+        if (!guard || guard->isCancelled())
+            return;
+        QTextCursor cursor(editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(text);
+        guard->chunkConsumed();
+    });
+    connect(loader, &FileLoader::progress, editor, [this, fileInfo](qint64 bytesRead, qint64 totalBytes) {
+        int percent = totalBytes > 0 ? int(bytesRead * 100 / totalBytes) : 100;
+        m_statusLabel->setText(QString("Loading %1… %2%").arg(fileInfo.fileName()).arg(percent));
+    });
+    connect(loader, &FileLoader::finished, editor, [this, editor]() {
+        finishLoading(editor);
+    });
+    connect(loader, &FileLoader::failed, editor, [this, editor, fileName](const QString& error) {
+        stopLoading(editor);
+        onCloseTab(indexOfEditor(editor));
+        QMessageBox::warning(this, "Error", "Cannot open file: " + fileName + "\n" + error);
+    });
+
+    updateLoadingState();
+    m_statusLabel->setText("Loading: " + fileName);
+    loader->start();
+    return loader;
+}
+
+LargeFileView* Notepad::createLargeFileView(const QString& fileName, QString* error)
+{
+    LargeFileView* view = new LargeFileView();
+    applyEditorAppearance(view);
+
+    if (!view->openFile(fileName, error))
     {
-        onSaveAsFile();
+        delete view;
+        return nullptr;
+    }
+
+    view->setProperty("filePath", fileName);
+    m_files->add(view, fileName);
+    connect(view, &LargeFileView::cursorPositionChanged, this, &Notepad::updateCursorPosition);
+    return view;
+}
+
+void Notepad::openFileAt(const QString& fileName, int line, int column)
+{
+    // 与“打开文件”走同一路径：已打开的直接切换，大文件使用 LargeFileView
+    openFile(fileName);
+
+    int index = m_tabWidget->indexOf(qobject_cast<QWidget*>(m_files->find(fileName)));
+
+    if (CodeEditor* editor = editorAt(index))
+    {
+        auto goToMatch = [editor, line, column]() {
+            editor->goToLine(line);
+            QTextCursor cursor = editor->textCursor();
+            cursor.setPosition(cursor.block().position() + qBound(0, column, cursor.block().length() - 1));
+            editor->setTextCursor(cursor);
+            editor->setFocus();
+        };
+
+        // 仍在后台加载时，等加载完成再定位
+        if (FileLoader* loader = m_loaders.value(editor))
+            connect(loader, &FileLoader::finished, editor, goToMatch);
+        else
+            goToMatch();
+    }
+    else if (LargeFileView* view = largeViewAt(index))
+    {
+        view->goToLine(line);
+        view->setFocus();
+    }
+}
+
+void Notepad::openLargeFile(const QString& fileName)
+{
+    QString error;
+    LargeFileView* view = createLargeFileView(fileName, &error);
+    if (!view)
+    {
+        QMessageBox::warning(this, "Error", "Cannot open file: " + fileName + "\n" + error);
         return;
     }
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    QFileInfo fileInfo(fileName);
+    int index = m_tabWidget->addTab(view, fileInfo.fileName());
+    m_tabWidget->setTabToolTip(index, fileName);
+    m_tabWidget->setCurrentIndex(index);
+    view->setFocus();
+
+    m_statusLabel->setText("Opened (large file mode): " + fileName);
+}
+
+void Notepad::finishLoading(CodeEditor* editor)
+{
+    FileLoader* loader = m_loaders.take(editor);
+    if (!loader)
+        return;
+
+    QString fileName = loader->filePath();
+    TextFormat format = loader->format();
+    setTextFormat(indexOfEditor(editor), format);
+
+    QString message = QString("Opened: %1 (%2 lines)").arg(fileName).arg(loader->lineCount());
+    if (loader->invalidSequences() > 0)
+        message += QString(" — %1 invalid UTF-8 sequences replaced").arg(loader->invalidSequences());
+    loader->deleteLater();
+
+    editor->setReadOnly(false);
+    editor->undoManager()->setEnabled(true);
+    editor->undoManager()->clear();
+    editor->document()->setModified(false);
+    resetJournal(editor, false);
+
+    updateLoadingState();
+    updateEncodingLabel();
+    m_statusLabel->setText(message);
+
+    // 新加载的文档可能让常驻内存超出预算
+    m_documents->enforceBudget();
+}
+
+void Notepad::onFileChangedOnDisk(QObject* object)
+{
+    QWidget* page = qobject_cast<QWidget*>(object);
+    int index = m_tabWidget->indexOf(page);
+    if (index < 0)
+        return;
+
+    // 自身的保存、正在加载的文件以及尚未恢复的会话 Tab 不需要处理
+    if (isSaving(page) || m_pendingTabs.contains(page))
+        return;
+
+    if (CodeEditor* editor = editorAt(index))
     {
-        QMessageBox::warning(this, "Error", "Cannot save file: " + filePath);
+        if (m_loaders.contains(editor))
+            return;
+        // 已脱水的文档等下次选中时再比较；日志的基准文件已变，未保存的修改改以快照为基准
+        if (m_documents->isDehydrated(editor))
+        {
+            if (m_documents->isModified(editor))
+                resetJournal(editor, true);
+            m_staleTabs.insert(page);
+            return;
+        }
+        reloadFromDisk(page);
+    }
+    else if (LargeFileView* view = largeViewAt(index))
+    {
+        // 大文件直接重新映射；有未保存的修改时只提示，避免覆盖
+        const QString filePath = getFilePath(index);
+        if (view->isModified())
+        {
+            m_statusLabel->setText("Changed on disk (unsaved edits kept): " + filePath);
+            return;
+        }
+        QString error;
+        if (!view->openFile(filePath, &error))
+            m_statusLabel->setText("Cannot reload " + filePath + ": " + error);
+        else
+            m_statusLabel->setText("Reloaded: " + filePath);
+    }
+}
+
+void Notepad::onFileRemovedOnDisk(QObject* object, const QString& filePath)
+{
+    QWidget* page = qobject_cast<QWidget*>(object);
+    int index = m_tabWidget->indexOf(page);
+    if (index < 0 || isSaving(page))
         return;
+
+    // 内容仍保留在编辑器中，标记为已修改以便提醒保存；日志不能再以该文件为基准
+    if (CodeEditor* editor = editorAt(index))
+    {
+        editor->document()->setModified(true);
+        resetJournal(editor, true);
     }
+    m_statusLabel->setText("Deleted on disk: " + filePath);
+}
 
-    QTextStream out(&file);
+void Notepad::reloadFromDisk(QWidget* page)
+{
+    int index = m_tabWidget->indexOf(page);
+    CodeEditor* editor = editorAt(index);
+    if (!editor)
+        return;
+
+    // 分块插入期间的修改在撤销历史中是一组，重新加载的修改不能混入其中，等插入结束后再进行
+    if (editor->isInserting())
+    {
+        m_staleTabs.insert(page);
+        return;
+    }
+
+    const QString filePath = getFilePath(index);
+    if (editor->document()->isModified())
+    {
+        QMessageBox::StandardButton answer = QMessageBox::question(
+            this,
+            "File Changed",
+            QString("%1 has been changed on disk.\nReload it? Your unsaved edits can be restored with Undo.")
+                .arg(QFileInfo(filePath).fileName()),
+            QMessageBox::Yes | QMessageBox::No
+        );
+        // 保留编辑器中的内容时，日志改以当前文本为基准
+        if (answer != QMessageBox::Yes)
+        {
+            resetJournal(editor, true);
+            return;
+        }
+    }
+
+    // 同一 Tab 已有比较在进行时以最新的磁盘内容重新开始
+    delete m_reloadSnapshots.take(page);
+    delete m_reloaders.take(page);
+
+    // 编辑器的全文在几轮事件循环中分块复制，复制完成后再开始比较
+    DocumentSnapshot* snapshot = new DocumentSnapshot(editor->document(), page);
+    m_reloadSnapshots.insert(page, snapshot);
+    connect(snapshot, &DocumentSnapshot::finished, this, [this, page, snapshot, filePath](const QString& text, int revision) {
+        if (m_reloadSnapshots.value(page) != snapshot)
+            return;
+        m_reloadSnapshots.take(page)->deleteLater();
+        startReloader(page, filePath, text, revision);
+    });
+    snapshot->start();
+}
+
+void Notepad::startReloader(QWidget* page, const QString& filePath, const QString& text, int revision)
+{
+    // 读取、解码与按行比较都在后台进行，GUI 线程只应用变化的区段
+    FileReloader* reloader = new FileReloader(filePath, text, this);
+    m_reloaders.insert(page, reloader);
+
+    QPointer<FileReloader> guard(reloader);
+    connect(reloader, &FileReloader::finished, page, [this, page, guard, revision]() {
+        if (!guard || m_reloaders.value(page) != guard)
+            return;
+        FileReloader* reloader = m_reloaders.take(page);
+        applyReload(page, reloader, revision);
+        reloader->deleteLater();
+    });
+    connect(reloader, &FileReloader::failed, page, [this, page, guard, filePath](const QString& error) {
+        if (!guard || m_reloaders.value(page) != guard)
+            return;
+        m_reloaders.take(page)->deleteLater();
+        m_statusLabel->setText("Cannot reload " + filePath + ": " + error);
+    });
+    reloader->start();
+}
+
+void Notepad::applyReload(QWidget* page, FileReloader* reloader, int revision)
+{
+    int index = m_tabWidget->indexOf(page);
+    CodeEditor* editor = editorAt(index);
+    if (!editor)
+        return;
+
+    // 比较期间又有编辑或开始了分块插入时，区段位置已经失效，以最新文本重新比较
+    if (editor->document()->revision() != revision || editor->isInserting())
+    {
+        reloadFromDisk(page);
+        return;
+    }
+
+    const QVector<TextDiff::Edit> edits = reloader->edits();
+    const QString text = reloader->text();
+    const int verticalScroll = editor->verticalScrollBar()->value();
+    const int horizontalScroll = editor->horizontalScrollBar()->value();
+
+    // 从后往前替换，前面区段的位置不受影响；合并为一个撤销步骤，
+    // 光标随编辑自动调整，撤销历史得以保留
+    if (!edits.isEmpty())
+        editor->undoManager()->prepareEdit(edits.first().position, edits.last().position + edits.last().length);
+    QTextCursor cursor(editor->document());
+    cursor.beginEditBlock();
+    for (int i = edits.size() - 1; i >= 0; --i)
+    {
+        const TextDiff::Edit& edit = edits[i];
+        cursor.setPosition(edit.position);
+        cursor.setPosition(edit.position + edit.length, QTextCursor::KeepAnchor);
+        cursor.insertText(text.mid(edit.newPosition, edit.newLength));
+    }
+    cursor.endEditBlock();
+
+    editor->verticalScrollBar()->setValue(verticalScroll);
+    editor->horizontalScrollBar()->setValue(horizontalScroll);
+    editor->document()->setModified(false);
+    resetJournal(editor, false);
+
+    setTextFormat(index, reloader->format());
+    if (index == m_tabWidget->currentIndex())
+        updateEncodingLabel();
+    m_statusLabel->setText(QString("Reloaded %1 (%2 changed regions)")
+                           .arg(QFileInfo(reloader->filePath()).fileName()).arg(edits.size()));
+}
+
+bool Notepad::stopLoading(CodeEditor* editor)
+{
+    FileLoader* loader = m_loaders.take(editor);
+    if (!loader)
+        return false;
+
+    // 析构时会取消并等待工作线程退出
+    delete loader;
+
+    editor->setReadOnly(false);
+    editor->undoManager()->setEnabled(true);
+    editor->undoManager()->clear();
+
+    updateLoadingState();
+    return true;
+}
+
+void Notepad::updateLoadingState()
+{
+    if (!m_cancelLoadAction)
+        return;
+
+    bool loading = m_loaders.contains(currentEditor());
+    m_cancelLoadAction->setEnabled(loading);
+    m_cancelLoadButton->setVisible(loading);
+}
+
+void Notepad::onCancelLoading()
+{
     CodeEditor* editor = currentEditor();
-    if (editor)
-        out << editor->toPlainText();
+    if (!editor || !stopLoading(editor))
+        return;
+
+    // 未加载完的内容不完整，直接关闭该 Tab，避免误保存截断原文件
+    onCloseTab(indexOfEditor(editor));
+    m_statusLabel->setText("Loading cancelled");
+}
+
+void Notepad::onGoToLine()
+{
+    int index = m_tabWidget->currentIndex();
+    bool ok = false;
+
+    if (CodeEditor* editor = editorAt(index))
+    {
+        int lines = editor->lineCount();
+        int line = QInputDialog::getInt(this, "Go to Line", QString("Line (1 - %1):").arg(lines),
+                                        editor->textCursor().blockNumber() + 1, 1, lines, 1, &ok);
+        if (ok)
+        {
+            editor->goToLine(line - 1);
+            editor->setFocus();
+        }
+    }
+    else if (LargeFileView* view = largeViewAt(index))
+    {
+        // 大文件的行号依赖后台建立的行索引
+        qint64 lines = view->buffer().lineCount();
+        if (lines < 0)
+        {
+            m_statusLabel->setText("Line index is still being built…");
+            return;
+        }
+
+        int maxLine = int(qMin<qint64>(lines, std::numeric_limits<int>::max()));
+        int current = int(qBound<qint64>(1, view->cursorLineNumber() + 1, maxLine));
+        int line = QInputDialog::getInt(this, "Go to Line", QString("Line (1 - %1):").arg(lines),
+                                        current, 1, maxLine, 1, &ok);
+        if (ok)
+        {
+            view->goToLine(line - 1);
+            view->setFocus();
+        }
+    }
+}
 
-    file.close();
-    m_statusLabel->setText("Saved: " + filePath);
+void Notepad::onSaveFile()
+{
+    int currentIndex = m_tabWidget->currentIndex();
+    QString filePath = getFilePath(currentIndex);
+
+    if (filePath.isEmpty())
+    {
+        onSaveAsFile();
+        return;
+    }
+
+    saveTab(currentIndex, filePath);
 }
 
 void Notepad::onSaveAsFile()
@@ -571,44 +1571,265 @@ void Notepad::onSaveAsFile()
     if (fileName.isEmpty())
         return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    saveTab(m_tabWidget->currentIndex(), fileName);
+}
+
+void Notepad::saveTab(int index, const QString& filePath)
+{
+    QWidget* page = m_tabWidget->widget(index);
+    if (!page)
+        return;
+
+    CodeEditor* editor = editorAt(index);
+    if (editor && m_loaders.contains(editor))
     {
-        QMessageBox::warning(this, "Error", "Cannot save file: " + fileName);
+        m_statusLabel->setText("Cannot save while the file is still loading");
+        return;
+    }
+    if (editor && editor->isInserting())
+    {
+        m_statusLabel->setText("Cannot save while text is still being inserted");
         return;
     }
 
-    QTextStream out(&file);
-    CodeEditor* editor = currentEditor();
-    if (editor)
-        out << editor->toPlainText();
+    // 同一 Tab 正在保存时放弃旧的保存（临时文件被丢弃，目标文件不受影响），以最新快照重新开始
+    if (FileSaver* running = m_savers.take(page))
+    {
+        running->cancel();
+        delete running;
+    }
+    delete m_snapshots.take(page);
 
-    file.close();
+    // GUI 线程只取快照，编码与写盘交给后台线程，期间可以继续编辑。
+    // 常驻文档的全文在几轮事件循环中分块复制；已脱水的文档从压缩快照解压
+    if (editor && !m_documents->isDehydrated(editor))
+    {
+        DocumentSnapshot* snapshot = new DocumentSnapshot(editor->document(), page);
+        m_snapshots.insert(page, snapshot);
+        const TextFormat format = textFormatAt(index);
+        connect(snapshot, &DocumentSnapshot::finished, this, [this, page, snapshot, filePath, format](const QString& text, int revision) {
+            if (m_snapshots.value(page) != snapshot)
+                return;
+            m_snapshots.take(page)->deleteLater();
+            startSaver(page, filePath, new FileSaver(filePath, text, format, this), quint64(revision));
+        });
+        m_statusLabel->setText("Saving: " + filePath);
+        snapshot->start();
+    }
+    else if (editor)
+    {
+        startSaver(page, filePath, new FileSaver(filePath, m_documents->text(editor), textFormatAt(index), this),
+                   quint64(editor->document()->revision()));
+    }
+    else if (LargeFileView* view = largeViewAt(index))
+    {
+        startSaver(page, filePath, new FileSaver(filePath, view->buffer().snapshot(), this), view->buffer().revision());
+    }
+}
 
-    int currentIndex = m_tabWidget->currentIndex();
-    setFilePath(currentIndex, fileName);
-    updateTabTitle(currentIndex, fileName);
-    m_statusLabel->setText("Saved: " + fileName);
+void Notepad::startSaver(QWidget* page, const QString& filePath, FileSaver* saver, quint64 revision)
+{
+    m_savers.insert(page, saver);
+
+    const QString fileName = QFileInfo(filePath).fileName();
+    QPointer<FileSaver> guard(saver);
+    connect(saver, &FileSaver::progress, page, [this, fileName](qint64 done, qint64 total, double bytesPerSecond) {
+        int percent = total > 0 ? int(done * 100 / total) : 100;
+        m_statusLabel->setText(QString("Saving %1… %2% (%3/s)")
+                               .arg(fileName).arg(percent).arg(formatBytes(qint64(bytesPerSecond))));
+    });
+    connect(saver, &FileSaver::finished, page, [this, page, guard, filePath, revision](qint64 bytesWritten, qint64 elapsedMs) {
+        if (!guard || m_savers.value(page) != guard)
+            return;
+        m_savers.take(page)->deleteLater();
+
+        int index = m_tabWidget->indexOf(page);
+        setFilePath(index, filePath);
+        updateTabTitle(index, filePath);
+
+        // 快照之后没有新的编辑时才清除修改标记；日志以刚写出的文件为新基准，
+        // 否则以当前文本为基准（此前的记录是相对旧文件的）
+        if (CodeEditor* editor = editorAt(index))
+        {
+            const bool clean = editor->document()->revision() == int(revision);
+            if (clean)
+                editor->document()->setModified(false);
+            resetJournal(editor, !clean);
+        }
+        else if (LargeFileView* view = largeViewAt(index))
+        {
+            view->fileSaved(filePath, revision);
+        }
+
+        m_statusLabel->setText(QString("Saved: %1 (%2 in %3 ms)")
+                               .arg(filePath, formatBytes(bytesWritten)).arg(elapsedMs));
+    });
+    connect(saver, &FileSaver::failed, page, [this, page, guard, filePath](const QString& error) {
+        if (!guard || m_savers.value(page) != guard)
+            return;
+        m_savers.take(page)->deleteLater();
+        m_statusLabel->setText("Save failed: " + filePath);
+        QMessageBox::warning(this, "Error", "Cannot save file: " + filePath + "\n" + error);
+    });
+
+    m_statusLabel->setText("Saving: " + filePath);
+    saver->start();
+}
+
+void Notepad::onExportHtml()
+{
+    exportTab(m_tabWidget->currentIndex(), DocumentExporter::Html);
+}
+
+void Notepad::onExportPdf()
+{
+    exportTab(m_tabWidget->currentIndex(), DocumentExporter::Pdf);
+}
+
+void Notepad::exportTab(int index, DocumentExporter::Format format)
+{
+    CodeEditor* editor = editorAt(index);
+    if (!editor)
+    {
+        if (largeViewAt(index))
+            m_statusLabel->setText("Export is not available for large files");
+        return;
+    }
+    if (m_loaders.contains(editor))
+    {
+        m_statusLabel->setText("Cannot export while the file is still loading");
+        return;
+    }
+
+    const QString sourcePath = getFilePath(index);
+    const QString title = QFileInfo(m_tabWidget->tabText(index)).completeBaseName();
+    const QString suffix = format == DocumentExporter::Html ? "html" : "pdf";
+    const QString directory = sourcePath.isEmpty() ? QDir::homePath() : QFileInfo(sourcePath).absolutePath();
+    const QString fileName = QFileDialog::getSaveFileName(
+        this,
+        format == DocumentExporter::Html ? "Export to HTML" : "Export to PDF",
+        QDir(directory).filePath(title + "." + suffix),
+        format == DocumentExporter::Html ? "HTML Files (*.html *.htm)" : "PDF Files (*.pdf)",
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+
+    if (fileName.isEmpty())
+        return;
+
+    // 在 GUI 线程只取快照，解析、渲染与写盘都在后台流水线中进行，期间可以继续编辑或导出其他 Tab。
+    // 常驻文档的全文分块复制，复制完成后才开始导出；快照随 Tab 关闭而销毁，导出也就不再开始
+    if (!m_documents->isDehydrated(editor))
+    {
+        DocumentSnapshot* snapshot = new DocumentSnapshot(editor->document(), editor->parentWidget());
+        connect(snapshot, &DocumentSnapshot::finished, this, [this, snapshot, fileName, format, title, directory](const QString& text) {
+            snapshot->deleteLater();
+            startExporter(new DocumentExporter(fileName, text, format, title, directory, this));
+        });
+        m_statusLabel->setText("Exporting: " + fileName);
+        snapshot->start();
+    }
+    else
+    {
+        startExporter(new DocumentExporter(fileName, m_documents->text(editor), format, title, directory, this));
+    }
+}
+
+void Notepad::startExporter(DocumentExporter* exporter)
+{
+    m_exporters.insert(exporter);
+    const QString fileName = exporter->filePath();
+    const DocumentExporter::Format format = exporter->format();
+
+    // 每个导出有自己的非模态进度对话框，取消只丢弃这一个导出
+    QProgressDialog* dialog = new QProgressDialog(QString("Exporting %1…").arg(QFileInfo(fileName).fileName()),
+                                                  "Cancel", 0, 100, this);
+    dialog->setWindowTitle(format == DocumentExporter::Html ? "Export to HTML" : "Export to PDF");
+    dialog->setWindowModality(Qt::NonModal);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    dialog->setMinimumDuration(500);
+    dialog->setValue(0);
+
+    QPointer<QProgressDialog> progress(dialog);
+    // 取消与完成可能同时发生，只处理先到的一个
+    auto finish = [this, exporter, progress]() {
+        if (!m_exporters.remove(exporter))
+            return false;
+        exporter->deleteLater();
+        if (progress)
+            progress->deleteLater();
+        return true;
+    };
+
+    connect(dialog, &QProgressDialog::canceled, this, [this, exporter, finish, fileName]() {
+        if (!m_exporters.contains(exporter))
+            return;
+        exporter->cancel();
+        finish();
+        m_statusLabel->setText("Export cancelled: " + fileName);
+    });
+    connect(exporter, &DocumentExporter::progress, this, [progress](qint64 done, qint64 total) {
+        if (progress)
+            progress->setValue(total > 0 ? int(done * 100 / total) : 100);
+    });
+    connect(exporter, &DocumentExporter::finished, this, [this, finish, fileName](qint64 bytesWritten, qint64 elapsedMs) {
+        if (!finish())
+            return;
+        m_statusLabel->setText(QString("Exported: %1 (%2 in %3 ms)")
+                               .arg(fileName, formatBytes(bytesWritten)).arg(elapsedMs));
+    });
+    connect(exporter, &DocumentExporter::failed, this, [this, finish, fileName](const QString& error) {
+        if (!finish())
+            return;
+        m_statusLabel->setText("Export failed: " + fileName);
+        QMessageBox::warning(this, "Error", "Cannot export file: " + fileName + "\n" + error);
+    });
+
+    m_statusLabel->setText("Exporting: " + fileName);
+    exporter->start();
 }
 
 void Notepad::onCloseTab(int index)
 {
-    if (m_tabWidget->count() == 1)
+    if (index < 0)
+        return;
+
+    stopLoading(editorAt(index));
+
+    // 关闭前等待该 Tab 的后台保存写完；尚未取完快照的保存与导出直接放弃
+    delete m_snapshots.take(m_tabWidget->widget(index));
+    delete m_reloadSnapshots.take(m_tabWidget->widget(index));
+    qDeleteAll(m_tabWidget->widget(index)->findChildren<DocumentSnapshot*>(QString(), Qt::FindDirectChildrenOnly));
+    delete m_savers.take(m_tabWidget->widget(index));
+    delete m_reloaders.take(m_tabWidget->widget(index));
+
+    if (m_tabWidget->count() == 1 && editorAt(index))
     {
-        CodeEditor* editor = editorAt(index);
-        if (editor)
-        {
-            editor->clear();
-            editor->setProperty("filePath", QString());
-            m_tabWidget->setTabText(index, "untitled-1");
-            m_tabWidget->setTabToolTip(index, "");
-        }
+        editorAt(index)->clear();
+        editorAt(index)->undoManager()->clear();
+        setFilePath(index, QString());
+        setTextFormat(index, TextFormat());
+        updateEncodingLabel();
+        m_tabWidget->setTabText(index, "untitled-1");
+        m_tabWidget->setTabToolTip(index, "");
+        resetJournal(editorAt(index), false);
         return;
     }
 
+    endJournal(editorAt(index));
+    m_documents->removeEditor(editorAt(index));
+    m_pendingTabs.remove(m_tabWidget->widget(index));
+    m_files->remove(m_tabWidget->widget(index));
+    m_staleTabs.remove(m_tabWidget->widget(index));
+
     QWidget* widget = m_tabWidget->widget(index);
     m_tabWidget->removeTab(index);
     delete widget;
+
+    // 关闭了最后一个大文件 Tab 时保留一个空白 Tab
+    if (m_tabWidget->count() == 0)
+        onNewFile();
 }
 
 void Notepad::onTabChanged(int index)
@@ -616,6 +1837,15 @@ void Notepad::onTabChanged(int index)
     if (index < 0)
         return;
 
+    // 会话中尚未恢复的 Tab 在选中时立即恢复，已脱水的文档在显示前恢复
+    restoreTab(index);
+    if (CodeEditor* editor = editorAt(index))
+        m_documents->activate(editor);
+    if (m_staleTabs.remove(m_tabWidget->widget(index)))
+        reloadFromDisk(m_tabWidget->widget(index));
+    m_findBar->setEditor(editorAt(index));
+    m_outlinePanel->setEditor(editorAt(index));
+
     QString filePath = getFilePath(index);
     if (!filePath.isEmpty())
     {
@@ -628,4 +1858,270 @@ void Notepad::onTabChanged(int index)
     }
     
     updateCursorPosition();
+    updateStatsLabel();
+    updateEncodingLabel();
+    updateLoadingState();
+}
+
+bool Notepad::restoreSession()
+{
+    Session session;
+    const bool loaded = m_sessionStore.load(&session);
+
+    // 上次没有正常退出时，日志里有会话之后的修改：并入会话并立即保存，之后才能删除日志。
+    // 保存失败时保留日志，下次启动再试
+    const int recovered = recoverJournals(&session);
+    if (recovered > 0 && !m_sessionStore.save(session))
+        qWarning("Cannot save recovered documents to %s", qPrintable(m_sessionStore.directory()));
+    else
+        m_journal->discardAll();
+    if (!loaded && session.tabs.isEmpty())
+        return false;
+
+    m_untitledCount = session.untitledCount;
+    m_showPreviewAction->setChecked(session.showPreview);
+
+    // 所有 Tab 先只建立空页面与标题，首帧只恢复当前 Tab，启动耗时与 Tab 数量无关
+    {
+        const QSignalBlocker blocker(m_tabWidget);
+        for (const SessionTab& tab : std::as_const(session.tabs))
+        {
+            QSplitter* page = createEditorPage(tab.filePath);
+            m_pendingTabs.insert(page, tab);
+            int index = m_tabWidget->addTab(page, tab.title);
+            if (!tab.filePath.isEmpty())
+                m_tabWidget->setTabToolTip(index, tab.filePath);
+        }
+        m_tabWidget->setCurrentIndex(session.currentIndex);
+    }
+    onTabChanged(m_tabWidget->currentIndex());
+
+    m_restoreTimer.start();
+    if (recovered > 0)
+        m_statusLabel->setText(QString("Recovered %1 unsaved document(s) after an unexpected exit").arg(recovered));
+    return true;
+}
+
+int Notepad::recoverJournals(Session* session)
+{
+    const QVector<EditJournal::Recovered> documents = EditJournal::recover(m_journal->directory());
+    int recovered = 0;
+    for (const EditJournal::Recovered& document : documents)
+    {
+        if (!document.error.isEmpty())
+        {
+            qWarning("Cannot recover %s: %s",
+                     qPrintable(document.filePath.isEmpty() ? document.title : document.filePath),
+                     qPrintable(document.error));
+            continue;
+        }
+
+        // 会话中已有的 Tab（同一文件，或同名的未命名文档）替换其内容，否则追加一个 Tab
+        const QString canonicalPath = FileRegistry::canonicalPath(document.filePath);
+        SessionTab* target = nullptr;
+        for (SessionTab& tab : session->tabs)
+        {
+            const bool same = document.filePath.isEmpty()
+                ? tab.filePath.isEmpty() && tab.title == document.title
+                : !tab.filePath.isEmpty() && FileRegistry::canonicalPath(tab.filePath) == canonicalPath;
+            if (same && !tab.largeFile)
+            {
+                target = &tab;
+                break;
+            }
+        }
+        if (!target)
+        {
+            session->tabs.append(SessionTab());
+            target = &session->tabs.last();
+            target->title = document.title;
+            target->filePath = document.filePath;
+        }
+        target->contents = document.text;
+        target->format = document.format;
+        target->hasContents = true;
+        recovered++;
+    }
+    return recovered;
+}
+
+void Notepad::resetJournal(CodeEditor* editor, bool snapshot)
+{
+    int index = indexOfEditor(editor);
+    if (index < 0)
+        return;
+
+    // 以磁盘上的文件为基准（刚加载或保存）或以当前文本为基准（未保存内容、压缩）重新开始日志
+    const QString title = m_tabWidget->tabText(index);
+    const QString filePath = getFilePath(index);
+    QString& id = m_journalIds[editor];
+    if (snapshot)
+    {
+        const QString text = m_documents->text(editor);
+        if (id.isEmpty())
+            id = m_journal->begin(title, filePath, text);
+        else
+            m_journal->rebase(id, title, filePath, text);
+    }
+    else if (id.isEmpty())
+    {
+        id = m_journal->begin(title, filePath);
+    }
+    else
+    {
+        m_journal->rebase(id, title, filePath);
+    }
+}
+
+void Notepad::endJournal(CodeEditor* editor)
+{
+    const QString id = m_journalIds.take(editor);
+    if (!id.isEmpty())
+        m_journal->end(id);
+}
+
+bool Notepad::saveSession()
+{
+    Session session;
+    session.currentIndex = m_tabWidget->currentIndex();
+    session.untitledCount = m_untitledCount;
+    session.showPreview = m_showPreviewAction->isChecked();
+
+    for (int i = 0; i < m_tabWidget->count(); i++)
+    {
+        // 尚未恢复的 Tab 原样写回，其未保存内容文件继续沿用
+        auto pending = m_pendingTabs.constFind(m_tabWidget->widget(i));
+        if (pending != m_pendingTabs.constEnd())
+        {
+            session.tabs.append(pending.value());
+            continue;
+        }
+
+        SessionTab tab;
+        tab.title = m_tabWidget->tabText(i);
+        tab.filePath = getFilePath(i);
+        if (CodeEditor* editor = editorAt(i))
+        {
+            DocumentManager::ViewState state = m_documents->viewState(editor);
+            tab.anchor = state.anchor;
+            tab.position = state.position;
+            tab.verticalScroll = state.verticalScroll;
+            tab.horizontalScroll = state.horizontalScroll;
+            tab.format = textFormatAt(i);
+
+            // 加载中的文档内容不完整，只记录路径
+            if (!m_loaders.contains(editor) && m_documents->isModified(editor))
+            {
+                tab.contents = m_documents->text(editor);
+                tab.hasContents = true;
+            }
+        }
+        else if (LargeFileView* view = largeViewAt(i))
+        {
+            tab.largeFile = true;
+            tab.line = qMax<qint64>(0, view->cursorLineNumber());
+        }
+        session.tabs.append(tab);
+    }
+
+    if (!m_sessionStore.save(session))
+    {
+        qWarning("Cannot save session to %s", qPrintable(m_sessionStore.directory()));
+        return false;
+    }
+    return true;
+}
+
+void Notepad::restoreTab(int index)
+{
+    QSplitter* page = qobject_cast<QSplitter*>(m_tabWidget->widget(index));
+    if (!page || !m_pendingTabs.contains(page))
+        return;
+
+    const SessionTab tab = m_pendingTabs.take(page);
+    QFileInfo fileInfo(tab.filePath);
+    const bool fileAvailable = !tab.filePath.isEmpty() && fileInfo.isFile() && fileInfo.isReadable();
+
+    // 文件已不存在且没有未保存内容的 Tab 直接关闭；可能正处于 Tab 切换信号中，延后到事件循环里关闭
+    auto closeLater = [this, page](const QString& message) {
+        m_statusLabel->setText(message);
+        QPointer<QWidget> guard(page);
+        QMetaObject::invokeMethod(this, [this, guard]() {
+            if (guard)
+                onCloseTab(m_tabWidget->indexOf(guard));
+        }, Qt::QueuedConnection);
+    };
+    if (!tab.filePath.isEmpty() && !fileAvailable && tab.contentsFile.isEmpty())
+    {
+        closeLater("File no longer exists: " + tab.filePath);
+        return;
+    }
+
+    if (tab.largeFile)
+    {
+        QString error;
+        LargeFileView* view = createLargeFileView(tab.filePath, &error);
+        if (!view)
+        {
+            closeLater("Cannot open file: " + tab.filePath + " (" + error + ")");
+            return;
+        }
+
+        // 大文件 Tab 的页面就是视图本身，替换占位页面时不触发 Tab 切换信号
+        {
+            const QSignalBlocker blocker(m_tabWidget);
+            const bool isCurrent = m_tabWidget->currentIndex() == index;
+            m_tabWidget->removeTab(index);
+            m_tabWidget->insertTab(index, view, tab.title);
+            m_tabWidget->setTabToolTip(index, tab.filePath);
+            if (isCurrent)
+                m_tabWidget->setCurrentIndex(index);
+        }
+        page->deleteLater();
+        view->goToLine(tab.line);
+        return;
+    }
+
+    CodeEditor* editor = populateEditorPage(page);
+    // 未保存的内容以 UTF-8 存放在会话目录中，保存回原文件时仍应使用原来的编码与换行
+    setTextFormat(index, tab.format);
+    DocumentManager::ViewState state;
+    state.anchor = tab.anchor;
+    state.position = tab.position;
+    state.verticalScroll = tab.verticalScroll;
+    state.horizontalScroll = tab.horizontalScroll;
+
+    if (!tab.contentsFile.isEmpty())
+    {
+        editor->undoManager()->setEnabled(false);
+        editor->setPlainText(m_sessionStore.readContents(tab));
+        editor->undoManager()->setEnabled(true);
+        editor->document()->setModified(true);
+        resetJournal(editor, true);
+        DocumentManager::applyViewState(editor, state);
+    }
+    else if (fileAvailable)
+    {
+        FileLoader* loader = startLoading(editor, tab.filePath);
+        connect(loader, &FileLoader::finished, editor, [editor, state]() {
+            DocumentManager::applyViewState(editor, state);
+        });
+    }
+}
+
+void Notepad::restoreNextTab()
+{
+    // 后台一次只恢复一个 Tab，前一个文件仍在加载时等待
+    if (!m_loaders.isEmpty())
+        return;
+
+    for (int i = 0; i < m_tabWidget->count(); i++)
+    {
+        if (m_pendingTabs.contains(m_tabWidget->widget(i)))
+        {
+            restoreTab(i);
+            return;
+        }
+    }
+    m_restoreTimer.stop();
 }
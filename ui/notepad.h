@@ -6,9 +6,33 @@
 #include <QTabBar>
 #include <QStatusBar>
 #include <QLabel>
+#include <QHash>
+#include <QSet>
+#include <QToolButton>
+#include <QCache>
+#include <QPixmap>
+#include <QTimer>
 #include "codeeditor.h"
+#include "../core/sessionstore.h"
+#include "../core/textscan.h"
+#include "../core/documentexporter.h"
+
+class FileLoader;
+class FileSaver;
+class DocumentSnapshot;
+class FileReloader;
+class FileRegistry;
+class EditJournal;
+class LargeFileView;
+class MarkdownPreview;
+class DocumentManager;
+class FindBar;
+class FindInFolderPanel;
+class OutlinePanel;
+class QSplitter;
 
 // 自定义 TabBar，实现更精细的样式控制
+// 每个标签按（文字、尺寸、状态）缓存渲染好的位图，只重绘状态变化的标签，命中测试使用二分查找
 class CustomTabBar : public QTabBar
 {
     Q_OBJECT
@@ -24,11 +48,40 @@ protected:
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void leaveEvent(QEvent* event) override;
+    void changeEvent(QEvent* event) override;
     
 private:
+    struct TabCacheKey
+    {
+        QString text;
+        QSize size;
+        int state;
+        qreal devicePixelRatio;
+
+        bool operator==(const TabCacheKey& other) const
+        {
+            return text == other.text && size == other.size && state == other.state
+                && devicePixelRatio == other.devicePixelRatio;
+        }
+
+        friend size_t qHash(const TabCacheKey& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.text, key.size.width(), key.size.height(), key.state, key.devicePixelRatio);
+        }
+    };
+
     QRect closeButtonRect(int index) const;
+    int tabIndexAt(const QPoint& pos) const;
+    int firstTabFrom(int x) const;
+    void updateTab(int index);
+    QPixmap tabPixmap(int index, bool isSelected, bool isHovered, bool closeHovered) const;
+    void renderTab(QPainter& painter, const QRect& rect, const QString& text,
+                   bool isSelected, bool isHovered, bool closeHovered) const;
+
     int m_hoverIndex;
     bool m_closeButtonHovered;
+    QFont m_tabFont;
+    mutable QCache<TabCacheKey, QPixmap> m_pixmapCache;
 };
 
 // 自定义 TabWidget
@@ -47,10 +100,40 @@ public:
     explicit Notepad(QWidget *parent = nullptr);
     ~Notepad();
 
+protected:
+    void closeEvent(QCloseEvent* event) override;
+
 private:
     CustomTabWidget* m_tabWidget;
+    FindBar* m_findBar;
+    FindInFolderPanel* m_findInFolder;
+    OutlinePanel* m_outlinePanel;
     QLabel* m_statusLabel;
     QLabel* m_cursorPosLabel;
+    QLabel* m_statsLabel;
+    QLabel* m_encodingLabel;
+    QLabel* m_memoryLabel;
+    QLabel* m_latencyLabel;
+    QToolButton* m_cancelLoadButton;
+    QAction* m_cancelLoadAction;
+    QAction* m_showPreviewAction;
+    QAction* m_showMinimapAction;
+    QAction* m_checkSpellingAction;
+    QHash<CodeEditor*, FileLoader*> m_loaders;
+    QHash<QWidget*, FileSaver*> m_savers;
+    QHash<QWidget*, DocumentSnapshot*> m_snapshots;   // 保存前正在分块复制文本的 Tab
+    QHash<QWidget*, DocumentSnapshot*> m_reloadSnapshots;   // 重新加载前正在分块复制文本的 Tab
+    QHash<QWidget*, FileReloader*> m_reloaders;
+    QSet<DocumentExporter*> m_exporters;   // 进行中的导出，各自独立运行，不随 Tab 关闭而取消
+    FileRegistry* m_files;
+    QSet<QWidget*> m_staleTabs;   // 磁盘上已修改、等选中（恢复脱水）或插入结束后再重新加载的 Tab
+    DocumentManager* m_documents;
+    SessionStore m_sessionStore;
+    EditJournal* m_journal;
+    QHash<CodeEditor*, QString> m_journalIds;   // 各编辑器的崩溃恢复日志，加载中的编辑器没有日志
+    QHash<QWidget*, SessionTab> m_pendingTabs;   // 尚未恢复内容的会话 Tab
+    QTimer m_restoreTimer;
+    QTimer m_latencyTimer;
     int m_untitledCount;
 
     void initUI();
@@ -61,19 +144,62 @@ private:
 
     CodeEditor* currentEditor();
     CodeEditor* editorAt(int index);
+    LargeFileView* largeViewAt(int index);
+    MarkdownPreview* previewAt(int index);
+    int indexOfEditor(CodeEditor* editor);
+    void applyEditorAppearance(QAbstractScrollArea* editor);
     CodeEditor* createEditorTab(const QString& title, const QString& filePath = QString());
+    QSplitter* createEditorPage(const QString& filePath);
+    CodeEditor* populateEditorPage(QSplitter* page);
+    LargeFileView* createLargeFileView(const QString& fileName, QString* error);
     QString getFilePath(int index);
     void setFilePath(int index, const QString& path);
     void updateTabTitle(int index, const QString& filePath);
+    TextFormat textFormatAt(int index);
+    void setTextFormat(int index, const TextFormat& format);
+    void updateEncodingLabel();
+    void updateMemoryLabel();
+    void updateLatencyLabel();
+    void updateStatsLabel();
+    void exportLatencyTrace();
+    void openFile(const QString& fileName);
+    void openLargeFile(const QString& fileName);
+    void openFileAt(const QString& fileName, int line, int column);
+    FileLoader* startLoading(CodeEditor* editor, const QString& fileName);
+    bool restoreSession();
+    bool saveSession();
+    int recoverJournals(Session* session);
+    void resetJournal(CodeEditor* editor, bool snapshot);
+    void endJournal(CodeEditor* editor);
+    void restoreTab(int index);
+    void restoreNextTab();
+    void saveTab(int index, const QString& filePath);
+    void startSaver(QWidget* page, const QString& filePath, FileSaver* saver, quint64 revision);
+    // 正在取快照或写盘
+    bool isSaving(QWidget* page) const { return m_savers.contains(page) || m_snapshots.contains(page); }
+    void exportTab(int index, DocumentExporter::Format format);
+    void startExporter(DocumentExporter* exporter);
+    void finishLoading(CodeEditor* editor);
+    void reloadFromDisk(QWidget* page);
+    void startReloader(QWidget* page, const QString& filePath, const QString& text, int revision);
+    void applyReload(QWidget* page, FileReloader* reloader, int revision);
+    bool stopLoading(CodeEditor* editor);
+    void updateLoadingState();
 
 private slots:
     void onNewFile();
     void onOpenFile();
+    void onCancelLoading();
+    void onGoToLine();
     void onSaveFile();
     void onSaveAsFile();
+    void onExportHtml();
+    void onExportPdf();
     void onCloseTab(int index);
     void onTabChanged(int index);
     void updateCursorPosition();
+    void onFileChangedOnDisk(QObject* page);
+    void onFileRemovedOnDisk(QObject* page, const QString& filePath);
 };
 
 #endif // NOTEPAD_H
@@ -0,0 +1,146 @@
+#include "outlineindex.h"
+#include <algorithm>
+
+// ============ OutlineIndex 实现 ============
+OutlineIndex::OutlineIndex(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int OutlineIndex::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant OutlineIndex::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= count())
+        return QVariant();
+
+    const Entry& entry = m_entries.at(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        // 列表是平铺的，按级别缩进表示层次
+        return QString((entry.level - 1) * 2, QLatin1Char(' ')) + entry.title;
+    case Qt::ToolTipRole:
+        return QString("Line %1").arg(lineAt(index.row()) + 1);
+    case LineRole:
+        return lineAt(index.row());
+    case LevelRole:
+        return entry.level;
+    default:
+        return QVariant();
+    }
+}
+
+int OutlineIndex::lineAt(int row) const
+{
+    const Entry& entry = m_entries.at(row);
+    return entry.setext ? entry.line - 1 : entry.line;
+}
+
+int OutlineIndex::levelAt(int row) const
+{
+    return m_entries.at(row).level;
+}
+
+int OutlineIndex::lowerBound(int line) const
+{
+    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), line,
+                               [](const Entry& entry, int value) { return entry.line < value; });
+    return int(it - m_entries.cbegin());
+}
+
+int OutlineIndex::rowForLine(int line) const
+{
+    // Setext 标题的文字行也属于该标题
+    int row = lowerBound(line + 1) - 1;
+    if (row + 1 < count() && m_entries.at(row + 1).setext && m_entries.at(row + 1).line == line + 1)
+        ++row;
+    return row;
+}
+
+void OutlineIndex::blocksChanged(int last, int delta)
+{
+    // 编辑区间内（直到 last）的块都会被重新高亮，其上的标题原地更新；
+    // 删除的行对应旧块号 (last, last - delta]，之后的块号统一平移
+    if (delta < 0)
+    {
+        const int from = lowerBound(last + 1);
+        const int to = lowerBound(last - delta + 1);
+        if (to > from)
+        {
+            beginRemoveRows(QModelIndex(), from, to - 1);
+            m_entries.remove(from, to - from);
+            endRemoveRows();
+        }
+    }
+
+    if (delta != 0)
+    {
+        // 块号不显示在列表中，平移不需要通知视图
+        for (int row = lowerBound(last - delta + 1); row < count(); ++row)
+            m_entries[row].line += delta;
+    }
+}
+
+void OutlineIndex::setHeading(int line, int level, const QString& title, bool setext)
+{
+    const int row = lowerBound(line);
+    const bool exists = row < count() && m_entries.at(row).line == line;
+
+    if (level <= 0)
+    {
+        if (exists)
+        {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_entries.remove(row);
+            endRemoveRows();
+        }
+        return;
+    }
+
+    if (exists)
+    {
+        Entry& entry = m_entries[row];
+        if (entry.level == level && entry.setext == setext && entry.title == title)
+            return;
+        entry.level = level;
+        entry.setext = setext;
+        entry.title = title;
+        const QModelIndex changed = index(row);
+        emit dataChanged(changed, changed);
+        return;
+    }
+
+    Entry entry;
+    entry.line = line;
+    entry.level = level;
+    entry.setext = setext;
+    entry.title = title;
+    beginInsertRows(QModelIndex(), row, row);
+    m_entries.insert(row, entry);
+    endInsertRows();
+}
+
+void OutlineIndex::setSetextTitle(int line, const QString& title)
+{
+    const int row = lowerBound(line);
+    if (row >= count() || m_entries.at(row).line != line || !m_entries.at(row).setext
+        || m_entries.at(row).title == title)
+        return;
+
+    m_entries[row].title = title;
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+void OutlineIndex::clear()
+{
+    if (m_entries.isEmpty())
+        return;
+    beginResetModel();
+    m_entries.clear();
+    endResetModel();
+}
@@ -0,0 +1,54 @@
+#ifndef OUTLINEINDEX_H
+#define OUTLINEINDEX_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+
+// 文档的标题索引（大纲）：按块号排序的 ATX 与 Setext 标题。
+// 由 MarkdownHighlighter 随增量高亮逐块维护——编辑只影响被重新高亮的块，
+// 其后的标题按增删的行数平移，从不重新扫描整个文档。按行号查找是 O(log n)
+class OutlineIndex : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles { LineRole = Qt::UserRole, LevelRole };
+
+    explicit OutlineIndex(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    int count() const { return int(m_entries.size()); }
+    // 跳转的目标行：ATX 标题为其所在行，Setext 标题为下划线上方的文字行
+    int lineAt(int row) const;
+    int levelAt(int row) const;
+    // 位于 line 处或之前的最后一个标题（即 line 所属的章节），没有时返回 -1
+    int rowForLine(int line) const;
+
+    // 一次编辑后直到 last 的块将被重新高亮，delta 为增删的块数：
+    // 被删除块上的标题移除，之后的标题平移
+    void blocksChanged(int last, int delta);
+    // 登记块 line 的高亮结果，level 为 0 表示不是标题。Setext 标题登记在下划线所在的块上
+    void setHeading(int line, int level, const QString& title, bool setext);
+    // 块 line 是 Setext 标题的下划线时更新其文字（文字行单独修改时）
+    void setSetextTitle(int line, const QString& title);
+    void clear();
+
+private:
+    struct Entry
+    {
+        int line = 0;
+        int level = 0;
+        bool setext = false;
+        QString title;
+    };
+
+    // 第一个 line 不小于给定值的条目
+    int lowerBound(int line) const;
+
+    QVector<Entry> m_entries;
+};
+
+#endif // OUTLINEINDEX_H
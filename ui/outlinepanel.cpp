@@ -0,0 +1,90 @@
+#include "outlinepanel.h"
+#include "markdownhighlighter.h"
+#include "outlineindex.h"
+#include <QListView>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace OutlineTheme {
+    const QColor background(39, 40, 34);       // #272822
+    const QColor foreground(248, 248, 242);    // #f8f8f2
+    const QColor selection(73, 72, 62);        // #49483e
+}
+
+// ============ OutlinePanel 实现 ============
+OutlinePanel::OutlinePanel(QWidget* parent)
+    : QDockWidget("Outline", parent)
+{
+    setObjectName("OutlinePanel");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
+
+    // 行高一致时视图按行号直接定位，几万个标题的滚动与插入都不需要逐行测量
+    m_list = new QListView(this);
+    m_list->setUniformItemSizes(true);
+    m_list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_list->setFrameShape(QFrame::NoFrame);
+    m_list->setFont(QFont("SF Pro Text", 11));
+    QPalette pal = m_list->palette();
+    pal.setColor(QPalette::Base, OutlineTheme::background);
+    pal.setColor(QPalette::Text, OutlineTheme::foreground);
+    pal.setColor(QPalette::Highlight, OutlineTheme::selection);
+    pal.setColor(QPalette::HighlightedText, OutlineTheme::foreground);
+    m_list->setPalette(pal);
+    setWidget(m_list);
+
+    connect(m_list, &QListView::activated, this, &OutlinePanel::onActivated);
+    connect(m_list, &QListView::clicked, this, &OutlinePanel::onActivated);
+    // 隐藏期间不跟随光标，显示时再同步
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible)
+            syncCurrentHeading();
+    });
+}
+
+void OutlinePanel::setEditor(CodeEditor* editor)
+{
+    if (editor == m_editor)
+        return;
+
+    if (m_editor)
+        disconnect(m_editor, nullptr, this, nullptr);
+
+    m_editor = editor;
+    m_list->setModel(editor ? editor->highlighter()->outline() : nullptr);
+
+    if (editor)
+    {
+        connect(editor, &CodeEditor::cursorPositionChanged, this, &OutlinePanel::syncCurrentHeading);
+        syncCurrentHeading();
+    }
+}
+
+void OutlinePanel::onActivated(const QModelIndex& index)
+{
+    if (!m_editor || !index.isValid())
+        return;
+
+    // 块表按行号查找是 O(log n)
+    m_editor->goToLine(index.data(OutlineIndex::LineRole).toInt());
+    m_editor->setFocus();
+}
+
+void OutlinePanel::syncCurrentHeading()
+{
+    if (!m_editor || !isVisible())
+        return;
+
+    OutlineIndex* outline = m_editor->highlighter()->outline();
+    const int row = outline->rowForLine(m_editor->textCursor().blockNumber());
+    if (row < 0)
+    {
+        m_list->clearSelection();
+        return;
+    }
+
+    const QModelIndex index = outline->index(row);
+    if (m_list->currentIndex() != index)
+    {
+        m_list->setCurrentIndex(index);
+        m_list->scrollTo(index);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef OUTLINEPANEL_H
+#define OUTLINEPANEL_H
+
+#include <QDockWidget>
+#include <QPointer>
+#include "codeeditor.h"
+
+class QListView;
+class QModelIndex;
+
+// 大纲面板：直接显示当前编辑器的标题索引，不复制条目；
+// 点击条目跳到对应行，光标移动时选中所在的章节
+class OutlinePanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit OutlinePanel(QWidget* parent = nullptr);
+
+    void setEditor(CodeEditor* editor);
+
+private slots:
+    void onActivated(const QModelIndex& index);
+    void syncCurrentHeading();
+
+private:
+    QPointer<CodeEditor> m_editor;
+    QListView* m_list;
+};
+
+#endif // OUTLINEPANEL_H
@@ -0,0 +1,395 @@
+#include "spellchecker.h"
+#include "codeeditor.h"
+#include "markdownhighlighter.h"
+#include "../core/spelldictionary.h"
+#include <QScrollBar>
+#include <QSet>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QThread>
+
+// 主题颜色（与 notepad.cpp 中保持一致）
+namespace SpellTheme {
+    const QColor underline(249, 38, 114);   // #f92672
+}
+
+namespace {
+    // 编辑或滚动停下多久之后提交检查
+    const int CheckDelayMs = 300;
+    // 结果陆续返回时合并刷新下划线
+    const int RefreshDelayMs = 30;
+    // 每次提交的被修改块的上限（可见块另计），粘贴大段文字时其余的等滚动到时再检查
+    const int MaxDirtyBlocks = 500;
+    // 缓存的总字符数
+    const int CacheChars = 4 * 1024 * 1024;
+    const int MinWordLength = 2;
+
+    bool isSpace(QChar c)
+    {
+        return c == QLatin1Char(' ') || c == QLatin1Char('\t');
+    }
+
+    int runLength(const QString& text, int pos, QChar c)
+    {
+        int n = 0;
+        while (pos + n < text.size() && text.at(pos + n) == c)
+            ++n;
+        return n;
+    }
+
+    bool isApostrophe(QChar c)
+    {
+        return c == QLatin1Char('\'') || c == QChar(0x2019);
+    }
+
+    // at 处的字符把词与相邻的字母数字连成文件名、标识符之类的技术性记号
+    bool joinsToken(const QString& text, int at)
+    {
+        if (at < 0 || at >= text.size())
+            return false;
+        const QChar c = text.at(at);
+        if (c.isDigit() || c == QLatin1Char('_') || c == QLatin1Char('/') || c == QLatin1Char('\\'))
+            return true;
+        if (c == QLatin1Char('.') || c == QLatin1Char(':'))
+            return at > 0 && at + 1 < text.size() && text.at(at - 1).isLetterOrNumber() && text.at(at + 1).isLetterOrNumber();
+        return false;
+    }
+
+    // 只检查拉丁字母拼写的词；词中有大写字母的视为标识符或缩写（如 QString、API）
+    bool shouldCheck(QStringView word)
+    {
+        if (word.size() < MinWordLength)
+            return false;
+        for (qsizetype i = 0; i < word.size(); ++i)
+        {
+            const QChar c = word.at(i);
+            if (!c.isLetter())
+                continue;
+            if (c.script() != QChar::Script_Latin)
+                return false;
+            if (i > 0 && c.isUpper())
+                return false;
+        }
+        return true;
+    }
+
+    bool isKnown(const SpellDictionary& dictionary, QStringView word)
+    {
+        QString normalized = word.toString();
+        normalized.replace(QChar(0x2019), QLatin1Char('\''));
+        if (dictionary.contains(normalized))
+            return true;
+
+        // 句首大写的词按小写查找
+        const QString lower = normalized.toLower();
+        if (lower != normalized && dictionary.contains(lower))
+            return true;
+
+        // 所有格
+        if (lower.endsWith(QLatin1String("'s")))
+            return dictionary.contains(normalized.chopped(2)) || dictionary.contains(lower.chopped(2));
+        return false;
+    }
+}
+
+// ============ SpellChecker 实现 ============
+SpellChecker::SpellChecker(CodeEditor* editor)
+    : QObject(editor)
+    , m_editor(editor)
+    , m_document(editor->document())
+    , m_enabled(false)
+    , m_dirtyFrom(-1)
+    , m_dirtyTo(-1)
+    , m_cache(CacheChars)
+    , m_running(false)
+    , m_thread(nullptr)
+    , m_stopping(false)
+    , m_unavailable(false)
+{
+    m_format.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    m_format.setUnderlineColor(SpellTheme::underline);
+
+    m_scheduleTimer.setSingleShot(true);
+    m_scheduleTimer.setInterval(CheckDelayMs);
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(RefreshDelayMs);
+
+    connect(&m_scheduleTimer, &QTimer::timeout, this, &SpellChecker::schedule);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &SpellChecker::updateSelections);
+    connect(this, &SpellChecker::blockChecked, this, &SpellChecker::onBlockChecked, Qt::QueuedConnection);
+    connect(m_document, &QTextDocument::contentsChange, this, &SpellChecker::onContentsChange);
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        if (m_enabled)
+            m_scheduleTimer.start();
+    });
+}
+
+SpellChecker::~SpellChecker()
+{
+    m_stopping = true;
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void SpellChecker::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled)
+        return;
+
+    m_enabled = enabled;
+    if (enabled)
+    {
+        schedule();
+        return;
+    }
+
+    m_scheduleTimer.stop();
+    m_refreshTimer.stop();
+    m_dirtyFrom = m_dirtyTo = -1;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.clear();
+    }
+    m_editor->setSpellSelections(QList<QTextEdit::ExtraSelection>());
+}
+
+void SpellChecker::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    if (!m_enabled)
+        return;
+
+    // 只记录编辑后的块区间；块号随之后的编辑偏移时最多多检查或漏检几个块，滚动到时仍会补上
+    const int first = m_document->findBlock(position).blockNumber();
+    const int last = qMax(first, m_document->findBlock(position + charsAdded).blockNumber());
+    m_dirtyFrom = m_dirtyFrom < 0 ? first : qMin(m_dirtyFrom, first);
+    m_dirtyTo = qMax(m_dirtyTo, last);
+    m_scheduleTimer.start();
+}
+
+void SpellChecker::schedule()
+{
+    if (!m_enabled || m_unavailable)
+        return;
+
+    QStringList jobs;
+    QSet<QString> queued;
+    auto collect = [&](int from, int to) {
+        QTextBlock block = m_document->findBlockByNumber(from);
+        for (int number = from; block.isValid() && number <= to; ++number, block = block.next())
+        {
+            if (!isProse(block))
+                continue;
+            const QString text = block.text();
+            if (text.isEmpty() || m_cache.contains(text) || queued.contains(text))
+                continue;
+            queued.insert(text);
+            jobs.append(text);
+        }
+    };
+
+    // 可见块排在前面，先得到结果
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+    collect(first, last);
+    if (m_dirtyFrom >= 0)
+    {
+        collect(m_dirtyFrom, qMin(m_dirtyTo, m_dirtyFrom + MaxDirtyBlocks - 1));
+        m_dirtyFrom = m_dirtyTo = -1;
+    }
+
+    // 已缓存的可见块立即显示
+    updateSelections();
+    if (jobs.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    // 尚未开始的旧任务多半已滚出视口或被修改，整体替换
+    m_jobs = jobs;
+    if (m_running)
+        return;
+
+    m_running = true;
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start(QThread::LowPriority);
+}
+
+void SpellChecker::run()
+{
+    // 第一次检查时才打开词典；词典在所有 Tab 之间共享
+    if (!m_dictionary)
+        m_dictionary = SpellDictionary::defaultDictionary();
+
+    for (;;)
+    {
+        QString text;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_dictionary)
+                m_unavailable = true;
+            if (m_jobs.isEmpty() || m_stopping || m_unavailable)
+            {
+                m_jobs.clear();
+                m_running = false;
+                return;
+            }
+            text = m_jobs.takeFirst();
+        }
+        emit blockChecked(text, check(*m_dictionary, text));
+    }
+}
+
+void SpellChecker::onBlockChecked(const QString& text, const SpellChecker::Misspellings& misspellings)
+{
+    if (!m_enabled)
+        return;
+
+    m_cache.insert(text, new Misspellings(misspellings), int(text.size()) + 1);
+    if (!m_refreshTimer.isActive())
+        m_refreshTimer.start();
+}
+
+void SpellChecker::updateSelections()
+{
+    if (!m_enabled)
+        return;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    int first = 0;
+    int last = 0;
+    m_editor->visibleBlockRange(&first, &last);
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int number = first; block.isValid() && number <= last; ++number, block = block.next())
+    {
+        if (!isProse(block))
+            continue;
+        const Misspellings* misspellings = m_cache.object(block.text());
+        if (!misspellings)
+            continue;
+
+        for (const Misspelling& misspelling : *misspellings)
+        {
+            QTextEdit::ExtraSelection selection;
+            selection.format = m_format;
+            selection.cursor = QTextCursor(m_document);
+            selection.cursor.setPosition(block.position() + misspelling.start);
+            selection.cursor.setPosition(block.position() + misspelling.start + misspelling.length, QTextCursor::KeepAnchor);
+            selections.append(selection);
+        }
+    }
+    m_editor->setSpellSelections(selections);
+}
+
+bool SpellChecker::isProse(const QTextBlock& block) const
+{
+    // 依赖高亮记录的块状态；尚未高亮的块等高亮后再检查
+    if (block.userState() < 0)
+        return false;
+
+    const QTextBlock previous = block.previous();
+    if (previous.isValid() && previous.userState() < 0)
+        return false;
+    const MarkdownBlockState incoming = previous.isValid() ? MarkdownBlockState::decode(previous.userState())
+                                                           : MarkdownBlockState();
+    const MarkdownBlockState outgoing = MarkdownBlockState::decode(block.userState());
+    if (incoming.context != MarkdownBlockState::Normal || outgoing.context != MarkdownBlockState::Normal)
+        return false;
+
+    // 缩进代码块
+    const QString text = block.text();
+    if (incoming.previousBlank && !incoming.inList
+        && (text.startsWith(QLatin1Char('\t')) || text.startsWith(QLatin1String("    "))))
+        return false;
+    return true;
+}
+
+SpellChecker::Misspellings SpellChecker::check(const SpellDictionary& dictionary, const QString& text)
+{
+    Misspellings result;
+    const QStringView view(text);
+    const int n = int(text.size());
+    int i = 0;
+
+    while (i < n)
+    {
+        const QChar c = text.at(i);
+
+        // 行内代码：跳到等长的反引号串，没有闭合时按普通字符处理
+        if (c == QLatin1Char('`'))
+        {
+            const int run = runLength(text, i, c);
+            const int close = int(text.indexOf(QString(run, c), i + run));
+            i = close >= 0 ? close + run : i + run;
+            continue;
+        }
+
+        // HTML 标签与自动链接 <...>
+        if (c == QLatin1Char('<') && i + 1 < n
+            && (text.at(i + 1).isLetter() || text.at(i + 1) == QLatin1Char('/') || text.at(i + 1) == QLatin1Char('!')))
+        {
+            const int close = int(text.indexOf(QLatin1Char('>'), i + 1));
+            i = close >= 0 ? close + 1 : n;
+            continue;
+        }
+
+        // 链接地址 [text](url)
+        if (c == QLatin1Char(']') && i + 1 < n && text.at(i + 1) == QLatin1Char('('))
+        {
+            const int close = int(text.indexOf(QLatin1Char(')'), i + 2));
+            i = close >= 0 ? close + 1 : n;
+            continue;
+        }
+
+        if (!c.isLetter())
+        {
+            ++i;
+            continue;
+        }
+
+        // 裸 URL 与邮件地址：整个非空白串都跳过
+        int tokenEnd = i;
+        while (tokenEnd < n && !isSpace(text.at(tokenEnd)))
+            ++tokenEnd;
+        const QStringView token = view.mid(i, tokenEnd - i);
+        if (token.contains(QLatin1String("://")) || token.contains(QLatin1Char('@'))
+            || token.startsWith(QLatin1String("www.")))
+        {
+            i = tokenEnd;
+            continue;
+        }
+
+        // 词：字母（含组合符号）以及夹在字母之间的撇号
+        int end = i;
+        while (end < n)
+        {
+            const QChar ch = text.at(end);
+            if (ch.isLetter() || ch.isMark())
+                ++end;
+            else if (isApostrophe(ch) && end + 1 < n && text.at(end + 1).isLetter())
+                end += 2;
+            else
+                break;
+        }
+
+        const QStringView word = view.mid(i, end - i);
+        if (!joinsToken(text, i - 1) && !joinsToken(text, end) && shouldCheck(word) && !isKnown(dictionary, word))
+        {
+            Misspelling misspelling;
+            misspelling.start = i;
+            misspelling.length = end - i;
+            result.append(misspelling);
+        }
+        i = end;
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+#ifndef SPELLCHECKER_H
+#define SPELLCHECKER_H
+
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QTextCharFormat>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+class CodeEditor;
+class QTextBlock;
+class QTextDocument;
+class QThread;
+class SpellDictionary;
+
+// 后台拼写检查，只检查正文：跳过围栏与缩进代码块、HTML 块、行内代码、链接地址与 URL。
+// 编辑或滚动停下后先提交可见块、再提交被修改的块，由工作线程查词典；
+// 结果按块的文字缓存，块不变就不再检查，从不重新扫描整个文档。
+// 错词以波浪下划线的附加选区显示，只覆盖可见块
+class SpellChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 块内一个错词的位置
+    struct Misspelling
+    {
+        int start = 0;
+        int length = 0;
+    };
+    typedef QVector<Misspelling> Misspellings;
+
+    explicit SpellChecker(CodeEditor* editor);
+    // 析构时等待正在检查的块完成
+    ~SpellChecker();
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    // 一行正文中的错词；在工作线程中调用
+    static Misspellings check(const SpellDictionary& dictionary, const QString& text);
+
+signals:
+    // 工作线程发出，排队送到 GUI 线程
+    void blockChecked(const QString& text, const SpellChecker::Misspellings& misspellings);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void schedule();
+    void onBlockChecked(const QString& text, const SpellChecker::Misspellings& misspellings);
+    void updateSelections();
+
+private:
+    bool isProse(const QTextBlock& block) const;
+    void run();
+
+    CodeEditor* m_editor;
+    QTextDocument* m_document;
+    bool m_enabled;
+    QTimer m_scheduleTimer;
+    QTimer m_refreshTimer;
+    int m_dirtyFrom;   // 上次提交以来被修改的块区间，-1 表示没有
+    int m_dirtyTo;
+    QCache<QString, Misspellings> m_cache;   // 以块的文字为键
+    QTextCharFormat m_format;
+
+    // 以下由 m_mutex 保护；工作线程只在有任务时存在，队列取空后退出
+    QMutex m_mutex;
+    QStringList m_jobs;
+    bool m_running;
+    QThread* m_thread;
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_unavailable;   // 找不到词典
+    std::shared_ptr<const SpellDictionary> m_dictionary;   // 只在工作线程中访问
+};
+
+#endif // SPELLCHECKER_H
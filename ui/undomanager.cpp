@@ -0,0 +1,596 @@
+#include "undomanager.h"
+#include <QDateTime>
+#include <QDir>
+#include <QPlainTextEdit>
+#include <QTemporaryFile>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+    // 默认每个 Tab 常驻历史的上限
+    const qint64 DefaultMemoryLimit = 32LL * 1024 * 1024;
+    // 步骤数上限，超出时丢弃最早的步骤（每步的元数据总是常驻）
+    const int MaxSteps = 100000;
+    // 磁盘日志上限，超出时丢弃最早的步骤
+    const qint64 MaxJournalBytes = 1024LL * 1024 * 1024;
+
+    // 间隔不超过该时间的相邻输入合并为一步
+    const qint64 CoalesceMs = 1000;
+    // 合并后单步的最大长度
+    const int MaxCoalescedLength = 256;
+
+    // 栈顶附近保持明文的步骤数，连续撤销/重做不需要解压
+    const int KeepPlainSteps = 8;
+    // 超过该字节数的步骤在空闲时压缩
+    const qint64 PackThreshold = 8 * 1024;
+    const int CompactDelayMs = 500;
+
+    // 窗口随插入增长，超过该长度后丢弃，下一次编辑前重新记下
+    const int MaxWindowChars = 64 * 1024;
+
+    bool hasSeparator(const QString& text)
+    {
+        return text.contains(QChar::ParagraphSeparator) || text.contains(QLatin1Char('\n'));
+    }
+}
+
+UndoManager::UndoManager(QPlainTextEdit* editor)
+    : QObject(editor)
+    , m_editor(editor)
+    , m_document(editor->document())
+    , m_windowStart(-1)
+    , m_length(editor->document()->characterCount() - 1)
+    , m_index(0)
+    , m_cleanIndex(0)
+    , m_enabled(true)
+    , m_applying(false)
+    , m_syncingModified(false)
+    , m_lastRevision(editor->document()->revision())
+    , m_groupDepth(0)
+    , m_group(0)
+    , m_nextGroup(0)
+    , m_memory(0)
+    , m_limit(DefaultMemoryLimit)
+    , m_journal(nullptr)
+    , m_journalSize(0)
+    , m_spilledBytes(0)
+{
+    // 文档自带的撤销栈关闭后，修改仍通过 contentsChange 通知
+    m_document->setUndoRedoEnabled(false);
+
+    m_compactTimer.setSingleShot(true);
+    m_compactTimer.setInterval(CompactDelayMs);
+
+    connect(m_document, &QTextDocument::contentsChange, this, &UndoManager::onContentsChange);
+    connect(m_document, &QTextDocument::contentsChanged, this, &UndoManager::onContentsChanged);
+    connect(m_document, &QTextDocument::modificationChanged, this, &UndoManager::onModificationChanged);
+    connect(&m_compactTimer, &QTimer::timeout, this, &UndoManager::compact);
+}
+
+UndoManager::~UndoManager()
+{
+    delete m_journal;
+}
+
+void UndoManager::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled)
+        return;
+
+    m_enabled = enabled;
+    if (enabled)
+    {
+        m_length = m_document->characterCount() - 1;
+        m_lastRevision = m_document->revision();
+    }
+    else
+    {
+        m_window = QString();
+        m_windowStart = -1;
+    }
+}
+
+void UndoManager::prepareEdit(int from, int to)
+{
+    if (!m_enabled)
+        return;
+
+    // 退格与向后删除可能越过段落分隔符，因此连同前后各一块
+    QTextBlock first = m_document->findBlock(qMin(from, to));
+    QTextBlock last = m_document->findBlock(qMax(from, to));
+    if (first.previous().isValid())
+        first = first.previous();
+    if (last.next().isValid())
+        last = last.next();
+    const int start = first.position();
+    const int end = qMin(last.position() + last.length(), m_length);
+
+    // 连续输入时窗口已覆盖这一段，不必重新复制
+    if (m_windowStart >= 0 && m_windowStart <= start && end <= m_windowStart + int(m_window.size()))
+        return;
+
+    QTextCursor cursor(m_document);
+    cursor.setPosition(start);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    m_window = cursor.selectedText();
+    m_windowStart = start;
+}
+
+void UndoManager::clear()
+{
+    const bool couldUndo = canUndo();
+    const bool couldRedo = canRedo();
+
+    m_steps.clear();
+    m_index = 0;
+    m_cleanIndex = m_document->isModified() ? -1 : 0;
+    m_memory = 0;
+    m_spilledBytes = 0;
+    m_journalSize = 0;
+    delete m_journal;
+    m_journal = nullptr;
+    m_compactTimer.stop();
+
+    emitAvailability(couldUndo, couldRedo);
+}
+
+void UndoManager::beginGroup()
+{
+    if (m_groupDepth++ == 0)
+        m_group = ++m_nextGroup;
+}
+
+void UndoManager::endGroup()
+{
+    if (m_groupDepth > 0 && --m_groupDepth == 0)
+        m_group = 0;
+}
+
+void UndoManager::setMemoryLimit(qint64 bytes)
+{
+    m_limit = qMax<qint64>(0, bytes);
+    m_compactTimer.start();
+}
+
+qint64 UndoManager::memoryUsage() const
+{
+    return m_memory + qint64(m_steps.size()) * qint64(sizeof(Step)) + qint64(m_window.capacity()) * qint64(sizeof(QChar));
+}
+
+qint64 UndoManager::payloadBytes(const Step& step)
+{
+    if (step.plain)
+        return (qint64(step.removed.size()) + step.inserted.size()) * qint64(sizeof(QChar));
+    return step.packed.size();
+}
+
+void UndoManager::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (!m_enabled)
+        return;
+
+    // 高亮等只改格式的通知不改变文档版本
+    const int revision = m_document->revision();
+    if (charsRemoved == charsAdded && revision == m_lastRevision)
+        return;
+    m_lastRevision = revision;
+
+    // 文档末尾隐含的段落分隔符可能被计入删除与插入的字符数，按实际长度截断
+    const int length = m_document->characterCount() - 1;
+    const int previousLength = m_length;
+    charsAdded = qBound(0, charsAdded, length - position);
+    charsRemoved = qBound(0, charsRemoved, previousLength - position);
+    m_length = length;
+
+    QString inserted;
+    if (charsAdded > 0)
+    {
+        QTextCursor cursor(m_document);
+        cursor.setPosition(position);
+        cursor.setPosition(position + charsAdded, QTextCursor::KeepAnchor);
+        inserted = cursor.selectedText();
+    }
+    // 通知与记下的长度对不上时（不应发生）整体重来，旧的历史位置已不可信
+    if (previousLength - charsRemoved + charsAdded != length)
+    {
+        m_window = QString();
+        m_windowStart = -1;
+        clear();
+        emit contentsEdited(0, previousLength, m_document->toRawText());
+        return;
+    }
+
+    if (charsRemoved == 0 && inserted.isEmpty())
+        return;
+
+    QString removed;
+    const bool known = updateWindow(position, charsRemoved, inserted, &removed);
+    if (!m_applying)
+    {
+        // 删除的文本没有记下，这一步无法撤销，更早的步骤也就无法按位置还原
+        if (known)
+            record(position, removed, inserted);
+        else
+            clear();
+    }
+    emit contentsEdited(position, charsRemoved, inserted);
+}
+
+bool UndoManager::updateWindow(int position, int charsRemoved, const QString& inserted, QString* removed)
+{
+    bool known = charsRemoved == 0;
+    if (m_windowStart < 0)
+        return known;
+
+    const int windowEnd = m_windowStart + int(m_window.size());
+    if (position >= m_windowStart && position + charsRemoved <= windowEnd)
+    {
+        *removed = m_window.mid(position - m_windowStart, charsRemoved);
+        m_window.replace(position - m_windowStart, charsRemoved, inserted);
+        known = true;
+        if (m_window.size() > MaxWindowChars)
+        {
+            m_window = QString();
+            m_windowStart = -1;
+        }
+    }
+    else if (position + charsRemoved <= m_windowStart)
+    {
+        // 修改在窗口之前，窗口整体平移
+        m_windowStart += int(inserted.size()) - charsRemoved;
+    }
+    else if (position < windowEnd)
+    {
+        // 与窗口部分重叠，窗口内容已不可信
+        m_window = QString();
+        m_windowStart = -1;
+    }
+    return known;
+}
+
+void UndoManager::onContentsChanged()
+{
+    // 撤销栈关闭时 QTextDocument 在每次修改后都把文档标记为已修改，这里按历史位置纠正
+    if (m_enabled && !m_applying)
+        syncModified();
+}
+
+void UndoManager::onModificationChanged(bool modified)
+{
+    if (!m_enabled || m_applying || m_syncingModified)
+        return;
+
+    // 保存后 setModified(false)：当前位置成为与磁盘一致的位置
+    if (!modified)
+        m_cleanIndex = m_index;
+    else if (m_cleanIndex == m_index)
+        m_cleanIndex = -1;
+}
+
+void UndoManager::syncModified()
+{
+    const bool modified = m_index != m_cleanIndex;
+    if (m_document->isModified() == modified)
+        return;
+    m_syncingModified = true;
+    m_document->setModified(modified);
+    m_syncingModified = false;
+}
+
+void UndoManager::emitAvailability(bool couldUndo, bool couldRedo)
+{
+    if (canUndo() != couldUndo)
+        emit undoAvailable(canUndo());
+    if (canRedo() != couldRedo)
+        emit redoAvailable(canRedo());
+}
+
+void UndoManager::record(int position, const QString& removed, const QString& inserted)
+{
+    const bool couldUndo = canUndo();
+    const bool couldRedo = canRedo();
+
+    // 新的编辑丢弃重做部分
+    dropRedo();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // 保存之后的第一次编辑不并入保存前的步骤，否则撤销回不到保存时的状态；组内的步骤各自独立
+    if (m_index == 0 || m_cleanIndex == m_index || m_group != 0
+        || !coalesce(m_steps.back(), position, removed, inserted, now))
+    {
+        Step step;
+        step.position = position;
+        step.removedLength = int(removed.size());
+        step.insertedLength = int(inserted.size());
+        step.time = now;
+        step.group = m_group;
+        step.plain = true;
+        step.removed = removed;
+        step.inserted = inserted;
+        m_memory += payloadBytes(step);
+        m_steps.push_back(std::move(step));
+        ++m_index;
+
+        if (int(m_steps.size()) > MaxSteps)
+            dropFront(int(m_steps.size()) - MaxSteps);
+    }
+
+    emitAvailability(couldUndo, couldRedo);
+    m_compactTimer.start();
+}
+
+bool UndoManager::coalesce(Step& top, int position, const QString& removed, const QString& inserted, qint64 now)
+{
+    if (!top.plain || top.group != 0 || now - top.time > CoalesceMs)
+        return false;
+    if (hasSeparator(removed) || hasSeparator(inserted))
+        return false;
+
+    const qint64 before = payloadBytes(top);
+    if (removed.isEmpty() && position == top.position + top.insertedLength
+        && top.insertedLength + inserted.size() <= MaxCoalescedLength)
+    {
+        // 连续输入
+        top.inserted += inserted;
+    }
+    else if (inserted.isEmpty() && top.inserted.isEmpty() && position + removed.size() == top.position
+             && top.removedLength + removed.size() <= MaxCoalescedLength)
+    {
+        // 连续退格
+        top.removed.prepend(removed);
+        top.position = position;
+    }
+    else if (inserted.isEmpty() && top.inserted.isEmpty() && position == top.position
+             && top.removedLength + removed.size() <= MaxCoalescedLength)
+    {
+        // 连续向后删除
+        top.removed += removed;
+    }
+    else
+    {
+        return false;
+    }
+
+    top.removedLength = int(top.removed.size());
+    top.insertedLength = int(top.inserted.size());
+    top.time = now;
+    m_memory += payloadBytes(top) - before;
+    return true;
+}
+
+void UndoManager::undo()
+{
+    // 组尚未结束（如后台插入仍在进行）时撤销会把组拆开
+    if (!canUndo() || m_groupDepth > 0)
+        return;
+
+    const bool couldUndo = canUndo();
+    const bool couldRedo = canRedo();
+
+    // 同一组的步骤按记录的逆序一起撤销
+    const quint64 group = m_steps[size_t(m_index - 1)].group;
+    do
+    {
+        Step& step = m_steps[size_t(m_index - 1)];
+        if (!load(step))
+        {
+            // 日志读取失败：该步骤及更早的历史无法恢复
+            dropFront(m_index);
+            syncModified();
+            emitAvailability(couldUndo, couldRedo);
+            return;
+        }
+
+        apply(step, true);
+        --m_index;
+    } while (group != 0 && m_index > 0 && m_steps[size_t(m_index - 1)].group == group);
+    syncModified();
+    emitAvailability(couldUndo, couldRedo);
+    m_compactTimer.start();
+}
+
+void UndoManager::redo()
+{
+    if (!canRedo() || m_groupDepth > 0)
+        return;
+
+    const bool couldUndo = canUndo();
+    const bool couldRedo = canRedo();
+
+    const quint64 group = m_steps[size_t(m_index)].group;
+    do
+    {
+        Step& step = m_steps[size_t(m_index)];
+        if (!load(step))
+        {
+            // 重做部分无法恢复，直接丢弃
+            dropRedo();
+            syncModified();
+            emitAvailability(couldUndo, couldRedo);
+            return;
+        }
+
+        apply(step, false);
+        ++m_index;
+    } while (group != 0 && m_index < int(m_steps.size()) && m_steps[size_t(m_index)].group == group);
+    syncModified();
+    emitAvailability(couldUndo, couldRedo);
+    m_compactTimer.start();
+}
+
+void UndoManager::apply(const Step& step, bool undo)
+{
+    const int length = undo ? step.insertedLength : step.removedLength;
+    const QString& text = undo ? step.removed : step.inserted;
+
+    // 窗口仍随 contentsChange 更新，只是不记录为新的步骤
+    m_applying = true;
+    QTextCursor cursor(m_document);
+    cursor.setPosition(step.position);
+    cursor.setPosition(step.position + length, QTextCursor::KeepAnchor);
+    cursor.insertText(text);
+    m_applying = false;
+
+    QTextCursor editorCursor = m_editor->textCursor();
+    editorCursor.setPosition(step.position + int(text.size()));
+    m_editor->setTextCursor(editorCursor);
+    m_editor->ensureCursorVisible();
+}
+
+void UndoManager::pack(Step& step)
+{
+    if (!step.plain)
+        return;
+
+    const qint64 before = payloadBytes(step);
+    QByteArray raw;
+    raw.reserve((step.removed.size() + step.inserted.size()) * qsizetype(sizeof(QChar)));
+    raw.append(reinterpret_cast<const char*>(step.removed.constData()), step.removed.size() * qsizetype(sizeof(QChar)));
+    raw.append(reinterpret_cast<const char*>(step.inserted.constData()), step.inserted.size() * qsizetype(sizeof(QChar)));
+    // 压缩级别取 1，优先速度
+    step.packed = qCompress(raw, 1);
+    step.removed.clear();
+    step.inserted.clear();
+    step.plain = false;
+    m_memory += payloadBytes(step) - before;
+}
+
+bool UndoManager::load(Step& step)
+{
+    if (step.plain)
+        return true;
+
+    const qint64 before = payloadBytes(step);
+    if (step.packed.isEmpty())
+    {
+        if (!m_journal || !m_journal->seek(step.journalOffset))
+            return false;
+        step.packed = m_journal->read(step.journalSize);
+        if (step.packed.size() != step.journalSize)
+        {
+            step.packed.clear();
+            return false;
+        }
+    }
+
+    const QByteArray raw = qUncompress(step.packed);
+    const qsizetype expected = (qsizetype(step.removedLength) + step.insertedLength) * qsizetype(sizeof(QChar));
+    if (raw.size() != expected)
+        return false;
+
+    const QChar* chars = reinterpret_cast<const QChar*>(raw.constData());
+    step.removed = QString(chars, step.removedLength);
+    step.inserted = QString(chars + step.removedLength, step.insertedLength);
+    step.plain = true;
+    step.packed.clear();
+    m_memory += payloadBytes(step) - before;
+    return true;
+}
+
+bool UndoManager::spill(Step& step)
+{
+    if (step.journalOffset < 0)
+    {
+        if (!m_journal)
+        {
+            m_journal = new QTemporaryFile(QDir::tempPath() + "/markdowneditor-undo-XXXXXX.journal");
+            if (!m_journal->open())
+            {
+                delete m_journal;
+                m_journal = nullptr;
+                return false;
+            }
+        }
+
+        pack(step);
+        if (m_journalSize + step.packed.size() > MaxJournalBytes)
+            return false;
+        if (!m_journal->seek(m_journalSize) || m_journal->write(step.packed) != step.packed.size())
+            return false;
+        step.journalOffset = m_journalSize;
+        step.journalSize = int(step.packed.size());
+        m_journalSize += step.journalSize;
+        m_spilledBytes += step.journalSize;
+    }
+
+    // 日志中已有副本，释放内存中的负载即可
+    m_memory -= payloadBytes(step);
+    step.removed.clear();
+    step.inserted.clear();
+    step.packed.clear();
+    step.plain = false;
+    return true;
+}
+
+void UndoManager::dropFront(int count)
+{
+    // 不留下半个组：与最后丢弃的步骤同组的步骤一并丢弃
+    int dropped = 0;
+    quint64 group = 0;
+    while (!m_steps.empty() && (dropped < count || (group != 0 && m_steps.front().group == group)))
+    {
+        const Step& step = m_steps.front();
+        group = step.group;
+        m_memory -= payloadBytes(step);
+        if (step.journalOffset >= 0)
+            m_spilledBytes -= step.journalSize;
+        m_steps.pop_front();
+        ++dropped;
+    }
+    m_index = qMax(0, m_index - dropped);
+    m_cleanIndex = m_cleanIndex >= dropped ? m_cleanIndex - dropped : -1;
+}
+
+void UndoManager::dropRedo()
+{
+    while (int(m_steps.size()) > m_index)
+    {
+        const Step& step = m_steps.back();
+        m_memory -= payloadBytes(step);
+        if (step.journalOffset >= 0)
+            m_spilledBytes -= step.journalSize;
+        m_steps.pop_back();
+    }
+    if (m_cleanIndex > m_index)
+        m_cleanIndex = -1;
+}
+
+void UndoManager::compact()
+{
+    const bool couldUndo = canUndo();
+    const bool couldRedo = canRedo();
+    const int size = int(m_steps.size());
+    auto nearTop = [this](int i) { return i >= m_index - KeepPlainSteps && i < m_index + KeepPlainSteps; };
+
+    // 远离栈顶的大步骤压缩存放
+    for (int i = 0; i < size; ++i)
+    {
+        Step& step = m_steps[size_t(i)];
+        if (step.plain && !nearTop(i) && payloadBytes(step) >= PackThreshold)
+            pack(step);
+    }
+
+    // 超出上限时先把最早的步骤写入磁盘日志，再处理重做部分中最远的步骤
+    for (int i = 0; i < size && m_memory > m_limit; ++i)
+    {
+        Step& step = m_steps[size_t(i)];
+        if (nearTop(i) || payloadBytes(step) == 0)
+            continue;
+        if (!spill(step))
+        {
+            // 无法写入日志：丢弃到该步骤为止的历史
+            dropFront(i + 1);
+            emitAvailability(couldUndo, couldRedo);
+            m_compactTimer.start();
+            return;
+        }
+    }
+    for (int i = size - 1; i >= 0 && m_memory > m_limit; --i)
+    {
+        Step& step = m_steps[size_t(i)];
+        if (nearTop(i) || payloadBytes(step) == 0)
+            continue;
+        spill(step);
+    }
+}
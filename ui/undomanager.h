@@ -0,0 +1,119 @@
+#ifndef UNDOMANAGER_H
+#define UNDOMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <deque>
+
+class QPlainTextEdit;
+class QTemporaryFile;
+class QTextDocument;
+
+// 有内存上限的撤销历史，取代 QTextDocument 自带的无上限撤销栈。
+// 插入的文本在 contentsChange 时从文档读出；删除的文本取自修改前记下的一小段窗口
+// （编辑位置所在的块及前后各一块，随后续修改同步更新），不保留整个文档的副本。
+// 删除的内容不在窗口中时（绕过编辑器的修改）无法记录，此前的历史随之清空。
+// 相邻的小编辑（连续输入、退格）合并为一步；空闲时把远离栈顶的大步骤压缩，
+// 常驻历史超过上限后把最远的步骤写入磁盘日志，撤销到那里时再读回
+class UndoManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UndoManager(QPlainTextEdit* editor);
+    ~UndoManager();
+
+    // 关闭期间（加载、脱水与恢复）文档的变化不记录，窗口也被释放。
+    // 期间文本若有实质变化，调用方应随后调用 clear()
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+    void clear();
+
+    // 即将修改 [from, to) 一带的文本时调用：记下这段及所在块前后各一块修改前的内容。
+    // 编辑块内的多处修改合并为一次通知，应传入覆盖全部修改的区间
+    void prepareEdit(int from, int to);
+
+    // 组内的修改（如多光标在各处的同一次输入）记录为同一组步骤，一起撤销与重做；可以嵌套。
+    // 组结束之前不接受撤销与重做
+    void beginGroup();
+    void endGroup();
+
+    bool canUndo() const { return m_index > 0; }
+    bool canRedo() const { return m_index < int(m_steps.size()); }
+
+    qint64 memoryLimit() const { return m_limit; }
+    void setMemoryLimit(qint64 bytes);
+    // 常驻的历史与窗口
+    qint64 memoryUsage() const;
+    qint64 spilledBytes() const { return m_spilledBytes; }
+
+public slots:
+    void undo();
+    void redo();
+
+signals:
+    void undoAvailable(bool available);
+    void redoAvailable(bool available);
+    // 开启期间文本的每次实际修改，包括撤销与重做；段落分隔符为 U+2029（与 toRawText 一致）
+    void contentsEdited(int position, int removedLength, const QString& inserted);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onContentsChanged();
+    void onModificationChanged(bool modified);
+    void compact();
+
+private:
+    struct Step
+    {
+        int position = 0;
+        int removedLength = 0;
+        int insertedLength = 0;
+        qint64 time = 0;            // 最近一次合并的时间，毫秒
+        quint64 group = 0;          // 所属的组，0 表示不属于任何组
+        bool plain = false;         // removed/inserted 有效
+        QString removed;
+        QString inserted;
+        QByteArray packed;          // 压缩的 removed + inserted（UTF-16）
+        qint64 journalOffset = -1;  // 已写入磁盘日志的位置
+        int journalSize = 0;
+    };
+
+    bool updateWindow(int position, int charsRemoved, const QString& inserted, QString* removed);
+    void record(int position, const QString& removed, const QString& inserted);
+    bool coalesce(Step& top, int position, const QString& removed, const QString& inserted, qint64 now);
+    void apply(const Step& step, bool undo);
+    bool load(Step& step);
+    void pack(Step& step);
+    bool spill(Step& step);
+    void dropFront(int count);
+    void dropRedo();
+    void syncModified();
+    void emitAvailability(bool couldUndo, bool couldRedo);
+    static qint64 payloadBytes(const Step& step);
+
+    QPlainTextEdit* m_editor;
+    QTextDocument* m_document;
+    QString m_window;     // 文档中 [m_windowStart, m_windowStart + m_window.size()) 的当前内容
+    int m_windowStart;    // -1 表示没有窗口
+    int m_length;         // 上次通知后的文档长度
+    std::deque<Step> m_steps;
+    int m_index;          // 已应用的步骤数，m_steps[m_index - 1] 是下一次撤销的步骤
+    int m_cleanIndex;     // 与磁盘一致（未修改）时的 m_index，-1 表示已不在历史中
+    bool m_enabled;
+    bool m_applying;
+    bool m_syncingModified;
+    int m_lastRevision;
+    int m_groupDepth;
+    quint64 m_group;      // 当前组，不在组内时为 0
+    quint64 m_nextGroup;
+    qint64 m_memory;      // 常驻负载字节数
+    qint64 m_limit;
+    QTemporaryFile* m_journal;
+    qint64 m_journalSize;
+    qint64 m_spilledBytes;
+    QTimer m_compactTimer;
+};
+
+#endif // UNDOMANAGER_H